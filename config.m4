@@ -20,6 +20,47 @@ if test "$PHP_CRYPTO" != "no"; then
     fi
 
     AC_DEFINE(HAVE_CRYPTOLIB,1,[Enable objective OpenSSL Crypto wrapper])
+
+    dnl Check for pthread (used for parallel KDF lanes)
+    AC_CHECK_HEADERS([pthread.h], [
+      PHP_CHECK_LIBRARY(pthread, pthread_create, [
+        PHP_ADD_LIBRARY(pthread,, CRYPTO_SHARED_LIBADD)
+        AC_DEFINE(HAVE_CRYPTO_PTHREAD,1,[Enable crypto worker threads])
+      ])
+    ])
+
+    dnl Check for system random functions (used for getrandom rand backend)
+    AC_CHECK_HEADERS([sys/random.h])
+    AC_CHECK_FUNCS([getrandom arc4random_buf])
+
+    dnl Check for memory mapping (used for crypto.file stream mmap read path)
+    AC_CHECK_HEADERS([sys/mman.h])
+    AC_CHECK_FUNCS([mmap madvise])
+
+    dnl Check for liburing (used for crypto.file stream io_uring backend)
+    AC_CHECK_HEADERS([liburing.h], [
+      PHP_CHECK_LIBRARY(uring, io_uring_queue_init, [
+        PHP_ADD_LIBRARY(uring,, CRYPTO_SHARED_LIBADD)
+        AC_DEFINE(HAVE_CRYPTO_URING,1,[Enable crypto stream io_uring backend])
+      ])
+    ])
+
+    dnl Check for zlib (used for crypto stream compress filter)
+    AC_CHECK_HEADERS([zlib.h], [
+      PHP_CHECK_LIBRARY(z, deflateInit2_, [
+        PHP_ADD_LIBRARY(z,, CRYPTO_SHARED_LIBADD)
+        AC_DEFINE(HAVE_CRYPTO_ZLIB,1,[Enable crypto stream zlib compression])
+      ])
+    ])
+
+    dnl Check for zstd (used for crypto stream compress filter)
+    AC_CHECK_HEADERS([zstd.h], [
+      PHP_CHECK_LIBRARY(zstd, ZSTD_compressStream2, [
+        PHP_ADD_LIBRARY(zstd,, CRYPTO_SHARED_LIBADD)
+        AC_DEFINE(HAVE_CRYPTO_ZSTD,1,[Enable crypto stream zstd compression])
+      ])
+    ])
+
     PHP_SUBST(CRYPTO_SHARED_LIBADD)
     PHP_NEW_EXTENSION(crypto, 
       crypto.c \
@@ -27,8 +68,15 @@ if test "$PHP_CRYPTO" != "no"; then
 	  crypto_cipher.c \
 	  crypto_hash.c \
 	  crypto_kdf.c \
+	  crypto_argon2.c \
+	  crypto_pbkdf2.c \
+	  crypto_scrypt.c \
+	  crypto_thread.c \
       crypto_base64.c \
       crypto_stream.c \
+      crypto_uring.c \
+      crypto_compress.c \
+      crypto_filter.c \
       crypto_rand.c,
       $ext_shared)
   fi
@@ -29,6 +29,7 @@
 #include "php_crypto_cipher.h"
 #include "php_crypto_base64.h"
 #include "php_crypto_stream.h"
+#include "php_crypto_filter.h"
 #include "php_crypto_rand.h"
 #include "php_crypto_kdf.h"
 
@@ -36,8 +37,43 @@
 
 ZEND_DECLARE_MODULE_GLOBALS(crypto)
 
+ZEND_BEGIN_ARG_INFO_EX(arginfo_crypto_hash, 0, 0, 2)
+ZEND_ARG_INFO(0, algorithm)
+ZEND_ARG_INFO(0, data)
+ZEND_ARG_INFO(0, raw_output)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_crypto_hmac, 0, 0, 3)
+ZEND_ARG_INFO(0, algorithm)
+ZEND_ARG_INFO(0, data)
+ZEND_ARG_INFO(0, key)
+ZEND_ARG_INFO(0, raw_output)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_crypto_encrypt, 0, 0, 3)
+ZEND_ARG_INFO(0, algorithm)
+ZEND_ARG_INFO(0, data)
+ZEND_ARG_INFO(0, key)
+ZEND_ARG_INFO(0, iv)
+ZEND_ARG_INFO(1, tag)
+ZEND_ARG_INFO(0, aad)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_crypto_decrypt, 0, 0, 3)
+ZEND_ARG_INFO(0, algorithm)
+ZEND_ARG_INFO(0, data)
+ZEND_ARG_INFO(0, key)
+ZEND_ARG_INFO(0, iv)
+ZEND_ARG_INFO(0, tag)
+ZEND_ARG_INFO(0, aad)
+ZEND_END_ARG_INFO()
+
 /* {{{ crypto_functions[] */
 const zend_function_entry crypto_functions[] = {
+	PHP_CRYPTO_FE(hash, arginfo_crypto_hash)
+	PHP_CRYPTO_FE(hmac, arginfo_crypto_hmac)
+	PHP_CRYPTO_FE(encrypt, arginfo_crypto_encrypt)
+	PHP_CRYPTO_FE(decrypt, arginfo_crypto_decrypt)
 	PHPC_FE_END
 };
 /* }}} */
@@ -51,12 +87,12 @@ zend_module_entry crypto_module_entry = {
 	PHP_MINIT(crypto),
 	PHP_MSHUTDOWN(crypto),
 	NULL,
-	NULL,
+	PHP_RSHUTDOWN(crypto),
 	PHP_MINFO(crypto),
 	PHP_CRYPTO_VERSION,
 	PHP_MODULE_GLOBALS(crypto),
 	PHP_GINIT(crypto),
-	NULL,
+	PHP_GSHUTDOWN(crypto),
 	NULL,
 	STANDARD_MODULE_PROPERTIES_EX
 };
@@ -69,12 +105,25 @@ ZEND_GET_MODULE(crypto)
 /* Base exception */
 PHP_CRYPTO_EXCEPTION_DEFINE(Crypto)
 
+/* {{{ PHP_INI */
+PHP_INI_BEGIN()
+	STD_PHP_INI_ENTRY("crypto.threads", "1", PHP_INI_ALL, OnUpdateLong,
+			threads, zend_crypto_globals, crypto_globals)
+	STD_PHP_INI_ENTRY("crypto.rand_backend", "openssl", PHP_INI_ALL, OnUpdateString,
+			rand_backend, zend_crypto_globals, crypto_globals)
+	STD_PHP_INI_ENTRY("crypto.argon2_max_memory", "268435456", PHP_INI_SYSTEM, OnUpdateLong,
+			argon2_max_memory, zend_crypto_globals, crypto_globals)
+PHP_INI_END()
+/* }}} */
+
 /* {{{ PHP_MINIT_FUNCTION
  */
 PHP_MINIT_FUNCTION(crypto)
 {
 	zend_class_entry ce;
 
+	REGISTER_INI_ENTRIES();
+
 	/* Register base exception */
 	PHP_CRYPTO_EXCEPTION_REGISTER_CE(ce, Crypto, zend_exception_get_default(TSRMLS_C));
 
@@ -91,6 +140,7 @@ PHP_MINIT_FUNCTION(crypto)
 	PHP_MINIT(crypto_hash)(INIT_FUNC_ARGS_PASSTHRU);
 	PHP_MINIT(crypto_base64)(INIT_FUNC_ARGS_PASSTHRU);
 	PHP_MINIT(crypto_stream)(INIT_FUNC_ARGS_PASSTHRU);
+	PHP_MINIT(crypto_filter)(INIT_FUNC_ARGS_PASSTHRU);
 	PHP_MINIT(crypto_rand)(INIT_FUNC_ARGS_PASSTHRU);
 	PHP_MINIT(crypto_kdf)(INIT_FUNC_ARGS_PASSTHRU);
 
@@ -103,6 +153,33 @@ PHP_MINIT_FUNCTION(crypto)
 PHP_GINIT_FUNCTION(crypto)
 {
 	crypto_globals->error_action = PHP_CRYPTO_ERROR_ACTION_EXCEPTION;
+	crypto_globals->threads = 1;
+	memset(&crypto_globals->md_cache, 0, sizeof(php_crypto_alg_cache));
+	memset(&crypto_globals->cipher_cache, 0, sizeof(php_crypto_alg_cache));
+	crypto_globals->md_ctx = NULL;
+	crypto_globals->hmac_ctx = NULL;
+	crypto_globals->cipher_ctx = NULL;
+	crypto_globals->argon2_arena = NULL;
+	crypto_globals->argon2_arena_size = 0;
+	crypto_globals->argon2_max_memory = 268435456;
+	crypto_globals->rand_backend = NULL;
+	crypto_globals->rand_pool = NULL;
+}
+/* }}} */
+
+/* {{{ PHP_GSHUTDOWN_FUNCTION
+*/
+PHP_GSHUTDOWN_FUNCTION(crypto)
+{
+	if (crypto_globals->argon2_arena) {
+		pefree(crypto_globals->argon2_arena, 1);
+		crypto_globals->argon2_arena = NULL;
+		crypto_globals->argon2_arena_size = 0;
+	}
+	if (crypto_globals->rand_pool) {
+		php_crypto_rand_pool_free(crypto_globals->rand_pool);
+		crypto_globals->rand_pool = NULL;
+	}
 }
 /* }}} */
 
@@ -111,9 +188,23 @@ PHP_GINIT_FUNCTION(crypto)
 PHP_MSHUTDOWN_FUNCTION(crypto)
 {
 	PHP_MSHUTDOWN(crypto_stream)(SHUTDOWN_FUNC_ARGS_PASSTHRU);
+	PHP_MSHUTDOWN(crypto_filter)(SHUTDOWN_FUNC_ARGS_PASSTHRU);
 
 	EVP_cleanup();
 
+	UNREGISTER_INI_ENTRIES();
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ PHP_RSHUTDOWN_FUNCTION
+ */
+PHP_RSHUTDOWN_FUNCTION(crypto)
+{
+	PHP_RSHUTDOWN(crypto_hash)(SHUTDOWN_FUNC_ARGS_PASSTHRU);
+	PHP_RSHUTDOWN(crypto_cipher)(SHUTDOWN_FUNC_ARGS_PASSTHRU);
+
 	return SUCCESS;
 }
 /* }}} */
@@ -127,7 +218,15 @@ PHP_MINFO_FUNCTION(crypto)
 	php_info_print_table_row(2, "Crypto Version", PHP_CRYPTO_VERSION);
 	php_info_print_table_row(2, "OpenSSL Library Version", SSLeay_version(SSLEAY_VERSION));
 	php_info_print_table_row(2, "OpenSSL Header Version", OPENSSL_VERSION_TEXT);
+	php_info_print_table_row(2, "Base64 Engine", php_crypto_base64_engine_name());
+#ifdef HAVE_CRYPTO_URING
+	php_info_print_table_row(2, "io_uring Support", "enabled");
+#else
+	php_info_print_table_row(2, "io_uring Support", "disabled");
+#endif
 	php_info_print_table_end();
+
+	DISPLAY_INI_ENTRIES();
 }
 /* }}} */
 
@@ -149,6 +248,45 @@ PHP_CRYPTO_API int php_crypto_long_to_int(
 }
 /* }}} */
 
+/* {{{ php_crypto_alg_cache_find */
+PHP_CRYPTO_API const void *php_crypto_alg_cache_find(
+		php_crypto_alg_cache *cache, const char *name, phpc_str_size_t name_len)
+{
+	php_crypto_alg_cache_entry *entry;
+	int i;
+
+	for (i = 0; i < PHP_CRYPTO_ALG_CACHE_SIZE; i++) {
+		entry = &cache->entries[i];
+		if (entry->alg && entry->name_len == name_len &&
+				!memcmp(entry->name, name, name_len)) {
+			return entry->alg;
+		}
+	}
+	return NULL;
+}
+/* }}} */
+
+/* {{{ php_crypto_alg_cache_add */
+PHP_CRYPTO_API void php_crypto_alg_cache_add(
+		php_crypto_alg_cache *cache, const char *name, phpc_str_size_t name_len,
+		const void *alg)
+{
+	php_crypto_alg_cache_entry *entry;
+
+	if (name_len >= PHP_CRYPTO_ALG_CACHE_NAME_LEN) {
+		return;
+	}
+
+	/* replace the oldest entry */
+	entry = &cache->entries[cache->next];
+	memcpy(entry->name, name, name_len);
+	entry->name[name_len] = '\0';
+	entry->name_len = name_len;
+	entry->alg = alg;
+	cache->next = (cache->next + 1) % PHP_CRYPTO_ALG_CACHE_SIZE;
+}
+/* }}} */
+
 /* {{{ php_crypto_verror */
 PHP_CRYPTO_API void php_crypto_verror(const php_crypto_error_info *info, zend_class_entry *exc_ce,
 		php_crypto_error_action action, int ignore_args TSRMLS_DC, const char *name, va_list args)
@@ -0,0 +1,555 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 2013-2016 Jakub Zelenka                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: Jakub Zelenka <bukka@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "php.h"
+#include "php_crypto.h"
+#include "php_crypto_argon2.h"
+#include "php_crypto_thread.h"
+
+#include <openssl/crypto.h>
+
+ZEND_EXTERN_MODULE_GLOBALS(crypto)
+
+/* Argon2 version and type */
+#define PHP_CRYPTO_ARGON2_VERSION 0x13
+#define PHP_CRYPTO_ARGON2_TYPE_ID 2
+
+/* Number of 64-bit words in a block */
+#define PHP_CRYPTO_ARGON2_QWORDS (PHP_CRYPTO_ARGON2_BLOCK_SIZE / 8)
+
+/* Number of addresses in an address block */
+#define PHP_CRYPTO_ARGON2_ADDRESSES PHP_CRYPTO_ARGON2_QWORDS
+
+/* BLAKE2b sizes */
+#define PHP_CRYPTO_BLAKE2B_BLOCK_SIZE 128
+#define PHP_CRYPTO_BLAKE2B_OUT_SIZE 64
+
+/* Argon2 initial hash (H0) size plus the block and lane numbers */
+#define PHP_CRYPTO_ARGON2_PREHASH_SIZE (PHP_CRYPTO_BLAKE2B_OUT_SIZE + 8)
+
+typedef struct {
+	uint64_t v[PHP_CRYPTO_ARGON2_QWORDS];
+} php_crypto_argon2_block;
+
+typedef struct {
+	uint64_t h[8];
+	uint64_t t[2];
+	unsigned char buf[PHP_CRYPTO_BLAKE2B_BLOCK_SIZE];
+	size_t buf_len;
+	size_t out_len;
+} php_crypto_blake2b_ctx;
+
+/* Shared data for all lanes */
+typedef struct {
+	php_crypto_argon2_block *memory;
+	uint32_t passes;
+	uint32_t lanes;
+	uint32_t blocks;
+	uint32_t lane_length;
+	uint32_t segment_length;
+	uint32_t pass;
+	uint32_t slice;
+} php_crypto_argon2_data;
+
+#define PHP_CRYPTO_ARGON2_ROTR64(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+
+#define PHP_CRYPTO_ARGON2_LOAD64(p) \
+	((uint64_t) (p)[0] | ((uint64_t) (p)[1] << 8) | ((uint64_t) (p)[2] << 16) | \
+	((uint64_t) (p)[3] << 24) | ((uint64_t) (p)[4] << 32) | ((uint64_t) (p)[5] << 40) | \
+	((uint64_t) (p)[6] << 48) | ((uint64_t) (p)[7] << 56))
+
+#define PHP_CRYPTO_ARGON2_STORE32(p, v) do { \
+		(p)[0] = (unsigned char) (v); \
+		(p)[1] = (unsigned char) ((v) >> 8); \
+		(p)[2] = (unsigned char) ((v) >> 16); \
+		(p)[3] = (unsigned char) ((v) >> 24); \
+	} while (0)
+
+#define PHP_CRYPTO_ARGON2_STORE64(p, v) do { \
+		PHP_CRYPTO_ARGON2_STORE32(p, (uint32_t) (v)); \
+		PHP_CRYPTO_ARGON2_STORE32((p) + 4, (uint32_t) ((v) >> 32)); \
+	} while (0)
+
+static const uint64_t php_crypto_blake2b_iv[8] = {
+	0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+	0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+};
+
+static const unsigned char php_crypto_blake2b_sigma[12][16] = {
+	{  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+	{ 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 },
+	{ 11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4 },
+	{  7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8 },
+	{  9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13 },
+	{  2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9 },
+	{ 12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11 },
+	{ 13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10 },
+	{  6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5 },
+	{ 10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13,  0 },
+	{  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+	{ 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 }
+};
+
+#define PHP_CRYPTO_BLAKE2B_G(r, i, a, b, c, d) do { \
+		a = a + b + m[php_crypto_blake2b_sigma[r][2 * (i)]]; \
+		d = PHP_CRYPTO_ARGON2_ROTR64(d ^ a, 32); \
+		c = c + d; \
+		b = PHP_CRYPTO_ARGON2_ROTR64(b ^ c, 24); \
+		a = a + b + m[php_crypto_blake2b_sigma[r][2 * (i) + 1]]; \
+		d = PHP_CRYPTO_ARGON2_ROTR64(d ^ a, 16); \
+		c = c + d; \
+		b = PHP_CRYPTO_ARGON2_ROTR64(b ^ c, 63); \
+	} while (0)
+
+/* {{{ php_crypto_blake2b_compress */
+static void php_crypto_blake2b_compress(php_crypto_blake2b_ctx *ctx,
+		const unsigned char *block, int last)
+{
+	uint64_t m[16], v[16];
+	int i, r;
+
+	for (i = 0; i < 16; i++) {
+		m[i] = PHP_CRYPTO_ARGON2_LOAD64(block + i * 8);
+	}
+	for (i = 0; i < 8; i++) {
+		v[i] = ctx->h[i];
+		v[i + 8] = php_crypto_blake2b_iv[i];
+	}
+	v[12] ^= ctx->t[0];
+	v[13] ^= ctx->t[1];
+	if (last) {
+		v[14] = ~v[14];
+	}
+	for (r = 0; r < 12; r++) {
+		PHP_CRYPTO_BLAKE2B_G(r, 0, v[0], v[4], v[8], v[12]);
+		PHP_CRYPTO_BLAKE2B_G(r, 1, v[1], v[5], v[9], v[13]);
+		PHP_CRYPTO_BLAKE2B_G(r, 2, v[2], v[6], v[10], v[14]);
+		PHP_CRYPTO_BLAKE2B_G(r, 3, v[3], v[7], v[11], v[15]);
+		PHP_CRYPTO_BLAKE2B_G(r, 4, v[0], v[5], v[10], v[15]);
+		PHP_CRYPTO_BLAKE2B_G(r, 5, v[1], v[6], v[11], v[12]);
+		PHP_CRYPTO_BLAKE2B_G(r, 6, v[2], v[7], v[8], v[13]);
+		PHP_CRYPTO_BLAKE2B_G(r, 7, v[3], v[4], v[9], v[14]);
+	}
+	for (i = 0; i < 8; i++) {
+		ctx->h[i] ^= v[i] ^ v[i + 8];
+	}
+}
+/* }}} */
+
+/* {{{ php_crypto_blake2b_init */
+static void php_crypto_blake2b_init(php_crypto_blake2b_ctx *ctx, size_t out_len)
+{
+	memcpy(ctx->h, php_crypto_blake2b_iv, sizeof(ctx->h));
+	/* parameter block without key: digest length, fanout 1 and depth 1 */
+	ctx->h[0] ^= 0x01010000ULL ^ out_len;
+	ctx->t[0] = ctx->t[1] = 0;
+	ctx->buf_len = 0;
+	ctx->out_len = out_len;
+}
+/* }}} */
+
+/* {{{ php_crypto_blake2b_update */
+static void php_crypto_blake2b_update(php_crypto_blake2b_ctx *ctx,
+		const unsigned char *in, size_t in_len)
+{
+	size_t fill;
+
+	/* the last block is kept in the buffer because it is compressed as final */
+	while (in_len > 0) {
+		if (ctx->buf_len == PHP_CRYPTO_BLAKE2B_BLOCK_SIZE) {
+			ctx->t[0] += PHP_CRYPTO_BLAKE2B_BLOCK_SIZE;
+			if (ctx->t[0] < PHP_CRYPTO_BLAKE2B_BLOCK_SIZE) {
+				ctx->t[1]++;
+			}
+			php_crypto_blake2b_compress(ctx, ctx->buf, 0);
+			ctx->buf_len = 0;
+		}
+		fill = PHP_CRYPTO_BLAKE2B_BLOCK_SIZE - ctx->buf_len;
+		if (fill > in_len) {
+			fill = in_len;
+		}
+		memcpy(ctx->buf + ctx->buf_len, in, fill);
+		ctx->buf_len += fill;
+		in += fill;
+		in_len -= fill;
+	}
+}
+/* }}} */
+
+/* {{{ php_crypto_blake2b_final */
+static void php_crypto_blake2b_final(php_crypto_blake2b_ctx *ctx, unsigned char *out)
+{
+	unsigned char digest[PHP_CRYPTO_BLAKE2B_OUT_SIZE];
+	int i;
+
+	ctx->t[0] += ctx->buf_len;
+	if (ctx->t[0] < ctx->buf_len) {
+		ctx->t[1]++;
+	}
+	memset(ctx->buf + ctx->buf_len, 0, PHP_CRYPTO_BLAKE2B_BLOCK_SIZE - ctx->buf_len);
+	php_crypto_blake2b_compress(ctx, ctx->buf, 1);
+
+	for (i = 0; i < 8; i++) {
+		PHP_CRYPTO_ARGON2_STORE64(digest + i * 8, ctx->h[i]);
+	}
+	memcpy(out, digest, ctx->out_len);
+
+	OPENSSL_cleanse(digest, sizeof(digest));
+	OPENSSL_cleanse(ctx, sizeof(*ctx));
+}
+/* }}} */
+
+/* {{{ php_crypto_argon2_hash_long
+	Variable length hash H' */
+static void php_crypto_argon2_hash_long(unsigned char *out, uint32_t out_len,
+		const unsigned char *in, size_t in_len)
+{
+	php_crypto_blake2b_ctx ctx;
+	unsigned char len[4], v[PHP_CRYPTO_BLAKE2B_OUT_SIZE];
+	uint32_t remaining;
+
+	PHP_CRYPTO_ARGON2_STORE32(len, out_len);
+	if (out_len <= PHP_CRYPTO_BLAKE2B_OUT_SIZE) {
+		php_crypto_blake2b_init(&ctx, out_len);
+		php_crypto_blake2b_update(&ctx, len, sizeof(len));
+		php_crypto_blake2b_update(&ctx, in, in_len);
+		php_crypto_blake2b_final(&ctx, out);
+		return;
+	}
+
+	/* the output is made of the first halves of the chained digests */
+	php_crypto_blake2b_init(&ctx, PHP_CRYPTO_BLAKE2B_OUT_SIZE);
+	php_crypto_blake2b_update(&ctx, len, sizeof(len));
+	php_crypto_blake2b_update(&ctx, in, in_len);
+	php_crypto_blake2b_final(&ctx, v);
+	memcpy(out, v, PHP_CRYPTO_BLAKE2B_OUT_SIZE / 2);
+	out += PHP_CRYPTO_BLAKE2B_OUT_SIZE / 2;
+	remaining = out_len - PHP_CRYPTO_BLAKE2B_OUT_SIZE / 2;
+
+	while (remaining > PHP_CRYPTO_BLAKE2B_OUT_SIZE) {
+		php_crypto_blake2b_init(&ctx, PHP_CRYPTO_BLAKE2B_OUT_SIZE);
+		php_crypto_blake2b_update(&ctx, v, PHP_CRYPTO_BLAKE2B_OUT_SIZE);
+		php_crypto_blake2b_final(&ctx, v);
+		memcpy(out, v, PHP_CRYPTO_BLAKE2B_OUT_SIZE / 2);
+		out += PHP_CRYPTO_BLAKE2B_OUT_SIZE / 2;
+		remaining -= PHP_CRYPTO_BLAKE2B_OUT_SIZE / 2;
+	}
+
+	php_crypto_blake2b_init(&ctx, remaining);
+	php_crypto_blake2b_update(&ctx, v, PHP_CRYPTO_BLAKE2B_OUT_SIZE);
+	php_crypto_blake2b_final(&ctx, out);
+
+	OPENSSL_cleanse(v, sizeof(v));
+}
+/* }}} */
+
+/* BlaMka mixing (BLAKE2b G with multiplication instead of the message) */
+#define PHP_CRYPTO_ARGON2_FBLAMKA(x, y) \
+	((x) + (y) + 2 * ((uint64_t) (uint32_t) (x) * (uint32_t) (y)))
+
+#define PHP_CRYPTO_ARGON2_GB(a, b, c, d) do { \
+		a = PHP_CRYPTO_ARGON2_FBLAMKA(a, b); \
+		d = PHP_CRYPTO_ARGON2_ROTR64(d ^ a, 32); \
+		c = PHP_CRYPTO_ARGON2_FBLAMKA(c, d); \
+		b = PHP_CRYPTO_ARGON2_ROTR64(b ^ c, 24); \
+		a = PHP_CRYPTO_ARGON2_FBLAMKA(a, b); \
+		d = PHP_CRYPTO_ARGON2_ROTR64(d ^ a, 16); \
+		c = PHP_CRYPTO_ARGON2_FBLAMKA(c, d); \
+		b = PHP_CRYPTO_ARGON2_ROTR64(b ^ c, 63); \
+	} while (0)
+
+#define PHP_CRYPTO_ARGON2_ROUND(v0, v1, v2, v3, v4, v5, v6, v7, \
+		v8, v9, v10, v11, v12, v13, v14, v15) do { \
+		PHP_CRYPTO_ARGON2_GB(v0, v4, v8, v12); \
+		PHP_CRYPTO_ARGON2_GB(v1, v5, v9, v13); \
+		PHP_CRYPTO_ARGON2_GB(v2, v6, v10, v14); \
+		PHP_CRYPTO_ARGON2_GB(v3, v7, v11, v15); \
+		PHP_CRYPTO_ARGON2_GB(v0, v5, v10, v15); \
+		PHP_CRYPTO_ARGON2_GB(v1, v6, v11, v12); \
+		PHP_CRYPTO_ARGON2_GB(v2, v7, v8, v13); \
+		PHP_CRYPTO_ARGON2_GB(v3, v4, v9, v14); \
+	} while (0)
+
+/* {{{ php_crypto_argon2_fill_block
+	Compression function G (the result is XOR-ed to the next block in later passes) */
+static void php_crypto_argon2_fill_block(const php_crypto_argon2_block *prev,
+		const php_crypto_argon2_block *ref, php_crypto_argon2_block *next, int with_xor)
+{
+	php_crypto_argon2_block r, tmp;
+	uint64_t *v = r.v;
+	int i;
+
+	for (i = 0; i < PHP_CRYPTO_ARGON2_QWORDS; i++) {
+		r.v[i] = ref->v[i] ^ prev->v[i];
+	}
+	memcpy(&tmp, &r, sizeof(tmp));
+	if (with_xor) {
+		for (i = 0; i < PHP_CRYPTO_ARGON2_QWORDS; i++) {
+			tmp.v[i] ^= next->v[i];
+		}
+	}
+
+	/* rows of 16 words */
+	for (i = 0; i < 8; i++) {
+		PHP_CRYPTO_ARGON2_ROUND(
+			v[16 * i], v[16 * i + 1], v[16 * i + 2], v[16 * i + 3],
+			v[16 * i + 4], v[16 * i + 5], v[16 * i + 6], v[16 * i + 7],
+			v[16 * i + 8], v[16 * i + 9], v[16 * i + 10], v[16 * i + 11],
+			v[16 * i + 12], v[16 * i + 13], v[16 * i + 14], v[16 * i + 15]);
+	}
+	/* columns of 8 word pairs */
+	for (i = 0; i < 8; i++) {
+		PHP_CRYPTO_ARGON2_ROUND(
+			v[2 * i], v[2 * i + 1], v[2 * i + 16], v[2 * i + 17],
+			v[2 * i + 32], v[2 * i + 33], v[2 * i + 48], v[2 * i + 49],
+			v[2 * i + 64], v[2 * i + 65], v[2 * i + 80], v[2 * i + 81],
+			v[2 * i + 96], v[2 * i + 97], v[2 * i + 112], v[2 * i + 113]);
+	}
+
+	for (i = 0; i < PHP_CRYPTO_ARGON2_QWORDS; i++) {
+		next->v[i] = tmp.v[i] ^ r.v[i];
+	}
+}
+/* }}} */
+
+/* {{{ php_crypto_argon2_next_addresses */
+static void php_crypto_argon2_next_addresses(php_crypto_argon2_block *address,
+		php_crypto_argon2_block *input, const php_crypto_argon2_block *zero)
+{
+	input->v[6]++;
+	php_crypto_argon2_fill_block(zero, input, address, 0);
+	php_crypto_argon2_fill_block(zero, address, address, 0);
+}
+/* }}} */
+
+/* {{{ php_crypto_argon2_index_alpha
+	Maps the pseudo-random value to the reference block index in the lane */
+static uint32_t php_crypto_argon2_index_alpha(const php_crypto_argon2_data *data,
+		uint32_t index, uint64_t pseudo_rand, int same_lane)
+{
+	uint32_t area_size, start = 0;
+	uint64_t relative;
+
+	if (data->pass == 0) {
+		if (data->slice == 0) {
+			area_size = index - 1;
+		} else if (same_lane) {
+			area_size = data->slice * data->segment_length + index - 1;
+		} else {
+			area_size = data->slice * data->segment_length - (index == 0 ? 1 : 0);
+		}
+	} else {
+		if (same_lane) {
+			area_size = data->lane_length - data->segment_length + index - 1;
+		} else {
+			area_size = data->lane_length - data->segment_length - (index == 0 ? 1 : 0);
+		}
+		if (data->slice != PHP_CRYPTO_ARGON2_SYNC_POINTS - 1) {
+			start = (data->slice + 1) * data->segment_length;
+		}
+	}
+
+	relative = pseudo_rand & 0xFFFFFFFF;
+	relative = (relative * relative) >> 32;
+	relative = area_size - 1 - ((area_size * relative) >> 32);
+
+	return (uint32_t) ((start + relative) % data->lane_length);
+}
+/* }}} */
+
+/* {{{ php_crypto_argon2_fill_segment */
+static void php_crypto_argon2_fill_segment(void *arg, int worker, int lane)
+{
+	php_crypto_argon2_data *data = (php_crypto_argon2_data *) arg;
+	php_crypto_argon2_block address, input, zero, *prev, *ref, *curr;
+	uint64_t pseudo_rand;
+	uint32_t i, start = 0, ref_lane, ref_index, curr_offset, prev_offset;
+	/* Argon2id uses data independent addressing in the first half of the first pass */
+	int independent = data->pass == 0 && data->slice < PHP_CRYPTO_ARGON2_SYNC_POINTS / 2;
+
+	if (independent) {
+		memset(&zero, 0, sizeof(zero));
+		memset(&input, 0, sizeof(input));
+		input.v[0] = data->pass;
+		input.v[1] = lane;
+		input.v[2] = data->slice;
+		input.v[3] = data->blocks;
+		input.v[4] = data->passes;
+		input.v[5] = PHP_CRYPTO_ARGON2_TYPE_ID;
+	}
+
+	/* the first two blocks of each lane are created from the initial hash */
+	if (data->pass == 0 && data->slice == 0) {
+		start = 2;
+		if (independent) {
+			php_crypto_argon2_next_addresses(&address, &input, &zero);
+		}
+	}
+
+	curr_offset = lane * data->lane_length + data->slice * data->segment_length + start;
+	if (curr_offset % data->lane_length == 0) {
+		prev_offset = curr_offset + data->lane_length - 1;
+	} else {
+		prev_offset = curr_offset - 1;
+	}
+
+	for (i = start; i < data->segment_length; i++, curr_offset++, prev_offset++) {
+		if (curr_offset % data->lane_length == 1) {
+			prev_offset = curr_offset - 1;
+		}
+		prev = data->memory + prev_offset;
+		curr = data->memory + curr_offset;
+
+		if (independent) {
+			if (i % PHP_CRYPTO_ARGON2_ADDRESSES == 0) {
+				php_crypto_argon2_next_addresses(&address, &input, &zero);
+			}
+			pseudo_rand = address.v[i % PHP_CRYPTO_ARGON2_ADDRESSES];
+		} else {
+			pseudo_rand = prev->v[0];
+		}
+
+		if (data->pass == 0 && data->slice == 0) {
+			ref_lane = lane;
+		} else {
+			ref_lane = (uint32_t) ((pseudo_rand >> 32) % data->lanes);
+		}
+		ref_index = php_crypto_argon2_index_alpha(data, i, pseudo_rand, ref_lane == (uint32_t) lane);
+		ref = data->memory + (uint64_t) data->lane_length * ref_lane + ref_index;
+
+		php_crypto_argon2_fill_block(prev, ref, curr, data->pass != 0);
+	}
+}
+/* }}} */
+
+/* {{{ php_crypto_argon2_arena */
+PHP_CRYPTO_API void *php_crypto_argon2_arena(size_t size TSRMLS_DC)
+{
+	if (PHP_CRYPTO_G(argon2_arena_size) < size) {
+		if (PHP_CRYPTO_G(argon2_arena)) {
+			pefree(PHP_CRYPTO_G(argon2_arena), 1);
+		}
+		PHP_CRYPTO_G(argon2_arena) = pemalloc(size, 1);
+		PHP_CRYPTO_G(argon2_arena_size) = size;
+	}
+
+	return PHP_CRYPTO_G(argon2_arena);
+}
+/* }}} */
+
+/* {{{ php_crypto_argon2_hash_params */
+static void php_crypto_argon2_hash_params(php_crypto_blake2b_ctx *ctx, uint32_t value,
+		const unsigned char *data, int data_len)
+{
+	unsigned char le[4];
+
+	PHP_CRYPTO_ARGON2_STORE32(le, value);
+	php_crypto_blake2b_update(ctx, le, sizeof(le));
+	if (data_len > 0) {
+		php_crypto_blake2b_update(ctx, data, data_len);
+	}
+}
+/* }}} */
+
+/* {{{ php_crypto_argon2id */
+PHP_CRYPTO_API int php_crypto_argon2id(
+		const char *pass, int pass_len, const unsigned char *salt, int salt_len,
+		const unsigned char *secret, int secret_len, const unsigned char *ad, int ad_len,
+		uint32_t t_cost, uint32_t m_cost, uint32_t lanes, int workers, void *memory,
+		unsigned char *key, int key_len)
+{
+	php_crypto_argon2_data data;
+	php_crypto_blake2b_ctx ctx;
+	php_crypto_argon2_block final;
+	unsigned char prehash[PHP_CRYPTO_ARGON2_PREHASH_SIZE], block[PHP_CRYPTO_ARGON2_BLOCK_SIZE];
+	uint32_t lane, i, j;
+
+	data.memory = (php_crypto_argon2_block *) memory;
+	data.passes = t_cost;
+	data.lanes = lanes;
+	data.blocks = PHP_CRYPTO_ARGON2_BLOCKS(m_cost, lanes);
+	data.lane_length = data.blocks / lanes;
+	data.segment_length = data.lane_length / PHP_CRYPTO_ARGON2_SYNC_POINTS;
+
+	/* H0 */
+	php_crypto_blake2b_init(&ctx, PHP_CRYPTO_BLAKE2B_OUT_SIZE);
+	php_crypto_argon2_hash_params(&ctx, lanes, NULL, 0);
+	php_crypto_argon2_hash_params(&ctx, key_len, NULL, 0);
+	php_crypto_argon2_hash_params(&ctx, m_cost, NULL, 0);
+	php_crypto_argon2_hash_params(&ctx, t_cost, NULL, 0);
+	php_crypto_argon2_hash_params(&ctx, PHP_CRYPTO_ARGON2_VERSION, NULL, 0);
+	php_crypto_argon2_hash_params(&ctx, PHP_CRYPTO_ARGON2_TYPE_ID, NULL, 0);
+	php_crypto_argon2_hash_params(&ctx, pass_len, (const unsigned char *) pass, pass_len);
+	php_crypto_argon2_hash_params(&ctx, salt_len, salt, salt_len);
+	php_crypto_argon2_hash_params(&ctx, secret_len, secret, secret_len);
+	php_crypto_argon2_hash_params(&ctx, ad_len, ad, ad_len);
+	php_crypto_blake2b_final(&ctx, prehash);
+
+	/* the first two blocks of each lane */
+	for (lane = 0; lane < lanes; lane++) {
+		PHP_CRYPTO_ARGON2_STORE32(prehash + PHP_CRYPTO_BLAKE2B_OUT_SIZE + 4, lane);
+		for (i = 0; i < 2; i++) {
+			PHP_CRYPTO_ARGON2_STORE32(prehash + PHP_CRYPTO_BLAKE2B_OUT_SIZE, i);
+			php_crypto_argon2_hash_long(block, PHP_CRYPTO_ARGON2_BLOCK_SIZE,
+					prehash, PHP_CRYPTO_ARGON2_PREHASH_SIZE);
+			for (j = 0; j < PHP_CRYPTO_ARGON2_QWORDS; j++) {
+				data.memory[lane * data.lane_length + i].v[j] =
+						PHP_CRYPTO_ARGON2_LOAD64(block + j * 8);
+			}
+		}
+	}
+
+	/* segments of the same slice are independent so the lanes can run in parallel */
+	for (data.pass = 0; data.pass < t_cost; data.pass++) {
+		for (data.slice = 0; data.slice < PHP_CRYPTO_ARGON2_SYNC_POINTS; data.slice++) {
+			php_crypto_thread_run(php_crypto_argon2_fill_segment, &data, lanes, workers);
+		}
+	}
+
+	/* XOR of the last blocks of all lanes */
+	memcpy(&final, data.memory + data.lane_length - 1, sizeof(final));
+	for (lane = 1; lane < lanes; lane++) {
+		for (j = 0; j < PHP_CRYPTO_ARGON2_QWORDS; j++) {
+			final.v[j] ^= data.memory[lane * data.lane_length + data.lane_length - 1].v[j];
+		}
+	}
+	for (j = 0; j < PHP_CRYPTO_ARGON2_QWORDS; j++) {
+		PHP_CRYPTO_ARGON2_STORE64(block + j * 8, final.v[j]);
+	}
+	php_crypto_argon2_hash_long(key, key_len, block, PHP_CRYPTO_ARGON2_BLOCK_SIZE);
+
+	OPENSSL_cleanse(prehash, sizeof(prehash));
+	OPENSSL_cleanse(block, sizeof(block));
+	OPENSSL_cleanse(&final, sizeof(final));
+
+	return SUCCESS;
+}
+/* }}} */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
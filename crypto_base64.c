@@ -21,38 +21,108 @@
 #include "php_crypto_base64.h"
 #include "zend_exceptions.h"
 
-#include <openssl/evp.h>
-
-#if OPENSSL_VERSION_NUMBER < 0x10100000L
-
-static inline EVP_ENCODE_CTX *EVP_ENCODE_CTX_new()
-{
-	EVP_ENCODE_CTX *ctx = OPENSSL_malloc(sizeof(EVP_ENCODE_CTX));
-
-	return ctx;
-}
-
-static inline void EVP_ENCODE_CTX_free(EVP_ENCODE_CTX *ctx)
-{
-	OPENSSL_free(ctx);
-}
-
-static inline int EVP_ENCODE_CTX_copy(EVP_ENCODE_CTX *dctx, EVP_ENCODE_CTX *sctx)
-{
-	memcpy(dctx, sctx, sizeof (EVP_ENCODE_CTX));
-
-	return 1;
-}
+/* SIMD engine (runtime detected SSSE3 and AVX2 on x86, NEON on AArch64) */
+#if (defined(__x86_64__) || defined(__i386__)) && (__GNUC__ >= 5 || defined(__clang__))
+#define PHP_CRYPTO_HAS_BASE64_SIMD_X86 1
+#include <immintrin.h>
+#define PHP_CRYPTO_BASE64_TARGET(_target) __attribute__((target(_target)))
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define PHP_CRYPTO_HAS_BASE64_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
 
-static inline int EVP_ENCODE_CTX_num(EVP_ENCODE_CTX *ctx)
-{
-	return ctx->num;
-}
+/* Decoding table values that are not base64 values */
+#define PHP_CRYPTO_BASE64_PAD  0x40
+#define PHP_CRYPTO_BASE64_WS   0xE0
+#define PHP_CRYPTO_BASE64_EOLN 0xF0
+#define PHP_CRYPTO_BASE64_CR   0xF1
+#define PHP_CRYPTO_BASE64_EOF  0xF2
+#define PHP_CRYPTO_BASE64_ERR  0xFF
+/* Whether the decoding table value is white space, new line or EOF */
+#define PHP_CRYPTO_BASE64_NOT_BASE64(_v) (((_v) | 0x13) == 0xF3)
+
+static const unsigned char php_crypto_base64_encode_tables[][65] = {
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/",
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"
+};
 
-#define EVP_ENCODE_LENGTH(l) (((l+2)/3*4)+(l/48+1)*2+80)
-#define EVP_DECODE_LENGTH(l) ((l+3)/4*3+80)
+/* The character classes are the same as in OpenSSL EVP decoding (the URL
+ * alphabet has no EOF character) */
+static const unsigned char php_crypto_base64_decode_tables[][256] = {
+	{
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xE0, 0xF0, 0xFF, 0xFF, 0xF1, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xE0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xF2, 0xFF, 0x3F,
+		0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B,
+		0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0x40, 0xFF, 0xFF,
+		0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+		0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+		0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16,
+		0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20,
+		0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+		0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30,
+		0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+	},
+	{
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xE0, 0xF0, 0xFF, 0xFF, 0xF1, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xE0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF,
+		0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B,
+		0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0x40, 0xFF, 0xFF,
+		0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+		0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+		0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16,
+		0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0x3F,
+		0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20,
+		0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+		0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30,
+		0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+	}
+};
 
-#endif
+/* Selected engine kernels */
+static php_crypto_base64_kernel php_crypto_base64_encode_kernel;
+static php_crypto_base64_kernel php_crypto_base64_decode_kernel;
+static const char *php_crypto_base64_engine = "scalar";
 
 PHP_CRYPTO_EXCEPTION_DEFINE(Base64)
 PHP_CRYPTO_ERROR_INFO_BEGIN(Base64)
@@ -80,26 +150,80 @@ PHP_CRYPTO_ERROR_INFO_ENTRY(
 	INPUT_DATA_LENGTH_HIGH,
 	"Input data length can't exceed max integer length"
 )
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	WRAP_INVALID,
+	"The wrap length has to be 0, 64 or 76"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	ALPHABET_INVALID,
+	"Unknown base64 alphabet"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	DATA_TYPE_INVALID,
+	"All data items have to be strings"
+)
 PHP_CRYPTO_ERROR_INFO_END()
 
 ZEND_BEGIN_ARG_INFO(arginfo_crypto_base64_data, 0)
 ZEND_ARG_INFO(0, data)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(arginfo_crypto_base64_encode, 0, 0, 1)
+ZEND_ARG_INFO(0, data)
+ZEND_ARG_INFO(0, wrap)
+ZEND_ARG_INFO(0, alphabet)
+ZEND_ARG_INFO(0, padding)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_crypto_base64_decode, 0, 0, 1)
+ZEND_ARG_INFO(0, data)
+ZEND_ARG_INFO(0, alphabet)
+ZEND_ARG_INFO(0, padding)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_crypto_base64_encode_many, 0, 0, 1)
+ZEND_ARG_ARRAY_INFO(0, data, 0)
+ZEND_ARG_INFO(0, wrap)
+ZEND_ARG_INFO(0, alphabet)
+ZEND_ARG_INFO(0, padding)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_crypto_base64_decode_many, 0, 0, 1)
+ZEND_ARG_ARRAY_INFO(0, data, 0)
+ZEND_ARG_INFO(0, alphabet)
+ZEND_ARG_INFO(0, padding)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_crypto_base64_new, 0, 0, 0)
+ZEND_ARG_INFO(0, wrap)
+ZEND_ARG_INFO(0, alphabet)
+ZEND_ARG_INFO(0, padding)
+ZEND_END_ARG_INFO()
+
 static const zend_function_entry php_crypto_base64_object_methods[] = {
 	PHP_CRYPTO_ME(
 		Base64, encode,
-		arginfo_crypto_base64_data,
+		arginfo_crypto_base64_encode,
 		ZEND_ACC_STATIC|ZEND_ACC_PUBLIC
 	)
 	PHP_CRYPTO_ME(
 		Base64, decode,
-		arginfo_crypto_base64_data,
+		arginfo_crypto_base64_decode,
+		ZEND_ACC_STATIC|ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		Base64, encodeMany,
+		arginfo_crypto_base64_encode_many,
+		ZEND_ACC_STATIC|ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		Base64, decodeMany,
+		arginfo_crypto_base64_decode_many,
 		ZEND_ACC_STATIC|ZEND_ACC_PUBLIC
 	)
 	PHP_CRYPTO_ME(
 		Base64, __construct,
-		NULL,
+		arginfo_crypto_base64_new,
 		ZEND_ACC_CTOR|ZEND_ACC_PUBLIC
 	)
 	PHP_CRYPTO_ME(
@@ -128,6 +252,746 @@ static const zend_function_entry php_crypto_base64_object_methods[] = {
 /* class entry */
 PHP_CRYPTO_API zend_class_entry *php_crypto_base64_ce;
 
+/* {{{ php_crypto_base64_encode_scalar */
+static size_t php_crypto_base64_encode_scalar(unsigned char *out,
+		const unsigned char *in, size_t len, php_crypto_base64_alphabet alphabet)
+{
+	const unsigned char *table = php_crypto_base64_encode_tables[alphabet];
+	size_t i;
+
+	len -= len % 3;
+	for (i = 0; i < len; i += 3) {
+		*out++ = table[in[i] >> 2];
+		*out++ = table[((in[i] & 0x03) << 4) | (in[i + 1] >> 4)];
+		*out++ = table[((in[i + 1] & 0x0f) << 2) | (in[i + 2] >> 6)];
+		*out++ = table[in[i + 2] & 0x3f];
+	}
+
+	return len;
+}
+/* }}} */
+
+/* {{{ php_crypto_base64_decode_scalar
+	Decodes quads of base64 characters until the first quad that contains
+	any other character (including padding) */
+static size_t php_crypto_base64_decode_scalar(unsigned char *out,
+		const unsigned char *in, size_t len, php_crypto_base64_alphabet alphabet)
+{
+	const unsigned char *table = php_crypto_base64_decode_tables[alphabet];
+	unsigned char a, b, c, d;
+	size_t i;
+
+	for (i = 0; i + 4 <= len; i += 4) {
+		a = table[in[i]];
+		b = table[in[i + 1]];
+		c = table[in[i + 2]];
+		d = table[in[i + 3]];
+		if ((a | b | c | d) & 0xC0) {
+			break;
+		}
+		*out++ = (a << 2) | (b >> 4);
+		*out++ = (b << 4) | (c >> 2);
+		*out++ = (c << 6) | d;
+	}
+
+	return i;
+}
+/* }}} */
+
+#ifdef PHP_CRYPTO_HAS_BASE64_SIMD_X86
+
+/* The SSSE3 and AVX2 kernels use the vectorized lookups described by
+ * Wojciech Mula and Daniel Lemire in "Faster Base64 Encoding and Decoding
+ * Using AVX2 Instructions" (the 6-bit fields are split by multiplication
+ * and translated using offsets looked up by pshufb) */
+
+/* {{{ php_crypto_base64_encode_ssse3 */
+PHP_CRYPTO_BASE64_TARGET("ssse3")
+static size_t php_crypto_base64_encode_ssse3(unsigned char *out,
+		const unsigned char *in, size_t len, php_crypto_base64_alphabet alphabet)
+{
+	const __m128i shuf = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+	/* offsets of '+' and '/' resp. '-' and '_' are at the end */
+	const __m128i lut = alphabet == PHP_CRYPTO_BASE64_ALPHABET_URL ?
+		_mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -17, 32, 0, 0) :
+		_mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+	__m128i v, t0, t1, idx;
+	size_t done = 0;
+
+	/* 12 bytes are encoded but 16 bytes are loaded */
+	while (len - done >= 16) {
+		v = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (in + done)), shuf);
+		t0 = _mm_mulhi_epu16(_mm_and_si128(v, _mm_set1_epi32(0x0FC0FC00)),
+				_mm_set1_epi32(0x04000040));
+		t1 = _mm_mullo_epi16(_mm_and_si128(v, _mm_set1_epi32(0x003F03F0)),
+				_mm_set1_epi32(0x01000010));
+		v = _mm_or_si128(t0, t1);
+		idx = _mm_subs_epu8(v, _mm_set1_epi8(51));
+		idx = _mm_sub_epi8(idx, _mm_cmpgt_epi8(v, _mm_set1_epi8(25)));
+		v = _mm_add_epi8(v, _mm_shuffle_epi8(lut, idx));
+		_mm_storeu_si128((__m128i *) out, v);
+		out += 16;
+		done += 12;
+	}
+
+	return done + php_crypto_base64_encode_scalar(out, in + done, len - done, alphabet);
+}
+/* }}} */
+
+/* {{{ php_crypto_base64_decode_ssse3 */
+PHP_CRYPTO_BASE64_TARGET("ssse3")
+static size_t php_crypto_base64_decode_ssse3(unsigned char *out,
+		const unsigned char *in, size_t len, php_crypto_base64_alphabet alphabet)
+{
+	const __m128i lut_lo = _mm_setr_epi8(
+			0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+			0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+	const __m128i lut_hi = _mm_setr_epi8(
+			0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+			0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+	const __m128i lut_roll = _mm_setr_epi8(
+			0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+	const __m128i shuf = _mm_setr_epi8(
+			2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+	const __m128i mask_2f = _mm_set1_epi8(0x2f);
+	__m128i v, hi_nibbles, lo_nibbles, roll, url_minus, url_underscore;
+	size_t done = 0;
+	int tail;
+
+	while (len - done >= 16) {
+		v = _mm_loadu_si128((const __m128i *) (in + done));
+		if (alphabet == PHP_CRYPTO_BASE64_ALPHABET_URL) {
+			/* reject '+' and '/' and translate '-' and '_' to them */
+			if (_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('+')),
+					_mm_cmpeq_epi8(v, _mm_set1_epi8('/'))))) {
+				break;
+			}
+			url_minus = _mm_and_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('-')),
+					_mm_set1_epi8('-' ^ '+'));
+			url_underscore = _mm_and_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('_')),
+					_mm_set1_epi8('_' ^ '/'));
+			v = _mm_xor_si128(v, _mm_or_si128(url_minus, url_underscore));
+		}
+		hi_nibbles = _mm_and_si128(_mm_srli_epi32(v, 4), mask_2f);
+		lo_nibbles = _mm_and_si128(v, mask_2f);
+		if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(
+				_mm_shuffle_epi8(lut_lo, lo_nibbles),
+				_mm_shuffle_epi8(lut_hi, hi_nibbles)), _mm_setzero_si128()))) {
+			break;
+		}
+		roll = _mm_shuffle_epi8(lut_roll,
+				_mm_add_epi8(_mm_cmpeq_epi8(v, mask_2f), hi_nibbles));
+		v = _mm_add_epi8(v, roll);
+		v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+		v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+		v = _mm_shuffle_epi8(v, shuf);
+		/* store exactly 12 bytes */
+		_mm_storel_epi64((__m128i *) out, v);
+		tail = _mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+		memcpy(out + 8, &tail, 4);
+		out += 12;
+		done += 16;
+	}
+
+	return done + php_crypto_base64_decode_scalar(out, in + done, len - done, alphabet);
+}
+/* }}} */
+
+/* {{{ php_crypto_base64_encode_avx2 */
+PHP_CRYPTO_BASE64_TARGET("avx2")
+static size_t php_crypto_base64_encode_avx2(unsigned char *out,
+		const unsigned char *in, size_t len, php_crypto_base64_alphabet alphabet)
+{
+	/* the upper lane is loaded from in + 8 so its 12 bytes start at 4 */
+	const __m256i shuf = _mm256_setr_epi8(
+			1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+			5, 4, 6, 5, 8, 7, 9, 8, 11, 10, 12, 11, 14, 13, 15, 14);
+	const __m256i lut = _mm256_broadcastsi128_si256(alphabet == PHP_CRYPTO_BASE64_ALPHABET_URL ?
+		_mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -17, 32, 0, 0) :
+		_mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0));
+	__m256i v, t0, t1, idx;
+	size_t done = 0;
+
+	while (len - done >= 24) {
+		v = _mm256_inserti128_si256(_mm256_castsi128_si256(
+				_mm_loadu_si128((const __m128i *) (in + done))),
+				_mm_loadu_si128((const __m128i *) (in + done + 8)), 1);
+		v = _mm256_shuffle_epi8(v, shuf);
+		t0 = _mm256_mulhi_epu16(_mm256_and_si256(v, _mm256_set1_epi32(0x0FC0FC00)),
+				_mm256_set1_epi32(0x04000040));
+		t1 = _mm256_mullo_epi16(_mm256_and_si256(v, _mm256_set1_epi32(0x003F03F0)),
+				_mm256_set1_epi32(0x01000010));
+		v = _mm256_or_si256(t0, t1);
+		idx = _mm256_subs_epu8(v, _mm256_set1_epi8(51));
+		idx = _mm256_sub_epi8(idx, _mm256_cmpgt_epi8(v, _mm256_set1_epi8(25)));
+		v = _mm256_add_epi8(v, _mm256_shuffle_epi8(lut, idx));
+		_mm256_storeu_si256((__m256i *) out, v);
+		out += 32;
+		done += 24;
+	}
+	/* avoid AVX to SSE transition penalty */
+	_mm256_zeroupper();
+
+	return done + php_crypto_base64_encode_scalar(out, in + done, len - done, alphabet);
+}
+/* }}} */
+
+/* {{{ php_crypto_base64_decode_avx2 */
+PHP_CRYPTO_BASE64_TARGET("avx2")
+static size_t php_crypto_base64_decode_avx2(unsigned char *out,
+		const unsigned char *in, size_t len, php_crypto_base64_alphabet alphabet)
+{
+	const __m256i lut_lo = _mm256_setr_epi8(
+			0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+			0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+			0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+			0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+	const __m256i lut_hi = _mm256_setr_epi8(
+			0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+			0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+			0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+			0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+	const __m256i lut_roll = _mm256_setr_epi8(
+			0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+	const __m256i shuf = _mm256_setr_epi8(
+			2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+			2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+	const __m256i mask_2f = _mm256_set1_epi8(0x2f);
+	__m256i v, hi_nibbles, lo_nibbles, roll, url_minus, url_underscore;
+	size_t done = 0;
+
+	while (len - done >= 32) {
+		v = _mm256_loadu_si256((const __m256i *) (in + done));
+		if (alphabet == PHP_CRYPTO_BASE64_ALPHABET_URL) {
+			/* reject '+' and '/' and translate '-' and '_' to them */
+			if (_mm256_movemask_epi8(_mm256_or_si256(
+					_mm256_cmpeq_epi8(v, _mm256_set1_epi8('+')),
+					_mm256_cmpeq_epi8(v, _mm256_set1_epi8('/'))))) {
+				break;
+			}
+			url_minus = _mm256_and_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('-')),
+					_mm256_set1_epi8('-' ^ '+'));
+			url_underscore = _mm256_and_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')),
+					_mm256_set1_epi8('_' ^ '/'));
+			v = _mm256_xor_si256(v, _mm256_or_si256(url_minus, url_underscore));
+		}
+		hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(v, 4), mask_2f);
+		lo_nibbles = _mm256_and_si256(v, mask_2f);
+		if (!_mm256_testz_si256(_mm256_shuffle_epi8(lut_lo, lo_nibbles),
+				_mm256_shuffle_epi8(lut_hi, hi_nibbles))) {
+			break;
+		}
+		roll = _mm256_shuffle_epi8(lut_roll,
+				_mm256_add_epi8(_mm256_cmpeq_epi8(v, mask_2f), hi_nibbles));
+		v = _mm256_add_epi8(v, roll);
+		v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+		v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+		v = _mm256_shuffle_epi8(v, shuf);
+		v = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+		/* store exactly 24 bytes */
+		_mm_storeu_si128((__m128i *) out, _mm256_castsi256_si128(v));
+		_mm_storel_epi64((__m128i *) (out + 16), _mm256_extracti128_si256(v, 1));
+		out += 24;
+		done += 32;
+	}
+	/* avoid AVX to SSE transition penalty */
+	_mm256_zeroupper();
+
+	return done + php_crypto_base64_decode_ssse3(out, in + done, len - done, alphabet);
+}
+/* }}} */
+
+#endif
+
+#ifdef PHP_CRYPTO_HAS_BASE64_SIMD_NEON
+
+/* {{{ php_crypto_base64_neon_table */
+static inline uint8x16x4_t php_crypto_base64_neon_table(const unsigned char *table)
+{
+	uint8x16x4_t t;
+
+	t.val[0] = vld1q_u8(table);
+	t.val[1] = vld1q_u8(table + 16);
+	t.val[2] = vld1q_u8(table + 32);
+	t.val[3] = vld1q_u8(table + 48);
+
+	return t;
+}
+/* }}} */
+
+/* {{{ php_crypto_base64_encode_neon */
+static size_t php_crypto_base64_encode_neon(unsigned char *out,
+		const unsigned char *in, size_t len, php_crypto_base64_alphabet alphabet)
+{
+	const uint8x16x4_t table = php_crypto_base64_neon_table(
+			php_crypto_base64_encode_tables[alphabet]);
+	uint8x16x3_t s;
+	uint8x16x4_t c;
+	size_t done = 0;
+
+	/* 48 bytes are deinterleaved to 3 registers and encoded to 64 chars */
+	while (len - done >= 48) {
+		s = vld3q_u8(in + done);
+		c.val[0] = vshrq_n_u8(s.val[0], 2);
+		c.val[1] = vorrq_u8(vshlq_n_u8(vandq_u8(s.val[0], vdupq_n_u8(0x03)), 4),
+				vshrq_n_u8(s.val[1], 4));
+		c.val[2] = vorrq_u8(vshlq_n_u8(vandq_u8(s.val[1], vdupq_n_u8(0x0f)), 2),
+				vshrq_n_u8(s.val[2], 6));
+		c.val[3] = vandq_u8(s.val[2], vdupq_n_u8(0x3f));
+		c.val[0] = vqtbl4q_u8(table, c.val[0]);
+		c.val[1] = vqtbl4q_u8(table, c.val[1]);
+		c.val[2] = vqtbl4q_u8(table, c.val[2]);
+		c.val[3] = vqtbl4q_u8(table, c.val[3]);
+		vst4q_u8(out, c);
+		out += 64;
+		done += 48;
+	}
+
+	return done + php_crypto_base64_encode_scalar(out, in + done, len - done, alphabet);
+}
+/* }}} */
+
+/* {{{ php_crypto_base64_decode_neon */
+static size_t php_crypto_base64_decode_neon(unsigned char *out,
+		const unsigned char *in, size_t len, php_crypto_base64_alphabet alphabet)
+{
+	const uint8x16x4_t table_lo = php_crypto_base64_neon_table(
+			php_crypto_base64_decode_tables[alphabet]);
+	const uint8x16x4_t table_hi = php_crypto_base64_neon_table(
+			php_crypto_base64_decode_tables[alphabet] + 64);
+	uint8x16x4_t c;
+	uint8x16x3_t s;
+	uint8x16_t err;
+	size_t done = 0;
+	int i;
+
+	/* 64 chars are deinterleaved to 4 registers and decoded to 48 bytes */
+	while (len - done >= 64) {
+		c = vld4q_u8(in + done);
+		err = vdupq_n_u8(0);
+		for (i = 0; i < 4; i++) {
+			/* chars over 127 are out of both tables so they are marked as error */
+			err = vorrq_u8(err, vcgeq_u8(c.val[i], vdupq_n_u8(0x80)));
+			c.val[i] = vqtbx4q_u8(vqtbl4q_u8(table_lo, c.val[i]), table_hi,
+					vsubq_u8(c.val[i], vdupq_n_u8(64)));
+			err = vorrq_u8(err, c.val[i]);
+		}
+		if (vmaxvq_u8(err) & 0xC0) {
+			break;
+		}
+		s.val[0] = vorrq_u8(vshlq_n_u8(c.val[0], 2), vshrq_n_u8(c.val[1], 4));
+		s.val[1] = vorrq_u8(vshlq_n_u8(c.val[1], 4), vshrq_n_u8(c.val[2], 2));
+		s.val[2] = vorrq_u8(vshlq_n_u8(c.val[2], 6), c.val[3]);
+		vst3q_u8(out, s);
+		out += 48;
+		done += 64;
+	}
+
+	return done + php_crypto_base64_decode_scalar(out, in + done, len - done, alphabet);
+}
+/* }}} */
+
+#endif
+
+/* {{{ php_crypto_base64_engine_init */
+static void php_crypto_base64_engine_init()
+{
+	php_crypto_base64_encode_kernel = php_crypto_base64_encode_scalar;
+	php_crypto_base64_decode_kernel = php_crypto_base64_decode_scalar;
+	php_crypto_base64_engine = "scalar";
+#if defined(PHP_CRYPTO_HAS_BASE64_SIMD_X86)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		php_crypto_base64_encode_kernel = php_crypto_base64_encode_avx2;
+		php_crypto_base64_decode_kernel = php_crypto_base64_decode_avx2;
+		php_crypto_base64_engine = "avx2";
+	} else if (__builtin_cpu_supports("ssse3")) {
+		php_crypto_base64_encode_kernel = php_crypto_base64_encode_ssse3;
+		php_crypto_base64_decode_kernel = php_crypto_base64_decode_ssse3;
+		php_crypto_base64_engine = "ssse3";
+	}
+#elif defined(PHP_CRYPTO_HAS_BASE64_SIMD_NEON)
+	php_crypto_base64_encode_kernel = php_crypto_base64_encode_neon;
+	php_crypto_base64_decode_kernel = php_crypto_base64_decode_neon;
+	php_crypto_base64_engine = "neon";
+#endif
+}
+/* }}} */
+
+/* {{{ php_crypto_base64_engine_name */
+PHP_CRYPTO_API const char *php_crypto_base64_engine_name(void)
+{
+	return php_crypto_base64_engine;
+}
+/* }}} */
+
+/* {{{ php_crypto_base64_encoded_chars
+	Returns number of characters (without new lines) for len bytes */
+static inline size_t php_crypto_base64_encoded_chars(php_crypto_base64_ctx *ctx, size_t len)
+{
+	if (ctx->padding) {
+		return (len + 2) / 3 * 4;
+	}
+	return len / 3 * 4 + (len % 3 ? len % 3 + 1 : 0);
+}
+/* }}} */
+
+/* {{{ php_crypto_base64_encode_block
+	Encodes len bytes including the final quad and returns number of chars */
+static size_t php_crypto_base64_encode_block(php_crypto_base64_ctx *ctx,
+		unsigned char *out, const unsigned char *in, size_t len)
+{
+	const unsigned char *table = php_crypto_base64_encode_tables[ctx->alphabet];
+	size_t done;
+
+	done = php_crypto_base64_encode_kernel(out, in, len, ctx->alphabet);
+	out += done / 3 * 4;
+	if (len - done == 1) {
+		*out++ = table[in[done] >> 2];
+		*out++ = table[(in[done] & 0x03) << 4];
+		if (ctx->padding) {
+			*out++ = '=';
+			*out++ = '=';
+		}
+	} else if (len - done == 2) {
+		*out++ = table[in[done] >> 2];
+		*out++ = table[((in[done] & 0x03) << 4) | (in[done + 1] >> 4)];
+		*out++ = table[(in[done + 1] & 0x0f) << 2];
+		if (ctx->padding) {
+			*out++ = '=';
+		}
+	}
+
+	return php_crypto_base64_encoded_chars(ctx, len);
+}
+/* }}} */
+
+/* {{{ php_crypto_base64_decode_block
+	Decodes n saved characters (base64 or padding), the last quad can be
+	partial if allowed */
+static int php_crypto_base64_decode_block(php_crypto_base64_ctx *ctx,
+		unsigned char *out, const unsigned char *in, int n, zend_bool partial)
+{
+	const unsigned char *table = php_crypto_base64_decode_tables[ctx->alphabet];
+	unsigned char v[4];
+	int i, j, rem = n % 4;
+
+	if (rem == 1 || (rem && !partial)) {
+		return -1;
+	}
+	/* the quads before padding are decoded by the engine */
+	i = (int) php_crypto_base64_decode_kernel(out, in, n, ctx->alphabet);
+	out += i / 4 * 3;
+	for (; i < n; i += 4) {
+		v[2] = v[3] = 0;
+		for (j = 0; j < 4 && i + j < n; j++) {
+			v[j] = table[in[i + j]];
+			if (v[j] == PHP_CRYPTO_BASE64_PAD) {
+				v[j] = 0;
+			} else if (v[j] & 0xC0) {
+				return -1;
+			}
+		}
+		*out++ = (v[0] << 2) | (v[1] >> 4);
+		if (j > 2) {
+			*out++ = (v[1] << 4) | (v[2] >> 2);
+		}
+		if (j > 3) {
+			*out++ = (v[2] << 6) | v[3];
+		}
+	}
+
+	return n / 4 * 3 + (rem ? rem - 1 : 0);
+}
+/* }}} */
+
+/* {{{ php_crypto_base64_ctx_init */
+PHP_CRYPTO_API int php_crypto_base64_ctx_init(php_crypto_base64_ctx *ctx,
+		int wrap, php_crypto_base64_alphabet alphabet, zend_bool padding)
+{
+	if (wrap != PHP_CRYPTO_BASE64_WRAP_NONE && wrap != PHP_CRYPTO_BASE64_WRAP_PEM &&
+			wrap != PHP_CRYPTO_BASE64_WRAP_MIME) {
+		return FAILURE;
+	}
+	if (alphabet != PHP_CRYPTO_BASE64_ALPHABET_STANDARD &&
+			alphabet != PHP_CRYPTO_BASE64_ALPHABET_URL) {
+		return FAILURE;
+	}
+
+	ctx->num = 0;
+	ctx->wrap = wrap;
+	ctx->alphabet = alphabet;
+	ctx->padding = padding;
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_base64_encode_length
+	Returns exact length of the encoded output for inl bytes passed to the
+	update and optionally followed by the final call */
+PHP_CRYPTO_API size_t php_crypto_base64_encode_length(
+		php_crypto_base64_ctx *ctx, size_t inl, zend_bool final)
+{
+	size_t total = (size_t) ctx->num + inl, line_bytes, len, rem;
+
+	if (ctx->wrap) {
+		line_bytes = ctx->wrap / 4 * 3;
+		len = total / line_bytes * (ctx->wrap + 1);
+		rem = total % line_bytes;
+	} else {
+		len = total / 3 * 4;
+		rem = total % 3;
+	}
+	if (final && rem) {
+		len += php_crypto_base64_encoded_chars(ctx, rem) + (ctx->wrap ? 1 : 0);
+	}
+
+	return len;
+}
+/* }}} */
+
+/* {{{ php_crypto_base64_decode_length
+	Returns max length of the decoded output for inl characters passed
+	to the update and the final call (it is exact for unwrapped input
+	without padding) */
+PHP_CRYPTO_API size_t php_crypto_base64_decode_length(
+		php_crypto_base64_ctx *ctx, size_t inl)
+{
+	size_t total = (size_t) ctx->num + inl;
+
+	return total / 4 * 3 + total % 4 * 3 / 4;
+}
+/* }}} */
+
+/* {{{ php_crypto_base64_encode_init */
+PHP_CRYPTO_API void php_crypto_base64_encode_init(php_crypto_base64_ctx *ctx)
+{
+	ctx->num = 0;
+}
+/* }}} */
+
+/* {{{ php_crypto_base64_encode_update */
+PHP_CRYPTO_API void php_crypto_base64_encode_update(php_crypto_base64_ctx *ctx,
+		unsigned char *out, int *outl, const unsigned char *in, int inl)
+{
+	int len, line_bytes, total = 0;
+
+	*outl = 0;
+	if (inl <= 0) {
+		return;
+	}
+
+	/* unwrapped output is encoded in multiples of 3 bytes */
+	line_bytes = ctx->wrap ? ctx->wrap / 4 * 3 : 3;
+	if (line_bytes - ctx->num > inl) {
+		memcpy(ctx->data + ctx->num, in, inl);
+		ctx->num += inl;
+		return;
+	}
+	if (ctx->num != 0) {
+		len = line_bytes - ctx->num;
+		memcpy(ctx->data + ctx->num, in, len);
+		in += len;
+		inl -= len;
+		len = (int) php_crypto_base64_encode_block(ctx, out, ctx->data, line_bytes);
+		out += len;
+		total += len;
+		if (ctx->wrap) {
+			*out++ = '\n';
+			total++;
+		}
+	}
+	if (ctx->wrap) {
+		while (inl >= line_bytes) {
+			php_crypto_base64_encode_block(ctx, out, in, line_bytes);
+			out[ctx->wrap] = '\n';
+			out += ctx->wrap + 1;
+			total += ctx->wrap + 1;
+			in += line_bytes;
+			inl -= line_bytes;
+		}
+	} else if (inl >= 3) {
+		len = inl - inl % 3;
+		total += (int) php_crypto_base64_encode_block(ctx, out, in, len);
+		in += len;
+		inl -= len;
+	}
+	if (inl != 0) {
+		memcpy(ctx->data, in, inl);
+	}
+	ctx->num = inl;
+	*outl = total;
+}
+/* }}} */
+
+/* {{{ php_crypto_base64_encode_final */
+PHP_CRYPTO_API void php_crypto_base64_encode_final(php_crypto_base64_ctx *ctx,
+		unsigned char *out, int *outl)
+{
+	int len = 0;
+
+	if (ctx->num != 0) {
+		len = (int) php_crypto_base64_encode_block(ctx, out, ctx->data, ctx->num);
+		if (ctx->wrap) {
+			out[len++] = '\n';
+		}
+		ctx->num = 0;
+	}
+	*outl = len;
+}
+/* }}} */
+
+/* {{{ php_crypto_base64_decode_init */
+PHP_CRYPTO_API void php_crypto_base64_decode_init(php_crypto_base64_ctx *ctx)
+{
+	ctx->num = 0;
+}
+/* }}} */
+
+/* {{{ php_crypto_base64_decode_update
+	Returns -1 on error, 0 if the end of base64 data was found or 1 otherwise */
+PHP_CRYPTO_API int php_crypto_base64_decode_update(php_crypto_base64_ctx *ctx,
+		unsigned char *out, int *outl, const unsigned char *in, int inl)
+{
+	const unsigned char *table = php_crypto_base64_decode_tables[ctx->alphabet];
+	unsigned char *d = ctx->data;
+	int seof = 0, eof = 0, rv = -1, ret = 0, i = 0, n, len;
+	unsigned char c, v;
+	size_t done;
+
+	n = ctx->num;
+	if (n > 0 && d[n - 1] == '=') {
+		eof++;
+		if (n > 1 && d[n - 2] == '=') {
+			eof++;
+		}
+	}
+
+	/* an empty input signals the end of input */
+	if (inl == 0) {
+		rv = 0;
+		goto end;
+	}
+
+	while (i < inl) {
+		/* decode base64 characters by the engine directly if they complete
+		 * the saved block or if they are the rest of the input that would be
+		 * decoded at the end anyway (the characters after the last complete
+		 * block are saved as the block is decoded only if it is complete) */
+		if ((n & 3) == 0 && eof == 0 && !(table[in[i]] & 0xC0)) {
+			done = php_crypto_base64_decode_kernel(out + n / 4 * 3, in + i, inl - i, ctx->alphabet);
+			if (done == (size_t) (inl - i)) {
+				len = n + (int) done;
+			} else if (done >= (size_t) (PHP_CRYPTO_BASE64_LINE_CHARS - n)) {
+				len = (int) ((n + done) / PHP_CRYPTO_BASE64_LINE_CHARS * PHP_CRYPTO_BASE64_LINE_CHARS);
+			} else {
+				len = 0;
+			}
+			if (len > 0) {
+				/* the saved characters are only base64 characters (no padding) */
+				if (n > 0 && php_crypto_base64_decode_kernel(out, d, n, ctx->alphabet) != (size_t) n) {
+					goto end;
+				}
+				out += len / 4 * 3;
+				ret += len / 4 * 3;
+				i += len - n;
+				done -= len - n;
+				n = 0;
+			} else if (done == 0) {
+				goto next;
+			}
+			memcpy(d + n, in + i, done);
+			n += (int) done;
+			i += (int) done;
+			continue;
+		}
+next:
+
+		c = in[i++];
+		v = table[c];
+		if (v == PHP_CRYPTO_BASE64_ERR) {
+			goto end;
+		}
+		if (c == '=') {
+			eof++;
+		} else if (eof > 0 && !PHP_CRYPTO_BASE64_NOT_BASE64(v)) {
+			/* more data after padding */
+			goto end;
+		}
+		if (eof > 2) {
+			goto end;
+		}
+		if (v == PHP_CRYPTO_BASE64_EOF) {
+			seof = 1;
+			break;
+		}
+		/* only base64 characters and padding are saved */
+		if (!PHP_CRYPTO_BASE64_NOT_BASE64(v)) {
+			d[n++] = c;
+		}
+		if (n == PHP_CRYPTO_BASE64_LINE_CHARS) {
+			len = php_crypto_base64_decode_block(ctx, out, d, n, 0);
+			n = 0;
+			if (len < 0 || eof > len) {
+				goto end;
+			}
+			ret += len - eof;
+			out += len - eof;
+		}
+	}
+
+	/* whole quads are decoded immediately */
+	if (n > 0) {
+		if ((n & 3) == 0) {
+			len = php_crypto_base64_decode_block(ctx, out, d, n, 0);
+			n = 0;
+			if (len < 0 || eof > len) {
+				goto end;
+			}
+			ret += len - eof;
+		} else if (seof) {
+			/* EOF in the middle of a quad */
+			goto end;
+		}
+	}
+
+	rv = seof || (n == 0 && eof) ? 0 : 1;
+end:
+	*outl = ret;
+	ctx->num = n;
+	return rv;
+}
+/* }}} */
+
+/* {{{ php_crypto_base64_decode_final */
+PHP_CRYPTO_API int php_crypto_base64_decode_final(php_crypto_base64_ctx *ctx,
+		unsigned char *out, int *outl)
+{
+	int len, eof = 0;
+
+	*outl = 0;
+	if (ctx->num != 0) {
+		/* the last quad can be partial only if padding is optional */
+		len = php_crypto_base64_decode_block(ctx, out, ctx->data, ctx->num, !ctx->padding);
+		if (len < 0) {
+			return -1;
+		}
+		/* EVP compatible decoding does not expect padding in the final block */
+		while (!ctx->padding && eof < ctx->num && ctx->data[ctx->num - eof - 1] == '=') {
+			eof++;
+		}
+		if (eof > len) {
+			return -1;
+		}
+		ctx->num = 0;
+		*outl = len - eof;
+	}
+	return 1;
+}
+/* }}} */
+
 /* object handler */
 PHPC_OBJ_DEFINE_HANDLER_VAR(crypto_base64);
 
@@ -136,7 +1000,7 @@ PHPC_OBJ_HANDLER_FREE(crypto_base64)
 {
 	PHPC_OBJ_HANDLER_FREE_INIT(crypto_base64);
 
-	EVP_ENCODE_CTX_free(PHPC_THIS->ctx);
+	OPENSSL_cleanse(&PHPC_THIS->ctx, sizeof(PHPC_THIS->ctx));
 
 	PHPC_OBJ_HANDLER_FREE_DESTROY();
 }
@@ -147,8 +1011,9 @@ PHPC_OBJ_HANDLER_CREATE_EX(crypto_base64)
 {
 	PHPC_OBJ_HANDLER_CREATE_EX_INIT(crypto_base64);
 
-	/* allocate encode context */
-	PHPC_THIS->ctx = EVP_ENCODE_CTX_new();
+	/* the encode context is embedded */
+	php_crypto_base64_ctx_init(&PHPC_THIS->ctx, PHP_CRYPTO_BASE64_WRAP_PEM,
+			PHP_CRYPTO_BASE64_ALPHABET_STANDARD, 1);
 
 	PHPC_OBJ_HANDLER_CREATE_EX_RETURN(crypto_base64);
 }
@@ -167,7 +1032,7 @@ PHPC_OBJ_HANDLER_CLONE(crypto_base64)
 	PHPC_OBJ_HANDLER_CLONE_INIT(crypto_base64);
 
 	PHPC_THAT->status = PHPC_THIS->status;
-	EVP_ENCODE_CTX_copy(PHPC_THAT->ctx, PHPC_THIS->ctx);
+	PHPC_THAT->ctx = PHPC_THIS->ctx;
 
 	PHPC_OBJ_HANDLER_CLONE_RETURN();
 }
@@ -177,6 +1042,10 @@ PHPC_OBJ_HANDLER_CLONE(crypto_base64)
 	zend_declare_class_constant_long(php_crypto_base64_exception_ce, \
 		#aconst, sizeof(#aconst)-1, PHP_CRYPTO_BASE64_E(aconst) TSRMLS_CC)
 
+#define PHP_CRYPTO_DECLARE_BASE64_CONST(aconst) \
+	zend_declare_class_constant_long(php_crypto_base64_ce, \
+		#aconst, sizeof(#aconst)-1, PHP_CRYPTO_BASE64_##aconst TSRMLS_CC)
+
 /* {{{ PHP_MINIT_FUNCTION */
 PHP_MINIT_FUNCTION(crypto_base64)
 {
@@ -191,166 +1060,304 @@ PHP_MINIT_FUNCTION(crypto_base64)
 	PHPC_OBJ_SET_HANDLER_FREE(crypto_base64);
 	PHPC_OBJ_SET_HANDLER_CLONE(crypto_base64);
 
+	/* Base64 constants for wrapping and alphabets */
+	PHP_CRYPTO_DECLARE_BASE64_CONST(WRAP_NONE);
+	PHP_CRYPTO_DECLARE_BASE64_CONST(WRAP_PEM);
+	PHP_CRYPTO_DECLARE_BASE64_CONST(WRAP_MIME);
+	PHP_CRYPTO_DECLARE_BASE64_CONST(ALPHABET_STANDARD);
+	PHP_CRYPTO_DECLARE_BASE64_CONST(ALPHABET_URL);
+
 	/* Base64Exception class */
 	PHP_CRYPTO_EXCEPTION_REGISTER(ce, Base64);
 	PHP_CRYPTO_ERROR_INFO_REGISTER(Base64);
 
+	/* select the fastest engine for this CPU */
+	php_crypto_base64_engine_init();
+
 	return SUCCESS;
 }
 /* }}} */
 
-/* {{{ php_crypto_base64_encode_init */
-static inline void php_crypto_base64_encode_init(EVP_ENCODE_CTX *ctx)
+/* {{{ php_crypto_base64_check_length */
+static inline int php_crypto_base64_check_length(phpc_str_size_t in_len, int *inl TSRMLS_DC)
 {
-	EVP_EncodeInit(ctx);
+	/* check string length overflow */
+	if (php_crypto_str_size_to_int(in_len, inl) == FAILURE) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Base64, INPUT_DATA_LENGTH_HIGH));
+		return FAILURE;
+	}
+
+	return SUCCESS;
 }
 /* }}} */
 
-/* {{{ php_crypto_base64_encode_update */
-static inline int php_crypto_base64_encode_update(
-		EVP_ENCODE_CTX *ctx, char *out, int *outl,
-		const char *in, phpc_str_size_t in_len TSRMLS_DC)
+/* {{{ php_crypto_base64_check_out_length */
+static inline int php_crypto_base64_check_out_length(size_t out_len, int *outl TSRMLS_DC)
 {
-	int inl;
-
-	/* check string length overflow */
-	if (php_crypto_str_size_to_int(in_len, &inl) == FAILURE) {
+	/* the encoded data are longer than the input */
+	if (out_len > INT_MAX) {
 		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Base64, INPUT_DATA_LENGTH_HIGH));
 		return FAILURE;
 	}
-
-	EVP_EncodeUpdate(ctx,
-			(unsigned char *) out, outl,
-			(const unsigned char *) in, inl);
+	*outl = (int) out_len;
 
 	return SUCCESS;
 }
 /* }}} */
 
-/* {{{ php_crypto_base64_encode_finish */
-static inline void php_crypto_base64_encode_finish(
-		EVP_ENCODE_CTX *ctx, char *out, int *outl)
+/* {{{ php_crypto_base64_set_options */
+static int php_crypto_base64_set_options(php_crypto_base64_ctx *ctx,
+		phpc_long_t wrap, phpc_long_t alphabet, zend_bool padding TSRMLS_DC)
 {
-	EVP_EncodeFinal(ctx, (unsigned char *) out, outl);
+	if (wrap != PHP_CRYPTO_BASE64_WRAP_NONE && wrap != PHP_CRYPTO_BASE64_WRAP_PEM &&
+			wrap != PHP_CRYPTO_BASE64_WRAP_MIME) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Base64, WRAP_INVALID));
+		return FAILURE;
+	}
+	if (alphabet != PHP_CRYPTO_BASE64_ALPHABET_STANDARD &&
+			alphabet != PHP_CRYPTO_BASE64_ALPHABET_URL) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Base64, ALPHABET_INVALID));
+		return FAILURE;
+	}
+
+	return php_crypto_base64_ctx_init(ctx, (int) wrap,
+			(php_crypto_base64_alphabet) alphabet, padding);
 }
 /* }}} */
 
-/* {{{ php_crypto_base64_decode_init */
-static inline void php_crypto_base64_decode_init(EVP_ENCODE_CTX *ctx)
+/* {{{ php_crypto_base64_encode_string
+	Encodes the whole input to out that has php_crypto_base64_encode_length size */
+static inline void php_crypto_base64_encode_string(php_crypto_base64_ctx *ctx,
+		char *out, const char *in, int inl)
 {
-	EVP_DecodeInit(ctx);
+	int update_len, final_len;
+
+	php_crypto_base64_encode_init(ctx);
+	php_crypto_base64_encode_update(ctx, (unsigned char *) out,
+			&update_len, (const unsigned char *) in, inl);
+	php_crypto_base64_encode_final(ctx, (unsigned char *) out + update_len, &final_len);
 }
 /* }}} */
 
-/* {{{ php_crypto_base64_decode_update */
-static inline int php_crypto_base64_decode_update(
-		EVP_ENCODE_CTX *ctx, char *out, int *outl,
-		const char *in, phpc_str_size_t in_len TSRMLS_DC)
+/* {{{ php_crypto_base64_decode_string
+	Decodes the whole input to out that has php_crypto_base64_decode_length size
+	(the context has to be initialized) and returns the decoded length or -1 on error */
+static inline int php_crypto_base64_decode_string(php_crypto_base64_ctx *ctx,
+		char *out, const char *in, int inl)
 {
-	int inl, rc;
+	int update_len, final_len;
 
-	/* check string length overflow */
-	if (php_crypto_str_size_to_int(in_len, &inl) == FAILURE) {
-		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Base64, INPUT_DATA_LENGTH_HIGH));
-		return FAILURE;
+	if (php_crypto_base64_decode_update(ctx, (unsigned char *) out,
+			&update_len, (const unsigned char *) in, inl) < 0) {
+		return -1;
 	}
-
-	rc = EVP_DecodeUpdate(ctx,
-			(unsigned char *) out, outl,
-			(const unsigned char *) in, inl);
-	if (rc < 0) {
-		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Base64, DECODE_UPDATE_FAILED));
-		return FAILURE;
+	/* the last partial quad is invalid if the padding is required */
+	if (php_crypto_base64_decode_final(ctx, (unsigned char *) out + update_len, &final_len) < 0) {
+		return -1;
 	}
 
-	return SUCCESS;
+	return update_len + final_len;
 }
 /* }}} */
 
-/* {{{ php_crypto_base64_decode_finish */
-static inline void php_crypto_base64_decode_finish(EVP_ENCODE_CTX *ctx,
-		char *out, int *outl)
-{
-	EVP_DecodeFinal(ctx, (unsigned char *) out, outl);
-}
-/* }}} */
-
-/* {{{ proto string Crypto\Base64::encode(string $data)
+/* {{{ proto string Crypto\Base64::encode(string $data, int $wrap = Base64::WRAP_PEM,
+			int $alphabet = Base64::ALPHABET_STANDARD, bool $padding = true)
 	Encodes string $data to base64 encoding */
 PHP_CRYPTO_METHOD(Base64, encode)
 {
 	char *in;
 	phpc_str_size_t in_len;
-	int real_len, final_len, update_len;
+	phpc_long_t wrap = PHP_CRYPTO_BASE64_WRAP_PEM;
+	phpc_long_t alphabet = PHP_CRYPTO_BASE64_ALPHABET_STANDARD;
+	zend_bool padding = 1;
+	int inl, real_len;
 	PHPC_STR_DECLARE(out);
-	EVP_ENCODE_CTX *ctx;
+	php_crypto_base64_ctx ctx;
 
-	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "s", &in, &in_len) == FAILURE) {
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "s|llb",
+			&in, &in_len, &wrap, &alphabet, &padding) == FAILURE) {
 		return;
 	}
 
-	ctx = EVP_ENCODE_CTX_new();
-	php_crypto_base64_encode_init(ctx);
-	real_len = EVP_ENCODE_LENGTH(in_len);
-	PHPC_STR_ALLOC(out, real_len);
-	if (php_crypto_base64_encode_update(
-			ctx, PHPC_STR_VAL(out), &update_len, in, in_len TSRMLS_CC) == FAILURE) {
-		PHPC_STR_RELEASE(out);
-		EVP_ENCODE_CTX_free(ctx);
+	/* the output length is exact so no reallocation is needed */
+	if (php_crypto_base64_set_options(&ctx, wrap, alphabet, padding TSRMLS_CC) == FAILURE ||
+			php_crypto_base64_check_length(in_len, &inl TSRMLS_CC) == FAILURE ||
+			php_crypto_base64_check_out_length(php_crypto_base64_encode_length(
+				&ctx, in_len, 1), &real_len TSRMLS_CC) == FAILURE) {
 		RETURN_NULL();
 	}
-	php_crypto_base64_encode_finish(ctx, PHPC_STR_VAL(out) + update_len, &final_len);
-	EVP_ENCODE_CTX_free(ctx);
-	final_len += update_len;
-	if (real_len > final_len) {
-		PHPC_STR_REALLOC(out, final_len);
+	if (real_len == 0) {
+		RETURN_EMPTY_STRING();
 	}
-	PHPC_STR_VAL(out)[final_len] = '\0';
+	PHPC_STR_ALLOC(out, real_len);
+	php_crypto_base64_encode_string(&ctx, PHPC_STR_VAL(out), in, inl);
+	PHPC_STR_VAL(out)[real_len] = '\0';
 	PHPC_STR_RETURN(out);
 }
 
-/* {{{ proto string Crypto\Base64::decode(string $data)
+/* {{{ proto string Crypto\Base64::decode(string $data,
+			int $alphabet = Base64::ALPHABET_STANDARD, bool $padding = true)
 	Decodes base64 string $data to raw encoding */
 PHP_CRYPTO_METHOD(Base64, decode)
 {
 	char *in;
 	phpc_str_size_t in_len;
-	int real_len, update_len, final_len;
+	phpc_long_t alphabet = PHP_CRYPTO_BASE64_ALPHABET_STANDARD;
+	zend_bool padding = 1;
+	int inl, real_len, out_len;
 	PHPC_STR_DECLARE(out);
-	EVP_ENCODE_CTX *ctx;
+	php_crypto_base64_ctx ctx;
 
-	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "s", &in, &in_len) == FAILURE) {
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "s|lb",
+			&in, &in_len, &alphabet, &padding) == FAILURE) {
 		return;
 	}
 
-	ctx = EVP_ENCODE_CTX_new();
-	php_crypto_base64_decode_init(ctx);
-	real_len = EVP_DECODE_LENGTH(in_len);
-	PHPC_STR_ALLOC(out, real_len);
-
-	if (php_crypto_base64_decode_update(ctx, PHPC_STR_VAL(out),
-			&update_len, in, in_len TSRMLS_CC) == FAILURE) {
-		EVP_ENCODE_CTX_free(ctx);
+	if (php_crypto_base64_set_options(&ctx, PHP_CRYPTO_BASE64_WRAP_NONE,
+				alphabet, padding TSRMLS_CC) == FAILURE ||
+			php_crypto_base64_check_length(in_len, &inl TSRMLS_CC) == FAILURE) {
 		RETURN_FALSE;
 	}
-	php_crypto_base64_decode_finish(ctx, PHPC_STR_VAL(out), &final_len);
-	final_len += update_len;
-	if (real_len > final_len) {
-		PHPC_STR_REALLOC(out, final_len);
+
+	/* the input is validated even if nothing can be decoded from it */
+	php_crypto_base64_decode_init(&ctx);
+	real_len = (int) php_crypto_base64_decode_length(&ctx, in_len);
+	PHPC_STR_ALLOC(out, real_len);
+	out_len = php_crypto_base64_decode_string(&ctx, PHPC_STR_VAL(out), in, inl);
+	if (out_len < 0) {
+		PHPC_STR_RELEASE(out);
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Base64, DECODE_UPDATE_FAILED));
+		RETURN_FALSE;
 	}
-	EVP_ENCODE_CTX_free(ctx);
-	PHPC_STR_VAL(out)[final_len] = '\0';
+	/* the decoded length is lower only for padded or wrapped input so the
+	 * string is just shortened instead of reallocating it */
+	PHPC_STR_LEN(out) = out_len;
+	PHPC_STR_VAL(out)[out_len] = '\0';
 	PHPC_STR_RETURN(out);
 }
 
-/* {{{ proto Crypto\Base64::__construct()
+/* {{{ proto array Crypto\Base64::encodeMany(array $data, int $wrap = Base64::WRAP_PEM,
+			int $alphabet = Base64::ALPHABET_STANDARD, bool $padding = true)
+	Encodes all strings in array $data to base64 encoding */
+PHP_CRYPTO_METHOD(Base64, encodeMany)
+{
+	zval *data;
+	phpc_val *ppv_item;
+	phpc_long_t wrap = PHP_CRYPTO_BASE64_WRAP_PEM;
+	phpc_long_t alphabet = PHP_CRYPTO_BASE64_ALPHABET_STANDARD;
+	zend_bool padding = 1;
+	int inl, real_len;
+	PHPC_STR_DECLARE(out);
+	php_crypto_base64_ctx ctx;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "a|llb",
+			&data, &wrap, &alphabet, &padding) == FAILURE) {
+		return;
+	}
+
+	/* the options and all lengths are checked just once before encoding */
+	if (php_crypto_base64_set_options(&ctx, wrap, alphabet, padding TSRMLS_CC) == FAILURE) {
+		RETURN_NULL();
+	}
+	PHPC_HASH_FOREACH_VAL(PHPC_ARRVAL_P(data), ppv_item) {
+		if (PHPC_TYPE_P(ppv_item) != IS_STRING) {
+			php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Base64, DATA_TYPE_INVALID));
+			RETURN_NULL();
+		}
+		if (php_crypto_base64_check_length(PHPC_STRLEN_P(ppv_item), &inl TSRMLS_CC) == FAILURE ||
+				php_crypto_base64_check_out_length(php_crypto_base64_encode_length(
+					&ctx, inl, 1), &real_len TSRMLS_CC) == FAILURE) {
+			RETURN_NULL();
+		}
+	} PHPC_HASH_FOREACH_END();
+
+	array_init(return_value);
+	PHPC_HASH_FOREACH_VAL(PHPC_ARRVAL_P(data), ppv_item) {
+		inl = (int) PHPC_STRLEN_P(ppv_item);
+		real_len = (int) php_crypto_base64_encode_length(&ctx, inl, 1);
+		PHPC_STR_ALLOC(out, real_len);
+		php_crypto_base64_encode_string(&ctx, PHPC_STR_VAL(out), PHPC_STRVAL_P(ppv_item), inl);
+		PHPC_STR_VAL(out)[real_len] = '\0';
+		PHPC_ARRAY_ADD_NEXT_INDEX_STR(return_value, out);
+	} PHPC_HASH_FOREACH_END();
+}
+/* }}} */
+
+/* {{{ proto array Crypto\Base64::decodeMany(array $data,
+			int $alphabet = Base64::ALPHABET_STANDARD, bool $padding = true)
+	Decodes all base64 strings in array $data to raw encoding */
+PHP_CRYPTO_METHOD(Base64, decodeMany)
+{
+	zval *data;
+	phpc_val *ppv_item;
+	phpc_long_t alphabet = PHP_CRYPTO_BASE64_ALPHABET_STANDARD;
+	zend_bool padding = 1;
+	int inl, out_len;
+	PHPC_STR_DECLARE(out);
+	php_crypto_base64_ctx ctx;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "a|lb",
+			&data, &alphabet, &padding) == FAILURE) {
+		return;
+	}
+
+	if (php_crypto_base64_set_options(&ctx, PHP_CRYPTO_BASE64_WRAP_NONE,
+				alphabet, padding TSRMLS_CC) == FAILURE) {
+		RETURN_FALSE;
+	}
+	PHPC_HASH_FOREACH_VAL(PHPC_ARRVAL_P(data), ppv_item) {
+		if (PHPC_TYPE_P(ppv_item) != IS_STRING) {
+			php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Base64, DATA_TYPE_INVALID));
+			RETURN_FALSE;
+		}
+		if (php_crypto_base64_check_length(PHPC_STRLEN_P(ppv_item), &inl TSRMLS_CC) == FAILURE) {
+			RETURN_FALSE;
+		}
+	} PHPC_HASH_FOREACH_END();
+
+	array_init(return_value);
+	PHPC_HASH_FOREACH_VAL(PHPC_ARRVAL_P(data), ppv_item) {
+		inl = (int) PHPC_STRLEN_P(ppv_item);
+		php_crypto_base64_decode_init(&ctx);
+		PHPC_STR_ALLOC(out, php_crypto_base64_decode_length(&ctx, inl));
+		out_len = php_crypto_base64_decode_string(&ctx, PHPC_STR_VAL(out),
+				PHPC_STRVAL_P(ppv_item), inl);
+		if (out_len < 0) {
+			PHPC_STR_RELEASE(out);
+			zval_dtor(return_value);
+			php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Base64, DECODE_UPDATE_FAILED));
+			RETURN_FALSE;
+		}
+		PHPC_STR_LEN(out) = out_len;
+		PHPC_STR_VAL(out)[out_len] = '\0';
+		PHPC_ARRAY_ADD_NEXT_INDEX_STR(return_value, out);
+	} PHPC_HASH_FOREACH_END();
+}
+/* }}} */
+
+/* {{{ proto Crypto\Base64::__construct(int $wrap = Base64::WRAP_PEM,
+			int $alphabet = Base64::ALPHABET_STANDARD, bool $padding = true)
    Base64 constructor */
 PHP_CRYPTO_METHOD(Base64, __construct)
 {
-	if (zend_parse_parameters_none() == FAILURE) {
+	phpc_long_t wrap = PHP_CRYPTO_BASE64_WRAP_PEM;
+	phpc_long_t alphabet = PHP_CRYPTO_BASE64_ALPHABET_STANDARD;
+	zend_bool padding = 1;
+	PHPC_THIS_DECLARE(crypto_base64);
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "|llb",
+			&wrap, &alphabet, &padding) == FAILURE) {
+		return;
+	}
+
+	PHPC_THIS_FETCH(crypto_base64);
+	/* the object keeps the default options if any option is invalid */
+	if (php_crypto_base64_set_options(&PHPC_THIS->ctx,
+			wrap, alphabet, padding TSRMLS_CC) == FAILURE) {
 		return;
 	}
 }
+/* }}} */
 
 /* {{{ proto Crypto\Base64::encode(string $data)
 	Encodes block of characters from $data and saves the reminder of
@@ -359,7 +1366,7 @@ PHP_CRYPTO_METHOD(Base64, encodeUpdate)
 {
 	char *in;
 	phpc_str_size_t in_len;
-	int update_len, real_len;
+	int inl, update_len, real_len;
 	PHPC_STR_DECLARE(out);
 	PHPC_THIS_DECLARE(crypto_base64);
 
@@ -374,21 +1381,25 @@ PHP_CRYPTO_METHOD(Base64, encodeUpdate)
 		RETURN_FALSE;
 	}
 	if (PHPC_THIS->status == PHP_CRYPTO_BASE64_STATUS_CLEAR) {
-		php_crypto_base64_encode_init(PHPC_THIS->ctx);
+		php_crypto_base64_encode_init(&PHPC_THIS->ctx);
 		PHPC_THIS->status = PHP_CRYPTO_BASE64_STATUS_ENCODE;
 	}
 
-	real_len = EVP_ENCODE_LENGTH(in_len);
-	PHPC_STR_ALLOC(out, real_len);
-	if (php_crypto_base64_encode_update(PHPC_THIS->ctx,
-			PHPC_STR_VAL(out), &update_len, in, in_len TSRMLS_CC) == FAILURE) {
-		PHPC_STR_RELEASE(out);
+	if (php_crypto_base64_check_length(in_len, &inl TSRMLS_CC) == FAILURE ||
+			php_crypto_base64_check_out_length(php_crypto_base64_encode_length(
+				&PHPC_THIS->ctx, in_len, 0), &real_len TSRMLS_CC) == FAILURE) {
 		RETURN_NULL();
 	}
-	if (real_len > update_len) {
-		PHPC_STR_REALLOC(out, update_len);
+	if (real_len == 0) {
+		/* the data are just saved to the context */
+		php_crypto_base64_encode_update(&PHPC_THIS->ctx, NULL,
+				&update_len, (const unsigned char *) in, inl);
+		RETURN_EMPTY_STRING();
 	}
-	PHPC_STR_VAL(out)[update_len] = '\0';
+	PHPC_STR_ALLOC(out, real_len);
+	php_crypto_base64_encode_update(&PHPC_THIS->ctx, (unsigned char *) PHPC_STR_VAL(out),
+			&update_len, (const unsigned char *) in, inl);
+	PHPC_STR_VAL(out)[real_len] = '\0';
 	PHPC_STR_RETURN(out);
 }
 
@@ -411,7 +1422,7 @@ PHP_CRYPTO_METHOD(Base64, encodeFinish)
 		RETURN_FALSE;
 	}
 
-	php_crypto_base64_encode_finish(PHPC_THIS->ctx, out, &out_len);
+	php_crypto_base64_encode_final(&PHPC_THIS->ctx, (unsigned char *) out, &out_len);
 	if (out_len == 0) {
 		RETURN_EMPTY_STRING();
 	}
@@ -426,7 +1437,7 @@ PHP_CRYPTO_METHOD(Base64, decodeUpdate)
 {
 	char *in;
 	phpc_str_size_t in_len;
-	int update_len, real_len;
+	int inl, update_len, real_len;
 	PHPC_STR_DECLARE(out);
 	PHPC_THIS_DECLARE(crypto_base64);
 
@@ -441,20 +1452,23 @@ PHP_CRYPTO_METHOD(Base64, decodeUpdate)
 		RETURN_FALSE;
 	}
 	if (PHPC_THIS->status == PHP_CRYPTO_BASE64_STATUS_CLEAR) {
-		php_crypto_base64_decode_init(PHPC_THIS->ctx);
+		php_crypto_base64_decode_init(&PHPC_THIS->ctx);
 		PHPC_THIS->status = PHP_CRYPTO_BASE64_STATUS_DECODE;
 	}
 
-	real_len = EVP_DECODE_LENGTH(in_len);
+	if (php_crypto_base64_check_length(in_len, &inl TSRMLS_CC) == FAILURE) {
+		RETURN_FALSE;
+	}
+
+	real_len = (int) php_crypto_base64_decode_length(&PHPC_THIS->ctx, in_len);
 	PHPC_STR_ALLOC(out, real_len);
-	if (php_crypto_base64_decode_update(PHPC_THIS->ctx,
-			PHPC_STR_VAL(out), &update_len, in, in_len TSRMLS_CC) == FAILURE) {
+	if (php_crypto_base64_decode_update(&PHPC_THIS->ctx, (unsigned char *) PHPC_STR_VAL(out),
+			&update_len, (const unsigned char *) in, inl) < 0) {
 		PHPC_STR_RELEASE(out);
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Base64, DECODE_UPDATE_FAILED));
 		RETURN_FALSE;
 	}
-	if (real_len > update_len) {
-		PHPC_STR_REALLOC(out, update_len);
-	}
+	PHPC_STR_LEN(out) = update_len;
 	PHPC_STR_VAL(out)[update_len] = '\0';
 	PHPC_STR_RETURN(out);
 }
@@ -478,7 +1492,10 @@ PHP_CRYPTO_METHOD(Base64, decodeFinish)
 		RETURN_FALSE;
 	}
 
-	php_crypto_base64_decode_finish(PHPC_THIS->ctx, buff, &final_len);
+	if (php_crypto_base64_decode_final(&PHPC_THIS->ctx, (unsigned char *) buff, &final_len) < 0) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Base64, DECODE_UPDATE_FAILED));
+		RETURN_FALSE;
+	}
 	if (final_len == 0) {
 		RETURN_EMPTY_STRING();
 	}
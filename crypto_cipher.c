@@ -27,6 +27,8 @@
 
 #include <openssl/evp.h>
 
+ZEND_EXTERN_MODULE_GLOBALS(crypto)
+
 /* ERRORS */
 
 PHP_CRYPTO_EXCEPTION_DEFINE(Cipher)
@@ -153,6 +155,10 @@ PHP_CRYPTO_ERROR_INFO_ENTRY(
 	INPUT_DATA_LENGTH_HIGH,
 	"Input data length can't exceed max integer length"
 )
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	TAG_REQUIRED,
+	"The tag variable is required for %s cipher mode"
+)
 PHP_CRYPTO_ERROR_INFO_END()
 
 
@@ -353,6 +359,13 @@ static const php_crypto_cipher_mode php_crypto_cipher_modes[] = {
 	PHP_CRYPTO_CIPHER_MODE_ENTRY(XTS)
 #else
 	PHP_CRYPTO_CIPHER_MODE_ENTRY_NOT_DEFINED(XTS)
+#endif
+#ifdef EVP_CIPH_OCB_MODE
+	PHP_CRYPTO_CIPHER_MODE_ENTRY_EX(OCB, 1, 0,
+			EVP_CTRL_AEAD_SET_IVLEN,
+			EVP_CTRL_AEAD_SET_TAG, EVP_CTRL_AEAD_GET_TAG)
+#else
+	PHP_CRYPTO_CIPHER_MODE_ENTRY_NOT_DEFINED(OCB)
 #endif
 	PHP_CRYPTO_CIPHER_MODE_ENTRY_END
 };
@@ -508,6 +521,18 @@ PHP_MINIT_FUNCTION(crypto_cipher)
 }
 /* }}} */
 
+/* {{{ PHP_RSHUTDOWN_FUNCTION */
+PHP_RSHUTDOWN_FUNCTION(crypto_cipher)
+{
+	if (PHP_CRYPTO_G(cipher_ctx)) {
+		EVP_CIPHER_CTX_free(PHP_CRYPTO_G(cipher_ctx));
+		PHP_CRYPTO_G(cipher_ctx) = NULL;
+	}
+
+	return SUCCESS;
+}
+/* }}} */
+
 /* METHODS */
 
 /* {{{ php_crypto_get_algorithm_object_ex */
@@ -1522,3 +1547,235 @@ PHP_CRYPTO_METHOD(Cipher, setAAD)
 	RETURN_TRUE;
 }
 /* }}} */
+
+/* FUNCTIONS */
+
+/* {{{ php_crypto_cipher_fn_get_algorithm */
+static const EVP_CIPHER *php_crypto_cipher_fn_get_algorithm(
+		char *algorithm, phpc_str_size_t algorithm_len TSRMLS_DC)
+{
+	char algorithm_buf[PHP_CRYPTO_CIPHER_ALGORITHM_LEN_MAX + 1];
+	const EVP_CIPHER *cipher = php_crypto_alg_cache_find(
+			&PHP_CRYPTO_G(cipher_cache), algorithm, algorithm_len);
+
+	if (cipher) {
+		return cipher;
+	}
+
+	/* the lookup changes the case so the user string is copied */
+	if (algorithm_len <= PHP_CRYPTO_CIPHER_ALGORITHM_LEN_MAX) {
+		memcpy(algorithm_buf, algorithm, algorithm_len);
+		algorithm_buf[algorithm_len] = '\0';
+		cipher = php_crypto_get_cipher_algorithm(algorithm_buf, algorithm_len);
+	}
+	if (!cipher) {
+		php_crypto_error_ex(PHP_CRYPTO_ERROR_ARGS(Cipher, ALGORITHM_NOT_FOUND), algorithm);
+		return NULL;
+	}
+
+	php_crypto_alg_cache_add(&PHP_CRYPTO_G(cipher_cache), algorithm, algorithm_len, cipher);
+	return cipher;
+}
+/* }}} */
+
+/* {{{ php_crypto_cipher_fn_crypt */
+static void php_crypto_cipher_fn_crypt(INTERNAL_FUNCTION_PARAMETERS, int enc)
+{
+	PHPC_STR_DECLARE(out);
+	const EVP_CIPHER *cipher;
+	const php_crypto_cipher_mode *mode;
+	EVP_CIPHER_CTX *ctx;
+	char *algorithm, *data, *key, *iv = NULL, *tag = NULL, *aad = NULL;
+	phpc_str_size_t algorithm_len, data_str_size, key_str_size;
+	phpc_str_size_t iv_str_size = 0, tag_str_size = 0, aad_str_size = 0;
+	int data_len, key_len, iv_len, tag_len = 0, aad_len = 0;
+	int alg_key_len, alg_iv_len, out_len, update_len, final_len = 0;
+	unsigned char tag_buf[PHP_CRYPTO_CIPHER_AUTH_TAG_LENGTH_MAX];
+	zval *z_tag = NULL;
+
+	if (enc) {
+		if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "sss|s!z/s!",
+				&algorithm, &algorithm_len, &data, &data_str_size,
+				&key, &key_str_size, &iv, &iv_str_size, &z_tag,
+				&aad, &aad_str_size) == FAILURE) {
+			return;
+		}
+	} else if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "sss|s!s!s!",
+			&algorithm, &algorithm_len, &data, &data_str_size,
+			&key, &key_str_size, &iv, &iv_str_size, &tag, &tag_str_size,
+			&aad, &aad_str_size) == FAILURE) {
+		return;
+	}
+
+	if (php_crypto_str_size_to_int(data_str_size, &data_len) == FAILURE) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Cipher, INPUT_DATA_LENGTH_HIGH));
+		RETURN_FALSE;
+	}
+	if (php_crypto_str_size_to_int(aad_str_size, &aad_len) == FAILURE) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Cipher, AAD_LENGTH_HIGH));
+		RETURN_FALSE;
+	}
+
+	cipher = php_crypto_cipher_fn_get_algorithm(algorithm, algorithm_len TSRMLS_CC);
+	if (!cipher) {
+		RETURN_FALSE;
+	}
+	mode = php_crypto_get_cipher_mode(cipher);
+	if (!mode) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Cipher, MODE_NOT_FOUND));
+		RETURN_FALSE;
+	}
+
+	/* tag and AAD are accepted only by authenticated modes */
+	if (((enc ? z_tag != NULL : tag != NULL) || aad) && !mode->auth_enc) {
+		php_crypto_error_ex(PHP_CRYPTO_ERROR_ARGS(Cipher, AUTHENTICATION_NOT_SUPPORTED),
+				mode->name);
+		RETURN_FALSE;
+	}
+	/* the cipher text could not be verified if the tag was dropped */
+	if (enc && mode->auth_enc && !z_tag) {
+		php_crypto_error_ex(PHP_CRYPTO_ERROR_ARGS(Cipher, TAG_REQUIRED), mode->name);
+		RETURN_FALSE;
+	}
+	if (tag) {
+		tag_len = (int) tag_str_size;
+		if (tag_str_size > PHP_CRYPTO_CIPHER_AUTH_TAG_LENGTH_MAX) {
+			php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Cipher, TAG_LENGTH_HIGH));
+			RETURN_FALSE;
+		}
+		if (php_crypto_cipher_check_tag_len(tag_len TSRMLS_CC) == FAILURE) {
+			RETURN_FALSE;
+		}
+	}
+
+	/* the context is created once and reused until the end of the request */
+	ctx = PHP_CRYPTO_G(cipher_ctx);
+	if (!ctx) {
+		ctx = PHP_CRYPTO_G(cipher_ctx) = EVP_CIPHER_CTX_new();
+	}
+
+	if (!ctx || !EVP_CipherInit_ex(ctx, cipher, NULL, NULL, NULL, enc)) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Cipher, INIT_ALG_FAILED));
+		RETURN_FALSE;
+	}
+
+	/* check key length */
+	alg_key_len = EVP_CIPHER_key_length(cipher);
+	if (php_crypto_str_size_to_int(key_str_size, &key_len) == FAILURE ||
+			(key_len != alg_key_len && !EVP_CIPHER_CTX_set_key_length(ctx, key_len))) {
+		php_crypto_error_ex(PHP_CRYPTO_ERROR_ARGS(Cipher, KEY_LENGTH_INVALID),
+				algorithm, alg_key_len);
+		goto php_crypto_cipher_fn_crypt_err;
+	}
+
+	/* mode with inlen init requires also pre-setting tag length */
+	if (mode->auth_inlen_init && enc) {
+		EVP_CIPHER_CTX_ctrl(ctx, mode->auth_set_tag_flag,
+				PHP_CRYPTO_CIPHER_AUTH_TAG_LENGTH_DEFAULT, NULL);
+	}
+
+	/* check initialization vector length */
+	alg_iv_len = EVP_CIPHER_iv_length(cipher);
+	if (php_crypto_str_size_to_int(iv_str_size, &iv_len) == FAILURE ||
+			(iv_len != alg_iv_len && (!mode->auth_enc || iv_len == INT_MAX ||
+				!EVP_CIPHER_CTX_ctrl(ctx, mode->auth_ivlen_flag, iv_len, NULL)))) {
+		php_crypto_error_ex(PHP_CRYPTO_ERROR_ARGS(Cipher, IV_LENGTH_INVALID),
+				algorithm, alg_iv_len);
+		goto php_crypto_cipher_fn_crypt_err;
+	}
+
+	if (!enc && php_crypto_cipher_set_tag(ctx, mode,
+			(unsigned char *) tag, tag_len TSRMLS_CC) == FAILURE) {
+		goto php_crypto_cipher_fn_crypt_err;
+	}
+
+	if (!EVP_CipherInit_ex(ctx, NULL, NULL,
+			(unsigned char *) key, (unsigned char *) iv, enc)) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Cipher, INIT_CTX_FAILED));
+		goto php_crypto_cipher_fn_crypt_err;
+	}
+
+	if (mode->auth_enc) {
+		/* check if plain text length needs to be initialized (CCM mode) */
+		if (mode->auth_inlen_init && php_crypto_cipher_write_inlen(
+				ctx, data_len TSRMLS_CC) == FAILURE) {
+			goto php_crypto_cipher_fn_crypt_err;
+		}
+		if (php_crypto_cipher_write_aad(ctx,
+				(unsigned char *) aad, aad_len TSRMLS_CC) == FAILURE) {
+			goto php_crypto_cipher_fn_crypt_err;
+		}
+	}
+
+	out_len = data_len + EVP_CIPHER_block_size(cipher);
+	PHPC_STR_ALLOC(out, out_len);
+
+	/* update encryption context */
+	if (!EVP_CipherUpdate(ctx, (unsigned char *) PHPC_STR_VAL(out), &update_len,
+			(unsigned char *) data, data_len)) {
+		if (!enc && mode->auth_inlen_init) {
+			php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Cipher, TAG_VERIFY_FAILED));
+		} else {
+			php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Cipher, UPDATE_FAILED));
+		}
+		PHPC_STR_RELEASE(out);
+		goto php_crypto_cipher_fn_crypt_err;
+	}
+
+	/* finalize cipher context */
+	if ((enc || !mode->auth_inlen_init) && !EVP_CipherFinal_ex(ctx,
+			(unsigned char *) (PHPC_STR_VAL(out) + update_len), &final_len)) {
+		if (!enc && mode->auth_enc) {
+			php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Cipher, TAG_VERIFY_FAILED));
+		} else {
+			php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Cipher, FINISH_FAILED));
+		}
+		PHPC_STR_RELEASE(out);
+		goto php_crypto_cipher_fn_crypt_err;
+	}
+
+	/* save the authentication tag */
+	if (enc && mode->auth_enc) {
+		if (!EVP_CIPHER_CTX_ctrl(ctx, mode->auth_get_tag_flag,
+				PHP_CRYPTO_CIPHER_AUTH_TAG_LENGTH_DEFAULT, tag_buf)) {
+			php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Cipher, TAG_GETTER_FAILED));
+			PHPC_STR_RELEASE(out);
+			goto php_crypto_cipher_fn_crypt_err;
+		}
+		zval_dtor(z_tag);
+		PHPC_ZVAL_CSTRL(z_tag, (char *) tag_buf, PHP_CRYPTO_CIPHER_AUTH_TAG_LENGTH_DEFAULT);
+	}
+
+	/* wipe the key schedule but keep the context allocated */
+	EVP_CIPHER_CTX_cleanup(ctx);
+
+	final_len += update_len;
+	if (out_len > final_len) {
+		PHPC_STR_REALLOC(out, final_len);
+	}
+	PHPC_STR_VAL(out)[final_len] = 0;
+	PHPC_STR_RETURN(out);
+
+php_crypto_cipher_fn_crypt_err:
+	EVP_CIPHER_CTX_cleanup(ctx);
+	RETURN_FALSE;
+}
+/* }}} */
+
+/* {{{ proto string Crypto\encrypt(string $algorithm, string $data, string $key,
+			string $iv = null, &string $tag = null, string $aad = null)
+	Encrypts the data without creating a Cipher object */
+PHP_CRYPTO_FUNCTION(encrypt)
+{
+	php_crypto_cipher_fn_crypt(INTERNAL_FUNCTION_PARAM_PASSTHRU, 1);
+}
+/* }}} */
+
+/* {{{ proto string Crypto\decrypt(string $algorithm, string $data, string $key,
+			string $iv = null, string $tag = null, string $aad = null)
+	Decrypts the data without creating a Cipher object */
+PHP_CRYPTO_FUNCTION(decrypt)
+{
+	php_crypto_cipher_fn_crypt(INTERNAL_FUNCTION_PARAM_PASSTHRU, 0);
+}
+/* }}} */
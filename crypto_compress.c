@@ -0,0 +1,233 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 2013-2016 Jakub Zelenka                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: Jakub Zelenka <bukka@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "php.h"
+#include "php_crypto.h"
+#include "php_crypto_compress.h"
+
+#ifdef HAVE_CRYPTO_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_CRYPTO_ZSTD
+#include <zstd.h>
+#ifndef ZSTD_CLEVEL_DEFAULT
+#define ZSTD_CLEVEL_DEFAULT 3
+#endif
+#endif
+
+struct _php_crypto_compress {
+	php_crypto_compress_algorithm algorithm;
+	zend_bool enc;
+	zend_bool init;
+#ifdef HAVE_CRYPTO_ZLIB
+	z_stream zs;
+#endif
+#ifdef HAVE_CRYPTO_ZSTD
+	ZSTD_CCtx *cctx;
+	ZSTD_DCtx *dctx;
+#endif
+};
+
+/* {{{ php_crypto_compress_find */
+PHP_CRYPTO_API int php_crypto_compress_find(const char *name,
+		php_crypto_compress_algorithm *algorithm)
+{
+#ifdef HAVE_CRYPTO_ZLIB
+	if (!strcasecmp(name, "zlib")) {
+		*algorithm = PHP_CRYPTO_COMPRESS_ZLIB;
+		return SUCCESS;
+	}
+	if (!strcasecmp(name, "gzip")) {
+		*algorithm = PHP_CRYPTO_COMPRESS_GZIP;
+		return SUCCESS;
+	}
+#endif
+#ifdef HAVE_CRYPTO_ZSTD
+	if (!strcasecmp(name, "zstd")) {
+		*algorithm = PHP_CRYPTO_COMPRESS_ZSTD;
+		return SUCCESS;
+	}
+#endif
+
+	return FAILURE;
+}
+/* }}} */
+
+/* {{{ php_crypto_compress_create */
+PHP_CRYPTO_API php_crypto_compress *php_crypto_compress_create(
+		php_crypto_compress_algorithm algorithm, int level, zend_bool enc)
+{
+	php_crypto_compress *compress = ecalloc(1, sizeof(php_crypto_compress));
+
+	compress->algorithm = algorithm;
+	compress->enc = enc;
+	switch (algorithm) {
+#ifdef HAVE_CRYPTO_ZLIB
+		case PHP_CRYPTO_COMPRESS_ZLIB:
+		case PHP_CRYPTO_COMPRESS_GZIP:
+		{
+			/* the gzip format is selected by adding 16 to the window bits */
+			int window_bits = algorithm == PHP_CRYPTO_COMPRESS_GZIP ? MAX_WBITS + 16 : MAX_WBITS;
+			int rc;
+
+			if (enc && (level < Z_DEFAULT_COMPRESSION || level > Z_BEST_COMPRESSION)) {
+				break;
+			}
+			rc = enc ?
+					deflateInit2(&compress->zs, level, Z_DEFLATED, window_bits,
+							MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY) :
+					inflateInit2(&compress->zs, window_bits);
+			compress->init = rc == Z_OK;
+			break;
+		}
+#endif
+#ifdef HAVE_CRYPTO_ZSTD
+		case PHP_CRYPTO_COMPRESS_ZSTD:
+			if (level == PHP_CRYPTO_COMPRESS_LEVEL_DEFAULT) {
+				level = ZSTD_CLEVEL_DEFAULT;
+			}
+			if (enc && (level < 1 || level > ZSTD_maxCLevel())) {
+				break;
+			}
+			if (enc) {
+				compress->cctx = ZSTD_createCCtx();
+				compress->init = compress->cctx && !ZSTD_isError(ZSTD_CCtx_setParameter(
+						compress->cctx, ZSTD_c_compressionLevel, level));
+			} else {
+				compress->dctx = ZSTD_createDCtx();
+				compress->init = compress->dctx != NULL;
+			}
+			break;
+#endif
+		default:
+			break;
+	}
+	if (!compress->init) {
+		php_crypto_compress_free(compress);
+		return NULL;
+	}
+
+	return compress;
+}
+/* }}} */
+
+/* {{{ php_crypto_compress_update */
+PHP_CRYPTO_API int php_crypto_compress_update(php_crypto_compress *compress,
+		const unsigned char **in, size_t *in_len,
+		unsigned char **out, size_t *out_len, zend_bool finish)
+{
+	switch (compress->algorithm) {
+#ifdef HAVE_CRYPTO_ZLIB
+		case PHP_CRYPTO_COMPRESS_ZLIB:
+		case PHP_CRYPTO_COMPRESS_GZIP:
+		{
+			z_stream *zs = &compress->zs;
+			uInt avail_in = *in_len > UINT_MAX ? UINT_MAX : (uInt) *in_len;
+			uInt avail_out = *out_len > UINT_MAX ? UINT_MAX : (uInt) *out_len;
+			int rc;
+
+			zs->next_in = (Bytef *) *in;
+			zs->avail_in = avail_in;
+			zs->next_out = (Bytef *) *out;
+			zs->avail_out = avail_out;
+			rc = compress->enc ?
+					deflate(zs, finish ? Z_FINISH : Z_NO_FLUSH) : inflate(zs, Z_NO_FLUSH);
+			*in += avail_in - zs->avail_in;
+			*in_len -= avail_in - zs->avail_in;
+			*out += avail_out - zs->avail_out;
+			*out_len -= avail_out - zs->avail_out;
+			if (rc == Z_STREAM_END) {
+				return PHP_CRYPTO_COMPRESS_END;
+			}
+			/* the buffer error only means that no progress was possible */
+			return rc == Z_OK || rc == Z_BUF_ERROR ? PHP_CRYPTO_COMPRESS_OK : PHP_CRYPTO_COMPRESS_ERROR;
+		}
+#endif
+#ifdef HAVE_CRYPTO_ZSTD
+		case PHP_CRYPTO_COMPRESS_ZSTD:
+		{
+			ZSTD_inBuffer input;
+			ZSTD_outBuffer output;
+			size_t rc;
+
+			input.src = *in;
+			input.size = *in_len;
+			input.pos = 0;
+			output.dst = *out;
+			output.size = *out_len;
+			output.pos = 0;
+			rc = compress->enc ?
+					ZSTD_compressStream2(compress->cctx, &output, &input,
+							finish ? ZSTD_e_end : ZSTD_e_continue) :
+					ZSTD_decompressStream(compress->dctx, &output, &input);
+			*in += input.pos;
+			*in_len -= input.pos;
+			*out += output.pos;
+			*out_len -= output.pos;
+			if (ZSTD_isError(rc)) {
+				return PHP_CRYPTO_COMPRESS_ERROR;
+			}
+			/* zero is returned when the frame is finished (flushed or decoded) */
+			return rc == 0 && (finish || !compress->enc) ?
+					PHP_CRYPTO_COMPRESS_END : PHP_CRYPTO_COMPRESS_OK;
+		}
+#endif
+		default:
+			return PHP_CRYPTO_COMPRESS_ERROR;
+	}
+}
+/* }}} */
+
+/* {{{ php_crypto_compress_free */
+PHP_CRYPTO_API void php_crypto_compress_free(php_crypto_compress *compress)
+{
+#ifdef HAVE_CRYPTO_ZLIB
+	if (compress->init && (compress->algorithm == PHP_CRYPTO_COMPRESS_ZLIB ||
+			compress->algorithm == PHP_CRYPTO_COMPRESS_GZIP)) {
+		if (compress->enc) {
+			deflateEnd(&compress->zs);
+		} else {
+			inflateEnd(&compress->zs);
+		}
+	}
+#endif
+#ifdef HAVE_CRYPTO_ZSTD
+	if (compress->cctx) {
+		ZSTD_freeCCtx(compress->cctx);
+	}
+	if (compress->dctx) {
+		ZSTD_freeDCtx(compress->dctx);
+	}
+#endif
+	efree(compress);
+}
+/* }}} */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
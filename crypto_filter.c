@@ -0,0 +1,635 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 2013-2016 Jakub Zelenka                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: Jakub Zelenka <bukka@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#include "php.h"
+#include "php_crypto.h"
+#include "php_crypto_filter.h"
+#include "php_crypto_stream.h"
+#include "php_crypto_base64.h"
+#include "php_crypto_cipher.h"
+#include "php_crypto_hash.h"
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+
+typedef struct _php_crypto_filter_codec php_crypto_filter_codec;
+
+/* crypto filter data */
+typedef struct {
+	const php_crypto_filter_codec *codec;
+	php_crypto_filter_persistent_t persistent;
+	union {
+		php_crypto_base64_ctx base64;
+		struct {
+			unsigned char nibble;
+			zend_bool pending;
+		} hex;
+		struct {
+			EVP_CIPHER_CTX *ctx;
+			const php_crypto_cipher_mode *mode;
+			int enc;
+		} cipher;
+	} ctx;
+} php_crypto_filter_data;
+
+/* Initializes filter context from the filter params */
+typedef int (*php_crypto_filter_init_func)(php_crypto_filter_data *data,
+		zval *filterparams TSRMLS_DC);
+/* Returns max output length for the input length */
+typedef size_t (*php_crypto_filter_length_func)(php_crypto_filter_data *data,
+		size_t inl, zend_bool final);
+/* Transforms input to the output (the input is empty if final is set) */
+typedef int (*php_crypto_filter_update_func)(php_stream *stream, php_crypto_filter_data *data,
+		char *out, size_t *outl, const char *in, size_t inl, zend_bool final TSRMLS_DC);
+/* Frees resources held by the filter context */
+typedef void (*php_crypto_filter_free_func)(php_crypto_filter_data *data);
+
+/* crypto filter codec (the ops label is the filter name) */
+struct _php_crypto_filter_codec {
+	php_stream_filter_ops ops;
+	php_crypto_filter_init_func init;
+	php_crypto_filter_length_func length;
+	php_crypto_filter_update_func update;
+	php_crypto_filter_free_func free;
+};
+
+/* {{{ php_crypto_filter_get_long */
+static int php_crypto_filter_get_long(zval *filterparams, const char *name,
+		phpc_long_t *lval TSRMLS_DC)
+{
+	phpc_val *ppv_param;
+	zval *pz_param;
+
+	if (PHPC_HASH_CSTR_FIND_IN_COND(Z_ARRVAL_P(filterparams), name, ppv_param)) {
+		PHPC_PVAL_TO_PZVAL(ppv_param, pz_param);
+		if (Z_TYPE_P(pz_param) != IS_LONG) {
+			php_crypto_error_ex(PHP_CRYPTO_STREAM_ERROR_ARGS(FILTER_PARAM_TYPE_INVALID), name);
+			return FAILURE;
+		}
+		*lval = Z_LVAL_P(pz_param);
+	}
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_filter_base64_init */
+static int php_crypto_filter_base64_init(php_crypto_filter_data *data,
+		zval *filterparams, zend_bool encode TSRMLS_DC)
+{
+	phpc_long_t wrap = PHP_CRYPTO_BASE64_WRAP_PEM;
+	phpc_long_t alphabet = PHP_CRYPTO_BASE64_ALPHABET_STANDARD;
+	zend_bool padding = 1;
+
+	if (filterparams && Z_TYPE_P(filterparams) != IS_NULL) {
+		phpc_val *ppv_padding;
+		zval *pz_padding;
+
+		if (Z_TYPE_P(filterparams) != IS_ARRAY) {
+			php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(FILTER_PARAMS_TYPE_INVALID));
+			return FAILURE;
+		}
+		/* the decoder accepts any line length */
+		if ((encode && php_crypto_filter_get_long(
+					filterparams, "wrap", &wrap TSRMLS_CC) == FAILURE) ||
+				php_crypto_filter_get_long(
+					filterparams, "alphabet", &alphabet TSRMLS_CC) == FAILURE) {
+			return FAILURE;
+		}
+		if (PHPC_HASH_CSTR_FIND_IN_COND(Z_ARRVAL_P(filterparams), "padding", ppv_padding)) {
+			PHPC_PVAL_TO_PZVAL(ppv_padding, pz_padding);
+			padding = zend_is_true(pz_padding) ? 1 : 0;
+		}
+	}
+
+	if (wrap != PHP_CRYPTO_BASE64_WRAP_NONE && wrap != PHP_CRYPTO_BASE64_WRAP_PEM &&
+			wrap != PHP_CRYPTO_BASE64_WRAP_MIME) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(FILTER_BASE64_WRAP_INVALID));
+		return FAILURE;
+	}
+	if (alphabet != PHP_CRYPTO_BASE64_ALPHABET_STANDARD &&
+			alphabet != PHP_CRYPTO_BASE64_ALPHABET_URL) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(FILTER_BASE64_ALPHABET_INVALID));
+		return FAILURE;
+	}
+
+	return php_crypto_base64_ctx_init(&data->ctx.base64, (int) wrap,
+			(php_crypto_base64_alphabet) alphabet, padding);
+}
+/* }}} */
+
+/* {{{ php_crypto_filter_base64_encode_init */
+static int php_crypto_filter_base64_encode_init(php_crypto_filter_data *data,
+		zval *filterparams TSRMLS_DC)
+{
+	if (php_crypto_filter_base64_init(data, filterparams, 1 TSRMLS_CC) == FAILURE) {
+		return FAILURE;
+	}
+	php_crypto_base64_encode_init(&data->ctx.base64);
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_filter_base64_encode_length */
+static size_t php_crypto_filter_base64_encode_length(php_crypto_filter_data *data,
+		size_t inl, zend_bool final)
+{
+	return php_crypto_base64_encode_length(&data->ctx.base64, inl, final);
+}
+/* }}} */
+
+/* {{{ php_crypto_filter_base64_encode_update */
+static int php_crypto_filter_base64_encode_update(php_stream *stream,
+		php_crypto_filter_data *data, char *out,
+		size_t *outl, const char *in, size_t inl, zend_bool final TSRMLS_DC)
+{
+	int len;
+
+	if (final) {
+		php_crypto_base64_encode_final(&data->ctx.base64, (unsigned char *) out, &len);
+	} else {
+		php_crypto_base64_encode_update(&data->ctx.base64,
+				(unsigned char *) out, &len, (const unsigned char *) in, (int) inl);
+	}
+	*outl = (size_t) len;
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_filter_base64_decode_init */
+static int php_crypto_filter_base64_decode_init(php_crypto_filter_data *data,
+		zval *filterparams TSRMLS_DC)
+{
+	if (php_crypto_filter_base64_init(data, filterparams, 0 TSRMLS_CC) == FAILURE) {
+		return FAILURE;
+	}
+	php_crypto_base64_decode_init(&data->ctx.base64);
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_filter_base64_decode_length */
+static size_t php_crypto_filter_base64_decode_length(php_crypto_filter_data *data,
+		size_t inl, zend_bool final)
+{
+	return php_crypto_base64_decode_length(&data->ctx.base64, inl);
+}
+/* }}} */
+
+/* {{{ php_crypto_filter_base64_decode_update */
+static int php_crypto_filter_base64_decode_update(php_stream *stream,
+		php_crypto_filter_data *data, char *out,
+		size_t *outl, const char *in, size_t inl, zend_bool final TSRMLS_DC)
+{
+	int len, rc;
+
+	if (final) {
+		rc = php_crypto_base64_decode_final(&data->ctx.base64, (unsigned char *) out, &len);
+	} else {
+		rc = php_crypto_base64_decode_update(&data->ctx.base64,
+				(unsigned char *) out, &len, (const unsigned char *) in, (int) inl);
+	}
+	if (rc < 0) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(FILTER_BASE64_DECODE_FAILED));
+		return FAILURE;
+	}
+	*outl = (size_t) len;
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_filter_hex_init */
+static int php_crypto_filter_hex_init(php_crypto_filter_data *data,
+		zval *filterparams TSRMLS_DC)
+{
+	data->ctx.hex.nibble = 0;
+	data->ctx.hex.pending = 0;
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_filter_hex_encode_length */
+static size_t php_crypto_filter_hex_encode_length(php_crypto_filter_data *data,
+		size_t inl, zend_bool final)
+{
+	/* php_crypto_hash_bin2hex adds a terminating null char */
+	return inl ? inl * 2 + 1 : 0;
+}
+/* }}} */
+
+/* {{{ php_crypto_filter_hex_encode_update */
+static int php_crypto_filter_hex_encode_update(php_stream *stream,
+		php_crypto_filter_data *data, char *out,
+		size_t *outl, const char *in, size_t inl, zend_bool final TSRMLS_DC)
+{
+	if (inl) {
+		php_crypto_hash_bin2hex(out, (const unsigned char *) in, (unsigned) inl);
+	}
+	*outl = inl * 2;
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_filter_hex_decode_length */
+static size_t php_crypto_filter_hex_decode_length(php_crypto_filter_data *data,
+		size_t inl, zend_bool final)
+{
+	return (inl + data->ctx.hex.pending) / 2;
+}
+/* }}} */
+
+/* {{{ php_crypto_filter_hex_decode_update */
+static int php_crypto_filter_hex_decode_update(php_stream *stream,
+		php_crypto_filter_data *data, char *out,
+		size_t *outl, const char *in, size_t inl, zend_bool final TSRMLS_DC)
+{
+	unsigned char c, nibble;
+	size_t i, len = 0;
+
+	for (i = 0; i < inl; i++) {
+		c = (unsigned char) in[i];
+		if (c >= '0' && c <= '9') {
+			nibble = c - '0';
+		} else if (c >= 'a' && c <= 'f') {
+			nibble = c - 'a' + 10;
+		} else if (c >= 'A' && c <= 'F') {
+			nibble = c - 'A' + 10;
+		} else if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+			/* white spaces are skipped */
+			continue;
+		} else {
+			php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(FILTER_HEX_DECODE_FAILED));
+			return FAILURE;
+		}
+		if (data->ctx.hex.pending) {
+			out[len++] = (char) ((data->ctx.hex.nibble << 4) | nibble);
+			data->ctx.hex.pending = 0;
+		} else {
+			data->ctx.hex.nibble = nibble;
+			data->ctx.hex.pending = 1;
+		}
+	}
+	/* the data ended in the middle of a byte */
+	if (final && data->ctx.hex.pending) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(FILTER_HEX_DECODE_FAILED));
+		return FAILURE;
+	}
+	*outl = len;
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_filter_cipher_init */
+static int php_crypto_filter_cipher_init(php_crypto_filter_data *data,
+		zval *filterparams TSRMLS_DC)
+{
+	php_crypto_stream_cipher_params params;
+	EVP_CIPHER_CTX *cipher_ctx;
+
+	/* the params are the same as the cipher field of the crypto stream filters context */
+	if (!filterparams || Z_TYPE_P(filterparams) != IS_ARRAY) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(FILTER_PARAMS_TYPE_INVALID));
+		return FAILURE;
+	}
+	if (php_crypto_stream_cipher_parse(&params, filterparams TSRMLS_CC) == FAILURE) {
+		return FAILURE;
+	}
+
+	cipher_ctx = EVP_CIPHER_CTX_new();
+	if (!cipher_ctx) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_INIT_FAILED));
+		return FAILURE;
+	}
+	if (!EVP_CipherInit_ex(cipher_ctx, params.cipher, NULL, NULL, NULL, params.enc)) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_INIT_FAILED));
+		EVP_CIPHER_CTX_free(cipher_ctx);
+		return FAILURE;
+	}
+	if (php_crypto_stream_cipher_init(cipher_ctx, &params TSRMLS_CC) == FAILURE) {
+		EVP_CIPHER_CTX_free(cipher_ctx);
+		return FAILURE;
+	}
+
+	data->ctx.cipher.ctx = cipher_ctx;
+	data->ctx.cipher.mode = params.mode;
+	data->ctx.cipher.enc = params.enc;
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_filter_cipher_length */
+static size_t php_crypto_filter_cipher_length(php_crypto_filter_data *data,
+		size_t inl, zend_bool final)
+{
+	/* the update can output one block more than the input and the final one block */
+	return inl + EVP_CIPHER_CTX_block_size(data->ctx.cipher.ctx);
+}
+/* }}} */
+
+/* {{{ php_crypto_filter_cipher_update */
+static int php_crypto_filter_cipher_update(php_stream *stream,
+		php_crypto_filter_data *data, char *out,
+		size_t *outl, const char *in, size_t inl, zend_bool final TSRMLS_DC)
+{
+	EVP_CIPHER_CTX *cipher_ctx = data->ctx.cipher.ctx;
+	int len, ok;
+
+	if (!final) {
+		if (!EVP_CipherUpdate(cipher_ctx, (unsigned char *) out, &len,
+				(const unsigned char *) in, (int) inl)) {
+			php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(FILTER_CIPHER_UPDATE_FAILED));
+			return FAILURE;
+		}
+		*outl = (size_t) len;
+		return SUCCESS;
+	}
+
+	ok = EVP_CipherFinal_ex(cipher_ctx, (unsigned char *) out, &len);
+	if (data->ctx.cipher.mode->auth_enc) {
+		/* the auth result is exposed in the stream meta the same way as for crypto stream */
+		if (data->ctx.cipher.enc) {
+			php_crypto_stream_auth_save_tag(stream, cipher_ctx TSRMLS_CC);
+		} else {
+			php_crypto_stream_auth_save_result(stream, ok);
+		}
+	} else if (!ok) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(FILTER_CIPHER_FINISH_FAILED));
+		return FAILURE;
+	}
+	*outl = ok ? (size_t) len : 0;
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_filter_cipher_free */
+static void php_crypto_filter_cipher_free(php_crypto_filter_data *data)
+{
+	EVP_CIPHER_CTX_free(data->ctx.cipher.ctx);
+}
+/* }}} */
+
+/* {{{ php_crypto_filter_emit
+	Returns -1 on error, 0 if no output was created or 1 if the bucket was appended */
+static int php_crypto_filter_emit(php_stream *stream, php_crypto_filter_data *data,
+		php_stream_bucket_brigade *buckets_out, const char *in, size_t inl,
+		zend_bool final TSRMLS_DC)
+{
+	const php_crypto_filter_codec *codec = data->codec;
+	php_stream_bucket *bucket;
+	size_t out_len = codec->length(data, inl, final);
+	char *out;
+
+	/* the input might be still buffered in the codec context */
+	if (out_len == 0) {
+		return codec->update(stream, data, NULL, &out_len, in, inl, final TSRMLS_CC) == FAILURE ?
+				-1 : 0;
+	}
+
+	/* the output is written directly to the new bucket buffer */
+	out = pemalloc(out_len, data->persistent);
+	if (codec->update(stream, data, out, &out_len, in, inl, final TSRMLS_CC) == FAILURE) {
+		pefree(out, data->persistent);
+		return -1;
+	}
+	if (out_len == 0) {
+		pefree(out, data->persistent);
+		return 0;
+	}
+
+	bucket = php_stream_bucket_new(stream, out, out_len, 1, data->persistent TSRMLS_CC);
+	php_stream_bucket_append(buckets_out, bucket TSRMLS_CC);
+
+	return 1;
+}
+/* }}} */
+
+/* {{{ php_crypto_filter_filter */
+static php_stream_filter_status_t php_crypto_filter_filter(
+		php_stream *stream, php_stream_filter *thisfilter,
+		php_stream_bucket_brigade *buckets_in, php_stream_bucket_brigade *buckets_out,
+		size_t *bytes_consumed, int flags TSRMLS_DC)
+{
+	php_crypto_filter_data *data = (php_crypto_filter_data *) PHP_CRYPTO_FILTER_ABSTRACT(thisfilter);
+	php_stream_filter_status_t status = PSFS_FEED_ME;
+	php_stream_bucket *bucket;
+	size_t consumed = 0, len, chunk_len;
+	const char *in;
+	int rc;
+
+	while (buckets_in->head) {
+		bucket = buckets_in->head;
+		php_stream_bucket_unlink(bucket TSRMLS_CC);
+		in = bucket->buf;
+		len = bucket->buflen;
+		/* the bucket is passed to the codec in chunks with int sized output */
+		while (len > 0) {
+			chunk_len = len > PHP_CRYPTO_FILTER_CHUNK_MAX ? PHP_CRYPTO_FILTER_CHUNK_MAX : len;
+			rc = php_crypto_filter_emit(stream, data, buckets_out, in, chunk_len, 0 TSRMLS_CC);
+			if (rc < 0) {
+				php_stream_bucket_delref(bucket TSRMLS_CC);
+				return PSFS_ERR_FATAL;
+			}
+			if (rc > 0) {
+				status = PSFS_PASS_ON;
+			}
+			in += chunk_len;
+			len -= chunk_len;
+		}
+		consumed += bucket->buflen;
+		php_stream_bucket_delref(bucket TSRMLS_CC);
+	}
+
+	if (flags & PSFS_FLAG_FLUSH_CLOSE) {
+		rc = php_crypto_filter_emit(stream, data, buckets_out, NULL, 0, 1 TSRMLS_CC);
+		if (rc < 0) {
+			return PSFS_ERR_FATAL;
+		}
+		if (rc > 0) {
+			status = PSFS_PASS_ON;
+		}
+	}
+
+	if (bytes_consumed) {
+		*bytes_consumed = consumed;
+	}
+
+	return status;
+}
+/* }}} */
+
+/* {{{ php_crypto_filter_dtor */
+static void php_crypto_filter_dtor(php_stream_filter *thisfilter TSRMLS_DC)
+{
+	php_crypto_filter_data *data = (php_crypto_filter_data *) PHP_CRYPTO_FILTER_ABSTRACT(thisfilter);
+
+	if (data) {
+		php_crypto_filter_persistent_t persistent = data->persistent;
+
+		if (data->codec->free) {
+			data->codec->free(data);
+		}
+		OPENSSL_cleanse(data, sizeof(php_crypto_filter_data));
+		pefree(data, persistent);
+	}
+}
+/* }}} */
+
+/* crypto filter codecs */
+static php_crypto_filter_codec php_crypto_filter_codecs[] = {
+	{
+		{
+			php_crypto_filter_filter,
+			php_crypto_filter_dtor,
+			PHP_CRYPTO_FILTER_BASE64_ENCODE_NAME
+		},
+		php_crypto_filter_base64_encode_init,
+		php_crypto_filter_base64_encode_length,
+		php_crypto_filter_base64_encode_update,
+		NULL
+	},
+	{
+		{
+			php_crypto_filter_filter,
+			php_crypto_filter_dtor,
+			PHP_CRYPTO_FILTER_BASE64_DECODE_NAME
+		},
+		php_crypto_filter_base64_decode_init,
+		php_crypto_filter_base64_decode_length,
+		php_crypto_filter_base64_decode_update,
+		NULL
+	},
+	{
+		{
+			php_crypto_filter_filter,
+			php_crypto_filter_dtor,
+			PHP_CRYPTO_FILTER_HEX_ENCODE_NAME
+		},
+		php_crypto_filter_hex_init,
+		php_crypto_filter_hex_encode_length,
+		php_crypto_filter_hex_encode_update,
+		NULL
+	},
+	{
+		{
+			php_crypto_filter_filter,
+			php_crypto_filter_dtor,
+			PHP_CRYPTO_FILTER_HEX_DECODE_NAME
+		},
+		php_crypto_filter_hex_init,
+		php_crypto_filter_hex_decode_length,
+		php_crypto_filter_hex_decode_update,
+		NULL
+	},
+	{
+		{
+			php_crypto_filter_filter,
+			php_crypto_filter_dtor,
+			PHP_CRYPTO_FILTER_CIPHER_NAME
+		},
+		php_crypto_filter_cipher_init,
+		php_crypto_filter_cipher_length,
+		php_crypto_filter_cipher_update,
+		php_crypto_filter_cipher_free
+	}
+};
+
+#define PHP_CRYPTO_FILTER_CODECS_COUNT \
+	(sizeof(php_crypto_filter_codecs) / sizeof(php_crypto_filter_codec))
+
+/* {{{ php_crypto_filter_create */
+static php_stream_filter *php_crypto_filter_create(const char *filtername,
+		zval *filterparams, php_crypto_filter_persistent_t persistent TSRMLS_DC)
+{
+	const php_crypto_filter_codec *codec = NULL;
+	php_crypto_filter_data *data;
+	php_stream_filter *filter;
+	size_t i;
+
+	for (i = 0; i < PHP_CRYPTO_FILTER_CODECS_COUNT; i++) {
+		if (!strcasecmp(filtername, php_crypto_filter_codecs[i].ops.label)) {
+			codec = &php_crypto_filter_codecs[i];
+			break;
+		}
+	}
+	if (!codec) {
+		return NULL;
+	}
+
+	data = pemalloc(sizeof(php_crypto_filter_data), persistent);
+	data->codec = codec;
+	data->persistent = persistent;
+	if (codec->init(data, filterparams TSRMLS_CC) == FAILURE) {
+		pefree(data, persistent);
+		return NULL;
+	}
+
+	filter = php_stream_filter_alloc(&php_crypto_filter_codecs[i].ops, data, persistent);
+	if (!filter) {
+		if (codec->free) {
+			codec->free(data);
+		}
+		OPENSSL_cleanse(data, sizeof(php_crypto_filter_data));
+		pefree(data, persistent);
+	}
+
+	return filter;
+}
+/* }}} */
+
+/* crypto filter factory */
+static php_stream_filter_factory php_crypto_filter_factory = {
+	php_crypto_filter_create
+};
+
+/* {{{ PHP_MINIT_FUNCTION */
+PHP_MINIT_FUNCTION(crypto_filter)
+{
+	size_t i;
+
+	for (i = 0; i < PHP_CRYPTO_FILTER_CODECS_COUNT; i++) {
+		if (php_stream_filter_register_factory(php_crypto_filter_codecs[i].ops.label,
+				&php_crypto_filter_factory TSRMLS_CC) == FAILURE) {
+			return FAILURE;
+		}
+	}
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ PHP_MSHUTDOWN_FUNCTION */
+PHP_MSHUTDOWN_FUNCTION(crypto_filter)
+{
+	size_t i;
+
+	for (i = 0; i < PHP_CRYPTO_FILTER_CODECS_COUNT; i++) {
+		php_stream_filter_unregister_factory(php_crypto_filter_codecs[i].ops.label TSRMLS_CC);
+	}
+
+	return SUCCESS;
+}
+/* }}} */
@@ -52,24 +52,7 @@ int HMAC_CTX_copy(HMAC_CTX *dctx, HMAC_CTX *sctx)
 
 #endif
 
-#if OPENSSL_VERSION_NUMBER < 0x10100000L
-
-static HMAC_CTX *HMAC_CTX_new()
-{
-	HMAC_CTX *ctx = OPENSSL_malloc(sizeof(HMAC_CTX));
-	if (ctx) {
-		HMAC_CTX_init(ctx);
-	}
-
-	return ctx;
-}
-
-static inline void HMAC_CTX_free(HMAC_CTX *ctx)
-{
-	OPENSSL_free(ctx);
-}
-
-#endif
+ZEND_EXTERN_MODULE_GLOBALS(crypto)
 
 PHP_CRYPTO_EXCEPTION_DEFINE(Hash)
 PHP_CRYPTO_ERROR_INFO_BEGIN(Hash)
@@ -186,6 +169,18 @@ PHP_CRYPTO_ERROR_INFO_ENTRY(
 	KEY_LENGTH_INVALID,
 	"The key length for MAC is invalid"
 )
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	INIT_FAILED,
+	"Initialization of MAC failed"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	UPDATE_FAILED,
+	"Updating of MAC context failed"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	DIGEST_FAILED,
+	"Creating of MAC digest failed"
+)
 PHP_CRYPTO_ERROR_INFO_END()
 
 ZEND_BEGIN_ARG_INFO(arginfo_crypto_mac_construct, 0)
@@ -221,6 +216,14 @@ PHPC_OBJ_DEFINE_HANDLER_VAR(crypto_hash);
 #define PHP_CRYPTO_HASH_GET_ALGORITHM_NAME(this_object) \
 	Z_STRVAL_P(PHP_CRYPTO_HASH_GET_ALGORITHM_NAME_EX(this_object))
 
+/* MAC objects report failures with the MAC error codes */
+#define PHP_CRYPTO_HASH_ERROR(pobj, einame) do { \
+	if ((pobj)->type == PHP_CRYPTO_HASH_TYPE_MD) { \
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Hash, einame)); \
+	} else { \
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(MAC, einame)); \
+	} } while (0)
+
 /* {{{ crypto_hash free object handler */
 PHPC_OBJ_HANDLER_FREE(crypto_hash)
 {
@@ -364,6 +367,22 @@ PHP_MINIT_FUNCTION(crypto_hash)
 }
 /* }}} */
 
+/* {{{ PHP_RSHUTDOWN_FUNCTION */
+PHP_RSHUTDOWN_FUNCTION(crypto_hash)
+{
+	if (PHP_CRYPTO_G(md_ctx)) {
+		EVP_MD_CTX_destroy(PHP_CRYPTO_G(md_ctx));
+		PHP_CRYPTO_G(md_ctx) = NULL;
+	}
+	if (PHP_CRYPTO_G(hmac_ctx)) {
+		HMAC_CTX_free(PHP_CRYPTO_G(hmac_ctx));
+		PHP_CRYPTO_G(hmac_ctx) = NULL;
+	}
+
+	return SUCCESS;
+}
+/* }}} */
+
 /* METHODS */
 
 /* {{{ php_crypto_hash_set_algorithm_name */
@@ -400,7 +419,7 @@ static inline int php_crypto_hash_init(PHPC_THIS_DECLARE(crypto_hash) TSRMLS_DC)
 	} else {
 		 /* It is a MAC instance and the key is required */
 		if (!PHPC_THIS->key) {
-			php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Hash, INIT_FAILED));
+			php_crypto_error(PHP_CRYPTO_ERROR_ARGS(MAC, INIT_FAILED));
 			return FAILURE;
 		}
 
@@ -427,7 +446,7 @@ static inline int php_crypto_hash_init(PHPC_THIS_DECLARE(crypto_hash) TSRMLS_DC)
 
 	/* initialize hash */
 	if (!rc) {
-		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Hash, INIT_FAILED));
+		PHP_CRYPTO_HASH_ERROR(PHPC_THIS, INIT_FAILED);
 		return FAILURE;
 	}
 	PHPC_THIS->status = PHP_CRYPTO_HASH_STATUS_HASH;
@@ -467,7 +486,7 @@ static inline int php_crypto_hash_update(PHPC_THIS_DECLARE(crypto_hash),
 	}
 
 	if (!rc) {
-		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Hash, UPDATE_FAILED));
+		PHP_CRYPTO_HASH_ERROR(PHPC_THIS, UPDATE_FAILED);
 		return FAILURE;
 	}
 
@@ -518,7 +537,7 @@ static inline void php_crypto_hash_digest(INTERNAL_FUNCTION_PARAMETERS, int enco
 	}
 
 	if (!rc) {
-		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Hash, DIGEST_FAILED));
+		PHP_CRYPTO_HASH_ERROR(PHPC_THIS, DIGEST_FAILED);
 		RETURN_FALSE;
 	}
 	hash_value[hash_len] = 0;
@@ -813,3 +832,152 @@ php_crypto_mac_alg_not_found:
 	php_crypto_error_ex(PHP_CRYPTO_ERROR_ARGS(MAC, MAC_ALGORITHM_NOT_FOUND), algorithm);
 	efree(algorithm_uc);
 }
+/* }}} */
+
+/* FUNCTIONS */
+
+/* {{{ php_crypto_hash_fn_get_digest */
+static const EVP_MD *php_crypto_hash_fn_get_digest(
+		char *algorithm, phpc_str_size_t algorithm_len, int is_mac TSRMLS_DC)
+{
+	const EVP_MD *digest = php_crypto_alg_cache_find(
+			&PHP_CRYPTO_G(md_cache), algorithm, algorithm_len);
+
+	if (digest) {
+		return digest;
+	}
+
+	digest = EVP_get_digestbyname(algorithm);
+	if (!digest) {
+		if (is_mac) {
+			php_crypto_error_ex(PHP_CRYPTO_ERROR_ARGS(MAC, MAC_ALGORITHM_NOT_FOUND), algorithm);
+		} else {
+			php_crypto_error_ex(PHP_CRYPTO_ERROR_ARGS(Hash, HASH_ALGORITHM_NOT_FOUND), algorithm);
+		}
+		return NULL;
+	}
+
+	php_crypto_alg_cache_add(&PHP_CRYPTO_G(md_cache), algorithm, algorithm_len, digest);
+	return digest;
+}
+/* }}} */
+
+/* {{{ php_crypto_hash_fn_return */
+static inline void php_crypto_hash_fn_return(zval *return_value,
+		unsigned char *hash_value, unsigned int hash_len, zend_bool raw_output)
+{
+	if (raw_output) {
+		PHPC_CSTRL_RETURN((char *) hash_value, hash_len);
+	} else {
+		char hash_hex[EVP_MAX_MD_SIZE * 2 + 1];
+		php_crypto_hash_bin2hex(hash_hex, hash_value, hash_len);
+		PHPC_CSTRL_RETURN(hash_hex, hash_len * 2);
+	}
+}
+/* }}} */
+
+/* {{{ proto string Crypto\hash(string $algorithm, string $data, bool $raw_output = false)
+	Returns hash of the data without creating a Hash object */
+PHP_CRYPTO_FUNCTION(hash)
+{
+	char *algorithm, *data;
+	phpc_str_size_t algorithm_len, data_len;
+	zend_bool raw_output = 0;
+	unsigned char hash_value[EVP_MAX_MD_SIZE];
+	unsigned int hash_len;
+	const EVP_MD *digest;
+	EVP_MD_CTX *ctx;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "ss|b",
+			&algorithm, &algorithm_len, &data, &data_len, &raw_output) == FAILURE) {
+		return;
+	}
+
+	digest = php_crypto_hash_fn_get_digest(algorithm, algorithm_len, 0 TSRMLS_CC);
+	if (!digest) {
+		RETURN_FALSE;
+	}
+
+	/* the context is created once and reused until the end of the request */
+	ctx = PHP_CRYPTO_G(md_ctx);
+	if (!ctx) {
+		ctx = PHP_CRYPTO_G(md_ctx) = EVP_MD_CTX_create();
+	}
+
+	if (!ctx || !EVP_DigestInit_ex(ctx, digest, NULL)) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Hash, INIT_FAILED));
+		RETURN_FALSE;
+	}
+	if (!EVP_DigestUpdate(ctx, data, data_len)) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Hash, UPDATE_FAILED));
+		RETURN_FALSE;
+	}
+	if (!EVP_DigestFinal_ex(ctx, hash_value, &hash_len)) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Hash, DIGEST_FAILED));
+		RETURN_FALSE;
+	}
+
+	php_crypto_hash_fn_return(return_value, hash_value, hash_len, raw_output);
+}
+/* }}} */
+
+/* {{{ proto string Crypto\hmac(string $algorithm, string $data, string $key,
+			bool $raw_output = false)
+	Returns HMAC of the data without creating a HMAC object */
+PHP_CRYPTO_FUNCTION(hmac)
+{
+	char *algorithm, *data, *key;
+	phpc_str_size_t algorithm_len, data_len, key_len;
+	zend_bool raw_output = 0;
+	unsigned char hash_value[EVP_MAX_MD_SIZE];
+	unsigned int hash_len;
+	int key_len_int, rc;
+	const EVP_MD *digest;
+	HMAC_CTX *ctx;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "sss|b",
+			&algorithm, &algorithm_len, &data, &data_len,
+			&key, &key_len, &raw_output) == FAILURE) {
+		return;
+	}
+
+	digest = php_crypto_hash_fn_get_digest(algorithm, algorithm_len, 1 TSRMLS_CC);
+	if (!digest) {
+		RETURN_FALSE;
+	}
+
+	/* check key length overflow */
+	if (php_crypto_str_size_to_int(key_len, &key_len_int) == FAILURE) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(MAC, KEY_LENGTH_INVALID));
+		RETURN_FALSE;
+	}
+
+	/* the context is created once and reused until the end of the request */
+	ctx = PHP_CRYPTO_G(hmac_ctx);
+	if (!ctx) {
+		ctx = PHP_CRYPTO_G(hmac_ctx) = HMAC_CTX_new();
+		if (!ctx) {
+			php_crypto_error(PHP_CRYPTO_ERROR_ARGS(MAC, INIT_FAILED));
+			RETURN_FALSE;
+		}
+	}
+
+	PHP_CRYPTO_HMAC_DO(rc, HMAC_Init_ex)(ctx, key, key_len_int, digest, NULL);
+	if (!rc) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(MAC, INIT_FAILED));
+		RETURN_FALSE;
+	}
+	PHP_CRYPTO_HMAC_DO(rc, HMAC_Update)(ctx, (unsigned char *) data, data_len);
+	if (!rc) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(MAC, UPDATE_FAILED));
+		RETURN_FALSE;
+	}
+	PHP_CRYPTO_HMAC_DO(rc, HMAC_Final)(ctx, hash_value, &hash_len);
+	if (!rc) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(MAC, DIGEST_FAILED));
+		RETURN_FALSE;
+	}
+
+	php_crypto_hash_fn_return(return_value, hash_value, hash_len, raw_output);
+}
+/* }}} */
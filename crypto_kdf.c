@@ -20,6 +20,11 @@
 #include "php_crypto.h"
 #include "zend_exceptions.h"
 #include "php_crypto_kdf.h"
+#include "php_crypto_hash.h"
+#include "php_crypto_pbkdf2.h"
+#include "php_crypto_scrypt.h"
+#include "php_crypto_argon2.h"
+#include "php_crypto_thread.h"
 
 #include <openssl/evp.h>
 
@@ -57,6 +62,118 @@ PHP_CRYPTO_ERROR_INFO_ENTRY(
 	ITERATIONS_HIGH,
 	"Iterations count is too high"
 )
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	PASSWORDS_SALTS_MISMATCH,
+	"The passwords and salts have to be lists with the same keys"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	PASSWORD_TYPE_INVALID,
+	"The password has to be a string"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	SALT_TYPE_INVALID,
+	"The salt has to be a string"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	TARGET_TIME_INVALID,
+	"The target time has to be greater than 0"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	CALIBRATION_FAILED,
+	"PBKDF2 calibration failed"
+)
+PHP_CRYPTO_ERROR_INFO_END()
+
+PHP_CRYPTO_EXCEPTION_DEFINE(Scrypt)
+PHP_CRYPTO_ERROR_INFO_BEGIN(Scrypt)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	COST_INVALID,
+	"The cost parameter N must be a power of two greater than 1"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	COST_HIGH,
+	"The cost parameter N is too high for the block size"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	BLOCK_SIZE_INVALID,
+	"The block size parameter r is invalid"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	PARALLELISM_INVALID,
+	"The parallelization parameter p is invalid"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	PARAMETERS_HIGH,
+	"The product of the block size and parallelization is too high"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	MAX_MEMORY_INVALID,
+	"The max memory must be greater than 0"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	MEMORY_LIMIT_EXCEEDED,
+	"The derivation requires more memory than the max memory"
+)
+PHP_CRYPTO_ERROR_INFO_END()
+
+PHP_CRYPTO_EXCEPTION_DEFINE(HKDF)
+PHP_CRYPTO_ERROR_INFO_BEGIN(HKDF)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	HASH_ALGORITHM_NOT_FOUND,
+	"Hash algorithm '%s' not found"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	EXTRACT_REQUIRED,
+	"The pseudorandom key has to be extracted before expanding"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	EXTRACT_FAILED,
+	"HKDF extraction failed"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	EXPAND_FAILED,
+	"HKDF expansion failed"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	LENGTH_HIGH,
+	"The output length is too high for the hash algorithm"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	INFO_TYPE_INVALID,
+	"The info has to be a string"
+)
+PHP_CRYPTO_ERROR_INFO_END()
+
+PHP_CRYPTO_EXCEPTION_DEFINE(Argon2)
+PHP_CRYPTO_ERROR_INFO_BEGIN(Argon2)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	MEMORY_COST_INVALID,
+	"The memory cost must be at least 8 KiB and fit to 32 bits"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	MEMORY_COST_LOW,
+	"The memory cost must be at least 8 KiB per lane"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	MEMORY_COST_HIGH,
+	"The memory cost is higher than crypto.argon2_max_memory"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	TIME_COST_INVALID,
+	"The time cost must be greater than 0 and fit to 32 bits"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	LANES_INVALID,
+	"The number of lanes must be between 1 and 16777215"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	SALT_LENGTH_LOW,
+	"The salt must be at least 8 bytes long"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	KEY_LENGTH_LOW,
+	"The key length must be at least 4 bytes"
+)
 PHP_CRYPTO_ERROR_INFO_END()
 
 ZEND_BEGIN_ARG_INFO_EX(arginfo_crypto_kdf_new, 0, 0, 1)
@@ -118,6 +235,17 @@ ZEND_ARG_INFO(0, salt)
 ZEND_ARG_INFO(0, iterations)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO(arginfo_crypto_pbkdf2_derive_many, 0)
+ZEND_ARG_ARRAY_INFO(0, passwords, 0)
+ZEND_ARG_ARRAY_INFO(0, salts, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO(arginfo_crypto_pbkdf2_calibrate, 0)
+ZEND_ARG_INFO(0, targetMillis)
+ZEND_ARG_INFO(0, hashAlgorithm)
+ZEND_ARG_INFO(0, length)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_INFO(arginfo_crypto_pbkdf2_iterations, 0)
 ZEND_ARG_INFO(0, iterations)
 ZEND_END_ARG_INFO()
@@ -127,6 +255,11 @@ ZEND_ARG_INFO(0, hashAlgorithm)
 ZEND_END_ARG_INFO()
 
 static const zend_function_entry php_crypto_pbkdf2_object_methods[] = {
+	PHP_CRYPTO_ME(
+		PBKDF2, calibrate,
+		arginfo_crypto_pbkdf2_calibrate,
+		ZEND_ACC_STATIC|ZEND_ACC_PUBLIC
+	)
 	PHP_CRYPTO_ME(
 		PBKDF2, __construct,
 		arginfo_crypto_pbkdf2_new,
@@ -137,6 +270,11 @@ static const zend_function_entry php_crypto_pbkdf2_object_methods[] = {
 		arginfo_crypto_kdf_derive,
 		ZEND_ACC_PUBLIC
 	)
+	PHP_CRYPTO_ME(
+		PBKDF2, deriveMany,
+		arginfo_crypto_pbkdf2_derive_many,
+		ZEND_ACC_PUBLIC
+	)
 	PHP_CRYPTO_ME(
 		PBKDF2, getIterations,
 		NULL,
@@ -162,8 +300,220 @@ static const zend_function_entry php_crypto_pbkdf2_object_methods[] = {
 
 #endif
 
+#ifdef PHP_CRYPTO_HAS_SCRYPT
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_crypto_scrypt_new, 0, 0, 1)
+ZEND_ARG_INFO(0, length)
+ZEND_ARG_INFO(0, salt)
+ZEND_ARG_INFO(0, n)
+ZEND_ARG_INFO(0, r)
+ZEND_ARG_INFO(0, p)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO(arginfo_crypto_scrypt_n, 0)
+ZEND_ARG_INFO(0, n)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO(arginfo_crypto_scrypt_r, 0)
+ZEND_ARG_INFO(0, r)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO(arginfo_crypto_scrypt_p, 0)
+ZEND_ARG_INFO(0, p)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO(arginfo_crypto_scrypt_max_memory, 0)
+ZEND_ARG_INFO(0, maxMemory)
+ZEND_END_ARG_INFO()
+
+static const zend_function_entry php_crypto_scrypt_object_methods[] = {
+	PHP_CRYPTO_ME(
+		Scrypt, __construct,
+		arginfo_crypto_scrypt_new,
+		ZEND_ACC_CTOR|ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		Scrypt, derive,
+		arginfo_crypto_kdf_derive,
+		ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		Scrypt, getN,
+		NULL,
+		ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		Scrypt, setN,
+		arginfo_crypto_scrypt_n,
+		ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		Scrypt, getR,
+		NULL,
+		ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		Scrypt, setR,
+		arginfo_crypto_scrypt_r,
+		ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		Scrypt, getP,
+		NULL,
+		ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		Scrypt, setP,
+		arginfo_crypto_scrypt_p,
+		ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		Scrypt, getMaxMemory,
+		NULL,
+		ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		Scrypt, setMaxMemory,
+		arginfo_crypto_scrypt_max_memory,
+		ZEND_ACC_PUBLIC
+	)
+	PHPC_FE_END
+};
+
+#endif
+
+#ifdef PHP_CRYPTO_HAS_HKDF
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_crypto_hkdf_new, 0, 0, 2)
+ZEND_ARG_INFO(0, hashAlgorithm)
+ZEND_ARG_INFO(0, length)
+ZEND_ARG_INFO(0, salt)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO(arginfo_crypto_hkdf_extract, 0)
+ZEND_ARG_INFO(0, inputKey)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_crypto_hkdf_expand, 0, 0, 1)
+ZEND_ARG_INFO(0, info)
+ZEND_ARG_INFO(0, length)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_crypto_hkdf_expand_many, 0, 0, 1)
+ZEND_ARG_ARRAY_INFO(0, infos, 0)
+ZEND_ARG_INFO(0, length)
+ZEND_END_ARG_INFO()
+
+static const zend_function_entry php_crypto_hkdf_object_methods[] = {
+	PHP_CRYPTO_ME(
+		HKDF, __construct,
+		arginfo_crypto_hkdf_new,
+		ZEND_ACC_CTOR|ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		HKDF, derive,
+		arginfo_crypto_kdf_derive,
+		ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		HKDF, extract,
+		arginfo_crypto_hkdf_extract,
+		ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		HKDF, expand,
+		arginfo_crypto_hkdf_expand,
+		ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		HKDF, expandMany,
+		arginfo_crypto_hkdf_expand_many,
+		ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		HKDF, getHashAlgorithm,
+		NULL,
+		ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		HKDF, setHashAlgorithm,
+		arginfo_crypto_pbkdf2_hash_algorithm,
+		ZEND_ACC_PUBLIC
+	)
+	PHPC_FE_END
+};
+
+#endif
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_crypto_argon2_new, 0, 0, 1)
+ZEND_ARG_INFO(0, length)
+ZEND_ARG_INFO(0, salt)
+ZEND_ARG_INFO(0, memoryCost)
+ZEND_ARG_INFO(0, timeCost)
+ZEND_ARG_INFO(0, lanes)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO(arginfo_crypto_argon2_memory_cost, 0)
+ZEND_ARG_INFO(0, memoryCost)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO(arginfo_crypto_argon2_time_cost, 0)
+ZEND_ARG_INFO(0, timeCost)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO(arginfo_crypto_argon2_lanes, 0)
+ZEND_ARG_INFO(0, lanes)
+ZEND_END_ARG_INFO()
+
+static const zend_function_entry php_crypto_argon2_object_methods[] = {
+	PHP_CRYPTO_ME(
+		Argon2, __construct,
+		arginfo_crypto_argon2_new,
+		ZEND_ACC_CTOR|ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		Argon2, derive,
+		arginfo_crypto_kdf_derive,
+		ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		Argon2, getMemoryCost,
+		NULL,
+		ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		Argon2, setMemoryCost,
+		arginfo_crypto_argon2_memory_cost,
+		ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		Argon2, getTimeCost,
+		NULL,
+		ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		Argon2, setTimeCost,
+		arginfo_crypto_argon2_time_cost,
+		ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		Argon2, getLanes,
+		NULL,
+		ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		Argon2, setLanes,
+		arginfo_crypto_argon2_lanes,
+		ZEND_ACC_PUBLIC
+	)
+	PHPC_FE_END
+};
+
 PHP_CRYPTO_API zend_class_entry *php_crypto_kdf_ce;
 PHP_CRYPTO_API zend_class_entry *php_crypto_pbkdf2_ce;
+PHP_CRYPTO_API zend_class_entry *php_crypto_scrypt_ce;
+PHP_CRYPTO_API zend_class_entry *php_crypto_hkdf_ce;
+PHP_CRYPTO_API zend_class_entry *php_crypto_argon2_ce;
 
 /* object handler */
 PHPC_OBJ_DEFINE_HANDLER_VAR(crypto_kdf);
@@ -176,6 +526,11 @@ PHPC_OBJ_HANDLER_FREE(crypto_kdf)
 	if (PHPC_THIS->salt) {
 		efree(PHPC_THIS->salt);
 	}
+#ifdef PHP_CRYPTO_HAS_HKDF
+	if (PHPC_THIS->type == PHP_CRYPTO_KDF_TYPE_HKDF && PHP_CRYPTO_HKDF_CTX_PRK(PHPC_THIS)) {
+		HMAC_CTX_free(PHP_CRYPTO_HKDF_CTX_PRK(PHPC_THIS));
+	}
+#endif
 
 	PHPC_OBJ_HANDLER_FREE_DESTROY();
 }
@@ -191,6 +546,24 @@ PHPC_OBJ_HANDLER_CREATE_EX(crypto_kdf)
 		PHP_CRYPTO_PBKDF2_CTX_MD(PHPC_THIS) = NULL;
 		PHP_CRYPTO_PBKDF2_CTX_ITER(PHPC_THIS) = PHP_CRYPTO_PBKDF2_ITER_DEFAULT;
 	}
+	else if (PHPC_CLASS_TYPE == php_crypto_scrypt_ce) {
+		PHPC_THIS->type = PHP_CRYPTO_KDF_TYPE_SCRYPT;
+		PHP_CRYPTO_SCRYPT_CTX_N(PHPC_THIS) = PHP_CRYPTO_SCRYPT_N_DEFAULT;
+		PHP_CRYPTO_SCRYPT_CTX_R(PHPC_THIS) = PHP_CRYPTO_SCRYPT_R_DEFAULT;
+		PHP_CRYPTO_SCRYPT_CTX_P(PHPC_THIS) = PHP_CRYPTO_SCRYPT_P_DEFAULT;
+		PHP_CRYPTO_SCRYPT_CTX_MAXMEM(PHPC_THIS) = PHP_CRYPTO_SCRYPT_MAXMEM_DEFAULT;
+	}
+	else if (PHPC_CLASS_TYPE == php_crypto_hkdf_ce) {
+		PHPC_THIS->type = PHP_CRYPTO_KDF_TYPE_HKDF;
+		PHP_CRYPTO_HKDF_CTX_MD(PHPC_THIS) = NULL;
+		PHP_CRYPTO_HKDF_CTX_PRK(PHPC_THIS) = NULL;
+	}
+	else if (PHPC_CLASS_TYPE == php_crypto_argon2_ce) {
+		PHPC_THIS->type = PHP_CRYPTO_KDF_TYPE_ARGON2;
+		PHP_CRYPTO_ARGON2_CTX_M_COST(PHPC_THIS) = PHP_CRYPTO_ARGON2_M_COST_DEFAULT;
+		PHP_CRYPTO_ARGON2_CTX_T_COST(PHPC_THIS) = PHP_CRYPTO_ARGON2_T_COST_DEFAULT;
+		PHP_CRYPTO_ARGON2_CTX_LANES(PHPC_THIS) = PHP_CRYPTO_ARGON2_LANES_DEFAULT;
+	}
 	else {
 		PHPC_THIS->type = PHP_CRYPTO_KDF_TYPE_NONE;
 	}
@@ -227,7 +600,24 @@ PHPC_OBJ_HANDLER_CLONE(crypto_kdf)
 	if (PHPC_THAT->type == PHP_CRYPTO_KDF_TYPE_PBKDF2) {
 		PHP_CRYPTO_PBKDF2_CTX_MD(PHPC_THAT) = PHP_CRYPTO_PBKDF2_CTX_MD(PHPC_THIS);
 		PHP_CRYPTO_PBKDF2_CTX_ITER(PHPC_THAT) = PHP_CRYPTO_PBKDF2_CTX_ITER(PHPC_THIS);
+	} else if (PHPC_THAT->type == PHP_CRYPTO_KDF_TYPE_SCRYPT) {
+		PHPC_THAT->ctx.scrypt = PHPC_THIS->ctx.scrypt;
+	} else if (PHPC_THAT->type == PHP_CRYPTO_KDF_TYPE_ARGON2) {
+		PHPC_THAT->ctx.argon2 = PHPC_THIS->ctx.argon2;
 	}
+#ifdef PHP_CRYPTO_HAS_HKDF
+	else if (PHPC_THAT->type == PHP_CRYPTO_KDF_TYPE_HKDF) {
+		PHP_CRYPTO_HKDF_CTX_MD(PHPC_THAT) = PHP_CRYPTO_HKDF_CTX_MD(PHPC_THIS);
+		if (PHP_CRYPTO_HKDF_CTX_PRK(PHPC_THIS)) {
+			PHP_CRYPTO_HKDF_CTX_PRK(PHPC_THAT) = HMAC_CTX_new();
+			copy_success = PHP_CRYPTO_HKDF_CTX_PRK(PHPC_THAT) && HMAC_CTX_copy(
+					PHP_CRYPTO_HKDF_CTX_PRK(PHPC_THAT), PHP_CRYPTO_HKDF_CTX_PRK(PHPC_THIS));
+			if (!copy_success) {
+				php_error(E_ERROR, "Cloning of HKDF object failed");
+			}
+		}
+	}
+#endif
 
 	PHPC_OBJ_HANDLER_CLONE_RETURN();
 }
@@ -262,6 +652,34 @@ PHP_MINIT_FUNCTION(crypto_kdf)
 	PHP_CRYPTO_ERROR_INFO_REGISTER(PBKDF2);
 #endif
 
+#ifdef PHP_CRYPTO_HAS_SCRYPT
+	/* Scrypt class */
+	INIT_CLASS_ENTRY(ce, PHP_CRYPTO_CLASS_NAME(Scrypt), php_crypto_scrypt_object_methods);
+	php_crypto_scrypt_ce = PHPC_CLASS_REGISTER_EX(ce, php_crypto_kdf_ce, NULL);
+
+	/* Scrypt Exception registration */
+	PHP_CRYPTO_EXCEPTION_REGISTER_EX(ce, Scrypt, KDF);
+	PHP_CRYPTO_ERROR_INFO_REGISTER(Scrypt);
+#endif
+
+#ifdef PHP_CRYPTO_HAS_HKDF
+	/* HKDF class */
+	INIT_CLASS_ENTRY(ce, PHP_CRYPTO_CLASS_NAME(HKDF), php_crypto_hkdf_object_methods);
+	php_crypto_hkdf_ce = PHPC_CLASS_REGISTER_EX(ce, php_crypto_kdf_ce, NULL);
+
+	/* HKDF Exception registration */
+	PHP_CRYPTO_EXCEPTION_REGISTER_EX(ce, HKDF, KDF);
+	PHP_CRYPTO_ERROR_INFO_REGISTER(HKDF);
+#endif
+
+	/* Argon2 class */
+	INIT_CLASS_ENTRY(ce, PHP_CRYPTO_CLASS_NAME(Argon2), php_crypto_argon2_object_methods);
+	php_crypto_argon2_ce = PHPC_CLASS_REGISTER_EX(ce, php_crypto_kdf_ce, NULL);
+
+	/* Argon2 Exception registration */
+	PHP_CRYPTO_EXCEPTION_REGISTER_EX(ce, Argon2, KDF);
+	PHP_CRYPTO_ERROR_INFO_REGISTER(Argon2);
+
 	return SUCCESS;
 }
 /* }}} */
@@ -441,6 +859,49 @@ static int php_crypto_pbkdf2_set_iterations(PHPC_THIS_DECLARE(crypto_kdf),
 }
 /* }}} */
 
+/* {{{ proto static int Crypto\PBKDF2::calibrate(int $targetMillis, string $hashAlgorithm,
+			int $length = 0)
+	Returns iterations count that takes the target time on this machine */
+PHP_CRYPTO_METHOD(PBKDF2, calibrate)
+{
+	const EVP_MD *digest;
+	char *hash_alg;
+	phpc_str_size_t hash_alg_len;
+	phpc_long_t target, key_len = 0;
+	int target_int, key_len_int, iterations;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "ls|l",
+			&target, &hash_alg, &hash_alg_len, &key_len) == FAILURE) {
+		return;
+	}
+
+	if (target < 1 || php_crypto_long_to_int(target, &target_int) == FAILURE) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(PBKDF2, TARGET_TIME_INVALID));
+		RETURN_NULL();
+	}
+	digest = EVP_get_digestbyname(hash_alg);
+	if (!digest) {
+		php_crypto_error_ex(PHP_CRYPTO_ERROR_ARGS(PBKDF2, HASH_ALGORITHM_NOT_FOUND), hash_alg);
+		RETURN_NULL();
+	}
+	/* 0 means the digest size */
+	if (key_len < 0) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(KDF, KEY_LENGTH_LOW));
+		RETURN_NULL();
+	}
+	if (php_crypto_long_to_int(key_len, &key_len_int) == FAILURE) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(KDF, KEY_LENGTH_HIGH));
+		RETURN_NULL();
+	}
+	if (php_crypto_pbkdf2_calibrate(digest, target_int, key_len_int, &iterations TSRMLS_CC) == FAILURE) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(PBKDF2, CALIBRATION_FAILED));
+		RETURN_NULL();
+	}
+
+	RETURN_LONG(iterations);
+}
+/* }}} */
+
 /* {{{ proto Crypto\PBKDF2::__construct(string $hashAlgorithm, int $length,
 			string $salt = NULL, int $iterations = 1000)
 	KDF constructor */
@@ -488,9 +949,11 @@ PHP_CRYPTO_METHOD(PBKDF2, derive)
 	PHPC_THIS_FETCH(crypto_kdf);
 	PHPC_STR_ALLOC(key, PHPC_THIS->key_len);
 
-	if (!PKCS5_PBKDF2_HMAC(password, password_len_int, PHPC_THIS->salt, PHPC_THIS->salt_len,
-			PHP_CRYPTO_PBKDF2_CTX_ITER(PHPC_THIS), PHP_CRYPTO_PBKDF2_CTX_MD(PHPC_THIS),
-			PHPC_THIS->key_len, PHPC_STR_VAL(key))) {
+	if (php_crypto_pbkdf2(PHP_CRYPTO_PBKDF2_CTX_MD(PHPC_THIS), password, password_len_int,
+			(unsigned char *) PHPC_THIS->salt, PHPC_THIS->salt_len,
+			PHP_CRYPTO_PBKDF2_CTX_ITER(PHPC_THIS), (unsigned char *) PHPC_STR_VAL(key),
+			PHPC_THIS->key_len TSRMLS_CC) == FAILURE) {
+		PHPC_STR_RELEASE(key);
 		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(KDF, DERIVATION_FAILED));
 		RETURN_NULL();
 	}
@@ -500,16 +963,123 @@ PHP_CRYPTO_METHOD(PBKDF2, derive)
 }
 /* }}} */
 
-/* {{{ proto int Crypto\PBKDF2::getIterations()
-	Get iterations */
-PHP_CRYPTO_METHOD(PBKDF2, getIterations)
+/* {{{ php_crypto_pbkdf2_collect
+	Collects the values by their index so passwords and salts are paired by key */
+static int php_crypto_pbkdf2_collect(zval *arr, int count, const char **vals, int *lens,
+		int is_salt TSRMLS_DC)
 {
-	PHPC_THIS_DECLARE(crypto_kdf);
-
-	if (zend_parse_parameters_none()) {
-		return;
+	phpc_val *ppv_val;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		/* all keys from 0 to count - 1 have to exist */
+		if (!PHPC_HASH_INDEX_FIND_IN_COND(PHPC_ARRVAL_P(arr), i, ppv_val)) {
+			php_crypto_error(PHP_CRYPTO_ERROR_ARGS(PBKDF2, PASSWORDS_SALTS_MISMATCH));
+			return FAILURE;
+		}
+		if (PHPC_TYPE_P(ppv_val) != IS_STRING) {
+			if (is_salt) {
+				php_crypto_error(PHP_CRYPTO_ERROR_ARGS(PBKDF2, SALT_TYPE_INVALID));
+			} else {
+				php_crypto_error(PHP_CRYPTO_ERROR_ARGS(PBKDF2, PASSWORD_TYPE_INVALID));
+			}
+			return FAILURE;
+		}
+		if (php_crypto_str_size_to_int(PHPC_STRLEN_P(ppv_val), &lens[i]) == FAILURE) {
+			if (is_salt) {
+				php_crypto_error(PHP_CRYPTO_ERROR_ARGS(KDF, SALT_LENGTH_HIGH));
+			} else {
+				php_crypto_error(PHP_CRYPTO_ERROR_ARGS(KDF, PASSWORD_LENGTH_INVALID));
+			}
+			return FAILURE;
+		}
+		vals[i] = PHPC_STRVAL_P(ppv_val);
 	}
-	PHPC_THIS_FETCH(crypto_kdf);
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ proto array Crypto\PBKDF2::deriveMany(array $passwords, array $salts)
+	Derive keys for all password and salt pairs */
+PHP_CRYPTO_METHOD(PBKDF2, deriveMany)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+	zval *passwords, *salts;
+	const char **pass;
+	const unsigned char **salt;
+	unsigned char **keys, *buf;
+	int *pass_len, *salt_len;
+	int i, count, rc;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "aa",
+			&passwords, &salts) == FAILURE) {
+		return;
+	}
+
+	count = zend_hash_num_elements(PHPC_ARRVAL_P(passwords));
+	if (count != zend_hash_num_elements(PHPC_ARRVAL_P(salts))) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(PBKDF2, PASSWORDS_SALTS_MISMATCH));
+		RETURN_NULL();
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	array_init(return_value);
+	if (count == 0) {
+		return;
+	}
+
+	pass = safe_emalloc(count, sizeof(char *), 0);
+	pass_len = safe_emalloc(count, sizeof(int), 0);
+	salt = safe_emalloc(count, sizeof(unsigned char *), 0);
+	salt_len = safe_emalloc(count, sizeof(int), 0);
+	keys = safe_emalloc(count, sizeof(unsigned char *), 0);
+	buf = safe_emalloc(count, PHPC_THIS->key_len, 0);
+
+	rc = php_crypto_pbkdf2_collect(passwords, count, pass, pass_len, 0 TSRMLS_CC);
+	if (rc == SUCCESS) {
+		rc = php_crypto_pbkdf2_collect(salts, count, (const char **) salt, salt_len, 1 TSRMLS_CC);
+	}
+	if (rc == SUCCESS) {
+		for (i = 0; i < count; i++) {
+			keys[i] = buf + i * PHPC_THIS->key_len;
+		}
+		rc = php_crypto_pbkdf2_many(PHP_CRYPTO_PBKDF2_CTX_MD(PHPC_THIS), count,
+				pass, pass_len, salt, salt_len, PHP_CRYPTO_PBKDF2_CTX_ITER(PHPC_THIS),
+				keys, PHPC_THIS->key_len TSRMLS_CC);
+		if (rc == FAILURE) {
+			php_crypto_error(PHP_CRYPTO_ERROR_ARGS(KDF, DERIVATION_FAILED));
+		}
+	}
+	if (rc == SUCCESS) {
+		for (i = 0; i < count; i++) {
+			PHPC_ARRAY_ADD_NEXT_INDEX_CSTRL(return_value, (char *) keys[i], PHPC_THIS->key_len);
+		}
+	} else {
+		zval_dtor(return_value);
+		RETVAL_NULL();
+	}
+
+	OPENSSL_cleanse(buf, count * PHPC_THIS->key_len);
+	efree(buf);
+	efree(keys);
+	efree(salt_len);
+	efree(salt);
+	efree(pass_len);
+	efree(pass);
+}
+/* }}} */
+
+/* {{{ proto int Crypto\PBKDF2::getIterations()
+	Get iterations */
+PHP_CRYPTO_METHOD(PBKDF2, getIterations)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+
+	if (zend_parse_parameters_none()) {
+		return;
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
 
 	RETURN_LONG(PHP_CRYPTO_PBKDF2_CTX_ITER(PHPC_THIS));
 }
@@ -571,3 +1141,855 @@ PHP_CRYPTO_METHOD(PBKDF2, setHashAlgorithm)
 }
 /* }}} */
 #endif
+
+#ifdef PHP_CRYPTO_HAS_SCRYPT
+/* Scrypt methods */
+
+/* {{{ php_crypto_scrypt_set_n */
+static int php_crypto_scrypt_set_n(PHPC_THIS_DECLARE(crypto_kdf),
+		phpc_long_t n TSRMLS_DC)
+{
+	if (n < 2 || (n & (n - 1)) != 0) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Scrypt, COST_INVALID));
+		return FAILURE;
+	}
+	PHP_CRYPTO_SCRYPT_CTX_N(PHPC_THIS) = (uint64_t) n;
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_scrypt_set_r */
+static int php_crypto_scrypt_set_r(PHPC_THIS_DECLARE(crypto_kdf),
+		phpc_long_t r TSRMLS_DC)
+{
+	int r_int;
+
+	if (r < 1 || php_crypto_long_to_int(r, &r_int) == FAILURE) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Scrypt, BLOCK_SIZE_INVALID));
+		return FAILURE;
+	}
+	PHP_CRYPTO_SCRYPT_CTX_R(PHPC_THIS) = (uint32_t) r_int;
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_scrypt_set_p */
+static int php_crypto_scrypt_set_p(PHPC_THIS_DECLARE(crypto_kdf),
+		phpc_long_t p TSRMLS_DC)
+{
+	int p_int;
+
+	if (p < 1 || php_crypto_long_to_int(p, &p_int) == FAILURE) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Scrypt, PARALLELISM_INVALID));
+		return FAILURE;
+	}
+	PHP_CRYPTO_SCRYPT_CTX_P(PHPC_THIS) = (uint32_t) p_int;
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_scrypt_get_lanes */
+static int php_crypto_scrypt_get_lanes(PHPC_THIS_DECLARE(crypto_kdf) TSRMLS_DC)
+{
+	uint64_t n = PHP_CRYPTO_SCRYPT_CTX_N(PHPC_THIS);
+	uint32_t r = PHP_CRYPTO_SCRYPT_CTX_R(PHPC_THIS);
+	uint32_t p = PHP_CRYPTO_SCRYPT_CTX_P(PHPC_THIS);
+	uint64_t maxmem = PHP_CRYPTO_SCRYPT_CTX_MAXMEM(PHPC_THIS);
+	uint64_t b_mem, lane_mem, fit;
+	int lanes;
+
+	/* RFC 7914 requires N < 2^(128 * r / 8) */
+	if (r < 4 && n >= ((uint64_t) 1 << (16 * r))) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Scrypt, COST_HIGH));
+		return 0;
+	}
+	/* B must fit to int for PBKDF2 */
+	b_mem = PHP_CRYPTO_SCRYPT_BLOCK_MEMORY(r, p);
+	if (b_mem > INT_MAX) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Scrypt, PARAMETERS_HIGH));
+		return 0;
+	}
+	/* V is N * 128 * r bytes so N must not overflow the lane memory */
+	if (n > (UINT64_MAX / 128 / r) - 2) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Scrypt, MEMORY_LIMIT_EXCEEDED));
+		return 0;
+	}
+	lane_mem = PHP_CRYPTO_SCRYPT_LANE_MEMORY(n, r);
+	if (b_mem > maxmem || lane_mem > maxmem - b_mem || lane_mem > SIZE_MAX) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Scrypt, MEMORY_LIMIT_EXCEEDED));
+		return 0;
+	}
+
+	/* run as many lanes concurrently as threads and the memory ceiling allow */
+	lanes = php_crypto_thread_workers((int) p TSRMLS_CC);
+	fit = (maxmem - b_mem) / lane_mem;
+	if ((uint64_t) lanes > fit) {
+		lanes = (int) fit;
+	}
+
+	return lanes;
+}
+/* }}} */
+
+/* {{{ proto Crypto\Scrypt::__construct(int $length, string $salt = NULL,
+			int $n = 16384, int $r = 8, int $p = 1)
+	Scrypt constructor */
+PHP_CRYPTO_METHOD(Scrypt, __construct)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+	char *salt = NULL;
+	phpc_str_size_t salt_len;
+	phpc_long_t key_len, n = PHP_CRYPTO_SCRYPT_N_DEFAULT;
+	phpc_long_t r = PHP_CRYPTO_SCRYPT_R_DEFAULT, p = PHP_CRYPTO_SCRYPT_P_DEFAULT;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "l|slll",
+			&key_len, &salt, &salt_len, &n, &r, &p) == FAILURE) {
+		return;
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	php_crypto_kdf_set_key_len(PHPC_THIS, key_len TSRMLS_CC);
+	if (salt != NULL) {
+		php_crypto_kdf_set_salt(PHPC_THIS, salt, salt_len TSRMLS_CC);
+	}
+	php_crypto_scrypt_set_n(PHPC_THIS, n TSRMLS_CC);
+	php_crypto_scrypt_set_r(PHPC_THIS, r TSRMLS_CC);
+	php_crypto_scrypt_set_p(PHPC_THIS, p TSRMLS_CC);
+}
+/* }}} */
+
+/* {{{ proto string Crypto\Scrypt::derive(string $password)
+	Derive key from password */
+PHP_CRYPTO_METHOD(Scrypt, derive)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+	PHPC_STR_DECLARE(key);
+	char *password;
+	phpc_str_size_t password_len;
+	int password_len_int, lanes, rc;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "s",
+			&password, &password_len) == FAILURE) {
+		return;
+	}
+
+	if (php_crypto_str_size_to_int(password_len, &password_len_int) == FAILURE) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(KDF, PASSWORD_LENGTH_INVALID));
+		RETURN_NULL();
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	lanes = php_crypto_scrypt_get_lanes(PHPC_THIS TSRMLS_CC);
+	if (lanes < 1) {
+		RETURN_NULL();
+	}
+
+	PHPC_STR_ALLOC(key, PHPC_THIS->key_len);
+#ifdef PHP_CRYPTO_HAS_EVP_SCRYPT
+	if (lanes == 1) {
+		rc = EVP_PBE_scrypt(password, password_len_int,
+				(unsigned char *) PHPC_THIS->salt, PHPC_THIS->salt_len,
+				PHP_CRYPTO_SCRYPT_CTX_N(PHPC_THIS), PHP_CRYPTO_SCRYPT_CTX_R(PHPC_THIS),
+				PHP_CRYPTO_SCRYPT_CTX_P(PHPC_THIS), PHP_CRYPTO_SCRYPT_CTX_MAXMEM(PHPC_THIS),
+				(unsigned char *) PHPC_STR_VAL(key), PHPC_THIS->key_len) ? SUCCESS : FAILURE;
+	} else
+#endif
+	rc = php_crypto_scrypt(password, password_len_int,
+			(unsigned char *) PHPC_THIS->salt, PHPC_THIS->salt_len,
+			PHP_CRYPTO_SCRYPT_CTX_N(PHPC_THIS), PHP_CRYPTO_SCRYPT_CTX_R(PHPC_THIS),
+			PHP_CRYPTO_SCRYPT_CTX_P(PHPC_THIS), lanes,
+			(unsigned char *) PHPC_STR_VAL(key), PHPC_THIS->key_len);
+
+	if (rc == FAILURE) {
+		PHPC_STR_RELEASE(key);
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(KDF, DERIVATION_FAILED));
+		RETURN_NULL();
+	}
+	PHPC_STR_VAL(key)[PHPC_THIS->key_len] = '\0';
+
+	PHPC_STR_RETURN(key);
+}
+/* }}} */
+
+/* {{{ proto int Crypto\Scrypt::getN()
+	Get CPU/memory cost parameter */
+PHP_CRYPTO_METHOD(Scrypt, getN)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+
+	if (zend_parse_parameters_none()) {
+		return;
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	RETURN_LONG((phpc_long_t) PHP_CRYPTO_SCRYPT_CTX_N(PHPC_THIS));
+}
+/* }}} */
+
+/* {{{ proto bool Crypto\Scrypt::setN(int $n)
+	Set CPU/memory cost parameter */
+PHP_CRYPTO_METHOD(Scrypt, setN)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+	phpc_long_t n;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "l", &n) == FAILURE) {
+		return;
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	RETURN_BOOL(php_crypto_scrypt_set_n(PHPC_THIS, n TSRMLS_CC) == SUCCESS);
+}
+/* }}} */
+
+/* {{{ proto int Crypto\Scrypt::getR()
+	Get block size parameter */
+PHP_CRYPTO_METHOD(Scrypt, getR)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+
+	if (zend_parse_parameters_none()) {
+		return;
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	RETURN_LONG(PHP_CRYPTO_SCRYPT_CTX_R(PHPC_THIS));
+}
+/* }}} */
+
+/* {{{ proto bool Crypto\Scrypt::setR(int $r)
+	Set block size parameter */
+PHP_CRYPTO_METHOD(Scrypt, setR)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+	phpc_long_t r;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "l", &r) == FAILURE) {
+		return;
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	RETURN_BOOL(php_crypto_scrypt_set_r(PHPC_THIS, r TSRMLS_CC) == SUCCESS);
+}
+/* }}} */
+
+/* {{{ proto int Crypto\Scrypt::getP()
+	Get parallelization parameter */
+PHP_CRYPTO_METHOD(Scrypt, getP)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+
+	if (zend_parse_parameters_none()) {
+		return;
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	RETURN_LONG(PHP_CRYPTO_SCRYPT_CTX_P(PHPC_THIS));
+}
+/* }}} */
+
+/* {{{ proto bool Crypto\Scrypt::setP(int $p)
+	Set parallelization parameter */
+PHP_CRYPTO_METHOD(Scrypt, setP)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+	phpc_long_t p;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "l", &p) == FAILURE) {
+		return;
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	RETURN_BOOL(php_crypto_scrypt_set_p(PHPC_THIS, p TSRMLS_CC) == SUCCESS);
+}
+/* }}} */
+
+/* {{{ proto int Crypto\Scrypt::getMaxMemory()
+	Get max memory in bytes that can be used by a derivation */
+PHP_CRYPTO_METHOD(Scrypt, getMaxMemory)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+
+	if (zend_parse_parameters_none()) {
+		return;
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	RETURN_LONG((phpc_long_t) PHP_CRYPTO_SCRYPT_CTX_MAXMEM(PHPC_THIS));
+}
+/* }}} */
+
+/* {{{ proto bool Crypto\Scrypt::setMaxMemory(int $maxMemory)
+	Set max memory in bytes that can be used by a derivation */
+PHP_CRYPTO_METHOD(Scrypt, setMaxMemory)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+	phpc_long_t maxmem;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "l", &maxmem) == FAILURE) {
+		return;
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	if (maxmem <= 0) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Scrypt, MAX_MEMORY_INVALID));
+		RETURN_FALSE;
+	}
+	PHP_CRYPTO_SCRYPT_CTX_MAXMEM(PHPC_THIS) = (uint64_t) maxmem;
+
+	RETURN_TRUE;
+}
+/* }}} */
+#endif
+
+#ifdef PHP_CRYPTO_HAS_HKDF
+/* HKDF methods */
+
+/* {{{ php_crypto_hkdf_reset */
+static void php_crypto_hkdf_reset(PHPC_THIS_DECLARE(crypto_kdf))
+{
+	if (PHP_CRYPTO_HKDF_CTX_PRK(PHPC_THIS)) {
+		HMAC_CTX_free(PHP_CRYPTO_HKDF_CTX_PRK(PHPC_THIS));
+		PHP_CRYPTO_HKDF_CTX_PRK(PHPC_THIS) = NULL;
+	}
+}
+/* }}} */
+
+/* {{{ php_crypto_hkdf_set_hash_algorithm */
+static int php_crypto_hkdf_set_hash_algorithm(PHPC_THIS_DECLARE(crypto_kdf),
+		char *hash_alg TSRMLS_DC)
+{
+	const EVP_MD *digest = EVP_get_digestbyname(hash_alg);
+
+	if (!digest) {
+		php_crypto_error_ex(PHP_CRYPTO_ERROR_ARGS(HKDF, HASH_ALGORITHM_NOT_FOUND), hash_alg);
+		return FAILURE;
+	}
+	PHP_CRYPTO_HKDF_CTX_MD(PHPC_THIS) = digest;
+	/* the PRK is bound to the previous algorithm */
+	php_crypto_hkdf_reset(PHPC_THIS);
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_hkdf_extract */
+static int php_crypto_hkdf_extract(PHPC_THIS_DECLARE(crypto_kdf),
+		const char *ikm, phpc_str_size_t ikm_len TSRMLS_DC)
+{
+	const EVP_MD *md = PHP_CRYPTO_HKDF_CTX_MD(PHPC_THIS);
+	HMAC_CTX *ctx = PHP_CRYPTO_HKDF_CTX_PRK(PHPC_THIS);
+	unsigned char prk[EVP_MAX_MD_SIZE];
+	unsigned int prk_len;
+	int rc;
+
+	if (!ctx) {
+		ctx = HMAC_CTX_new();
+		if (!ctx) {
+			php_crypto_error(PHP_CRYPTO_ERROR_ARGS(HKDF, EXTRACT_FAILED));
+			return FAILURE;
+		}
+		PHP_CRYPTO_HKDF_CTX_PRK(PHPC_THIS) = ctx;
+	}
+
+	/* PRK = HMAC(salt, IKM) where missing salt is the same as zero filled key */
+	rc = HMAC_Init_ex(ctx, PHPC_THIS->salt ? PHPC_THIS->salt : "",
+				PHPC_THIS->salt_len, md, NULL) &&
+			HMAC_Update(ctx, (const unsigned char *) ikm, ikm_len) &&
+			HMAC_Final(ctx, prk, &prk_len) &&
+			/* keep the context keyed with PRK so expand does not rehash the key */
+			HMAC_Init_ex(ctx, prk, prk_len, md, NULL);
+	OPENSSL_cleanse(prk, sizeof(prk));
+
+	if (!rc) {
+		php_crypto_hkdf_reset(PHPC_THIS);
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(HKDF, EXTRACT_FAILED));
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_hkdf_check_length */
+static int php_crypto_hkdf_check_length(PHPC_THIS_DECLARE(crypto_kdf),
+		phpc_long_t length TSRMLS_DC)
+{
+	if (!PHP_CRYPTO_HKDF_CTX_PRK(PHPC_THIS)) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(HKDF, EXTRACT_REQUIRED));
+		return FAILURE;
+	}
+	if (length <= 0) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(KDF, KEY_LENGTH_LOW));
+		return FAILURE;
+	}
+	if (length > PHP_CRYPTO_HKDF_BLOCKS_MAX * EVP_MD_size(PHP_CRYPTO_HKDF_CTX_MD(PHPC_THIS))) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(HKDF, LENGTH_HIGH));
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_hkdf_expand */
+static int php_crypto_hkdf_expand(PHPC_THIS_DECLARE(crypto_kdf),
+		const char *info, phpc_str_size_t info_len, char *out, phpc_long_t out_len TSRMLS_DC)
+{
+	HMAC_CTX *ctx = PHP_CRYPTO_HKDF_CTX_PRK(PHPC_THIS);
+	unsigned char t[EVP_MAX_MD_SIZE], counter;
+	unsigned int t_len = 0;
+	int done = 0, n, rc = SUCCESS;
+
+	/* T(i) = HMAC(PRK, T(i - 1) | info | i) - out_len is already checked */
+	for (counter = 1; done < out_len; counter++) {
+		/* re-initialization without key reuses the PRK keyed state */
+		if (!HMAC_Init_ex(ctx, NULL, 0, NULL, NULL) ||
+				!HMAC_Update(ctx, t, t_len) ||
+				!HMAC_Update(ctx, (const unsigned char *) info, info_len) ||
+				!HMAC_Update(ctx, &counter, 1) ||
+				!HMAC_Final(ctx, t, &t_len)) {
+			rc = FAILURE;
+			break;
+		}
+		n = (int) out_len - done < (int) t_len ? (int) out_len - done : (int) t_len;
+		memcpy(out + done, t, n);
+		done += n;
+	}
+	OPENSSL_cleanse(t, sizeof(t));
+
+	if (rc == FAILURE) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(HKDF, EXPAND_FAILED));
+	} else {
+		out[out_len] = '\0';
+	}
+
+	return rc;
+}
+/* }}} */
+
+/* {{{ proto Crypto\HKDF::__construct(string $hashAlgorithm, int $length,
+			string $salt = NULL)
+	HKDF constructor */
+PHP_CRYPTO_METHOD(HKDF, __construct)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+	char *hash_alg, *salt = NULL;
+	phpc_str_size_t hash_alg_len, salt_len;
+	phpc_long_t key_len;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "sl|s",
+			&hash_alg, &hash_alg_len, &key_len, &salt, &salt_len) == FAILURE) {
+		return;
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	php_crypto_hkdf_set_hash_algorithm(PHPC_THIS, hash_alg TSRMLS_CC);
+	php_crypto_kdf_set_key_len(PHPC_THIS, key_len TSRMLS_CC);
+	if (salt != NULL) {
+		php_crypto_kdf_set_salt(PHPC_THIS, salt, salt_len TSRMLS_CC);
+	}
+}
+/* }}} */
+
+/* {{{ proto string Crypto\HKDF::derive(string $password)
+	Derive key from input key using extract and expand with empty info */
+PHP_CRYPTO_METHOD(HKDF, derive)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+	PHPC_STR_DECLARE(key);
+	char *password;
+	phpc_str_size_t password_len;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "s",
+			&password, &password_len) == FAILURE) {
+		return;
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	if (php_crypto_hkdf_extract(PHPC_THIS, password, password_len TSRMLS_CC) == FAILURE ||
+			php_crypto_hkdf_check_length(PHPC_THIS, PHPC_THIS->key_len TSRMLS_CC) == FAILURE) {
+		RETURN_NULL();
+	}
+
+	PHPC_STR_ALLOC(key, PHPC_THIS->key_len);
+	if (php_crypto_hkdf_expand(PHPC_THIS, "", 0, PHPC_STR_VAL(key),
+			PHPC_THIS->key_len TSRMLS_CC) == FAILURE) {
+		PHPC_STR_RELEASE(key);
+		RETURN_NULL();
+	}
+
+	PHPC_STR_RETURN(key);
+}
+/* }}} */
+
+/* {{{ proto bool Crypto\HKDF::extract(string $inputKey)
+	Extract pseudorandom key from input key and keep it for expanding */
+PHP_CRYPTO_METHOD(HKDF, extract)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+	char *ikm;
+	phpc_str_size_t ikm_len;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "s",
+			&ikm, &ikm_len) == FAILURE) {
+		return;
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	RETURN_BOOL(php_crypto_hkdf_extract(PHPC_THIS, ikm, ikm_len TSRMLS_CC) == SUCCESS);
+}
+/* }}} */
+
+/* {{{ proto string Crypto\HKDF::expand(string $info, int $length = NULL)
+	Expand extracted pseudorandom key to output key for info */
+PHP_CRYPTO_METHOD(HKDF, expand)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+	PHPC_STR_DECLARE(key);
+	char *info;
+	phpc_str_size_t info_len;
+	phpc_long_t length = 0;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "s|l",
+			&info, &info_len, &length) == FAILURE) {
+		return;
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	if (ZEND_NUM_ARGS() < 2) {
+		length = PHPC_THIS->key_len;
+	}
+	if (php_crypto_hkdf_check_length(PHPC_THIS, length TSRMLS_CC) == FAILURE) {
+		RETURN_NULL();
+	}
+
+	PHPC_STR_ALLOC(key, length);
+	if (php_crypto_hkdf_expand(PHPC_THIS, info, info_len, PHPC_STR_VAL(key),
+			length TSRMLS_CC) == FAILURE) {
+		PHPC_STR_RELEASE(key);
+		RETURN_NULL();
+	}
+
+	PHPC_STR_RETURN(key);
+}
+/* }}} */
+
+/* {{{ proto array Crypto\HKDF::expandMany(array $infos, int $length = NULL)
+	Expand extracted pseudorandom key to output keys for all infos */
+PHP_CRYPTO_METHOD(HKDF, expandMany)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+	PHPC_STR_DECLARE(key);
+	zval *infos;
+	phpc_val *ppv_info;
+	phpc_long_t length = 0;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "a|l",
+			&infos, &length) == FAILURE) {
+		return;
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	if (ZEND_NUM_ARGS() < 2) {
+		length = PHPC_THIS->key_len;
+	}
+	if (php_crypto_hkdf_check_length(PHPC_THIS, length TSRMLS_CC) == FAILURE) {
+		RETURN_NULL();
+	}
+	PHPC_HASH_FOREACH_VAL(PHPC_ARRVAL_P(infos), ppv_info) {
+		if (PHPC_TYPE_P(ppv_info) != IS_STRING) {
+			php_crypto_error(PHP_CRYPTO_ERROR_ARGS(HKDF, INFO_TYPE_INVALID));
+			RETURN_NULL();
+		}
+	} PHPC_HASH_FOREACH_END();
+
+	array_init(return_value);
+	PHPC_HASH_FOREACH_VAL(PHPC_ARRVAL_P(infos), ppv_info) {
+		PHPC_STR_ALLOC(key, length);
+		if (php_crypto_hkdf_expand(PHPC_THIS, PHPC_STRVAL_P(ppv_info),
+				PHPC_STRLEN_P(ppv_info), PHPC_STR_VAL(key), length TSRMLS_CC) == FAILURE) {
+			PHPC_STR_RELEASE(key);
+			zval_dtor(return_value);
+			RETURN_NULL();
+		}
+		PHPC_ARRAY_ADD_NEXT_INDEX_STR(return_value, key);
+	} PHPC_HASH_FOREACH_END();
+}
+/* }}} */
+
+/* {{{ proto string Crypto\HKDF::getHashAlgorithm()
+	Get hash algorithm */
+PHP_CRYPTO_METHOD(HKDF, getHashAlgorithm)
+{
+	const EVP_MD *md;
+	PHPC_THIS_DECLARE(crypto_kdf);
+
+	if (zend_parse_parameters_none()) {
+		return;
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	md = PHP_CRYPTO_HKDF_CTX_MD(PHPC_THIS);
+	if (md == NULL) {
+		RETURN_NULL();
+	}
+
+	PHPC_CSTR_RETURN(EVP_MD_name(md));
+}
+/* }}} */
+
+/* {{{ proto bool Crypto\HKDF::setHashAlgorithm(string $hashAlgorithm)
+	Set hash algorithm (the extracted key is discarded) */
+PHP_CRYPTO_METHOD(HKDF, setHashAlgorithm)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+	char *hash_alg;
+	phpc_str_size_t hash_alg_len;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "s",
+			&hash_alg, &hash_alg_len) == FAILURE) {
+		return;
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	RETURN_BOOL(php_crypto_hkdf_set_hash_algorithm(PHPC_THIS, hash_alg TSRMLS_CC) == SUCCESS);
+}
+/* }}} */
+#endif
+
+/* Argon2 methods */
+
+/* {{{ php_crypto_argon2_set_memory_cost */
+static int php_crypto_argon2_set_memory_cost(PHPC_THIS_DECLARE(crypto_kdf),
+		phpc_long_t m_cost TSRMLS_DC)
+{
+	if (m_cost < PHP_CRYPTO_ARGON2_LANE_BLOCKS_MIN || (uint64_t) m_cost > UINT32_MAX) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Argon2, MEMORY_COST_INVALID));
+		return FAILURE;
+	}
+	PHP_CRYPTO_ARGON2_CTX_M_COST(PHPC_THIS) = (uint32_t) m_cost;
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_argon2_set_time_cost */
+static int php_crypto_argon2_set_time_cost(PHPC_THIS_DECLARE(crypto_kdf),
+		phpc_long_t t_cost TSRMLS_DC)
+{
+	if (t_cost < 1 || (uint64_t) t_cost > UINT32_MAX) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Argon2, TIME_COST_INVALID));
+		return FAILURE;
+	}
+	PHP_CRYPTO_ARGON2_CTX_T_COST(PHPC_THIS) = (uint32_t) t_cost;
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_argon2_set_lanes */
+static int php_crypto_argon2_set_lanes(PHPC_THIS_DECLARE(crypto_kdf),
+		phpc_long_t lanes TSRMLS_DC)
+{
+	if (lanes < 1 || lanes > PHP_CRYPTO_ARGON2_LANES_MAX) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Argon2, LANES_INVALID));
+		return FAILURE;
+	}
+	PHP_CRYPTO_ARGON2_CTX_LANES(PHPC_THIS) = (uint32_t) lanes;
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ proto Crypto\Argon2::__construct(int $length, string $salt = NULL,
+			int $memoryCost = 65536, int $timeCost = 3, int $lanes = 1)
+	Argon2 constructor */
+PHP_CRYPTO_METHOD(Argon2, __construct)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+	char *salt = NULL;
+	phpc_str_size_t salt_len;
+	phpc_long_t key_len, m_cost = PHP_CRYPTO_ARGON2_M_COST_DEFAULT;
+	phpc_long_t t_cost = PHP_CRYPTO_ARGON2_T_COST_DEFAULT, lanes = PHP_CRYPTO_ARGON2_LANES_DEFAULT;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "l|slll",
+			&key_len, &salt, &salt_len, &m_cost, &t_cost, &lanes) == FAILURE) {
+		return;
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	php_crypto_kdf_set_key_len(PHPC_THIS, key_len TSRMLS_CC);
+	if (salt != NULL) {
+		php_crypto_kdf_set_salt(PHPC_THIS, salt, salt_len TSRMLS_CC);
+	}
+	php_crypto_argon2_set_memory_cost(PHPC_THIS, m_cost TSRMLS_CC);
+	php_crypto_argon2_set_time_cost(PHPC_THIS, t_cost TSRMLS_CC);
+	php_crypto_argon2_set_lanes(PHPC_THIS, lanes TSRMLS_CC);
+}
+/* }}} */
+
+/* {{{ proto string Crypto\Argon2::derive(string $password)
+	Derive key from password */
+PHP_CRYPTO_METHOD(Argon2, derive)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+	PHPC_STR_DECLARE(key);
+	char *password;
+	phpc_str_size_t password_len;
+	int password_len_int, workers, rc;
+	uint32_t m_cost, lanes;
+	uint64_t memory_size;
+	void *memory;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "s",
+			&password, &password_len) == FAILURE) {
+		return;
+	}
+
+	if (php_crypto_str_size_to_int(password_len, &password_len_int) == FAILURE) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(KDF, PASSWORD_LENGTH_INVALID));
+		RETURN_NULL();
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	m_cost = PHP_CRYPTO_ARGON2_CTX_M_COST(PHPC_THIS);
+	lanes = PHP_CRYPTO_ARGON2_CTX_LANES(PHPC_THIS);
+	if (m_cost / lanes < PHP_CRYPTO_ARGON2_LANE_BLOCKS_MIN) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Argon2, MEMORY_COST_LOW));
+		RETURN_NULL();
+	}
+	memory_size = PHP_CRYPTO_ARGON2_MEMORY(m_cost, lanes);
+	/* the arena is not counted to memory_limit so it has its own limit */
+	if (memory_size > SIZE_MAX ||
+			memory_size > (uint64_t) PHP_CRYPTO_G(argon2_max_memory)) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Argon2, MEMORY_COST_HIGH));
+		RETURN_NULL();
+	}
+	if (PHPC_THIS->salt_len < PHP_CRYPTO_ARGON2_SALT_MIN) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Argon2, SALT_LENGTH_LOW));
+		RETURN_NULL();
+	}
+	if (PHPC_THIS->key_len < 4) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Argon2, KEY_LENGTH_LOW));
+		RETURN_NULL();
+	}
+
+	/* the arena keeps the blocks for the next derivations in this process */
+	memory = php_crypto_argon2_arena((size_t) memory_size TSRMLS_CC);
+	workers = php_crypto_thread_workers((int) lanes TSRMLS_CC);
+
+	PHPC_STR_ALLOC(key, PHPC_THIS->key_len);
+	rc = php_crypto_argon2id(password, password_len_int,
+			(unsigned char *) PHPC_THIS->salt, PHPC_THIS->salt_len, NULL, 0, NULL, 0,
+			PHP_CRYPTO_ARGON2_CTX_T_COST(PHPC_THIS), m_cost, lanes, workers, memory,
+			(unsigned char *) PHPC_STR_VAL(key), PHPC_THIS->key_len);
+	/* the blocks are derived from the password and the arena outlives the request */
+	OPENSSL_cleanse(memory, (size_t) memory_size);
+	if (rc == FAILURE) {
+		PHPC_STR_RELEASE(key);
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(KDF, DERIVATION_FAILED));
+		RETURN_NULL();
+	}
+	PHPC_STR_VAL(key)[PHPC_THIS->key_len] = '\0';
+
+	PHPC_STR_RETURN(key);
+}
+/* }}} */
+
+/* {{{ proto int Crypto\Argon2::getMemoryCost()
+	Get memory cost in KiB */
+PHP_CRYPTO_METHOD(Argon2, getMemoryCost)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+
+	if (zend_parse_parameters_none()) {
+		return;
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	RETURN_LONG((phpc_long_t) PHP_CRYPTO_ARGON2_CTX_M_COST(PHPC_THIS));
+}
+/* }}} */
+
+/* {{{ proto bool Crypto\Argon2::setMemoryCost(int $memoryCost)
+	Set memory cost in KiB */
+PHP_CRYPTO_METHOD(Argon2, setMemoryCost)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+	phpc_long_t value;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "l", &value) == FAILURE) {
+		return;
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	RETURN_BOOL(php_crypto_argon2_set_memory_cost(PHPC_THIS, value TSRMLS_CC) == SUCCESS);
+}
+/* }}} */
+
+/* {{{ proto int Crypto\Argon2::getTimeCost()
+	Get time cost (number of passes) */
+PHP_CRYPTO_METHOD(Argon2, getTimeCost)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+
+	if (zend_parse_parameters_none()) {
+		return;
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	RETURN_LONG((phpc_long_t) PHP_CRYPTO_ARGON2_CTX_T_COST(PHPC_THIS));
+}
+/* }}} */
+
+/* {{{ proto bool Crypto\Argon2::setTimeCost(int $timeCost)
+	Set time cost (number of passes) */
+PHP_CRYPTO_METHOD(Argon2, setTimeCost)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+	phpc_long_t value;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "l", &value) == FAILURE) {
+		return;
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	RETURN_BOOL(php_crypto_argon2_set_time_cost(PHPC_THIS, value TSRMLS_CC) == SUCCESS);
+}
+/* }}} */
+
+/* {{{ proto int Crypto\Argon2::getLanes()
+	Get number of lanes */
+PHP_CRYPTO_METHOD(Argon2, getLanes)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+
+	if (zend_parse_parameters_none()) {
+		return;
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	RETURN_LONG((phpc_long_t) PHP_CRYPTO_ARGON2_CTX_LANES(PHPC_THIS));
+}
+/* }}} */
+
+/* {{{ proto bool Crypto\Argon2::setLanes(int $lanes)
+	Set number of lanes */
+PHP_CRYPTO_METHOD(Argon2, setLanes)
+{
+	PHPC_THIS_DECLARE(crypto_kdf);
+	phpc_long_t value;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "l", &value) == FAILURE) {
+		return;
+	}
+	PHPC_THIS_FETCH(crypto_kdf);
+
+	RETURN_BOOL(php_crypto_argon2_set_lanes(PHPC_THIS, value TSRMLS_CC) == SUCCESS);
+}
+/* }}} */
+
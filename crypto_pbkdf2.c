@@ -0,0 +1,761 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 2013-2016 Jakub Zelenka                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: Jakub Zelenka <bukka@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "php.h"
+#include "php_crypto.h"
+#include "php_crypto_pbkdf2.h"
+#include "php_crypto_thread.h"
+
+#include <openssl/evp.h>
+#ifdef PHP_WIN32
+#include "win32/time.h"
+#else
+#include <sys/time.h>
+#endif
+
+#ifdef PHP_CRYPTO_HAS_PBKDF2_ENGINE
+#include <openssl/sha.h>
+
+/* Multi-buffer SHA-256 (runtime detected AVX2 and AVX-512 lanes) */
+#if (defined(__x86_64__) || defined(__i386__)) && (__GNUC__ >= 5 || defined(__clang__))
+#define PHP_CRYPTO_HAS_PBKDF2_SIMD 1
+#include <immintrin.h>
+#include <cpuid.h>
+#define PHP_CRYPTO_PBKDF2_TARGET(_target) __attribute__((target(_target)))
+/* Max number of SIMD lanes */
+#define PHP_CRYPTO_PBKDF2_LANES_MAX 16
+#endif
+#endif
+
+/* Iterates U_j for all lanes of SHA-256 in word major arrays (8 * lanes) */
+typedef void (*php_crypto_pbkdf2_iterate_func)(const uint32_t *ipad, const uint32_t *opad,
+		uint32_t *u, uint32_t *t, int iter);
+
+/* Derivation data shared by all work items */
+typedef struct {
+	const EVP_MD *md;
+#ifdef PHP_CRYPTO_HAS_PBKDF2_ENGINE
+	const struct _php_crypto_pbkdf2_engine *engine;
+#endif
+	int count;
+	const char **pass;
+	const int *pass_len;
+	const unsigned char **salt;
+	const int *salt_len;
+	int iter;
+	unsigned char **keys;
+	int key_len;
+	/* output blocks per key and all blocks */
+	int blocks;
+	int units;
+	/* SIMD lanes (0 if not used) */
+	int lanes;
+	php_crypto_pbkdf2_iterate_func iterate;
+	/* failure flags are per worker so the workers never write the same flag */
+	int failed[PHP_CRYPTO_THREADS_MAX];
+} php_crypto_pbkdf2_data;
+
+#ifdef PHP_CRYPTO_HAS_PBKDF2_ENGINE
+
+/* Max block size of the supported digests */
+#define PHP_CRYPTO_PBKDF2_BLOCK_MAX 128
+
+typedef union {
+	SHA_CTX sha1;
+	SHA256_CTX sha256;
+	SHA512_CTX sha512;
+} php_crypto_pbkdf2_sha_ctx;
+
+/* Digest functions used by the engine */
+typedef struct _php_crypto_pbkdf2_engine {
+	int nid;
+	int md_size;
+	int block_size;
+	int (*init)(php_crypto_pbkdf2_sha_ctx *ctx);
+	int (*update)(php_crypto_pbkdf2_sha_ctx *ctx, const void *data, size_t len);
+	int (*final)(unsigned char *md, php_crypto_pbkdf2_sha_ctx *ctx);
+	/* compress one block */
+	void (*transform)(php_crypto_pbkdf2_sha_ctx *ctx, const unsigned char *block);
+	/* store chaining state as big endian digest */
+	void (*store)(php_crypto_pbkdf2_sha_ctx *ctx, unsigned char *md);
+} php_crypto_pbkdf2_engine;
+
+#define PHP_CRYPTO_PBKDF2_STORE32(p, v) \
+	(p)[0] = (unsigned char) ((v) >> 24); \
+	(p)[1] = (unsigned char) ((v) >> 16); \
+	(p)[2] = (unsigned char) ((v) >> 8); \
+	(p)[3] = (unsigned char) (v)
+
+#define PHP_CRYPTO_PBKDF2_STORE64(p, v) \
+	PHP_CRYPTO_PBKDF2_STORE32(p, (v) >> 32); \
+	PHP_CRYPTO_PBKDF2_STORE32((p) + 4, (v) & 0xffffffffU)
+
+/* Generates engine wrappers for SHA functions */
+#define PHP_CRYPTO_PBKDF2_ENGINE_FUNCS(name, alg, member) \
+	static int php_crypto_pbkdf2_##name##_init(php_crypto_pbkdf2_sha_ctx *ctx) \
+	{ \
+		return alg##_Init(&ctx->member); \
+	} \
+	static int php_crypto_pbkdf2_##name##_update(php_crypto_pbkdf2_sha_ctx *ctx, \
+			const void *data, size_t len) \
+	{ \
+		return alg##_Update(&ctx->member, data, len); \
+	}  \
+	static int php_crypto_pbkdf2_##name##_final(unsigned char *md, \
+			php_crypto_pbkdf2_sha_ctx *ctx) \
+	{ \
+		return alg##_Final(md, &ctx->member); \
+	}
+
+PHP_CRYPTO_PBKDF2_ENGINE_FUNCS(sha1, SHA1, sha1)
+PHP_CRYPTO_PBKDF2_ENGINE_FUNCS(sha224, SHA224, sha256)
+PHP_CRYPTO_PBKDF2_ENGINE_FUNCS(sha256, SHA256, sha256)
+PHP_CRYPTO_PBKDF2_ENGINE_FUNCS(sha384, SHA384, sha512)
+PHP_CRYPTO_PBKDF2_ENGINE_FUNCS(sha512, SHA512, sha512)
+
+/* {{{ php_crypto_pbkdf2_sha1_transform */
+static void php_crypto_pbkdf2_sha1_transform(php_crypto_pbkdf2_sha_ctx *ctx,
+		const unsigned char *block)
+{
+	SHA1_Transform(&ctx->sha1, block);
+}
+/* }}} */
+
+/* {{{ php_crypto_pbkdf2_sha256_transform */
+static void php_crypto_pbkdf2_sha256_transform(php_crypto_pbkdf2_sha_ctx *ctx,
+		const unsigned char *block)
+{
+	SHA256_Transform(&ctx->sha256, block);
+}
+/* }}} */
+
+/* {{{ php_crypto_pbkdf2_sha512_transform */
+static void php_crypto_pbkdf2_sha512_transform(php_crypto_pbkdf2_sha_ctx *ctx,
+		const unsigned char *block)
+{
+	SHA512_Transform(&ctx->sha512, block);
+}
+/* }}} */
+
+/* {{{ php_crypto_pbkdf2_sha1_store */
+static void php_crypto_pbkdf2_sha1_store(php_crypto_pbkdf2_sha_ctx *ctx,
+		unsigned char *md)
+{
+	PHP_CRYPTO_PBKDF2_STORE32(md, ctx->sha1.h0);
+	PHP_CRYPTO_PBKDF2_STORE32(md + 4, ctx->sha1.h1);
+	PHP_CRYPTO_PBKDF2_STORE32(md + 8, ctx->sha1.h2);
+	PHP_CRYPTO_PBKDF2_STORE32(md + 12, ctx->sha1.h3);
+	PHP_CRYPTO_PBKDF2_STORE32(md + 16, ctx->sha1.h4);
+}
+/* }}} */
+
+/* {{{ php_crypto_pbkdf2_sha224_store */
+static void php_crypto_pbkdf2_sha224_store(php_crypto_pbkdf2_sha_ctx *ctx,
+		unsigned char *md)
+{
+	int i;
+
+	for (i = 0; i < 7; i++) {
+		PHP_CRYPTO_PBKDF2_STORE32(md + i * 4, ctx->sha256.h[i]);
+	}
+}
+/* }}} */
+
+/* {{{ php_crypto_pbkdf2_sha256_store */
+static void php_crypto_pbkdf2_sha256_store(php_crypto_pbkdf2_sha_ctx *ctx,
+		unsigned char *md)
+{
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		PHP_CRYPTO_PBKDF2_STORE32(md + i * 4, ctx->sha256.h[i]);
+	}
+}
+/* }}} */
+
+/* {{{ php_crypto_pbkdf2_sha384_store */
+static void php_crypto_pbkdf2_sha384_store(php_crypto_pbkdf2_sha_ctx *ctx,
+		unsigned char *md)
+{
+	int i;
+
+	for (i = 0; i < 6; i++) {
+		PHP_CRYPTO_PBKDF2_STORE64(md + i * 8, ctx->sha512.h[i]);
+	}
+}
+/* }}} */
+
+/* {{{ php_crypto_pbkdf2_sha512_store */
+static void php_crypto_pbkdf2_sha512_store(php_crypto_pbkdf2_sha_ctx *ctx,
+		unsigned char *md)
+{
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		PHP_CRYPTO_PBKDF2_STORE64(md + i * 8, ctx->sha512.h[i]);
+	}
+}
+/* }}} */
+
+#define PHP_CRYPTO_PBKDF2_ENGINE(name, nid, md_size, block_size, transform) \
+	{ \
+		nid, md_size, block_size, \
+		php_crypto_pbkdf2_##name##_init, \
+		php_crypto_pbkdf2_##name##_update, \
+		php_crypto_pbkdf2_##name##_final, \
+		php_crypto_pbkdf2_##transform##_transform, \
+		php_crypto_pbkdf2_##name##_store \
+	}
+
+static const php_crypto_pbkdf2_engine php_crypto_pbkdf2_engines[] = {
+	PHP_CRYPTO_PBKDF2_ENGINE(sha1, NID_sha1, 20, 64, sha1),
+	PHP_CRYPTO_PBKDF2_ENGINE(sha224, NID_sha224, 28, 64, sha256),
+	PHP_CRYPTO_PBKDF2_ENGINE(sha256, NID_sha256, 32, 64, sha256),
+	PHP_CRYPTO_PBKDF2_ENGINE(sha384, NID_sha384, 48, 128, sha512),
+	PHP_CRYPTO_PBKDF2_ENGINE(sha512, NID_sha512, 64, 128, sha512),
+	{ NID_undef, 0, 0, NULL, NULL, NULL, NULL, NULL }
+};
+
+/* {{{ php_crypto_pbkdf2_find_engine */
+static const php_crypto_pbkdf2_engine *php_crypto_pbkdf2_find_engine(const EVP_MD *md)
+{
+	const php_crypto_pbkdf2_engine *engine;
+	int nid = EVP_MD_type(md);
+
+	for (engine = php_crypto_pbkdf2_engines; engine->nid != NID_undef; engine++) {
+		if (engine->nid == nid) {
+			return engine;
+		}
+	}
+	return NULL;
+}
+/* }}} */
+
+
+/* {{{ php_crypto_pbkdf2_start */
+static int php_crypto_pbkdf2_start(php_crypto_pbkdf2_data *data, int worker, int unit,
+		php_crypto_pbkdf2_sha_ctx *ipad, php_crypto_pbkdf2_sha_ctx *opad, unsigned char *u)
+{
+	const php_crypto_pbkdf2_engine *engine = data->engine;
+	php_crypto_pbkdf2_sha_ctx ctx;
+	unsigned char key[PHP_CRYPTO_PBKDF2_BLOCK_MAX], pad[PHP_CRYPTO_PBKDF2_BLOCK_MAX], be_block[4];
+	int i, rc, item = unit / data->blocks, pass_len = data->pass_len[item];
+
+	/* HMAC key is hashed only once so iterations just copy the pad state */
+	memset(key, 0, sizeof(key));
+	if (pass_len > engine->block_size) {
+		rc = engine->init(&ctx) && engine->update(&ctx, data->pass[item], pass_len) &&
+				engine->final(key, &ctx);
+	} else {
+		memcpy(key, data->pass[item], pass_len);
+		rc = 1;
+	}
+
+	for (i = 0; i < engine->block_size; i++) {
+		pad[i] = key[i] ^ 0x36;
+	}
+	rc = rc && engine->init(ipad) && engine->update(ipad, pad, engine->block_size);
+	for (i = 0; i < engine->block_size; i++) {
+		pad[i] = key[i] ^ 0x5c;
+	}
+	rc = rc && engine->init(opad) && engine->update(opad, pad, engine->block_size);
+
+	/* U_1 = HMAC(P, S || INT(i)) */
+	PHP_CRYPTO_PBKDF2_STORE32(be_block, (unsigned int) (unit % data->blocks + 1));
+	memcpy(&ctx, ipad, sizeof(ctx));
+	rc = rc && engine->update(&ctx, data->salt[item], data->salt_len[item]) &&
+			engine->update(&ctx, be_block, 4) && engine->final(u, &ctx);
+	memcpy(&ctx, opad, sizeof(ctx));
+	rc = rc && engine->update(&ctx, u, engine->md_size) && engine->final(u, &ctx);
+
+	OPENSSL_cleanse(&ctx, sizeof(ctx));
+	OPENSSL_cleanse(key, sizeof(key));
+	OPENSSL_cleanse(pad, sizeof(pad));
+
+	if (!rc) {
+		OPENSSL_cleanse(ipad, sizeof(*ipad));
+		OPENSSL_cleanse(opad, sizeof(*opad));
+		OPENSSL_cleanse(u, engine->md_size);
+		data->failed[worker] = 1;
+		return FAILURE;
+	}
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_pbkdf2_finish */
+static void php_crypto_pbkdf2_finish(php_crypto_pbkdf2_data *data, int unit,
+		const unsigned char *t)
+{
+	int md_size = data->engine->md_size, block = unit % data->blocks;
+	int out_len = data->key_len - block * md_size;
+
+	if (out_len > md_size) {
+		out_len = md_size;
+	}
+	memcpy(data->keys[unit / data->blocks] + block * md_size, t, out_len);
+}
+/* }}} */
+
+/* {{{ php_crypto_pbkdf2_block */
+static void php_crypto_pbkdf2_block(void *arg, int worker, int unit)
+{
+	php_crypto_pbkdf2_data *data = (php_crypto_pbkdf2_data *) arg;
+	const php_crypto_pbkdf2_engine *engine = data->engine;
+	php_crypto_pbkdf2_sha_ctx ipad, opad, ctx;
+	unsigned char block[PHP_CRYPTO_PBKDF2_BLOCK_MAX], t[EVP_MAX_MD_SIZE];
+	unsigned int bits;
+	int i, j, md_size = engine->md_size, block_size = engine->block_size;
+
+	if (php_crypto_pbkdf2_start(data, worker, unit, &ipad, &opad, block) == FAILURE) {
+		return;
+	}
+	memcpy(t, block, md_size);
+
+	/* Both inner and outer messages of U_j are one pad block and one digest so
+	 * the final block is always digest || 0x80 || 0 ... || bit length */
+	memset(block + md_size, 0, block_size - md_size);
+	block[md_size] = 0x80;
+	bits = (block_size + md_size) * 8;
+	PHP_CRYPTO_PBKDF2_STORE32(block + block_size - 4, bits);
+
+	/* U_j = HMAC(P, U_{j-1}) computed directly on the compression function */
+	for (i = 1; i < data->iter; i++) {
+		memcpy(&ctx, &ipad, sizeof(ctx));
+		engine->transform(&ctx, block);
+		engine->store(&ctx, block);
+		memcpy(&ctx, &opad, sizeof(ctx));
+		engine->transform(&ctx, block);
+		engine->store(&ctx, block);
+		for (j = 0; j < md_size; j++) {
+			t[j] ^= block[j];
+		}
+	}
+
+	php_crypto_pbkdf2_finish(data, unit, t);
+
+	OPENSSL_cleanse(&ipad, sizeof(ipad));
+	OPENSSL_cleanse(&opad, sizeof(opad));
+	OPENSSL_cleanse(&ctx, sizeof(ctx));
+	OPENSSL_cleanse(block, sizeof(block));
+	OPENSSL_cleanse(t, sizeof(t));
+}
+/* }}} */
+
+#ifdef PHP_CRYPTO_HAS_PBKDF2_SIMD
+
+static const uint32_t php_crypto_pbkdf2_sha256_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/* Generates SHA-256 compression and PBKDF2 iteration for one SIMD width. The
+ * message is always U_{j-1} || 0x80 || 0 ... || 768 (pad block and digest)
+ * and the vector operations are supplied by the PHP_CRYPTO_PBKDF2_V* macros. */
+#define PHP_CRYPTO_PBKDF2_SHA256_SIMD(_name, _target, _lanes) \
+	PHP_CRYPTO_PBKDF2_TARGET(_target) \
+	static void php_crypto_pbkdf2_sha256_##_name##_compress( \
+			const PHP_CRYPTO_PBKDF2_V *chain, const PHP_CRYPTO_PBKDF2_V *msg, \
+			PHP_CRYPTO_PBKDF2_V *out) \
+	{ \
+		PHP_CRYPTO_PBKDF2_V w[64], a, b, c, d, e, f, g, h, t1, t2; \
+		int i; \
+		for (i = 0; i < 8; i++) { \
+			w[i] = msg[i]; \
+		} \
+		w[8] = PHP_CRYPTO_PBKDF2_VSET1(0x80000000); \
+		for (i = 9; i < 15; i++) { \
+			w[i] = PHP_CRYPTO_PBKDF2_VSET1(0); \
+		} \
+		w[15] = PHP_CRYPTO_PBKDF2_VSET1(768); \
+		for (i = 16; i < 64; i++) { \
+			t1 = PHP_CRYPTO_PBKDF2_VXOR3(PHP_CRYPTO_PBKDF2_VROR(w[i - 15], 7), \
+					PHP_CRYPTO_PBKDF2_VROR(w[i - 15], 18), PHP_CRYPTO_PBKDF2_VSHR(w[i - 15], 3)); \
+			t2 = PHP_CRYPTO_PBKDF2_VXOR3(PHP_CRYPTO_PBKDF2_VROR(w[i - 2], 17), \
+					PHP_CRYPTO_PBKDF2_VROR(w[i - 2], 19), PHP_CRYPTO_PBKDF2_VSHR(w[i - 2], 10)); \
+			w[i] = PHP_CRYPTO_PBKDF2_VADD(PHP_CRYPTO_PBKDF2_VADD(w[i - 16], t1), \
+					PHP_CRYPTO_PBKDF2_VADD(w[i - 7], t2)); \
+		} \
+		a = chain[0]; b = chain[1]; c = chain[2]; d = chain[3]; \
+		e = chain[4]; f = chain[5]; g = chain[6]; h = chain[7]; \
+		for (i = 0; i < 64; i++) { \
+			t1 = PHP_CRYPTO_PBKDF2_VADD( \
+					PHP_CRYPTO_PBKDF2_VADD(h, PHP_CRYPTO_PBKDF2_VXOR3(PHP_CRYPTO_PBKDF2_VROR(e, 6), \
+							PHP_CRYPTO_PBKDF2_VROR(e, 11), PHP_CRYPTO_PBKDF2_VROR(e, 25))), \
+					PHP_CRYPTO_PBKDF2_VADD(PHP_CRYPTO_PBKDF2_VCH(e, f, g), PHP_CRYPTO_PBKDF2_VADD( \
+							PHP_CRYPTO_PBKDF2_VSET1(php_crypto_pbkdf2_sha256_k[i]), w[i]))); \
+			t2 = PHP_CRYPTO_PBKDF2_VADD(PHP_CRYPTO_PBKDF2_VXOR3(PHP_CRYPTO_PBKDF2_VROR(a, 2), \
+						PHP_CRYPTO_PBKDF2_VROR(a, 13), PHP_CRYPTO_PBKDF2_VROR(a, 22)), \
+					PHP_CRYPTO_PBKDF2_VMAJ(a, b, c)); \
+			h = g; g = f; f = e; e = PHP_CRYPTO_PBKDF2_VADD(d, t1); \
+			d = c; c = b; b = a; a = PHP_CRYPTO_PBKDF2_VADD(t1, t2); \
+		} \
+		out[0] = PHP_CRYPTO_PBKDF2_VADD(chain[0], a); \
+		out[1] = PHP_CRYPTO_PBKDF2_VADD(chain[1], b); \
+		out[2] = PHP_CRYPTO_PBKDF2_VADD(chain[2], c); \
+		out[3] = PHP_CRYPTO_PBKDF2_VADD(chain[3], d); \
+		out[4] = PHP_CRYPTO_PBKDF2_VADD(chain[4], e); \
+		out[5] = PHP_CRYPTO_PBKDF2_VADD(chain[5], f); \
+		out[6] = PHP_CRYPTO_PBKDF2_VADD(chain[6], g); \
+		out[7] = PHP_CRYPTO_PBKDF2_VADD(chain[7], h); \
+	} \
+	PHP_CRYPTO_PBKDF2_TARGET(_target) \
+	static void php_crypto_pbkdf2_sha256_##_name##_iterate(const uint32_t *ipad, \
+			const uint32_t *opad, uint32_t *u, uint32_t *t, int iter) \
+	{ \
+		PHP_CRYPTO_PBKDF2_V vipad[8], vopad[8], vu[8], vt[8], vinner[8]; \
+		int i, j; \
+		for (j = 0; j < 8; j++) { \
+			vipad[j] = PHP_CRYPTO_PBKDF2_VLOAD(ipad + j * _lanes); \
+			vopad[j] = PHP_CRYPTO_PBKDF2_VLOAD(opad + j * _lanes); \
+			vu[j] = vt[j] = PHP_CRYPTO_PBKDF2_VLOAD(u + j * _lanes); \
+		} \
+		for (i = 1; i < iter; i++) { \
+			php_crypto_pbkdf2_sha256_##_name##_compress(vipad, vu, vinner); \
+			php_crypto_pbkdf2_sha256_##_name##_compress(vopad, vinner, vu); \
+			for (j = 0; j < 8; j++) { \
+				vt[j] = PHP_CRYPTO_PBKDF2_VXOR(vt[j], vu[j]); \
+			} \
+		} \
+		for (j = 0; j < 8; j++) { \
+			PHP_CRYPTO_PBKDF2_VSTORE(t + j * _lanes, vt[j]); \
+		} \
+	}
+
+/* AVX2 - 8 lanes */
+#define PHP_CRYPTO_PBKDF2_V __m256i
+#define PHP_CRYPTO_PBKDF2_VLOAD(p) _mm256_loadu_si256((const __m256i *) (p))
+#define PHP_CRYPTO_PBKDF2_VSTORE(p, x) _mm256_storeu_si256((__m256i *) (p), x)
+#define PHP_CRYPTO_PBKDF2_VSET1(x) _mm256_set1_epi32((int) (x))
+#define PHP_CRYPTO_PBKDF2_VADD(x, y) _mm256_add_epi32(x, y)
+#define PHP_CRYPTO_PBKDF2_VXOR(x, y) _mm256_xor_si256(x, y)
+#define PHP_CRYPTO_PBKDF2_VXOR3(x, y, z) _mm256_xor_si256(_mm256_xor_si256(x, y), z)
+#define PHP_CRYPTO_PBKDF2_VSHR(x, n) _mm256_srli_epi32(x, n)
+#define PHP_CRYPTO_PBKDF2_VROR(x, n) \
+	_mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+#define PHP_CRYPTO_PBKDF2_VCH(x, y, z) \
+	_mm256_xor_si256(_mm256_and_si256(x, y), _mm256_andnot_si256(x, z))
+#define PHP_CRYPTO_PBKDF2_VMAJ(x, y, z) \
+	_mm256_xor_si256(_mm256_and_si256(x, y), _mm256_and_si256(z, _mm256_xor_si256(x, y)))
+
+PHP_CRYPTO_PBKDF2_SHA256_SIMD(x8, "avx2", 8)
+
+#undef PHP_CRYPTO_PBKDF2_V
+#undef PHP_CRYPTO_PBKDF2_VLOAD
+#undef PHP_CRYPTO_PBKDF2_VSTORE
+#undef PHP_CRYPTO_PBKDF2_VSET1
+#undef PHP_CRYPTO_PBKDF2_VADD
+#undef PHP_CRYPTO_PBKDF2_VXOR
+#undef PHP_CRYPTO_PBKDF2_VXOR3
+#undef PHP_CRYPTO_PBKDF2_VSHR
+#undef PHP_CRYPTO_PBKDF2_VROR
+#undef PHP_CRYPTO_PBKDF2_VCH
+#undef PHP_CRYPTO_PBKDF2_VMAJ
+
+/* AVX-512 - 16 lanes with native rotations and ternary logic */
+#define PHP_CRYPTO_PBKDF2_V __m512i
+#define PHP_CRYPTO_PBKDF2_VLOAD(p) _mm512_loadu_si512((const void *) (p))
+#define PHP_CRYPTO_PBKDF2_VSTORE(p, x) _mm512_storeu_si512((void *) (p), x)
+#define PHP_CRYPTO_PBKDF2_VSET1(x) _mm512_set1_epi32((int) (x))
+#define PHP_CRYPTO_PBKDF2_VADD(x, y) _mm512_add_epi32(x, y)
+#define PHP_CRYPTO_PBKDF2_VXOR(x, y) _mm512_xor_si512(x, y)
+#define PHP_CRYPTO_PBKDF2_VXOR3(x, y, z) _mm512_ternarylogic_epi32(x, y, z, 0x96)
+#define PHP_CRYPTO_PBKDF2_VSHR(x, n) _mm512_srli_epi32(x, n)
+#define PHP_CRYPTO_PBKDF2_VROR(x, n) _mm512_ror_epi32(x, n)
+#define PHP_CRYPTO_PBKDF2_VCH(x, y, z) _mm512_ternarylogic_epi32(x, y, z, 0xca)
+#define PHP_CRYPTO_PBKDF2_VMAJ(x, y, z) _mm512_ternarylogic_epi32(x, y, z, 0xe8)
+
+PHP_CRYPTO_PBKDF2_SHA256_SIMD(x16, "avx512f", 16)
+
+#undef PHP_CRYPTO_PBKDF2_V
+#undef PHP_CRYPTO_PBKDF2_VLOAD
+#undef PHP_CRYPTO_PBKDF2_VSTORE
+#undef PHP_CRYPTO_PBKDF2_VSET1
+#undef PHP_CRYPTO_PBKDF2_VADD
+#undef PHP_CRYPTO_PBKDF2_VXOR
+#undef PHP_CRYPTO_PBKDF2_VXOR3
+#undef PHP_CRYPTO_PBKDF2_VSHR
+#undef PHP_CRYPTO_PBKDF2_VROR
+#undef PHP_CRYPTO_PBKDF2_VCH
+#undef PHP_CRYPTO_PBKDF2_VMAJ
+
+/* {{{ php_crypto_pbkdf2_simd_select */
+static int php_crypto_pbkdf2_simd_select(php_crypto_pbkdf2_iterate_func *iterate)
+{
+	unsigned int eax, ebx = 0, ecx, edx;
+
+	if (__builtin_cpu_supports("avx512f")) {
+		*iterate = php_crypto_pbkdf2_sha256_x16_iterate;
+		return 16;
+	}
+	if (__get_cpuid_max(0, NULL) >= 7) {
+		__cpuid_count(7, 0, eax, ebx, ecx, edx);
+	}
+	/* a single SHA extensions lane is faster than 8 AVX2 lanes */
+	if (__builtin_cpu_supports("avx2") && !(ebx & (1U << 29))) {
+		*iterate = php_crypto_pbkdf2_sha256_x8_iterate;
+		return 8;
+	}
+	return 0;
+}
+/* }}} */
+
+/* {{{ php_crypto_pbkdf2_batch */
+static void php_crypto_pbkdf2_batch(void *arg, int worker, int batch)
+{
+	php_crypto_pbkdf2_data *data = (php_crypto_pbkdf2_data *) arg;
+	php_crypto_pbkdf2_sha_ctx ipad, opad;
+	uint32_t wipad[8 * PHP_CRYPTO_PBKDF2_LANES_MAX], wopad[8 * PHP_CRYPTO_PBKDF2_LANES_MAX];
+	uint32_t wu[8 * PHP_CRYPTO_PBKDF2_LANES_MAX], wt[8 * PHP_CRYPTO_PBKDF2_LANES_MAX];
+	unsigned char u[32];
+	int lane, j, unit, lanes = data->lanes;
+
+	/* U_1 is computed per lane and unused lanes just repeat the last unit */
+	for (lane = 0; lane < lanes; lane++) {
+		unit = batch * lanes + lane;
+		if (unit >= data->units) {
+			unit = data->units - 1;
+		}
+		if (php_crypto_pbkdf2_start(data, worker, unit, &ipad, &opad, u) == FAILURE) {
+			break;
+		}
+		for (j = 0; j < 8; j++) {
+			wipad[j * lanes + lane] = ipad.sha256.h[j];
+			wopad[j * lanes + lane] = opad.sha256.h[j];
+			wu[j * lanes + lane] = ((uint32_t) u[j * 4] << 24) | ((uint32_t) u[j * 4 + 1] << 16) |
+					((uint32_t) u[j * 4 + 2] << 8) | u[j * 4 + 3];
+		}
+	}
+
+	if (lane == lanes) {
+		data->iterate(wipad, wopad, wu, wt, data->iter);
+		for (lane = 0; lane < lanes && batch * lanes + lane < data->units; lane++) {
+			for (j = 0; j < 8; j++) {
+				PHP_CRYPTO_PBKDF2_STORE32(u + j * 4, wt[j * lanes + lane]);
+			}
+			php_crypto_pbkdf2_finish(data, batch * lanes + lane, u);
+		}
+	}
+
+	/* the pad states of all lanes are wiped also if any lane failed */
+	OPENSSL_cleanse(&ipad, sizeof(ipad));
+	OPENSSL_cleanse(&opad, sizeof(opad));
+	OPENSSL_cleanse(wipad, sizeof(wipad));
+	OPENSSL_cleanse(wopad, sizeof(wopad));
+	OPENSSL_cleanse(wu, sizeof(wu));
+	OPENSSL_cleanse(wt, sizeof(wt));
+	OPENSSL_cleanse(u, sizeof(u));
+}
+/* }}} */
+
+#endif
+
+#endif
+
+/* {{{ php_crypto_pbkdf2_openssl */
+static void php_crypto_pbkdf2_openssl(void *arg, int worker, int item)
+{
+	php_crypto_pbkdf2_data *data = (php_crypto_pbkdf2_data *) arg;
+
+	if (!PKCS5_PBKDF2_HMAC(data->pass[item], data->pass_len[item],
+			data->salt[item], data->salt_len[item], data->iter, data->md,
+			data->key_len, data->keys[item])) {
+		data->failed[worker] = 1;
+	}
+}
+/* }}} */
+
+/* {{{ php_crypto_pbkdf2_many */
+PHP_CRYPTO_API int php_crypto_pbkdf2_many(const EVP_MD *md, int count,
+		const char **pass, const int *pass_len, const unsigned char **salt, const int *salt_len,
+		int iter, unsigned char **keys, int key_len TSRMLS_DC)
+{
+	php_crypto_pbkdf2_data data;
+	php_crypto_thread_func func = php_crypto_pbkdf2_openssl;
+	int i, items = count, failed = 0;
+
+	if (count < 1 || key_len < 1) {
+		return SUCCESS;
+	}
+	/* the digest is not set if the subclass does not call the constructor */
+	if (!md) {
+		return FAILURE;
+	}
+
+	data.md = md;
+	data.count = count;
+	data.pass = pass;
+	data.pass_len = pass_len;
+	data.salt = salt;
+	data.salt_len = salt_len;
+	data.iter = iter < 1 ? 1 : iter;
+	data.keys = keys;
+	data.key_len = key_len;
+	data.lanes = 0;
+	memset(data.failed, 0, sizeof(data.failed));
+
+#ifdef PHP_CRYPTO_HAS_PBKDF2_ENGINE
+	data.engine = php_crypto_pbkdf2_find_engine(md);
+	if (data.engine) {
+		/* all output blocks of all keys are independent */
+		data.blocks = (key_len + data.engine->md_size - 1) / data.engine->md_size;
+		if (count > INT_MAX / data.blocks) {
+			return FAILURE;
+		}
+		data.units = items = count * data.blocks;
+		func = php_crypto_pbkdf2_block;
+#ifdef PHP_CRYPTO_HAS_PBKDF2_SIMD
+		/* lanes are used only if at least half of them is filled */
+		if (data.engine->nid == NID_sha256 && data.iter > 1) {
+			data.lanes = php_crypto_pbkdf2_simd_select(&data.iterate);
+			if (data.lanes && items >= data.lanes / 2) {
+				items = (data.units + data.lanes - 1) / data.lanes;
+				func = php_crypto_pbkdf2_batch;
+			} else {
+				data.lanes = 0;
+			}
+		}
+#endif
+	}
+#endif
+
+	php_crypto_thread_run(func, &data, items, php_crypto_thread_workers(items TSRMLS_CC));
+
+	for (i = 0; i < PHP_CRYPTO_THREADS_MAX; i++) {
+		failed |= data.failed[i];
+	}
+	return failed ? FAILURE : SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_pbkdf2 */
+PHP_CRYPTO_API int php_crypto_pbkdf2(const EVP_MD *md,
+		const char *pass, int pass_len, const unsigned char *salt, int salt_len,
+		int iter, unsigned char *key, int key_len TSRMLS_DC)
+{
+	return php_crypto_pbkdf2_many(md, 1, &pass, &pass_len, &salt, &salt_len,
+			iter, &key, key_len TSRMLS_CC);
+}
+/* }}} */
+
+/* Calibration parameters (the sample duration is in microseconds) */
+#define PHP_CRYPTO_PBKDF2_CALIBRATE_ITER_START 1000
+#define PHP_CRYPTO_PBKDF2_CALIBRATE_SAMPLE_MIN 20000
+#define PHP_CRYPTO_PBKDF2_CALIBRATE_SAMPLES 5
+
+/* {{{ php_crypto_pbkdf2_sample */
+static int php_crypto_pbkdf2_sample(const EVP_MD *md, int iter, unsigned char *key,
+		int key_len, double *elapsed TSRMLS_DC)
+{
+	static const char pass[] = "calibration pass";
+	static const unsigned char salt[] = "calibration salt";
+	struct timeval start, end;
+	int rc;
+
+	gettimeofday(&start, NULL);
+	rc = php_crypto_pbkdf2(md, pass, sizeof(pass) - 1, salt, sizeof(salt) - 1,
+			iter, key, key_len TSRMLS_CC);
+	gettimeofday(&end, NULL);
+
+	*elapsed = (end.tv_sec - start.tv_sec) * 1000000.0 + (end.tv_usec - start.tv_usec);
+
+	return rc;
+}
+/* }}} */
+
+/* {{{ php_crypto_pbkdf2_calibrate */
+PHP_CRYPTO_API int php_crypto_pbkdf2_calibrate(const EVP_MD *md, int target_ms,
+		int key_len, int *iter TSRMLS_DC)
+{
+	double samples[PHP_CRYPTO_PBKDF2_CALIBRATE_SAMPLES], elapsed, result;
+	unsigned char *key;
+	int i, j, rc = FAILURE, sample_iter = PHP_CRYPTO_PBKDF2_CALIBRATE_ITER_START;
+
+	if (EVP_MD_size(md) <= 0 || target_ms < 1 || key_len < 0) {
+		return FAILURE;
+	}
+	/* the cost grows with the number of output blocks so the whole key is
+	 * sampled (it also counts the blocks derived in parallel threads) */
+	if (key_len == 0) {
+		key_len = EVP_MD_size(md);
+	}
+	key = emalloc(key_len);
+
+	/* warm-up that grows the sample until it is long enough to be timed */
+	while (1) {
+		if (php_crypto_pbkdf2_sample(md, sample_iter, key, key_len, &elapsed TSRMLS_CC) == FAILURE) {
+			goto end;
+		}
+		if (elapsed >= PHP_CRYPTO_PBKDF2_CALIBRATE_SAMPLE_MIN || sample_iter > INT_MAX / 2) {
+			break;
+		}
+		sample_iter *= 2;
+	}
+
+	/* the median is not affected by occasional scheduling noise */
+	for (i = 0; i < PHP_CRYPTO_PBKDF2_CALIBRATE_SAMPLES; i++) {
+		if (php_crypto_pbkdf2_sample(md, sample_iter, key, key_len, &elapsed TSRMLS_CC) == FAILURE) {
+			goto end;
+		}
+		for (j = i; j > 0 && samples[j - 1] > elapsed; j--) {
+			samples[j] = samples[j - 1];
+		}
+		samples[j] = elapsed;
+	}
+	elapsed = samples[PHP_CRYPTO_PBKDF2_CALIBRATE_SAMPLES / 2];
+	if (elapsed < 1.0) {
+		elapsed = 1.0;
+	}
+
+	result = target_ms * 1000.0 * sample_iter / elapsed;
+	if (result < 1.0) {
+		*iter = 1;
+	} else if (result >= INT_MAX) {
+		*iter = INT_MAX;
+	} else {
+		*iter = (int) result;
+	}
+	rc = SUCCESS;
+
+end:
+	OPENSSL_cleanse(key, key_len);
+	efree(key);
+
+	return rc;
+}
+/* }}} */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
@@ -16,13 +16,39 @@
   +----------------------------------------------------------------------+
 */
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #include "php.h"
 #include "php_crypto.h"
 #include "php_crypto_rand.h"
+#include "php_crypto_hash.h"
 #include "zend_exceptions.h"
 
 #include <openssl/rand.h>
 #include <openssl/err.h>
+#include <openssl/evp.h>
+
+#ifndef PHP_WIN32
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+#ifdef HAVE_SYS_RANDOM_H
+#include <sys/random.h>
+#endif
+#if !defined(HAVE_GETRANDOM) && defined(__linux__)
+#include <sys/syscall.h>
+#endif
+#include <errno.h>
+
+/* System random backend feature test (getrandom or arc4random_buf) */
+#if defined(HAVE_GETRANDOM) || defined(HAVE_ARC4RANDOM_BUF) || \
+		(defined(__linux__) && defined(SYS_getrandom))
+#define PHP_CRYPTO_HAS_RAND_GETRANDOM 1
+#endif
+
+ZEND_EXTERN_MODULE_GLOBALS(crypto)
 
 PHP_CRYPTO_EXCEPTION_DEFINE(Rand)
 PHP_CRYPTO_ERROR_INFO_BEGIN(Rand)
@@ -42,6 +68,22 @@ PHP_CRYPTO_ERROR_INFO_ENTRY(
 	SEED_LENGTH_TOO_HIGH,
 	"The supplied seed length is too high"
 )
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	RANGE_INVALID,
+	"The minimum is greater than the maximum"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	COUNT_INVALID,
+	"The count is negative or too high"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	TOKEN_LENGTH_INVALID,
+	"The token length is negative or too high"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	TOKEN_ENCODING_INVALID,
+	"The token encoding is invalid"
+)
 PHP_CRYPTO_ERROR_INFO_END()
 
 ZEND_BEGIN_ARG_INFO_EX(arginfo_crypto_rand_generate, 0, 0, 1)
@@ -50,6 +92,32 @@ ZEND_ARG_INFO(0, must_be_strong)
 ZEND_ARG_INFO(1, returned_strong_result)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO(arginfo_crypto_rand_int, 0)
+ZEND_ARG_INFO(0, min)
+ZEND_ARG_INFO(0, max)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO(arginfo_crypto_rand_ints, 0)
+ZEND_ARG_INFO(0, count)
+ZEND_ARG_INFO(0, min)
+ZEND_ARG_INFO(0, max)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO(arginfo_crypto_rand_shuffle, 0)
+ZEND_ARG_ARRAY_INFO(1, array, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_crypto_rand_token, 0, 0, 1)
+ZEND_ARG_INFO(0, bytes)
+ZEND_ARG_INFO(0, encoding)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_crypto_rand_tokens, 0, 0, 2)
+ZEND_ARG_INFO(0, count)
+ZEND_ARG_INFO(0, bytes)
+ZEND_ARG_INFO(0, encoding)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_INFO_EX(arginfo_crypto_rand_seed, 0, 0, 1)
 ZEND_ARG_INFO(0, buf)
 ZEND_ARG_INFO(0, entropy)
@@ -70,6 +138,31 @@ static const zend_function_entry php_crypto_rand_object_methods[] = {
 		arginfo_crypto_rand_generate,
 		ZEND_ACC_STATIC|ZEND_ACC_PUBLIC
 	)
+	PHP_CRYPTO_ME(
+		Rand, int,
+		arginfo_crypto_rand_int,
+		ZEND_ACC_STATIC|ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		Rand, ints,
+		arginfo_crypto_rand_ints,
+		ZEND_ACC_STATIC|ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		Rand, shuffle,
+		arginfo_crypto_rand_shuffle,
+		ZEND_ACC_STATIC|ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		Rand, token,
+		arginfo_crypto_rand_token,
+		ZEND_ACC_STATIC|ZEND_ACC_PUBLIC
+	)
+	PHP_CRYPTO_ME(
+		Rand, tokens,
+		arginfo_crypto_rand_tokens,
+		ZEND_ACC_STATIC|ZEND_ACC_PUBLIC
+	)
 	PHP_CRYPTO_ME(
 		Rand, seed,
 		arginfo_crypto_rand_seed,
@@ -114,6 +207,282 @@ PHP_MINIT_FUNCTION(crypto_rand)
 }
 /* }}} */
 
+/* {{{ php_crypto_rand_get_backend */
+PHP_CRYPTO_API php_crypto_rand_backend php_crypto_rand_get_backend(TSRMLS_D)
+{
+	const char *backend = PHP_CRYPTO_G(rand_backend);
+
+	if (!backend) {
+		return PHP_CRYPTO_RAND_BACKEND_OPENSSL;
+	}
+#ifdef PHP_CRYPTO_HAS_RAND_POOL
+	if (!strcasecmp(backend, "buffered")) {
+		return PHP_CRYPTO_RAND_BACKEND_BUFFERED;
+	}
+#endif
+#ifdef PHP_CRYPTO_HAS_RAND_GETRANDOM
+	if (!strcasecmp(backend, "getrandom")) {
+		return PHP_CRYPTO_RAND_BACKEND_GETRANDOM;
+	}
+#endif
+	return PHP_CRYPTO_RAND_BACKEND_OPENSSL;
+}
+/* }}} */
+
+/* {{{ php_crypto_rand_pool_free */
+PHP_CRYPTO_API void php_crypto_rand_pool_free(php_crypto_rand_pool *pool)
+{
+	OPENSSL_cleanse(pool->state, sizeof(php_crypto_rand_pool_state));
+#ifdef MADV_WIPEONFORK
+	if (pool->wipe_on_fork) {
+		munmap(pool->state, sizeof(php_crypto_rand_pool_state));
+	} else
+#endif
+	pefree(pool->state, 1);
+	EVP_CIPHER_CTX_free(pool->ctx);
+	pefree(pool, 1);
+}
+/* }}} */
+
+#ifdef PHP_CRYPTO_HAS_RAND_POOL
+
+/* {{{ php_crypto_rand_pool_create */
+static php_crypto_rand_pool *php_crypto_rand_pool_create()
+{
+	php_crypto_rand_pool *pool;
+#ifdef MADV_WIPEONFORK
+	void *mem;
+#endif
+
+	pool = pemalloc(sizeof(php_crypto_rand_pool), 1);
+	pool->ctx = EVP_CIPHER_CTX_new();
+	if (!pool->ctx) {
+		pefree(pool, 1);
+		return NULL;
+	}
+	pool->state = NULL;
+	pool->wipe_on_fork = 0;
+#ifdef MADV_WIPEONFORK
+	/* the kernel zeroes the state in the forked child so the child
+	 * sees an unseeded generator without checking pid on each call */
+	mem = mmap(NULL, sizeof(php_crypto_rand_pool_state), PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mem != MAP_FAILED) {
+		if (madvise(mem, sizeof(php_crypto_rand_pool_state), MADV_WIPEONFORK) == 0) {
+			pool->state = (php_crypto_rand_pool_state *) mem;
+			pool->wipe_on_fork = 1;
+		} else {
+			munmap(mem, sizeof(php_crypto_rand_pool_state));
+		}
+	}
+#endif
+	if (!pool->state) {
+		pool->state = pemalloc(sizeof(php_crypto_rand_pool_state), 1);
+	}
+	memset(pool->state, 0, sizeof(php_crypto_rand_pool_state));
+
+	return pool;
+}
+/* }}} */
+
+/* {{{ php_crypto_rand_pool_fork_id */
+static inline unsigned long php_crypto_rand_pool_fork_id(php_crypto_rand_pool *pool)
+{
+#ifdef PHP_WIN32
+	return 1;
+#else
+	return pool->wipe_on_fork ? 1 : (unsigned long) getpid();
+#endif
+}
+/* }}} */
+
+/* {{{ php_crypto_rand_pool_seed */
+static int php_crypto_rand_pool_seed(php_crypto_rand_pool *pool)
+{
+	php_crypto_rand_pool_state *state = pool->state;
+	unsigned char seed[PHP_CRYPTO_RAND_POOL_SEED_LEN];
+	int rc;
+
+	if (RAND_bytes(seed, sizeof(seed)) != 1) {
+		return FAILURE;
+	}
+	rc = EVP_EncryptInit_ex(pool->ctx, EVP_chacha20(), NULL,
+			seed, seed + PHP_CRYPTO_RAND_POOL_KEY_LEN);
+	OPENSSL_cleanse(seed, sizeof(seed));
+	if (!rc) {
+		return FAILURE;
+	}
+
+	OPENSSL_cleanse(state->buf, sizeof(state->buf));
+	state->avail = 0;
+	state->generated = 0;
+	state->fork_id = php_crypto_rand_pool_fork_id(pool);
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_rand_pool_stream */
+static int php_crypto_rand_pool_stream(
+		php_crypto_rand_pool *pool, unsigned char *out, int len)
+{
+	int outl;
+
+	memset(out, 0, len);
+	return EVP_EncryptUpdate(pool->ctx, out, &outl, out, len) ? SUCCESS : FAILURE;
+}
+/* }}} */
+
+/* {{{ php_crypto_rand_pool_refill */
+static int php_crypto_rand_pool_refill(php_crypto_rand_pool *pool)
+{
+	php_crypto_rand_pool_state *state = pool->state;
+
+	if (php_crypto_rand_pool_stream(pool, state->buf, sizeof(state->buf)) == FAILURE) {
+		return FAILURE;
+	}
+	/* fast key erasure: the keystream start becomes the next key and IV
+	 * so the bytes already returned cannot be recomputed from the state */
+	if (!EVP_EncryptInit_ex(pool->ctx, NULL, NULL,
+			state->buf, state->buf + PHP_CRYPTO_RAND_POOL_KEY_LEN)) {
+		return FAILURE;
+	}
+	OPENSSL_cleanse(state->buf, PHP_CRYPTO_RAND_POOL_SEED_LEN);
+	state->avail = sizeof(state->buf) - PHP_CRYPTO_RAND_POOL_SEED_LEN;
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_rand_pool_bytes */
+static int php_crypto_rand_pool_bytes(
+		php_crypto_rand_pool *pool, unsigned char *buf, int num)
+{
+	php_crypto_rand_pool_state *state = pool->state;
+	unsigned char *pos;
+	size_t len;
+
+	if (num <= 0) {
+		return SUCCESS;
+	}
+
+	if ((state->fork_id != php_crypto_rand_pool_fork_id(pool) ||
+			state->generated >= PHP_CRYPTO_RAND_POOL_RESEED) &&
+			php_crypto_rand_pool_seed(pool) == FAILURE) {
+		return FAILURE;
+	}
+	state->generated += num;
+
+	/* large requests are served directly from the keystream */
+	if (num >= PHP_CRYPTO_RAND_POOL_SIZE) {
+		if (php_crypto_rand_pool_stream(pool, buf, num) == FAILURE) {
+			return FAILURE;
+		}
+		return php_crypto_rand_pool_refill(pool);
+	}
+
+	while (num > 0) {
+		if (!state->avail && php_crypto_rand_pool_refill(pool) == FAILURE) {
+			return FAILURE;
+		}
+		len = state->avail < (size_t) num ? state->avail : (size_t) num;
+		pos = state->buf + sizeof(state->buf) - state->avail;
+		memcpy(buf, pos, len);
+		OPENSSL_cleanse(pos, len);
+		state->avail -= len;
+		buf += len;
+		num -= (int) len;
+	}
+
+	return SUCCESS;
+}
+/* }}} */
+
+#endif
+
+#ifdef PHP_CRYPTO_HAS_RAND_GETRANDOM
+
+/* {{{ php_crypto_rand_getrandom
+	Reads bytes from the kernel CSPRNG without any user space locking */
+static int php_crypto_rand_getrandom(unsigned char *buf, int num)
+{
+#if defined(HAVE_GETRANDOM) || defined(SYS_getrandom)
+	ssize_t n;
+	size_t len;
+
+	while (num > 0) {
+		len = num < PHP_CRYPTO_RAND_GETRANDOM_MAX ? num : PHP_CRYPTO_RAND_GETRANDOM_MAX;
+#ifdef HAVE_GETRANDOM
+		n = getrandom(buf, len, 0);
+#else
+		n = syscall(SYS_getrandom, buf, len, 0);
+#endif
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return FAILURE;
+		}
+		buf += n;
+		num -= (int) n;
+	}
+#else
+	if (num > 0) {
+		arc4random_buf(buf, num);
+	}
+#endif
+	return SUCCESS;
+}
+/* }}} */
+
+#endif
+
+/* {{{ php_crypto_rand_bytes */
+PHP_CRYPTO_API int php_crypto_rand_bytes(unsigned char *buf, int num TSRMLS_DC)
+{
+	php_crypto_rand_backend backend = php_crypto_rand_get_backend(TSRMLS_C);
+#ifdef PHP_CRYPTO_HAS_RAND_POOL
+	php_crypto_rand_pool *pool;
+#endif
+
+#ifdef PHP_CRYPTO_HAS_RAND_GETRANDOM
+	if (backend == PHP_CRYPTO_RAND_BACKEND_GETRANDOM) {
+		return php_crypto_rand_getrandom(buf, num);
+	}
+#endif
+#ifdef PHP_CRYPTO_HAS_RAND_POOL
+	if (backend == PHP_CRYPTO_RAND_BACKEND_BUFFERED) {
+		pool = PHP_CRYPTO_G(rand_pool);
+		if (!pool) {
+			pool = php_crypto_rand_pool_create();
+			if (!pool) {
+				return FAILURE;
+			}
+			PHP_CRYPTO_G(rand_pool) = pool;
+		}
+		if (php_crypto_rand_pool_bytes(pool, buf, num) == FAILURE) {
+			/* the generator is seeded again on the next call */
+			pool->state->fork_id = 0;
+			return FAILURE;
+		}
+		return SUCCESS;
+	}
+#endif
+	return RAND_bytes(buf, num) == 1 ? SUCCESS : FAILURE;
+}
+/* }}} */
+
+/* {{{ php_crypto_rand_pool_reset */
+static void php_crypto_rand_pool_reset(TSRMLS_D)
+{
+	php_crypto_rand_pool *pool = PHP_CRYPTO_G(rand_pool);
+
+	if (pool) {
+		pool->state->fork_id = 0;
+	}
+}
+/* }}} */
+
 /* {{{ proto static string Crypto\Rand::generate(
 			int $num, bool $must_be_strong = true,
 			&bool $returned_strong_result = true)
@@ -139,8 +508,9 @@ PHP_CRYPTO_METHOD(Rand, generate)
 
 	PHPC_STR_ALLOC(buf, num);
 
-	if (must_be_strong) {
-		if (!RAND_bytes((unsigned char *) PHPC_STR_VAL(buf), num)) {
+	if (must_be_strong ||
+			php_crypto_rand_get_backend(TSRMLS_C) != PHP_CRYPTO_RAND_BACKEND_OPENSSL) {
+		if (php_crypto_rand_bytes((unsigned char *) PHPC_STR_VAL(buf), num TSRMLS_CC) == FAILURE) {
 			php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Rand, GENERATE_PREDICTABLE));
 			PHPC_STR_RELEASE(buf);
 			RETURN_FALSE;
@@ -157,6 +527,423 @@ PHP_CRYPTO_METHOD(Rand, generate)
 }
 /* }}} */
 
+/* {{{ php_crypto_rand_batch_init */
+static void php_crypto_rand_batch_init(php_crypto_rand_batch *batch, size_t expected)
+{
+	if (expected > PHP_CRYPTO_RAND_BATCH_SIZE) {
+		expected = PHP_CRYPTO_RAND_BATCH_SIZE;
+	} else if (expected < PHP_CRYPTO_RAND_BATCH_MIN) {
+		expected = PHP_CRYPTO_RAND_BATCH_MIN;
+	}
+	batch->size = (int) expected;
+	batch->len = 0;
+	batch->pos = 0;
+}
+/* }}} */
+
+/* {{{ php_crypto_rand_batch_clean */
+static void php_crypto_rand_batch_clean(php_crypto_rand_batch *batch)
+{
+	OPENSSL_cleanse(batch->buf, batch->len);
+	batch->len = 0;
+	batch->pos = 0;
+}
+/* }}} */
+
+/* {{{ php_crypto_rand_batch_fetch */
+PHP_CRYPTO_API unsigned char *php_crypto_rand_batch_fetch(
+		php_crypto_rand_batch *batch, int len TSRMLS_DC)
+{
+	unsigned char *p;
+
+	if (batch->len - batch->pos < len) {
+		/* the remaining bytes are dropped */
+		if (php_crypto_rand_bytes(batch->buf, batch->size TSRMLS_CC) == FAILURE) {
+			return NULL;
+		}
+		batch->len = batch->size;
+		batch->pos = 0;
+	}
+	p = batch->buf + batch->pos;
+	batch->pos += len;
+
+	return p;
+}
+/* }}} */
+
+/* {{{ php_crypto_rand_batch_uniform */
+PHP_CRYPTO_API int php_crypto_rand_batch_uniform(
+		php_crypto_rand_batch *batch, uint64_t range, uint64_t *value TSRMLS_DC)
+{
+	uint64_t mask, v;
+	unsigned char *p;
+	int i, nbytes = 0;
+
+	/* mask and number of bytes covering the range */
+	mask = range;
+	mask |= mask >> 1;
+	mask |= mask >> 2;
+	mask |= mask >> 4;
+	mask |= mask >> 8;
+	mask |= mask >> 16;
+	mask |= mask >> 32;
+	for (v = range; v; v >>= 8) {
+		nbytes++;
+	}
+
+	/* rejection sampling (less than two draws on average) */
+	do {
+		p = php_crypto_rand_batch_fetch(batch, nbytes TSRMLS_CC);
+		if (!p) {
+			return FAILURE;
+		}
+		for (v = 0, i = 0; i < nbytes; i++) {
+			v = (v << 8) | p[i];
+		}
+		v &= mask;
+	} while (v > range);
+
+	*value = v;
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_rand_range */
+static int php_crypto_rand_range(phpc_long_t min, phpc_long_t max, uint64_t *range TSRMLS_DC)
+{
+	if (min > max) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Rand, RANGE_INVALID));
+		return FAILURE;
+	}
+	/* unsigned difference is exact as it is lower than 2^64 */
+	*range = (uint64_t) max - (uint64_t) min;
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ proto static int Crypto\Rand::int(int $min, int $max)
+	Returns uniformly distributed random integer from the interval [$min, $max] */
+PHP_CRYPTO_METHOD(Rand, int)
+{
+	phpc_long_t min, max;
+	php_crypto_rand_batch batch;
+	uint64_t range, value;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "ll",
+			&min, &max) == FAILURE) {
+		return;
+	}
+
+	if (php_crypto_rand_range(min, max, &range TSRMLS_CC) == FAILURE) {
+		RETURN_FALSE;
+	}
+
+	php_crypto_rand_batch_init(&batch, 2 * sizeof(uint64_t));
+	if (php_crypto_rand_batch_uniform(&batch, range, &value TSRMLS_CC) == FAILURE) {
+		php_crypto_rand_batch_clean(&batch);
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Rand, GENERATE_PREDICTABLE));
+		RETURN_FALSE;
+	}
+	php_crypto_rand_batch_clean(&batch);
+
+	RETURN_LONG((phpc_long_t) ((uint64_t) min + value));
+}
+/* }}} */
+
+/* {{{ proto static array Crypto\Rand::ints(int $count, int $min, int $max)
+	Returns an array of uniformly distributed random integers from the interval
+	[$min, $max] */
+PHP_CRYPTO_METHOD(Rand, ints)
+{
+	phpc_long_t count_long, min, max;
+	php_crypto_rand_batch batch;
+	uint64_t range, value;
+	int i, count;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "lll",
+			&count_long, &min, &max) == FAILURE) {
+		return;
+	}
+
+	if (count_long < 0 || php_crypto_long_to_int(count_long, &count) == FAILURE) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Rand, COUNT_INVALID));
+		RETURN_FALSE;
+	}
+	if (php_crypto_rand_range(min, max, &range TSRMLS_CC) == FAILURE) {
+		RETURN_FALSE;
+	}
+
+	array_init_size(return_value, count);
+	php_crypto_rand_batch_init(&batch, (size_t) count * 2 * sizeof(uint64_t));
+	for (i = 0; i < count; i++) {
+		if (php_crypto_rand_batch_uniform(&batch, range, &value TSRMLS_CC) == FAILURE) {
+			php_crypto_rand_batch_clean(&batch);
+			zval_dtor(return_value);
+			php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Rand, GENERATE_PREDICTABLE));
+			RETURN_FALSE;
+		}
+		add_next_index_long(return_value, (phpc_long_t) ((uint64_t) min + value));
+	}
+	php_crypto_rand_batch_clean(&batch);
+}
+/* }}} */
+
+/* {{{ proto static void Crypto\Rand::shuffle(array &$array)
+	Shuffles values of the array in place */
+PHP_CRYPTO_METHOD(Rand, shuffle)
+{
+	zval *arr;
+	phpc_val **vals, *ppv_val, tmp;
+	php_crypto_rand_batch batch;
+	uint64_t j;
+	int i, count;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "a/", &arr) == FAILURE) {
+		return;
+	}
+
+	count = zend_hash_num_elements(PHPC_ARRVAL_P(arr));
+	if (count < 2) {
+		return;
+	}
+
+	vals = safe_emalloc(count, sizeof(phpc_val *), 0);
+	i = 0;
+	PHPC_HASH_FOREACH_VAL(PHPC_ARRVAL_P(arr), ppv_val) {
+		vals[i++] = ppv_val;
+	} PHPC_HASH_FOREACH_END();
+
+	/* Fisher-Yates shuffle of the values (keys stay in their place) */
+	php_crypto_rand_batch_init(&batch, (size_t) count * 2 * sizeof(uint64_t));
+	for (i = count - 1; i > 0; i--) {
+		if (php_crypto_rand_batch_uniform(&batch, (uint64_t) i, &j TSRMLS_CC) == FAILURE) {
+			php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Rand, GENERATE_PREDICTABLE));
+			break;
+		}
+		PHP_CRYPTO_RAND_VAL_SWAP(vals[i], vals[j], tmp);
+	}
+	php_crypto_rand_batch_clean(&batch);
+	efree(vals);
+}
+/* }}} */
+
+/* {{{ php_crypto_rand_token_encoding */
+static int php_crypto_rand_token_encoding(const char *name,
+		php_crypto_rand_encoding *encoding)
+{
+	if (!strcasecmp(name, "base64url")) {
+		*encoding = PHP_CRYPTO_RAND_ENCODING_BASE64URL;
+	} else if (!strcasecmp(name, "hex")) {
+		*encoding = PHP_CRYPTO_RAND_ENCODING_HEX;
+	} else if (!strcasecmp(name, "base32")) {
+		*encoding = PHP_CRYPTO_RAND_ENCODING_BASE32;
+	} else {
+		return FAILURE;
+	}
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_rand_token_len */
+static size_t php_crypto_rand_token_len(php_crypto_rand_encoding encoding, size_t bytes)
+{
+	static const size_t base64_tail[3] = {0, 2, 3};
+	static const size_t base32_tail[5] = {0, 2, 4, 5, 7};
+
+	switch (encoding) {
+		case PHP_CRYPTO_RAND_ENCODING_HEX:
+			return bytes * 2;
+		case PHP_CRYPTO_RAND_ENCODING_BASE64URL:
+			return bytes / 3 * 4 + base64_tail[bytes % 3];
+		case PHP_CRYPTO_RAND_ENCODING_BASE32:
+			return bytes / 5 * 8 + base32_tail[bytes % 5];
+	}
+	return 0;
+}
+/* }}} */
+
+/* {{{ php_crypto_rand_token_encode
+	Encodes in to out without padding and returns the end of the output */
+static char *php_crypto_rand_token_encode(php_crypto_rand_encoding encoding,
+		const unsigned char *in, int len, char *out)
+{
+	static const char base64url[] =
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+	static const char base32[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
+	unsigned long bits = 0;
+	int i, nbits = 0;
+
+	switch (encoding) {
+		case PHP_CRYPTO_RAND_ENCODING_HEX:
+			php_crypto_hash_bin2hex(out, in, (unsigned) len);
+			return out + 2 * len;
+		case PHP_CRYPTO_RAND_ENCODING_BASE64URL:
+			for (i = 0; i + 2 < len; i += 3) {
+				*out++ = base64url[in[i] >> 2];
+				*out++ = base64url[((in[i] & 0x03) << 4) | (in[i + 1] >> 4)];
+				*out++ = base64url[((in[i + 1] & 0x0f) << 2) | (in[i + 2] >> 6)];
+				*out++ = base64url[in[i + 2] & 0x3f];
+			}
+			if (i + 1 == len) {
+				*out++ = base64url[in[i] >> 2];
+				*out++ = base64url[(in[i] & 0x03) << 4];
+			} else if (i + 2 == len) {
+				*out++ = base64url[in[i] >> 2];
+				*out++ = base64url[((in[i] & 0x03) << 4) | (in[i + 1] >> 4)];
+				*out++ = base64url[(in[i + 1] & 0x0f) << 2];
+			}
+			return out;
+		case PHP_CRYPTO_RAND_ENCODING_BASE32:
+			for (i = 0; i < len; i++) {
+				bits = (bits << 8) | in[i];
+				nbits += 8;
+				while (nbits >= 5) {
+					nbits -= 5;
+					*out++ = base32[(bits >> nbits) & 0x1f];
+				}
+			}
+			if (nbits) {
+				*out++ = base32[(bits << (5 - nbits)) & 0x1f];
+			}
+			return out;
+	}
+	return out;
+}
+/* }}} */
+
+/* {{{ php_crypto_rand_token_fill
+	Generates and encodes one token directly to out */
+static int php_crypto_rand_token_fill(php_crypto_rand_batch *batch,
+		php_crypto_rand_encoding encoding, int bytes, char *out TSRMLS_DC)
+{
+	unsigned char *raw;
+	int len;
+
+	while (bytes > 0) {
+		/* the chunk is multiple of all encoding groups */
+		len = bytes < PHP_CRYPTO_RAND_TOKEN_CHUNK ? bytes : PHP_CRYPTO_RAND_TOKEN_CHUNK;
+		raw = php_crypto_rand_batch_fetch(batch, len TSRMLS_CC);
+		if (!raw) {
+			return FAILURE;
+		}
+		out = php_crypto_rand_token_encode(encoding, raw, len, out);
+		OPENSSL_cleanse(raw, len);
+		bytes -= len;
+	}
+	*out = '\0';
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_rand_token_params */
+static int php_crypto_rand_token_params(phpc_long_t bytes_long, int *bytes,
+		const char *encoding_name, php_crypto_rand_encoding *encoding TSRMLS_DC)
+{
+	/* the limit makes sure that the encoded length fits to int */
+	if (bytes_long < 0 || bytes_long > INT_MAX / 2) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Rand, TOKEN_LENGTH_INVALID));
+		return FAILURE;
+	}
+	*bytes = (int) bytes_long;
+
+	if (encoding_name &&
+			php_crypto_rand_token_encoding(encoding_name, encoding) == FAILURE) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Rand, TOKEN_ENCODING_INVALID));
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ proto static string Crypto\Rand::token(int $bytes, string $encoding = 'base64url')
+	Returns encoded random token of $bytes random bytes */
+PHP_CRYPTO_METHOD(Rand, token)
+{
+	phpc_long_t bytes_long;
+	char *encoding_name = NULL;
+	phpc_str_size_t encoding_name_len;
+	php_crypto_rand_encoding encoding = PHP_CRYPTO_RAND_ENCODING_BASE64URL;
+	php_crypto_rand_batch batch;
+	PHPC_STR_DECLARE(token);
+	int bytes;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "l|s",
+			&bytes_long, &encoding_name, &encoding_name_len) == FAILURE) {
+		return;
+	}
+
+	if (php_crypto_rand_token_params(bytes_long, &bytes,
+			encoding_name, &encoding TSRMLS_CC) == FAILURE) {
+		RETURN_FALSE;
+	}
+
+	PHPC_STR_ALLOC(token, php_crypto_rand_token_len(encoding, bytes));
+	php_crypto_rand_batch_init(&batch, bytes);
+	if (php_crypto_rand_token_fill(&batch, encoding, bytes,
+			PHPC_STR_VAL(token) TSRMLS_CC) == FAILURE) {
+		php_crypto_rand_batch_clean(&batch);
+		PHPC_STR_RELEASE(token);
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Rand, GENERATE_PREDICTABLE));
+		RETURN_FALSE;
+	}
+	php_crypto_rand_batch_clean(&batch);
+
+	PHPC_STR_RETURN(token);
+}
+/* }}} */
+
+/* {{{ proto static array Crypto\Rand::tokens(int $count, int $bytes,
+			string $encoding = 'base64url')
+	Returns an array of encoded random tokens */
+PHP_CRYPTO_METHOD(Rand, tokens)
+{
+	phpc_long_t count_long, bytes_long;
+	char *encoding_name = NULL;
+	phpc_str_size_t encoding_name_len;
+	php_crypto_rand_encoding encoding = PHP_CRYPTO_RAND_ENCODING_BASE64URL;
+	php_crypto_rand_batch batch;
+	PHPC_STR_DECLARE(token);
+	size_t token_len;
+	int i, count, bytes;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "ll|s",
+			&count_long, &bytes_long, &encoding_name, &encoding_name_len) == FAILURE) {
+		return;
+	}
+
+	if (count_long < 0 || php_crypto_long_to_int(count_long, &count) == FAILURE) {
+		php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Rand, COUNT_INVALID));
+		RETURN_FALSE;
+	}
+	if (php_crypto_rand_token_params(bytes_long, &bytes,
+			encoding_name, &encoding TSRMLS_CC) == FAILURE) {
+		RETURN_FALSE;
+	}
+
+	token_len = php_crypto_rand_token_len(encoding, bytes);
+	array_init_size(return_value, count);
+	/* the random bytes for many tokens are fetched at once */
+	php_crypto_rand_batch_init(&batch, count && bytes > PHP_CRYPTO_RAND_BATCH_SIZE / count ?
+			PHP_CRYPTO_RAND_BATCH_SIZE : (size_t) count * bytes);
+	for (i = 0; i < count; i++) {
+		PHPC_STR_ALLOC(token, token_len);
+		if (php_crypto_rand_token_fill(&batch, encoding, bytes,
+				PHPC_STR_VAL(token) TSRMLS_CC) == FAILURE) {
+			php_crypto_rand_batch_clean(&batch);
+			PHPC_STR_RELEASE(token);
+			zval_dtor(return_value);
+			php_crypto_error(PHP_CRYPTO_ERROR_ARGS(Rand, GENERATE_PREDICTABLE));
+			RETURN_FALSE;
+		}
+		PHPC_ARRAY_ADD_NEXT_INDEX_STR(return_value, token);
+	}
+	php_crypto_rand_batch_clean(&batch);
+}
+/* }}} */
+
 /* {{{ proto static void Crypto\Rand::seed(
 			string $buf, float $entropy = (float) strlen($buf))
 	Mixes bytes in $buf into PRNG state */
@@ -182,6 +969,7 @@ PHP_CRYPTO_METHOD(Rand, seed)
 	}
 
 	RAND_add(buf, buf_len, entropy);
+	php_crypto_rand_pool_reset(TSRMLS_C);
 }
 /* }}} */
 
@@ -193,6 +981,7 @@ PHP_CRYPTO_METHOD(Rand, cleanup)
 		return;
 	}
 	RAND_cleanup();
+	php_crypto_rand_pool_reset(TSRMLS_C);
 	RETURN_NULL();
 }
 /* }}} */
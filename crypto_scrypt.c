@@ -0,0 +1,203 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 2013-2016 Jakub Zelenka                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: Jakub Zelenka <bukka@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "php.h"
+#include "php_crypto.h"
+#include "php_crypto_scrypt.h"
+#include "php_crypto_thread.h"
+
+#include <openssl/evp.h>
+
+/* Shared data for all ROMix lanes */
+typedef struct {
+	unsigned char *b;
+	uint32_t *mem;
+	uint64_t n;
+	uint32_t r;
+} php_crypto_scrypt_lanes;
+
+#define PHP_CRYPTO_SCRYPT_ROTL(a, b) (((a) << (b)) | ((a) >> (32 - (b))))
+
+/* {{{ php_crypto_scrypt_salsa208 */
+static void php_crypto_scrypt_salsa208(uint32_t b[16])
+{
+	uint32_t x[16];
+	int i;
+
+	memcpy(x, b, sizeof(x));
+	for (i = 8; i > 0; i -= 2) {
+		x[4] ^= PHP_CRYPTO_SCRYPT_ROTL(x[0] + x[12], 7);
+		x[8] ^= PHP_CRYPTO_SCRYPT_ROTL(x[4] + x[0], 9);
+		x[12] ^= PHP_CRYPTO_SCRYPT_ROTL(x[8] + x[4], 13);
+		x[0] ^= PHP_CRYPTO_SCRYPT_ROTL(x[12] + x[8], 18);
+		x[9] ^= PHP_CRYPTO_SCRYPT_ROTL(x[5] + x[1], 7);
+		x[13] ^= PHP_CRYPTO_SCRYPT_ROTL(x[9] + x[5], 9);
+		x[1] ^= PHP_CRYPTO_SCRYPT_ROTL(x[13] + x[9], 13);
+		x[5] ^= PHP_CRYPTO_SCRYPT_ROTL(x[1] + x[13], 18);
+		x[14] ^= PHP_CRYPTO_SCRYPT_ROTL(x[10] + x[6], 7);
+		x[2] ^= PHP_CRYPTO_SCRYPT_ROTL(x[14] + x[10], 9);
+		x[6] ^= PHP_CRYPTO_SCRYPT_ROTL(x[2] + x[14], 13);
+		x[10] ^= PHP_CRYPTO_SCRYPT_ROTL(x[6] + x[2], 18);
+		x[3] ^= PHP_CRYPTO_SCRYPT_ROTL(x[15] + x[11], 7);
+		x[7] ^= PHP_CRYPTO_SCRYPT_ROTL(x[3] + x[15], 9);
+		x[11] ^= PHP_CRYPTO_SCRYPT_ROTL(x[7] + x[3], 13);
+		x[15] ^= PHP_CRYPTO_SCRYPT_ROTL(x[11] + x[7], 18);
+		x[1] ^= PHP_CRYPTO_SCRYPT_ROTL(x[0] + x[3], 7);
+		x[2] ^= PHP_CRYPTO_SCRYPT_ROTL(x[1] + x[0], 9);
+		x[3] ^= PHP_CRYPTO_SCRYPT_ROTL(x[2] + x[1], 13);
+		x[0] ^= PHP_CRYPTO_SCRYPT_ROTL(x[3] + x[2], 18);
+		x[6] ^= PHP_CRYPTO_SCRYPT_ROTL(x[5] + x[4], 7);
+		x[7] ^= PHP_CRYPTO_SCRYPT_ROTL(x[6] + x[5], 9);
+		x[4] ^= PHP_CRYPTO_SCRYPT_ROTL(x[7] + x[6], 13);
+		x[5] ^= PHP_CRYPTO_SCRYPT_ROTL(x[4] + x[7], 18);
+		x[11] ^= PHP_CRYPTO_SCRYPT_ROTL(x[10] + x[9], 7);
+		x[8] ^= PHP_CRYPTO_SCRYPT_ROTL(x[11] + x[10], 9);
+		x[9] ^= PHP_CRYPTO_SCRYPT_ROTL(x[8] + x[11], 13);
+		x[10] ^= PHP_CRYPTO_SCRYPT_ROTL(x[9] + x[8], 18);
+		x[12] ^= PHP_CRYPTO_SCRYPT_ROTL(x[15] + x[14], 7);
+		x[13] ^= PHP_CRYPTO_SCRYPT_ROTL(x[12] + x[15], 9);
+		x[14] ^= PHP_CRYPTO_SCRYPT_ROTL(x[13] + x[12], 13);
+		x[15] ^= PHP_CRYPTO_SCRYPT_ROTL(x[14] + x[13], 18);
+	}
+	for (i = 0; i < 16; i++) {
+		b[i] += x[i];
+	}
+}
+/* }}} */
+
+/* {{{ php_crypto_scrypt_block_mix */
+static void php_crypto_scrypt_block_mix(uint32_t *out, const uint32_t *in, uint32_t r)
+{
+	uint32_t x[16];
+	uint32_t i, j;
+
+	memcpy(x, in + (2 * r - 1) * 16, sizeof(x));
+
+	/* even blocks go to the first half and odd blocks to the second half */
+	for (i = 0; i < 2 * r; i++) {
+		for (j = 0; j < 16; j++) {
+			x[j] ^= in[i * 16 + j];
+		}
+		php_crypto_scrypt_salsa208(x);
+		memcpy(out + ((i / 2) + (i & 1) * r) * 16, x, sizeof(x));
+	}
+}
+/* }}} */
+
+/* {{{ php_crypto_scrypt_romix */
+static void php_crypto_scrypt_romix(unsigned char *b, uint64_t n, uint32_t r, uint32_t *mem)
+{
+	uint64_t i, j;
+	uint32_t k, words = 32 * r;
+	uint32_t *v = mem, *x = mem + words * n, *t = x + words, *pv;
+	unsigned char *pb;
+
+	/* load little endian words */
+	for (k = 0, pb = b; k < words; k++, pb += 4) {
+		x[k] = pb[0] | (pb[1] << 8) | (pb[2] << 16) | ((uint32_t) pb[3] << 24);
+	}
+
+	for (i = 0, pv = v; i < n; i++, pv += words) {
+		memcpy(pv, x, words * sizeof(uint32_t));
+		php_crypto_scrypt_block_mix(x, pv, r);
+	}
+
+	for (i = 0; i < n; i++) {
+		/* integerify */
+		j = (x[words - 16] | ((uint64_t) x[words - 15] << 32)) & (n - 1);
+		pv = v + j * words;
+		for (k = 0; k < words; k++) {
+			t[k] = x[k] ^ pv[k];
+		}
+		php_crypto_scrypt_block_mix(x, t, r);
+	}
+
+	/* store little endian words */
+	for (k = 0, pb = b; k < words; k++) {
+		*pb++ = x[k] & 0xff;
+		*pb++ = (x[k] >> 8) & 0xff;
+		*pb++ = (x[k] >> 16) & 0xff;
+		*pb++ = (x[k] >> 24) & 0xff;
+	}
+}
+/* }}} */
+
+/* {{{ php_crypto_scrypt_lane */
+static void php_crypto_scrypt_lane(void *data, int worker, int item)
+{
+	php_crypto_scrypt_lanes *lanes = (php_crypto_scrypt_lanes *) data;
+	uint32_t *mem = lanes->mem + (size_t) worker * 32 * lanes->r * (lanes->n + 2);
+
+	php_crypto_scrypt_romix(lanes->b + (size_t) item * 128 * lanes->r,
+			lanes->n, lanes->r, mem);
+}
+/* }}} */
+
+/* {{{ php_crypto_scrypt */
+PHP_CRYPTO_API int php_crypto_scrypt(
+		const char *pass, int pass_len, const unsigned char *salt, int salt_len,
+		uint64_t n, uint32_t r, uint32_t p, int lanes,
+		unsigned char *key, int key_len)
+{
+	php_crypto_scrypt_lanes data;
+	int b_len = (int) PHP_CRYPTO_SCRYPT_BLOCK_MEMORY(r, p);
+	size_t mem_len;
+	int rc = FAILURE;
+
+	if (lanes < 1) {
+		lanes = 1;
+	}
+
+	data.n = n;
+	data.r = r;
+	data.b = emalloc(b_len);
+	mem_len = (size_t) lanes * PHP_CRYPTO_SCRYPT_LANE_MEMORY(n, r);
+	data.mem = emalloc(mem_len);
+
+	if (PKCS5_PBKDF2_HMAC(pass, pass_len, salt, salt_len, 1,
+				EVP_sha256(), b_len, data.b)) {
+		php_crypto_thread_run(php_crypto_scrypt_lane, &data, (int) p, lanes);
+		if (PKCS5_PBKDF2_HMAC(pass, pass_len, data.b, b_len, 1,
+					EVP_sha256(), key_len, key)) {
+			rc = SUCCESS;
+		}
+	}
+
+	OPENSSL_cleanse(data.b, b_len);
+	efree(data.b);
+	/* the V blocks are derived from the password */
+	OPENSSL_cleanse(data.mem, mem_len);
+	efree(data.mem);
+
+	return rc;
+}
+/* }}} */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
@@ -16,15 +16,41 @@
   +----------------------------------------------------------------------+
 */
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #include "php.h"
 #include "php_crypto.h"
 #include "php_crypto_stream.h"
 #include "php_crypto_cipher.h"
 #include "php_crypto_hash.h"
+#include "php_crypto_rand.h"
+#include "php_crypto_thread.h"
+#include "php_crypto_uring.h"
+#include "php_crypto_compress.h"
+#include "SAPI.h"
 
 #include <openssl/bio.h>
 #include <openssl/evp.h>
 
+#if defined(HAVE_SYS_MMAN_H) && defined(HAVE_MMAP)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define PHP_CRYPTO_STREAM_HAS_MMAP 1
+#endif
+
+#ifndef PHP_WIN32
+#include <fcntl.h>
+#endif
+
+#ifdef HAVE_SYS_UN_H
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#define PHP_CRYPTO_STREAM_HAS_SOCKET 1
+#endif
+
 PHP_CRYPTO_ERROR_INFO_BEGIN(Stream)
 PHP_CRYPTO_ERROR_INFO_ENTRY(
 	SEEK_OPERATION_FORBIDDEN,
@@ -121,258 +147,1792 @@ PHP_CRYPTO_ERROR_INFO_ENTRY_EX(
 	"The cipher AAD is useful only for authenticated mode",
 	E_NOTICE
 )
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	FILTER_PARAMS_TYPE_INVALID,
+	"The filter parameters have to be an array"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	FILTER_PARAM_TYPE_INVALID,
+	"The filter parameter '%s' has to be an integer"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	FILTER_BASE64_WRAP_INVALID,
+	"The base64 filter wrap has to be 0, 64 or 76"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	FILTER_BASE64_ALPHABET_INVALID,
+	"Unknown base64 filter alphabet"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	FILTER_BASE64_DECODE_FAILED,
+	"The base64 filter input is not valid base64 data"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	FILTER_HEX_DECODE_FAILED,
+	"The hex filter input is not valid hex data"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	CIPHER_INIT_FAILED,
+	"The cipher initialization failed"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	FILTER_CIPHER_UPDATE_FAILED,
+	"The cipher filter update failed"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	FILTER_CIPHER_FINISH_FAILED,
+	"The cipher filter finalization failed"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	CIPHER_SEEKABLE_MODE_INVALID,
+	"The seekable cipher filter requires CTR mode"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	CIPHER_SEEKABLE_NOT_ALONE,
+	"The seekable cipher filter has to be the only filter"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	SEEK_OFFSET_INVALID,
+	"The seek offset is out of the file range"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	CIPHER_AAD_TYPE_INVALID,
+	"The cipher AAD has to be a string"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	SEGMENT_MODE_INVALID,
+	"The aead filter requires GCM or OCB mode"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	SEGMENT_NOT_ALONE,
+	"The aead filter has to be the only filter"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	SEGMENT_SIZE_INVALID,
+	"The aead filter segment size has to be between %d and %d bytes"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	SEGMENT_HEADER_INVALID,
+	"The aead stream header is invalid"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	SEGMENT_WRITE_FAILED,
+	"The aead stream segment write failed"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	SEGMENT_AUTH_FAILED,
+	"The aead stream segment authentication failed"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	SEGMENT_LIMIT_EXCEEDED,
+	"The aead stream segments limit exceeded"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	SEGMENT_SEEK_FORBIDDEN,
+	"Seeking is not allowed in the aead stream"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	SEGMENT_THREADS_INVALID,
+	"The aead filter threads has to be between 0 and %d"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	BUFFER_SIZE_INVALID,
+	"The buffer size has to be an integer between %d and %d bytes"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	FILE_READ_FAILED,
+	"The crypto stream file read failed"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	FILE_WRITE_FAILED,
+	"The crypto stream file write failed"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	MEMORY_FILTER_UNSUPPORTED,
+	"The seekable cipher and aead decryption are not supported in the memory stream"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	MEMORY_WRITE_FINISHED,
+	"The memory stream cannot be written after it is read"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	MEMORY_SPILL_FAILED,
+	"The temp stream file creation failed"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	TEMP_MAX_MEMORY_INVALID,
+	"The temp stream max memory has to be a non-negative integer"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	CIPHER_SEEKABLE_FILE_REQUIRED,
+	"The seekable cipher filter requires the crypto.file stream"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	FD_NOT_ALLOWED,
+	"Direct access to file descriptors is only available from command-line PHP"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	FD_INVALID,
+	"The file descriptor '%s' is not valid"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	SOCKET_PATH_INVALID,
+	"The socket path is too long"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	SOCKET_CONNECT_FAILED,
+	"The socket connection to '%s' failed: %s"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	COMPRESS_NOT_FIRST,
+	"The compress filter has to be the first filter"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	COMPRESS_ALGORITHM_TYPE_INVALID,
+	"The compress algorithm has to be a string"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	COMPRESS_ALGORITHM_UNKNOWN,
+	"The compress algorithm '%s' is not supported"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	COMPRESS_MODE_INVALID,
+	"The compress filter cannot be used for reading and writing at once"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	COMPRESS_INIT_FAILED,
+	"The compress filter initialization failed"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	COMPRESS_FAILED,
+	"The stream data compression failed"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	COMPRESS_DATA_INVALID,
+	"The compressed stream data are invalid"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	COMPRESS_SEEK_FORBIDDEN,
+	"Seeking is not allowed in the compressed stream"
+)
+PHP_CRYPTO_ERROR_INFO_ENTRY(
+	CIPHER_UPDATE_FAILED,
+	"The crypto stream cipher update failed"
+)
 PHP_CRYPTO_ERROR_INFO_END()
 
 ZEND_EXTERN_MODULE_GLOBALS(crypto)
 
+/* segmented AEAD stream state */
+typedef struct {
+	EVP_CIPHER_CTX *ctx;
+	const php_crypto_cipher_mode *mode;
+	unsigned char header[PHP_CRYPTO_STREAM_SEGMENT_HEADER_SIZE];
+	unsigned char *aad;
+	int aad_len;
+	/* filter key kept for decryption until the header salt is read */
+	unsigned char *key;
+	int key_len;
+	/* plain segment for encryption or sealed segment with one look ahead byte
+	 * for decryption (the plain data are then decrypted in place) */
+	unsigned char *buf;
+	size_t segment_size;
+	size_t buf_len;
+	size_t buf_pos;
+	uint32_t index;
+	int enc;
+	/* pipelined writer - the buf is owned by the pipeline and the segments
+	 * are sealed by workers using their own contexts */
+	php_crypto_thread_pipeline *pipeline;
+	EVP_CIPHER_CTX **worker_ctx;
+	int workers;
+	zend_bool header_done;
+	zend_bool has_next;
+	zend_bool done;
+} php_crypto_stream_segmented;
+
+/* mapped file of the read only stream (it is mapped in windows) */
+typedef struct {
+	unsigned char *addr;
+	size_t addr_len;
+	uint64_t addr_offset;
+	uint64_t size;
+	uint64_t pos;
+	size_t page_size;
+	int fd;
+} php_crypto_stream_mmap;
+
+/* compression of the plain data (it is done before the filters on write
+ * and after them on read) */
+typedef struct {
+	php_crypto_compress *ctx;
+	/* compressed output for writing or compressed input for reading */
+	unsigned char *buf;
+	size_t buf_len;
+	size_t buf_pos;
+	zend_bool enc;
+	zend_bool done;
+	zend_bool raw_eof;
+} php_crypto_stream_compress;
+
 /* crypto stream data */
 typedef struct {
 	BIO *bio;
 	zend_bool auth_enc;
 	zend_bool is_encrypting;
+	/* seekable CTR mode (the bio is the file BIO and the data are encrypted here) */
+	EVP_CIPHER_CTX *seekable_ctx;
+	unsigned char seekable_iv[EVP_MAX_IV_LENGTH];
+	/* segmented AEAD mode (the bio is the file BIO) */
+	php_crypto_stream_segmented *segmented;
+	/* stdio buffer of the file allocated by emalloc (it is freed after the file is closed) */
+	void *buffer;
+	/* mmap read path (the file is read from the mapping instead of the bio) */
+	php_crypto_stream_mmap *map;
+	/* io_uring backend (the file is read or written by the ring instead of the bio) */
+	php_crypto_uring *uring;
+	/* memory sink at the end of the bio chain of the memory and temp streams
+	 * (the data written through the filters are then read back from it) */
+	BIO *sink;
+	size_t sink_pos;
+	size_t sink_size;
+	/* memory size limit after which the sink is moved to a temp file */
+	size_t spill_size;
+	zend_bool sink_done;
+	/* compression stage */
+	php_crypto_stream_compress *compress;
 } php_crypto_stream_data;
 
-/* {{{ php_crypto_stream_write */
-static size_t php_crypto_stream_write(php_stream *stream,
-		const char *buf, size_t count TSRMLS_DC)
+/* {{{ php_crypto_stream_mmap_free */
+static void php_crypto_stream_mmap_free(php_crypto_stream_mmap *map)
 {
-	php_crypto_stream_data *data = (php_crypto_stream_data *) stream->abstract;
-	int bytes_written = BIO_write(data->bio, buf, count > INT_MAX ? INT_MAX : count);
-
-	return bytes_written <= 0 ? 0 : (size_t) bytes_written;
+#ifdef PHP_CRYPTO_STREAM_HAS_MMAP
+	if (map->addr) {
+		munmap(map->addr, map->addr_len);
+	}
+#endif
+	efree(map);
 }
 /* }}} */
 
-/* {{{ php_crypto_stream_auth_get_first_bio */
-static int php_crypto_stream_auth_get_first_bio(
-		BIO *bio, BIO **p_auth_bio, EVP_CIPHER_CTX **p_cipher_ctx)
-{
-	while (bio && (bio = BIO_find_type(bio, BIO_TYPE_CIPHER))) {
-		EVP_CIPHER_CTX *cipher_ctx;
-		const php_crypto_cipher_mode *mode;
+#ifdef PHP_CRYPTO_STREAM_HAS_MMAP
 
-		BIO_get_cipher_ctx(bio, &cipher_ctx);
-		mode = php_crypto_get_cipher_mode(EVP_CIPHER_CTX_cipher(cipher_ctx));
-		if (mode->auth_enc) {
-			*p_cipher_ctx = cipher_ctx;
-			*p_auth_bio = bio;
+/* {{{ php_crypto_stream_mmap_window
+	Returns pointer to len bytes at the current position. If partial is set
+	then the bytes remaining in the current window are returned. */
+static int php_crypto_stream_mmap_window(php_crypto_stream_mmap *map,
+		size_t need, zend_bool partial, unsigned char **ptr, size_t *len)
+{
+	uint64_t start;
+	size_t window;
+	void *addr;
+	struct stat st;
 
+	if (map->pos >= map->size) {
+		need = 0;
+	} else if (need > map->size - map->pos) {
+		need = (size_t) (map->size - map->pos);
+	}
+	*len = need;
+	if (need == 0) {
+		*ptr = NULL;
+		return SUCCESS;
+	}
+	if (map->addr && map->pos >= map->addr_offset &&
+			map->pos < map->addr_offset + map->addr_len) {
+		window = (size_t) (map->addr_offset + map->addr_len - map->pos);
+		if (need <= window || partial) {
+			*ptr = map->addr + (map->pos - map->addr_offset);
+			*len = need <= window ? need : window;
 			return SUCCESS;
 		}
-		bio = BIO_next(bio);
 	}
 
-	return FAILURE;
-}
-/* }}} */
+	/* map the window starting at the page of the current position */
+	if (map->addr) {
+		munmap(map->addr, map->addr_len);
+		map->addr = NULL;
+	}
+	/* the file can be truncated after it was opened and the pages past its end
+	 * raise SIGBUS so the size is checked again before each new window */
+	if (fstat(map->fd, &st) == 0 && (uint64_t) st.st_size < map->size) {
+		map->size = (uint64_t) st.st_size;
+		if (map->pos >= map->size) {
+			*ptr = NULL;
+			*len = 0;
+			return SUCCESS;
+		}
+		if (need > map->size - map->pos) {
+			need = (size_t) (map->size - map->pos);
+			*len = need;
+		}
+	}
+	start = map->pos - map->pos % map->page_size;
+	window = PHP_CRYPTO_STREAM_MMAP_WINDOW;
+	if (window < need + (size_t) (map->pos - start)) {
+		window = need + (size_t) (map->pos - start);
+	}
+	if (window > map->size - start) {
+		window = (size_t) (map->size - start);
+	}
+	addr = mmap(NULL, window, PROT_READ, MAP_SHARED, map->fd, (off_t) start);
+	if (addr == MAP_FAILED) {
+		return FAILURE;
+	}
+#if defined(HAVE_MADVISE) && defined(MADV_SEQUENTIAL)
+	madvise(addr, window, MADV_SEQUENTIAL);
+#endif
+	map->addr = (unsigned char *) addr;
+	map->addr_len = window;
+	map->addr_offset = start;
+	*ptr = map->addr + (map->pos - start);
 
-/* {{{ php_crypto_stream_create_meta_field */
-static void inline php_crypto_stream_create_meta_field(
-		char *out, const char *key, const char *value)
-{
-	char *ptr;
-	strcpy(out, key);
-	ptr = out + strlen(key);
-	memcpy(ptr,  ": ", 2);
-	strcpy(ptr + 2, value);
+	return SUCCESS;
 }
 /* }}} */
 
-/* {{{ php_crypto_stream_auth_save_tag */
-static void php_crypto_stream_set_meta(php_stream *stream,
-		const char *key, const char *value)
+/* {{{ php_crypto_stream_mmap_read
+	Copies or decrypts (seekable CTR) data directly from the mapping. If the
+	file cannot be mapped, it returns FAILURE and the bio is used instead. */
+static int php_crypto_stream_mmap_read(php_stream *stream,
+		php_crypto_stream_data *data, char *buf, size_t count, size_t *bytes_read TSRMLS_DC)
 {
-	PHPC_STR_DECLARE(header);
-	size_t len = strlen(key) + strlen(value) + 2;
-	zval *p_wrapper;
+	php_crypto_stream_mmap *map = data->map;
+	unsigned char *ptr;
+	size_t len;
+	int outl;
 
-	if (PHPC_STREAM_WRAPPERDATA_ISSET(stream) && PHPC_TYPE(stream->wrapperdata) != IS_ARRAY) {
-		PHPC_STREAM_WRAPPERDATA_UNSET(stream);
+	*bytes_read = 0;
+	if (count > INT_MAX) {
+		count = INT_MAX;
 	}
-	if (PHPC_STREAM_WRAPPERDATA_ISSET(stream)) {
-		phpc_val *ppv_wrapperdata_item;
+	if (php_crypto_stream_mmap_window(map, count, 1, &ptr, &len) == FAILURE) {
+		if (BIO_ctrl(data->bio, BIO_C_FILE_SEEK, (long) map->pos, NULL) < 0) {
+			stream->eof = 1;
+			return SUCCESS;
+		}
+		php_crypto_stream_mmap_free(map);
+		data->map = NULL;
+		return FAILURE;
+	}
+	if (len == 0) {
+		stream->eof = 1;
+		return SUCCESS;
+	}
+	if (data->seekable_ctx) {
+		if (!EVP_CipherUpdate(data->seekable_ctx, (unsigned char *) buf, &outl, ptr, (int) len)) {
+			/* the cipher state is unknown so nothing more can be read */
+			php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_UPDATE_FAILED));
+			stream->eof = 1;
+			return SUCCESS;
+		}
+	} else {
+		memcpy(buf, ptr, len);
+	}
+	map->pos += len;
+	*bytes_read = len;
 
-		PHPC_HASH_FOREACH_VAL(PHPC_ARRVAL(stream->wrapperdata), ppv_wrapperdata_item) {
-			if (PHPC_TYPE_P(ppv_wrapperdata_item) == IS_STRING &&
-				(size_t) PHPC_STRLEN_P(ppv_wrapperdata_item) > strlen(key) &&
-				!strncmp(PHPC_STRVAL_P(ppv_wrapperdata_item), key, strlen(key))
-			) {
-				if (len != (size_t) PHPC_STRLEN_P(ppv_wrapperdata_item)) {
-					PHPC_STR_DECLARE(item);
+	return SUCCESS;
+}
+/* }}} */
 
-					PHPC_STR_INIT(item,
-							PHPC_STRVAL_P(ppv_wrapperdata_item),
-							PHPC_STRLEN_P(ppv_wrapperdata_item));
-					zval_ptr_dtor(ppv_wrapperdata_item);
-					PHPC_VAL_STR(*ppv_wrapperdata_item, item);
-				}
-				php_crypto_stream_create_meta_field(
-						PHPC_STRVAL_P(ppv_wrapperdata_item), key, value);
-				return;
-			}
+#endif
 
-		} PHPC_HASH_FOREACH_END();
 
-		PHPC_VAL_TO_PZVAL(stream->wrapperdata, p_wrapper);
+/* {{{ php_crypto_stream_uring_read
+	Copies or decrypts (seekable CTR) data directly from the ring buffer */
+static size_t php_crypto_stream_uring_read(php_stream *stream,
+		php_crypto_stream_data *data, char *buf, size_t count TSRMLS_DC)
+{
+	unsigned char *ptr;
+	size_t len;
+	int outl;
+
+	if (count > INT_MAX) {
+		count = INT_MAX;
+	}
+	if (php_crypto_uring_read(data->uring, count, &ptr, &len) == FAILURE) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(FILE_READ_FAILED));
+		stream->eof = 1;
+		return 0;
+	}
+	if (len == 0) {
+		stream->eof = 1;
+		return 0;
+	}
+	if (data->seekable_ctx) {
+		if (!EVP_CipherUpdate(data->seekable_ctx, (unsigned char *) buf, &outl, ptr, (int) len)) {
+			/* the ring data are already consumed so nothing more can be read */
+			php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_UPDATE_FAILED));
+			stream->eof = 1;
+			return 0;
+		}
 	} else {
-		PHPC_STREAM_WRAPPERDATA_ALLOC(stream);
-		PHPC_VAL_TO_PZVAL(stream->wrapperdata, p_wrapper);
-		PHPC_ARRAY_INIT(p_wrapper);
+		memcpy(buf, ptr, len);
 	}
 
-	PHPC_STR_ALLOC(header, len);
-	php_crypto_stream_create_meta_field(PHPC_STR_VAL(header), key, value);
-	PHPC_ARRAY_ADD_NEXT_INDEX_STR(p_wrapper, header);
-
+	return len;
 }
 /* }}} */
 
-/* {{{ php_crypto_stream_auth_save_tag */
-static void php_crypto_stream_auth_save_tag(php_stream *stream,
-		EVP_CIPHER_CTX *cipher_ctx TSRMLS_DC)
+/* {{{ php_crypto_stream_uring_write
+	Encrypts (seekable CTR) or copies data directly to the ring buffers */
+static size_t php_crypto_stream_uring_write(php_crypto_stream_data *data,
+		const char *buf, size_t count TSRMLS_DC)
 {
-	char hex_tag[PHP_CRYPTO_CIPHER_AUTH_TAG_LENGTH_MAX * 2 + 1];
-	unsigned char bin_tag[PHP_CRYPTO_CIPHER_AUTH_TAG_LENGTH_MAX + 1];
-	const php_crypto_cipher_mode *mode = php_crypto_get_cipher_mode(
-			EVP_CIPHER_CTX_cipher(cipher_ctx));
-	if (EVP_CIPHER_CTX_ctrl(cipher_ctx, mode->auth_get_tag_flag,
-			PHP_CRYPTO_CIPHER_AUTH_TAG_LENGTH_MAX, &bin_tag[0])) {
-		php_crypto_hash_bin2hex(&hex_tag[0], &bin_tag[0], PHP_CRYPTO_CIPHER_AUTH_TAG_LENGTH_MAX);
-		php_crypto_stream_set_meta(stream, PHP_CRYPTO_STREAM_META_AUTH_TAG, &hex_tag[0]);
-	} else {
-		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_TAG_FAILED));
+	unsigned char *dst;
+	size_t avail, written = 0;
+	int len;
+
+	while (written < count) {
+		if ((dst = php_crypto_uring_write_buffer(data->uring, &avail)) == NULL) {
+			break;
+		}
+		if (avail > count - written) {
+			avail = count - written;
+		}
+		if (data->seekable_ctx) {
+			if (!EVP_CipherUpdate(data->seekable_ctx, dst, &len,
+					(const unsigned char *) buf + written, (int) avail)) {
+				break;
+			}
+		} else {
+			memcpy(dst, buf + written, avail);
+		}
+		written += avail;
+		if (php_crypto_uring_write_commit(data->uring, avail) == FAILURE) {
+			break;
+		}
 	}
+	if (written < count) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(FILE_WRITE_FAILED));
+	}
+
+	return written;
 }
 /* }}} */
 
-/* {{{ php_crypto_stream_auth_save_result */
-static void php_crypto_stream_auth_save_result(php_stream *stream, int ok)
+/* {{{ php_crypto_stream_file_read
+	Reads raw data from the file bio or from the ring (the pipes and
+	sockets can return less data so it is read until the len or the end) */
+static int php_crypto_stream_file_read(php_crypto_stream_data *data,
+		unsigned char *buf, int len)
 {
-	php_crypto_stream_set_meta(
-			stream,
-			PHP_CRYPTO_STREAM_META_AUTH_RESULT,
-			ok ? "success" : "failure");
+	unsigned char *ptr;
+	size_t n;
+	int bytes_read, total = 0;
+
+	if (!data->uring) {
+		while (total < len && (bytes_read = BIO_read(data->bio, buf + total, len - total)) > 0) {
+			total += bytes_read;
+		}
+		return total;
+	}
+	while (total < len && php_crypto_uring_read(data->uring, (size_t) (len - total),
+			&ptr, &n) == SUCCESS && n > 0) {
+		memcpy(buf + total, ptr, n);
+		total += (int) n;
+	}
+
+	return total;
 }
 /* }}} */
 
-/* {{{ php_crypto_stream_read */
-static size_t php_crypto_stream_read(php_stream *stream, char *buf, size_t count TSRMLS_DC)
+/* {{{ php_crypto_stream_file_write
+	Writes raw data to the file bio or to the ring */
+static int php_crypto_stream_file_write(php_crypto_stream_data *data,
+		const unsigned char *buf, int len)
 {
-	php_crypto_stream_data *data = (php_crypto_stream_data *) stream->abstract;
-	int bytes_read = BIO_read(data->bio, buf, count > INT_MAX ? INT_MAX : count);
-	if (bytes_read > 0) {
-		return (size_t) bytes_read;
-	}
-	stream->eof = !BIO_should_retry(data->bio);
-	if (data->auth_enc && stream->eof) {
-		EVP_CIPHER_CTX *cipher_ctx;
-		BIO *auth_bio;
-		if (php_crypto_stream_auth_get_first_bio(data->bio, &auth_bio, &cipher_ctx) == SUCCESS) {
-			if (data->is_encrypting) {
-				/* encryption - save auth tag */
-				php_crypto_stream_auth_save_tag(stream, cipher_ctx TSRMLS_CC);
-			} else {
-				/* decryption - save auth result */
-				int ok = (int) BIO_ctrl(auth_bio, BIO_C_GET_CIPHER_STATUS, 0, NULL);
-				php_crypto_stream_auth_save_result(stream, ok);
-			}
-		}
+	if (!data->uring) {
+		return BIO_write(data->bio, buf, len);
 	}
-	return 0;
+
+	return php_crypto_uring_write(data->uring, buf, (size_t) len) == SUCCESS ? len : -1;
 }
 /* }}} */
 
-/* {{{ php_crypto_stream_close */
-static int php_crypto_stream_close(php_stream *stream, int close_handle TSRMLS_DC)
+/* {{{ php_crypto_stream_seekable_set_offset
+	Sets the CTR counter so the key stream continues at the supplied offset */
+static int php_crypto_stream_seekable_set_offset(php_crypto_stream_data *data,
+		phpc_off_t offset)
 {
-	php_crypto_stream_data *data = (php_crypto_stream_data *) stream->abstract;
-	BIO_free_all(data->bio);
+	EVP_CIPHER_CTX *cipher_ctx = data->seekable_ctx;
+	unsigned char iv[EVP_MAX_IV_LENGTH], skip[EVP_MAX_IV_LENGTH];
+	int i, len, iv_len = EVP_CIPHER_CTX_iv_length(cipher_ctx);
+	uint64_t counter = (uint64_t) offset / iv_len;
+
+	/* add the block index to the big endian counter in the IV */
+	memcpy(iv, data->seekable_iv, iv_len);
+	for (i = iv_len - 1; i >= 0 && counter; i--) {
+		counter += iv[i];
+		iv[i] = (unsigned char) counter;
+		counter >>= 8;
+	}
+	if (!EVP_CipherInit_ex(cipher_ctx, NULL, NULL, NULL, iv, -1)) {
+		return FAILURE;
+	}
+
+	/* skip the key stream bytes before offset in the block */
+	len = (int) ((uint64_t) offset % iv_len);
+	if (len > 0) {
+		memset(skip, 0, len);
+		if (!EVP_CipherUpdate(cipher_ctx, skip, &len, skip, len)) {
+			return FAILURE;
+		}
+		OPENSSL_cleanse(skip, sizeof(skip));
+	}
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_seekable_write */
+static size_t php_crypto_stream_seekable_write(php_crypto_stream_data *data,
+		const char *buf, size_t count)
+{
+	unsigned char chunk[PHP_CRYPTO_STREAM_SEEKABLE_CHUNK_SIZE];
+	size_t written = 0;
+	int len, bytes_written;
+
+	while (written < count) {
+		len = count - written > sizeof(chunk) ? sizeof(chunk) : (int) (count - written);
+		if (!EVP_CipherUpdate(data->seekable_ctx, chunk, &len,
+				(const unsigned char *) buf + written, len)) {
+			break;
+		}
+		bytes_written = BIO_write(data->bio, chunk, len);
+		if (bytes_written > 0) {
+			written += bytes_written;
+		}
+		if (bytes_written != len) {
+			/* the key stream has to follow the file position */
+			php_crypto_stream_seekable_set_offset(data,
+					(phpc_off_t) BIO_ctrl(data->bio, BIO_C_FILE_TELL, 0, NULL));
+			break;
+		}
+	}
+	OPENSSL_cleanse(chunk, sizeof(chunk));
+
+	return written;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_segment_crypt
+	Seals (encryption) or opens (decryption) one segment. The sealed segment
+	is the data followed by the tag. It does not use any PHP API. */
+static int php_crypto_stream_segment_crypt(php_crypto_stream_segmented *seg,
+		EVP_CIPHER_CTX *cipher_ctx, uint32_t index, zend_bool last,
+		unsigned char *out, const unsigned char *in, int inl)
+{
+	unsigned char nonce[PHP_CRYPTO_STREAM_SEGMENT_NONCE_SIZE];
+	unsigned char *tag = (seg->enc ? out : (unsigned char *) in) + inl;
+	int len;
+
+	/* nonce is prefix || big endian index || last segment flag */
+	memcpy(nonce, seg->header + PHP_CRYPTO_STREAM_SEGMENT_HEADER_SIZE -
+			PHP_CRYPTO_STREAM_SEGMENT_NONCE_PREFIX_SIZE, PHP_CRYPTO_STREAM_SEGMENT_NONCE_PREFIX_SIZE);
+	nonce[7] = (unsigned char) (index >> 24);
+	nonce[8] = (unsigned char) (index >> 16);
+	nonce[9] = (unsigned char) (index >> 8);
+	nonce[10] = (unsigned char) index;
+	nonce[11] = last ? 1 : 0;
+
+	if (!EVP_CipherInit_ex(cipher_ctx, NULL, NULL, NULL, nonce, seg->enc)) {
+		return FAILURE;
+	}
+	/* the header is authenticated in every segment */
+	if (!EVP_CipherUpdate(cipher_ctx, NULL, &len, seg->header, sizeof(seg->header)) ||
+			(seg->aad_len && !EVP_CipherUpdate(cipher_ctx, NULL, &len, seg->aad, seg->aad_len))) {
+		return FAILURE;
+	}
+	if (!seg->enc && !EVP_CIPHER_CTX_ctrl(cipher_ctx, seg->mode->auth_set_tag_flag,
+			PHP_CRYPTO_STREAM_SEGMENT_TAG_SIZE, tag)) {
+		return FAILURE;
+	}
+	if ((inl && !EVP_CipherUpdate(cipher_ctx, out, &len, in, inl)) ||
+			!EVP_CipherFinal_ex(cipher_ctx, out + inl, &len)) {
+		return FAILURE;
+	}
+	if (seg->enc && !EVP_CIPHER_CTX_ctrl(cipher_ctx, seg->mode->auth_get_tag_flag,
+			PHP_CRYPTO_STREAM_SEGMENT_TAG_SIZE, tag)) {
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_segmented_set_key
+	Keys the context with the stream key derived from the filter key and the
+	header salt by HKDF-SHA256 so the nonces are never repeated under one key */
+static int php_crypto_stream_segmented_set_key(php_crypto_stream_segmented *seg,
+		const unsigned char *key, int key_len)
+{
+	static const unsigned char info[] = PHP_CRYPTO_STREAM_SEGMENT_KEY_INFO;
+	unsigned char prk[EVP_MAX_MD_SIZE], t[EVP_MAX_MD_SIZE], counter;
+	unsigned char stream_key[EVP_MAX_KEY_LENGTH];
+	unsigned int prk_len, t_len = 0;
+	int done = 0, n, rc;
+	HMAC_CTX *hmac_ctx;
+
+	if (key_len > EVP_MAX_KEY_LENGTH || !(hmac_ctx = HMAC_CTX_new())) {
+		return FAILURE;
+	}
+	/* PRK = HMAC(salt, key) and T(i) = HMAC(PRK, T(i - 1) | info | i) */
+	rc = HMAC_Init_ex(hmac_ctx, seg->header + PHP_CRYPTO_STREAM_SEGMENT_SALT_OFFSET,
+				PHP_CRYPTO_STREAM_SEGMENT_SALT_SIZE, EVP_sha256(), NULL) &&
+			HMAC_Update(hmac_ctx, key, key_len) &&
+			HMAC_Final(hmac_ctx, prk, &prk_len) &&
+			HMAC_Init_ex(hmac_ctx, prk, prk_len, EVP_sha256(), NULL);
+	for (counter = 1; rc && done < key_len; counter++) {
+		rc = HMAC_Init_ex(hmac_ctx, NULL, 0, NULL, NULL) &&
+				HMAC_Update(hmac_ctx, t, t_len) &&
+				HMAC_Update(hmac_ctx, info, sizeof(info) - 1) &&
+				HMAC_Update(hmac_ctx, &counter, 1) &&
+				HMAC_Final(hmac_ctx, t, &t_len);
+		if (!rc) {
+			break;
+		}
+		n = key_len - done < (int) t_len ? key_len - done : (int) t_len;
+		memcpy(stream_key + done, t, n);
+		done += n;
+	}
+	rc = rc && EVP_CipherInit_ex(seg->ctx, NULL, NULL, stream_key, NULL, seg->enc);
+	HMAC_CTX_free(hmac_ctx);
+	OPENSSL_cleanse(prk, sizeof(prk));
+	OPENSSL_cleanse(t, sizeof(t));
+	OPENSSL_cleanse(stream_key, sizeof(stream_key));
+
+	return rc ? SUCCESS : FAILURE;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_segmented_process
+	Seals the segment in the pipeline worker */
+static int php_crypto_stream_segmented_process(void *ptr, int worker,
+		unsigned char *buf, int len, uint32_t index, int last)
+{
+	php_crypto_stream_segmented *seg = ((php_crypto_stream_data *) ptr)->segmented;
+
+	if (php_crypto_stream_segment_crypt(seg, seg->worker_ctx[worker], index, last,
+			buf, buf, len) == FAILURE) {
+		return -1;
+	}
+
+	return len + PHP_CRYPTO_STREAM_SEGMENT_TAG_SIZE;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_segmented_output
+	Writes the sealed segment in the pipeline I/O thread */
+static int php_crypto_stream_segmented_output(void *ptr, const unsigned char *buf, int len)
+{
+	php_crypto_stream_data *data = (php_crypto_stream_data *) ptr;
+
+	return BIO_write(data->bio, buf, len) == len ? SUCCESS : FAILURE;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_segmented_submit
+	Passes the filled segment to the pipeline and gets the next buffer */
+static int php_crypto_stream_segmented_submit(php_crypto_stream_data *data,
+		zend_bool last TSRMLS_DC)
+{
+	php_crypto_stream_segmented *seg = data->segmented;
+	int rc = php_crypto_thread_pipeline_submit(seg->pipeline, (int) seg->buf_len, last);
+
+	seg->index++;
+	seg->buf_len = 0;
+	if (last) {
+		/* all segments are written when the pipeline is destroyed */
+		if (php_crypto_thread_pipeline_destroy(seg->pipeline) == FAILURE) {
+			rc = FAILURE;
+		}
+		seg->pipeline = NULL;
+		seg->buf = NULL;
+	} else if (rc == SUCCESS) {
+		/* it waits if the workers or the I/O are behind */
+		seg->buf = php_crypto_thread_pipeline_get(seg->pipeline);
+	}
+	seg->done = last;
+	if (rc == FAILURE) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(SEGMENT_WRITE_FAILED));
+		seg->done = 1;
+	}
+
+	return rc;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_segmented_drain
+	Waits until the pipelined segments are written so the file can be used */
+static void php_crypto_stream_segmented_drain(php_crypto_stream_data *data)
+{
+	if (data->segmented && data->segmented->pipeline) {
+		php_crypto_thread_pipeline_drain(data->segmented->pipeline);
+	}
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_segmented_seal */
+static int php_crypto_stream_segmented_seal(php_crypto_stream_data *data,
+		zend_bool last TSRMLS_DC)
+{
+	php_crypto_stream_segmented *seg = data->segmented;
+	int len = (int) seg->buf_len + PHP_CRYPTO_STREAM_SEGMENT_TAG_SIZE;
+
+	/* the index must not wrap as the nonce would be reused */
+	if (seg->index == UINT32_MAX && !last) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(SEGMENT_LIMIT_EXCEEDED));
+		seg->done = 1;
+		return FAILURE;
+	}
+	if (seg->pipeline) {
+		return php_crypto_stream_segmented_submit(data, last TSRMLS_CC);
+	}
+	if (php_crypto_stream_segment_crypt(seg, seg->ctx, seg->index, last,
+				seg->buf, seg->buf, (int) seg->buf_len) == FAILURE ||
+			php_crypto_stream_file_write(data, seg->buf, len) != len) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(SEGMENT_WRITE_FAILED));
+		seg->done = 1;
+		return FAILURE;
+	}
+	seg->index++;
+	seg->buf_len = 0;
+	seg->done = last;
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_segmented_write */
+static size_t php_crypto_stream_segmented_write(php_crypto_stream_data *data,
+		const char *buf, size_t count TSRMLS_DC)
+{
+	php_crypto_stream_segmented *seg = data->segmented;
+	size_t len, written = 0;
+
+	while (written < count && !seg->done) {
+		/* the full segment is sealed only when more data follow as it can be the last one */
+		if (seg->buf_len == seg->segment_size &&
+				php_crypto_stream_segmented_seal(data, 0 TSRMLS_CC) == FAILURE) {
+			break;
+		}
+		len = seg->segment_size - seg->buf_len;
+		if (len > count - written) {
+			len = count - written;
+		}
+		memcpy(seg->buf + seg->buf_len, buf + written, len);
+		seg->buf_len += len;
+		written += len;
+	}
+
+	return written;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_segmented_read_header */
+static int php_crypto_stream_segmented_read_header(php_crypto_stream_data *data TSRMLS_DC)
+{
+	php_crypto_stream_segmented *seg = data->segmented;
+	unsigned char *header = seg->header;
+
+	int len;
+
+#ifdef PHP_CRYPTO_STREAM_HAS_MMAP
+	if (data->map) {
+		unsigned char *ptr;
+		size_t map_len;
+
+		len = 0;
+		if (php_crypto_stream_mmap_window(data->map, sizeof(seg->header), 0,
+				&ptr, &map_len) == SUCCESS && map_len == sizeof(seg->header)) {
+			memcpy(header, ptr, map_len);
+			data->map->pos += map_len;
+			len = (int) map_len;
+		}
+	} else
+#endif
+	len = php_crypto_stream_file_read(data, header, sizeof(seg->header));
+	if (len != sizeof(seg->header) || header[0] != PHP_CRYPTO_STREAM_SEGMENT_VERSION) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(SEGMENT_HEADER_INVALID));
+		return FAILURE;
+	}
+	seg->segment_size = ((size_t) header[1] << 24) | ((size_t) header[2] << 16) |
+			((size_t) header[3] << 8) | (size_t) header[4];
+	if (seg->segment_size < PHP_CRYPTO_STREAM_SEGMENT_SIZE_MIN ||
+			seg->segment_size > PHP_CRYPTO_STREAM_SEGMENT_SIZE_MAX) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(SEGMENT_HEADER_INVALID));
+		return FAILURE;
+	}
+	if (php_crypto_stream_segmented_set_key(seg, seg->key, seg->key_len) == FAILURE) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_INIT_FAILED));
+		return FAILURE;
+	}
+	OPENSSL_cleanse(seg->key, seg->key_len);
+	efree(seg->key);
+	seg->key = NULL;
+	seg->buf = emalloc(seg->segment_size + PHP_CRYPTO_STREAM_SEGMENT_TAG_SIZE + 1);
+	seg->header_done = 1;
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_segmented_open
+	Reads and opens the next segment to the buffer */
+static int php_crypto_stream_segmented_open(php_stream *stream,
+		php_crypto_stream_data *data TSRMLS_DC)
+{
+	php_crypto_stream_segmented *seg = data->segmented;
+	unsigned char *in;
+	size_t sealed_len, len = 0;
+	zend_bool last;
+	int bytes_read;
+
+	if (!seg->header_done && php_crypto_stream_segmented_read_header(data TSRMLS_CC) == FAILURE) {
+		seg->done = 1;
+		return FAILURE;
+	}
+	sealed_len = seg->segment_size + PHP_CRYPTO_STREAM_SEGMENT_TAG_SIZE;
+
+#ifdef PHP_CRYPTO_STREAM_HAS_MMAP
+	if (data->map) {
+		/* the segment is opened directly from the mapped pages */
+		last = data->map->size - data->map->pos <= sealed_len;
+		if (php_crypto_stream_mmap_window(data->map, sealed_len, 0, &in, &len) == FAILURE) {
+			len = 0;
+		}
+		data->map->pos += len;
+	} else
+#endif
+	{
+		in = seg->buf;
+		/* one byte more is read to find out whether the segment is the last one */
+		if (seg->has_next) {
+			seg->buf[0] = seg->buf[sealed_len];
+			len = 1;
+		}
+		while (len < sealed_len + 1 && (bytes_read = php_crypto_stream_file_read(data,
+				seg->buf + len, (int) (sealed_len + 1 - len))) > 0) {
+			len += bytes_read;
+		}
+		last = len <= sealed_len;
+		seg->has_next = !last;
+		if (!last) {
+			len = sealed_len;
+		}
+	}
+
+	if (len < PHP_CRYPTO_STREAM_SEGMENT_TAG_SIZE || (seg->index == UINT32_MAX && !last) ||
+			php_crypto_stream_segment_crypt(seg, seg->ctx, seg->index, last,
+				seg->buf, in, (int) (len - PHP_CRYPTO_STREAM_SEGMENT_TAG_SIZE)) == FAILURE) {
+		/* nothing from the failed segment can be released */
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(SEGMENT_AUTH_FAILED));
+		php_crypto_stream_auth_save_result(stream, 0);
+		seg->done = 1;
+		return FAILURE;
+	}
+	seg->index++;
+	seg->buf_len = len - PHP_CRYPTO_STREAM_SEGMENT_TAG_SIZE;
+	seg->buf_pos = 0;
+	if (last) {
+		php_crypto_stream_auth_save_result(stream, 1);
+		seg->done = 1;
+	}
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_segmented_read */
+static size_t php_crypto_stream_segmented_read(php_stream *stream,
+		php_crypto_stream_data *data, char *buf, size_t count TSRMLS_DC)
+{
+	php_crypto_stream_segmented *seg = data->segmented;
+	size_t len;
+
+	while (seg->buf_pos == seg->buf_len) {
+		if (seg->done || php_crypto_stream_segmented_open(stream, data TSRMLS_CC) == FAILURE) {
+			stream->eof = 1;
+			return 0;
+		}
+	}
+	len = seg->buf_len - seg->buf_pos;
+	if (len > count) {
+		len = count;
+	}
+	memcpy(buf, seg->buf + seg->buf_pos, len);
+	seg->buf_pos += len;
+
+	return len;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_segmented_free */
+static void php_crypto_stream_segmented_free(php_crypto_stream_segmented *seg)
+{
+	int i;
+
+	if (seg->pipeline) {
+		php_crypto_thread_pipeline_destroy(seg->pipeline);
+		seg->buf = NULL;
+	}
+	if (seg->worker_ctx) {
+		for (i = 0; i < seg->workers; i++) {
+			if (seg->worker_ctx[i]) {
+				EVP_CIPHER_CTX_free(seg->worker_ctx[i]);
+			}
+		}
+		efree(seg->worker_ctx);
+	}
+	if (seg->ctx) {
+		EVP_CIPHER_CTX_free(seg->ctx);
+	}
+	if (seg->buf) {
+		OPENSSL_cleanse(seg->buf, seg->segment_size + PHP_CRYPTO_STREAM_SEGMENT_TAG_SIZE + 1);
+		efree(seg->buf);
+	}
+	if (seg->aad) {
+		efree(seg->aad);
+	}
+	if (seg->key) {
+		OPENSSL_cleanse(seg->key, seg->key_len);
+		efree(seg->key);
+	}
+	efree(seg);
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_write_chain
+	Writes data to the filters chain */
+static size_t php_crypto_stream_write_chain(php_stream *stream,
+		const char *buf, size_t count TSRMLS_DC)
+{
+	php_crypto_stream_data *data = (php_crypto_stream_data *) stream->abstract;
+	int bytes_written;
+
+	if (data->segmented) {
+		return data->segmented->enc ?
+				php_crypto_stream_segmented_write(data, buf, count TSRMLS_CC) : 0;
+	}
+	if (data->uring) {
+		return php_crypto_stream_uring_write(data, buf, count TSRMLS_CC);
+	}
+	if (data->seekable_ctx) {
+		return php_crypto_stream_seekable_write(data, buf, count);
+	}
+
+	bytes_written = BIO_write(data->bio, buf, count > INT_MAX ? INT_MAX : count);
+
+	return bytes_written <= 0 ? 0 : (size_t) bytes_written;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_auth_get_first_bio */
+static int php_crypto_stream_auth_get_first_bio(
+		BIO *bio, BIO **p_auth_bio, EVP_CIPHER_CTX **p_cipher_ctx)
+{
+	while (bio && (bio = BIO_find_type(bio, BIO_TYPE_CIPHER))) {
+		EVP_CIPHER_CTX *cipher_ctx;
+		const php_crypto_cipher_mode *mode;
+
+		BIO_get_cipher_ctx(bio, &cipher_ctx);
+		mode = php_crypto_get_cipher_mode(EVP_CIPHER_CTX_cipher(cipher_ctx));
+		if (mode->auth_enc) {
+			*p_cipher_ctx = cipher_ctx;
+			*p_auth_bio = bio;
+
+			return SUCCESS;
+		}
+		bio = BIO_next(bio);
+	}
+
+	return FAILURE;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_create_meta_field */
+static void inline php_crypto_stream_create_meta_field(
+		char *out, const char *key, const char *value)
+{
+	char *ptr;
+	strcpy(out, key);
+	ptr = out + strlen(key);
+	memcpy(ptr,  ": ", 2);
+	strcpy(ptr + 2, value);
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_auth_save_tag */
+static void php_crypto_stream_set_meta(php_stream *stream,
+		const char *key, const char *value)
+{
+	PHPC_STR_DECLARE(header);
+	size_t len = strlen(key) + strlen(value) + 2;
+	zval *p_wrapper;
+
+	if (PHPC_STREAM_WRAPPERDATA_ISSET(stream) && PHPC_TYPE(stream->wrapperdata) != IS_ARRAY) {
+		PHPC_STREAM_WRAPPERDATA_UNSET(stream);
+	}
+	if (PHPC_STREAM_WRAPPERDATA_ISSET(stream)) {
+		phpc_val *ppv_wrapperdata_item;
+
+		PHPC_HASH_FOREACH_VAL(PHPC_ARRVAL(stream->wrapperdata), ppv_wrapperdata_item) {
+			if (PHPC_TYPE_P(ppv_wrapperdata_item) == IS_STRING &&
+				(size_t) PHPC_STRLEN_P(ppv_wrapperdata_item) > strlen(key) &&
+				!strncmp(PHPC_STRVAL_P(ppv_wrapperdata_item), key, strlen(key))
+			) {
+				if (len != (size_t) PHPC_STRLEN_P(ppv_wrapperdata_item)) {
+					PHPC_STR_DECLARE(item);
+
+					PHPC_STR_INIT(item,
+							PHPC_STRVAL_P(ppv_wrapperdata_item),
+							PHPC_STRLEN_P(ppv_wrapperdata_item));
+					zval_ptr_dtor(ppv_wrapperdata_item);
+					PHPC_VAL_STR(*ppv_wrapperdata_item, item);
+				}
+				php_crypto_stream_create_meta_field(
+						PHPC_STRVAL_P(ppv_wrapperdata_item), key, value);
+				return;
+			}
+
+		} PHPC_HASH_FOREACH_END();
+
+		PHPC_VAL_TO_PZVAL(stream->wrapperdata, p_wrapper);
+	} else {
+		PHPC_STREAM_WRAPPERDATA_ALLOC(stream);
+		PHPC_VAL_TO_PZVAL(stream->wrapperdata, p_wrapper);
+		PHPC_ARRAY_INIT(p_wrapper);
+	}
+
+	PHPC_STR_ALLOC(header, len);
+	php_crypto_stream_create_meta_field(PHPC_STR_VAL(header), key, value);
+	PHPC_ARRAY_ADD_NEXT_INDEX_STR(p_wrapper, header);
+
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_auth_save_tag */
+PHP_CRYPTO_API void php_crypto_stream_auth_save_tag(php_stream *stream,
+		EVP_CIPHER_CTX *cipher_ctx TSRMLS_DC)
+{
+	char hex_tag[PHP_CRYPTO_CIPHER_AUTH_TAG_LENGTH_MAX * 2 + 1];
+	unsigned char bin_tag[PHP_CRYPTO_CIPHER_AUTH_TAG_LENGTH_MAX + 1];
+	const php_crypto_cipher_mode *mode = php_crypto_get_cipher_mode(
+			EVP_CIPHER_CTX_cipher(cipher_ctx));
+	if (EVP_CIPHER_CTX_ctrl(cipher_ctx, mode->auth_get_tag_flag,
+			PHP_CRYPTO_CIPHER_AUTH_TAG_LENGTH_MAX, &bin_tag[0])) {
+		php_crypto_hash_bin2hex(&hex_tag[0], &bin_tag[0], PHP_CRYPTO_CIPHER_AUTH_TAG_LENGTH_MAX);
+		php_crypto_stream_set_meta(stream, PHP_CRYPTO_STREAM_META_AUTH_TAG, &hex_tag[0]);
+	} else {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_TAG_FAILED));
+	}
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_auth_save_result */
+PHP_CRYPTO_API void php_crypto_stream_auth_save_result(php_stream *stream, int ok)
+{
+	php_crypto_stream_set_meta(
+			stream,
+			PHP_CRYPTO_STREAM_META_AUTH_RESULT,
+			ok ? "success" : "failure");
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_read_chain
+	Reads data from the filters chain */
+static size_t php_crypto_stream_read_chain(php_stream *stream, char *buf, size_t count TSRMLS_DC)
+{
+	php_crypto_stream_data *data = (php_crypto_stream_data *) stream->abstract;
+	int bytes_read;
+
+	if (data->segmented) {
+		return data->segmented->enc ?
+				0 : php_crypto_stream_segmented_read(stream, data, buf, count TSRMLS_CC);
+	}
+	if (data->uring) {
+		return php_crypto_stream_uring_read(stream, data, buf, count TSRMLS_CC);
+	}
+#ifdef PHP_CRYPTO_STREAM_HAS_MMAP
+	if (data->map) {
+		size_t map_bytes_read;
+		if (php_crypto_stream_mmap_read(stream, data, buf, count,
+				&map_bytes_read TSRMLS_CC) == SUCCESS) {
+			return map_bytes_read;
+		}
+	}
+#endif
+
+	bytes_read = BIO_read(data->bio, buf, count > INT_MAX ? INT_MAX : count);
+	if (bytes_read > 0) {
+		/* CTR decryption is done in place */
+		if (data->seekable_ctx && !EVP_CipherUpdate(data->seekable_ctx,
+				(unsigned char *) buf, &bytes_read, (unsigned char *) buf, bytes_read)) {
+			php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_UPDATE_FAILED));
+			stream->eof = 1;
+			return 0;
+		}
+		return (size_t) bytes_read;
+	}
+	stream->eof = !BIO_should_retry(data->bio);
+	if (data->auth_enc && stream->eof) {
+		EVP_CIPHER_CTX *cipher_ctx;
+		BIO *auth_bio;
+		if (php_crypto_stream_auth_get_first_bio(data->bio, &auth_bio, &cipher_ctx) == SUCCESS) {
+			if (data->is_encrypting) {
+				/* encryption - save auth tag */
+				php_crypto_stream_auth_save_tag(stream, cipher_ctx TSRMLS_CC);
+			} else {
+				/* decryption - save auth result */
+				int ok = (int) BIO_ctrl(auth_bio, BIO_C_GET_CIPHER_STATUS, 0, NULL);
+				php_crypto_stream_auth_save_result(stream, ok);
+			}
+		}
+	}
+	return 0;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_compress_output
+	Writes the whole compressed buffer to the filters chain */
+static int php_crypto_stream_compress_output(php_stream *stream,
+		php_crypto_stream_compress *comp TSRMLS_DC)
+{
+	size_t bytes_written;
+
+	while (comp->buf_pos < comp->buf_len) {
+		bytes_written = php_crypto_stream_write_chain(stream,
+				(char *) comp->buf + comp->buf_pos, comp->buf_len - comp->buf_pos TSRMLS_CC);
+		if (bytes_written == 0) {
+			php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(COMPRESS_FAILED));
+			comp->done = 1;
+			return FAILURE;
+		}
+		comp->buf_pos += bytes_written;
+	}
+	comp->buf_len = 0;
+	comp->buf_pos = 0;
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_compress_write
+	Compresses data to the buffer and writes them to the filters chain */
+static size_t php_crypto_stream_compress_write(php_stream *stream,
+		php_crypto_stream_compress *comp, const char *buf, size_t count,
+		zend_bool finish TSRMLS_DC)
+{
+	const unsigned char *in = (const unsigned char *) buf;
+	unsigned char *out;
+	size_t in_len = count, out_len;
+	int rc;
+
+	if (comp->done) {
+		return 0;
+	}
+	do {
+		out = comp->buf;
+		out_len = PHP_CRYPTO_STREAM_COMPRESS_BUFFER_SIZE;
+		rc = php_crypto_compress_update(comp->ctx, &in, &in_len, &out, &out_len, finish);
+		if (rc == PHP_CRYPTO_COMPRESS_ERROR) {
+			php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(COMPRESS_FAILED));
+			comp->done = 1;
+			return 0;
+		}
+		comp->buf_len = PHP_CRYPTO_STREAM_COMPRESS_BUFFER_SIZE - out_len;
+		if (php_crypto_stream_compress_output(stream, comp TSRMLS_CC) == FAILURE) {
+			return 0;
+		}
+		/* the full output buffer means that more output can be pending */
+	} while (in_len > 0 || out_len == 0 || (finish && rc != PHP_CRYPTO_COMPRESS_END));
+	comp->done = finish;
+
+	return count;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_compress_finish
+	Writes the rest of the compressed data before the filters are finalized */
+static void php_crypto_stream_compress_finish(php_stream *stream,
+		php_crypto_stream_data *data TSRMLS_DC)
+{
+	if (data->compress && data->compress->enc && !data->compress->done) {
+		php_crypto_stream_compress_write(stream, data->compress, NULL, 0, 1 TSRMLS_CC);
+	}
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_decompress_read
+	Reads compressed data from the filters chain and decompresses them */
+static size_t php_crypto_stream_decompress_read(php_stream *stream,
+		php_crypto_stream_compress *comp, char *buf, size_t count TSRMLS_DC)
+{
+	const unsigned char *in;
+	unsigned char *out = (unsigned char *) buf;
+	size_t in_len, out_len = count;
+	int rc;
+
+	while (out_len == count && !comp->done) {
+		/* the decompressor can have pending output even without input */
+		in = comp->buf + comp->buf_pos;
+		in_len = comp->buf_len - comp->buf_pos;
+		rc = php_crypto_compress_update(comp->ctx, &in, &in_len, &out, &out_len, 0);
+		comp->buf_pos = comp->buf_len - in_len;
+		if (rc == PHP_CRYPTO_COMPRESS_ERROR) {
+			php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(COMPRESS_DATA_INVALID));
+			comp->done = 1;
+			break;
+		}
+		if (rc == PHP_CRYPTO_COMPRESS_END) {
+			comp->done = 1;
+			break;
+		}
+		if (out_len < count || comp->buf_pos < comp->buf_len) {
+			continue;
+		}
+		if (comp->raw_eof) {
+			/* the data end before the end of the compressed stream */
+			php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(COMPRESS_DATA_INVALID));
+			comp->done = 1;
+			break;
+		}
+		comp->buf_len = php_crypto_stream_read_chain(stream, (char *) comp->buf,
+				PHP_CRYPTO_STREAM_COMPRESS_BUFFER_SIZE TSRMLS_CC);
+		comp->buf_pos = 0;
+		/* the stream eof is set only when all decompressed data are read */
+		comp->raw_eof = stream->eof;
+		stream->eof = 0;
+		if (comp->buf_len == 0 && !comp->raw_eof) {
+			/* no data are available in the non-blocking mode */
+			break;
+		}
+	}
+	if (comp->done && out_len == count) {
+		stream->eof = 1;
+	}
+
+	return count - out_len;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_compress_free */
+static void php_crypto_stream_compress_free(php_crypto_stream_compress *comp)
+{
+	if (comp->ctx) {
+		php_crypto_compress_free(comp->ctx);
+	}
+	if (comp->buf) {
+		OPENSSL_cleanse(comp->buf, PHP_CRYPTO_STREAM_COMPRESS_BUFFER_SIZE);
+		efree(comp->buf);
+	}
+	efree(comp);
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_write */
+static size_t php_crypto_stream_write(php_stream *stream,
+		const char *buf, size_t count TSRMLS_DC)
+{
+	php_crypto_stream_data *data = (php_crypto_stream_data *) stream->abstract;
+
+	if (data->compress) {
+		return data->compress->enc ? php_crypto_stream_compress_write(
+				stream, data->compress, buf, count, 0 TSRMLS_CC) : 0;
+	}
+
+	return php_crypto_stream_write_chain(stream, buf, count TSRMLS_CC);
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_read */
+static size_t php_crypto_stream_read(php_stream *stream, char *buf, size_t count TSRMLS_DC)
+{
+	php_crypto_stream_data *data = (php_crypto_stream_data *) stream->abstract;
+
+	if (data->compress) {
+		return data->compress->enc ?
+				0 : php_crypto_stream_decompress_read(stream, data->compress, buf, count TSRMLS_CC);
+	}
+
+	return php_crypto_stream_read_chain(stream, buf, count TSRMLS_CC);
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_close */
+static int php_crypto_stream_close(php_stream *stream, int close_handle TSRMLS_DC)
+{
+	php_crypto_stream_data *data = (php_crypto_stream_data *) stream->abstract;
+	if (data->compress) {
+		php_crypto_stream_compress_finish(stream, data TSRMLS_CC);
+		php_crypto_stream_compress_free(data->compress);
+		data->compress = NULL;
+	}
+	if (data->segmented) {
+		/* the last segment is sealed on close */
+		if (data->segmented->enc && !data->segmented->done) {
+			php_crypto_stream_segmented_seal(data, 1 TSRMLS_CC);
+		}
+		php_crypto_stream_segmented_free(data->segmented);
+	}
+	if (data->map) {
+		php_crypto_stream_mmap_free(data->map);
+	}
+	/* the queued writes are finished before the file is closed */
+	if (data->uring && php_crypto_uring_destroy(data->uring) == FAILURE) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(FILE_WRITE_FAILED));
+	}
+	if (data->sink && BIO_method_type(data->sink) == BIO_TYPE_MEM) {
+		char *mem;
+		long mem_len = BIO_get_mem_data(data->sink, &mem);
+		if (mem_len > 0) {
+			OPENSSL_cleanse(mem, (size_t) mem_len);
+		}
+	}
+	/* the file is flushed from the buffer when it is closed */
+	BIO_free_all(data->bio);
+	if (data->buffer) {
+		efree(data->buffer);
+	}
+	if (data->seekable_ctx) {
+		EVP_CIPHER_CTX_free(data->seekable_ctx);
+	}
+	OPENSSL_cleanse(data, sizeof(php_crypto_stream_data));
 	efree(data);
 	return 0;
 }
 /* }}} */
 
-/* {{{ php_crypto_stream_flush */
-static int php_crypto_stream_flush(php_stream *stream TSRMLS_DC)
+/* {{{ php_crypto_stream_flush */
+static int php_crypto_stream_flush(php_stream *stream TSRMLS_DC)
+{
+	php_crypto_stream_data *data = (php_crypto_stream_data *) stream->abstract;
+	/* eof is set when the last read is done (this prevents infinite loop in cipher bio) */
+	if (!stream->eof) {
+		int ok;
+		php_crypto_stream_compress_finish(stream, data TSRMLS_CC);
+		php_crypto_stream_segmented_drain(data);
+		if (data->uring && php_crypto_uring_flush(data->uring) == FAILURE) {
+			php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(FILE_WRITE_FAILED));
+		}
+		ok = BIO_flush(data->bio);
+		if (data->auth_enc) {
+			EVP_CIPHER_CTX *cipher_ctx;
+			BIO *auth_bio;
+			if (php_crypto_stream_auth_get_first_bio(data->bio, &auth_bio, &cipher_ctx) == SUCCESS) {
+				if (data->is_encrypting) {
+					/* encryption - save auth tag */
+					php_crypto_stream_auth_save_tag(stream, cipher_ctx TSRMLS_CC);
+				} else {
+					/* decryption - save auth result */
+					php_crypto_stream_auth_save_result(stream, ok);
+				}
+			}
+		}
+	}
+	return 0;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_seekable_seek */
+static int php_crypto_stream_seekable_seek(php_crypto_stream_data *data,
+		phpc_off_t offset, int whence, phpc_off_t *newoffset TSRMLS_DC)
+{
+	FILE *fp;
+	long base;
+
+	/* the mapped file position is just moved */
+	if (data->map) {
+		base = whence == SEEK_CUR ? (long) data->map->pos :
+				(whence == SEEK_END ? (long) data->map->size : 0);
+	} else if (data->uring && whence == SEEK_CUR) {
+		base = (long) php_crypto_uring_tell(data->uring);
+	} else if (whence == SEEK_CUR) {
+		/* the file BIO seeks only from the start */
+		base = BIO_ctrl(data->bio, BIO_C_FILE_TELL, 0, NULL);
+	} else if (whence == SEEK_END) {
+		/* the queued writes have to be in the file */
+		if (data->uring) {
+			php_crypto_uring_flush(data->uring);
+		}
+		BIO_get_fp(data->bio, &fp);
+		if (fseek(fp, 0, SEEK_END)) {
+			return -1;
+		}
+		base = ftell(fp);
+	} else {
+		base = 0;
+	}
+	if (base < 0 || (offset > 0 && offset > LONG_MAX - base) || offset + base < 0) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(SEEK_OFFSET_INVALID));
+		return -1;
+	}
+	offset += base;
+
+	if (data->map) {
+		data->map->pos = (uint64_t) offset;
+	} else if (data->uring) {
+		if (php_crypto_uring_seek(data->uring, (uint64_t) offset) == FAILURE) {
+			php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(FILE_WRITE_FAILED));
+			return -1;
+		}
+	} else if (BIO_ctrl(data->bio, BIO_C_FILE_SEEK, (long) offset, NULL) < 0) {
+		return -1;
+	}
+	if (php_crypto_stream_seekable_set_offset(data, offset) == FAILURE) {
+		return -1;
+	}
+	*newoffset = offset;
+
+	return 0;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_seek */
+static int php_crypto_stream_seek(php_stream *stream,
+		phpc_off_t offset, int whence, phpc_off_t *newoffset TSRMLS_DC)
+{
+	int ret;
+	php_crypto_stream_data *data = (php_crypto_stream_data *) stream->abstract;
+
+	if (data->compress) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(COMPRESS_SEEK_FORBIDDEN));
+		return -1;
+	}
+	/* the CTR counter is computed directly from the offset */
+	if (data->seekable_ctx) {
+		return php_crypto_stream_seekable_seek(data, offset, whence, newoffset TSRMLS_CC);
+	}
+	if (data->segmented) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(SEGMENT_SEEK_FORBIDDEN));
+		return -1;
+	}
+
+	/* The only supported value in OpenSSL */
+	if (whence != SEEK_SET) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(SEEK_OPERATION_FORBIDDEN));
+		return -1;
+	}
+	/* Don't allow offset greater than INT_MAX due to BIO_ctrl return value casting */
+	if (offset > INT_MAX) {
+		php_crypto_error_ex(PHP_CRYPTO_STREAM_ERROR_ARGS(SEEK_OFFSET_HIGH), INT_MAX);
+		return -1;
+	}
+
+	ret = BIO_seek(data->bio, offset);
+	*newoffset = (phpc_off_t) BIO_tell(data->bio);
+	return ret;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_get_fd
+	Returns the descriptor of the file, fd or socket bio at the end of the chain */
+static int php_crypto_stream_get_fd(php_crypto_stream_data *data)
+{
+	BIO *bio;
+	FILE *fp;
+	int fd;
+
+	if ((bio = BIO_find_type(data->bio, BIO_TYPE_FILE)) != NULL) {
+		BIO_get_fp(bio, &fp);
+		return fp ? fileno(fp) : -1;
+	}
+	/* the type without the low bits matches all descriptor bios */
+	if ((bio = BIO_find_type(data->bio, BIO_TYPE_DESCRIPTOR)) != NULL &&
+			BIO_get_fd(bio, &fd) >= 0) {
+		return fd;
+	}
+
+	return -1;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_stat */
+static int php_crypto_stream_stat(php_stream *stream, php_stream_statbuf *ssb TSRMLS_DC)
+{
+	php_crypto_stream_data *data = (php_crypto_stream_data *) stream->abstract;
+	BIO *file_bio = BIO_find_type(data->bio, BIO_TYPE_FILE);
+	FILE *fp;
+	int fd;
+
+	if (!file_bio) {
+		/* the fd and socket streams */
+		fd = php_crypto_stream_get_fd(data);
+		return fd < 0 ? -1 : fstat(fd, &ssb->sb);
+	}
+	php_crypto_stream_segmented_drain(data);
+	if (data->uring) {
+		php_crypto_uring_flush(data->uring);
+	}
+	BIO_get_fp(file_bio, &fp);
+	fflush(fp);
+
+	return fstat(fileno(fp), &ssb->sb);
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_cast */
+static int php_crypto_stream_cast(php_stream *stream, int castas, void **ret TSRMLS_DC)
+{
+	php_crypto_stream_data *data = (php_crypto_stream_data *) stream->abstract;
+	int fd;
+
+	/* only select is allowed as the raw descriptor would bypass the filters */
+	if (castas != PHP_STREAM_AS_FD_FOR_SELECT || (fd = php_crypto_stream_get_fd(data)) < 0) {
+		return FAILURE;
+	}
+	if (ret) {
+		*(php_socket_t *) ret = fd;
+	}
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_set_option */
+static int php_crypto_stream_set_option(php_stream *stream,
+		int option, int value, void *ptrparam TSRMLS_DC)
+{
+#ifndef PHP_WIN32
+	php_crypto_stream_data *data = (php_crypto_stream_data *) stream->abstract;
+	int fd, flags, old_value;
+
+	if (option != PHP_STREAM_OPTION_BLOCKING || (fd = php_crypto_stream_get_fd(data)) < 0 ||
+			(flags = fcntl(fd, F_GETFL, 0)) == -1) {
+		return PHP_STREAM_OPTION_RETURN_NOTIMPL;
+	}
+	old_value = (flags & O_NONBLOCK) ? 0 : 1;
+	/* the aead segments are always read whole and the compressed data written whole */
+	if (!value && (data->segmented || data->compress)) {
+		return PHP_STREAM_OPTION_RETURN_ERR;
+	}
+	if (value) {
+		flags &= ~O_NONBLOCK;
+	} else {
+		flags |= O_NONBLOCK;
+	}
+	if (fcntl(fd, F_SETFL, flags) == -1) {
+		return PHP_STREAM_OPTION_RETURN_ERR;
+	}
+
+	return old_value;
+#else
+	return PHP_STREAM_OPTION_RETURN_NOTIMPL;
+#endif
+}
+/* }}} */
+
+/* crypto stream options */
+php_stream_ops  php_crypto_stream_ops = {
+	php_crypto_stream_write, php_crypto_stream_read,
+	php_crypto_stream_close, php_crypto_stream_flush,
+	"crypto",
+	php_crypto_stream_seek,
+	php_crypto_stream_cast,
+	php_crypto_stream_stat,
+	php_crypto_stream_set_option
+};
+
+/* {{{ php_crypto_stream_memory_spill
+	Moves the memory sink to a temp file if it is over the limit */
+static int php_crypto_stream_memory_spill(php_crypto_stream_data *data TSRMLS_DC)
+{
+	BIO *file_bio, *bio;
+	FILE *fp;
+	char *mem;
+	long mem_len, written, len;
+
+	if (!data->spill_size || BIO_method_type(data->sink) != BIO_TYPE_MEM) {
+		return SUCCESS;
+	}
+	mem_len = BIO_get_mem_data(data->sink, &mem);
+	if (mem_len <= 0 || (size_t) mem_len <= data->spill_size) {
+		return SUCCESS;
+	}
+	fp = tmpfile();
+	if (!fp) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(MEMORY_SPILL_FAILED));
+		return FAILURE;
+	}
+	file_bio = BIO_new_fp(fp, BIO_CLOSE);
+	if (!file_bio) {
+		fclose(fp);
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(MEMORY_SPILL_FAILED));
+		return FAILURE;
+	}
+	for (written = 0; written < mem_len; written += len) {
+		len = mem_len - written > INT_MAX ? INT_MAX : mem_len - written;
+		if (BIO_write(file_bio, mem + written, (int) len) != len) {
+			BIO_free(file_bio);
+			php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(MEMORY_SPILL_FAILED));
+			return FAILURE;
+		}
+	}
+
+	/* the file replaces the memory at the end of the chain */
+	if (data->bio == data->sink) {
+		data->bio = file_bio;
+	} else {
+		for (bio = data->bio; BIO_next(bio) != data->sink; bio = BIO_next(bio));
+		BIO_pop(data->sink);
+		BIO_push(bio, file_bio);
+	}
+	OPENSSL_cleanse(mem, (size_t) mem_len);
+	BIO_free(data->sink);
+	data->sink = file_bio;
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_memory_finish
+	Finishes the writing (the filters are finalized) before the sink is read */
+static void php_crypto_stream_memory_finish(php_stream *stream,
+		php_crypto_stream_data *data TSRMLS_DC)
+{
+	char *mem;
+	long size;
+
+	if (data->sink_done) {
+		return;
+	}
+	data->sink_done = 1;
+	php_crypto_stream_compress_finish(stream, data TSRMLS_CC);
+	if (data->segmented && data->segmented->enc && !data->segmented->done) {
+		php_crypto_stream_segmented_seal(data, 1 TSRMLS_CC);
+	}
+	php_crypto_stream_flush(stream TSRMLS_CC);
+	php_crypto_stream_memory_spill(data TSRMLS_CC);
+
+	if (BIO_method_type(data->sink) == BIO_TYPE_MEM) {
+		size = BIO_get_mem_data(data->sink, &mem);
+	} else {
+		BIO_flush(data->sink);
+		size = BIO_ctrl(data->sink, BIO_C_FILE_TELL, 0, NULL);
+		BIO_ctrl(data->sink, BIO_C_FILE_SEEK, 0, NULL);
+	}
+	data->sink_size = size > 0 ? (size_t) size : 0;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_memory_write */
+static size_t php_crypto_stream_memory_write(php_stream *stream,
+		const char *buf, size_t count TSRMLS_DC)
 {
 	php_crypto_stream_data *data = (php_crypto_stream_data *) stream->abstract;
-	/* eof is set when the last read is done (this prevents infinite loop in cipher bio) */
-	if (!stream->eof) {
-		int ok = BIO_flush(data->bio);
-		if (data->auth_enc) {
-			EVP_CIPHER_CTX *cipher_ctx;
-			BIO *auth_bio;
-			if (php_crypto_stream_auth_get_first_bio(data->bio, &auth_bio, &cipher_ctx) == SUCCESS) {
-				if (data->is_encrypting) {
-					/* encryption - save auth tag */
-					php_crypto_stream_auth_save_tag(stream, cipher_ctx TSRMLS_CC);
-				} else {
-					/* decryption - save auth result */
-					php_crypto_stream_auth_save_result(stream, ok);
-				}
-			}
+	size_t bytes_written;
+
+	if (data->sink_done) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(MEMORY_WRITE_FINISHED));
+		return 0;
+	}
+	bytes_written = php_crypto_stream_write(stream, buf, count TSRMLS_CC);
+	if (php_crypto_stream_memory_spill(data TSRMLS_CC) == FAILURE) {
+		return 0;
+	}
+
+	return bytes_written;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_memory_read */
+static size_t php_crypto_stream_memory_read(php_stream *stream,
+		char *buf, size_t count TSRMLS_DC)
+{
+	php_crypto_stream_data *data = (php_crypto_stream_data *) stream->abstract;
+	char *mem;
+	int bytes_read;
+
+	php_crypto_stream_memory_finish(stream, data TSRMLS_CC);
+	if (data->sink_pos >= data->sink_size) {
+		stream->eof = 1;
+		return 0;
+	}
+	if (count > data->sink_size - data->sink_pos) {
+		count = data->sink_size - data->sink_pos;
+	}
+	if (BIO_method_type(data->sink) == BIO_TYPE_MEM) {
+		BIO_get_mem_data(data->sink, &mem);
+		memcpy(buf, mem + data->sink_pos, count);
+	} else {
+		bytes_read = BIO_read(data->sink, buf, count > INT_MAX ? INT_MAX : (int) count);
+		if (bytes_read <= 0) {
+			stream->eof = 1;
+			return 0;
 		}
+		count = (size_t) bytes_read;
 	}
-	return 0;
+	data->sink_pos += count;
+
+	return count;
 }
 /* }}} */
 
-/* {{{ php_crypto_stream_seek */
-static int php_crypto_stream_seek(php_stream *stream,
+/* {{{ php_crypto_stream_memory_seek */
+static int php_crypto_stream_memory_seek(php_stream *stream,
 		phpc_off_t offset, int whence, phpc_off_t *newoffset TSRMLS_DC)
 {
-	int ret;
-	php_crypto_stream_data *data;
+	php_crypto_stream_data *data = (php_crypto_stream_data *) stream->abstract;
+	phpc_off_t base;
 
-	/* The only supported value in OpenSSL */
-	if (whence != SEEK_SET) {
-		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(SEEK_OPERATION_FORBIDDEN));
+	php_crypto_stream_memory_finish(stream, data TSRMLS_CC);
+	base = whence == SEEK_CUR ? (phpc_off_t) data->sink_pos :
+			(whence == SEEK_END ? (phpc_off_t) data->sink_size : 0);
+	if (offset < -base || offset > (phpc_off_t) data->sink_size - base) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(SEEK_OFFSET_INVALID));
 		return -1;
 	}
-	/* Don't allow offset greater than INT_MAX due to BIO_ctrl return value casting */
-	if (offset > INT_MAX) {
-		php_crypto_error_ex(PHP_CRYPTO_STREAM_ERROR_ARGS(SEEK_OFFSET_HIGH), INT_MAX);
+	offset += base;
+	if (BIO_method_type(data->sink) != BIO_TYPE_MEM &&
+			(offset > LONG_MAX || BIO_ctrl(data->sink, BIO_C_FILE_SEEK, (long) offset, NULL) < 0)) {
 		return -1;
 	}
+	data->sink_pos = (size_t) offset;
+	*newoffset = offset;
 
-	data = (php_crypto_stream_data *) stream->abstract;
-	ret = BIO_seek(data->bio, offset);
-	*newoffset = (phpc_off_t) BIO_tell(data->bio);
-	return ret;
+	return 0;
 }
 /* }}} */
 
-/* crypto stream options */
-php_stream_ops  php_crypto_stream_ops = {
-	php_crypto_stream_write, php_crypto_stream_read,
+/* {{{ php_crypto_stream_memory_stat */
+static int php_crypto_stream_memory_stat(php_stream *stream,
+		php_stream_statbuf *ssb TSRMLS_DC)
+{
+	php_crypto_stream_data *data = (php_crypto_stream_data *) stream->abstract;
+
+	/* the size is known only when the writing is finished */
+	php_crypto_stream_memory_finish(stream, data TSRMLS_CC);
+	memset(ssb, 0, sizeof(php_stream_statbuf));
+	ssb->sb.st_mode = S_IFREG | 0666;
+	ssb->sb.st_nlink = 1;
+	ssb->sb.st_size = data->sink_size;
+
+	return 0;
+}
+/* }}} */
+
+/* crypto memory stream options */
+php_stream_ops  php_crypto_stream_memory_ops = {
+	php_crypto_stream_memory_write, php_crypto_stream_memory_read,
 	php_crypto_stream_close, php_crypto_stream_flush,
 	"crypto",
-	php_crypto_stream_seek,
+	php_crypto_stream_memory_seek,
 	NULL, /* cast */
-	NULL, /* stat */
+	php_crypto_stream_memory_stat,
 	NULL  /* set_option */
 };
 
-/* {{{ php_crypto_stream_set_cipher */
-static int php_crypto_stream_set_cipher(php_crypto_stream_data *data,
-		phpc_val *ppv_cipher TSRMLS_DC)
+/* {{{ php_crypto_stream_cipher_parse_algorithm */
+static int php_crypto_stream_cipher_parse_algorithm(zval *pz_cipher,
+		int *p_enc, const EVP_CIPHER **p_cipher TSRMLS_DC)
 {
-	phpc_val *ppv_action, *ppv_alg, *ppv_mode;
-	phpc_val *ppv_key_size, *ppv_key, *ppv_iv, *ppv_tag, *ppv_aad;
+	phpc_val *ppv_action, *ppv_alg, *ppv_mode, *ppv_key_size;
 	zval *pz_mode, *pz_key_size;
-	BIO *cipher_bio;
-	const EVP_CIPHER *cipher;
-	EVP_CIPHER_CTX *cipher_ctx;
-	const php_crypto_cipher_mode *mode;
-	unsigned char *aad;
-	int enc = 1, aad_len;
-
-	if (PHPC_TYPE_P(ppv_cipher) != IS_ARRAY) {
-		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_CONTEXT_TYPE_INVALID));
-		return FAILURE;
-	}
+	int enc = 1;
 
-	if (!PHPC_HASH_CSTR_FIND_IN_COND(PHPC_ARRVAL_P(ppv_cipher), "action", ppv_action)) {
+	if (!PHPC_HASH_CSTR_FIND_IN_COND(Z_ARRVAL_P(pz_cipher), "action", ppv_action)) {
 		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_ACTION_NOT_SUPPLIED));
 		return FAILURE;
 	}
@@ -382,9 +1942,9 @@ static int php_crypto_stream_set_cipher(php_crypto_stream_data *data,
 		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_ACTION_INVALID));
 		return FAILURE;
 	}
-	data->is_encrypting = enc;
+	*p_enc = enc;
 
-	if (!PHPC_HASH_CSTR_FIND_IN_COND(PHPC_ARRVAL_P(ppv_cipher), "algorithm", ppv_alg)) {
+	if (!PHPC_HASH_CSTR_FIND_IN_COND(Z_ARRVAL_P(pz_cipher), "algorithm", ppv_alg)) {
 		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_ALGORITHM_NOT_SUPPLIED));
 		return FAILURE;
 	}
@@ -392,10 +1952,10 @@ static int php_crypto_stream_set_cipher(php_crypto_stream_data *data,
 		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_ALGORITHM_TYPE_INVALID));
 		return FAILURE;
 	}
-	if (!PHPC_HASH_CSTR_FIND_IN_COND(PHPC_ARRVAL_P(ppv_cipher), "mode", ppv_mode)) {
+	if (!PHPC_HASH_CSTR_FIND_IN_COND(Z_ARRVAL_P(pz_cipher), "mode", ppv_mode)) {
 		ppv_mode = NULL;
 	}
-	if (!PHPC_HASH_CSTR_FIND_IN_COND(PHPC_ARRVAL_P(ppv_cipher), "key_size", ppv_key_size)) {
+	if (!PHPC_HASH_CSTR_FIND_IN_COND(Z_ARRVAL_P(pz_cipher), "key_size", ppv_key_size)) {
 		ppv_key_size = NULL;
 	}
 	if (ppv_mode) {
@@ -408,104 +1968,591 @@ static int php_crypto_stream_set_cipher(php_crypto_stream_data *data,
 	} else {
 		pz_key_size = NULL;
 	}
-	cipher = php_crypto_get_cipher_algorithm_from_params(
+	*p_cipher = php_crypto_get_cipher_algorithm_from_params(
 			PHPC_STRVAL_P(ppv_alg), PHPC_STRLEN_P(ppv_alg), pz_mode, pz_key_size TSRMLS_CC);
-	if (!cipher) {
+	if (!*p_cipher) {
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_cipher_parse */
+PHP_CRYPTO_API int php_crypto_stream_cipher_parse(php_crypto_stream_cipher_params *params,
+		zval *pz_cipher TSRMLS_DC)
+{
+	const EVP_CIPHER *cipher;
+	const php_crypto_cipher_mode *mode;
+	int enc;
+
+	if (Z_TYPE_P(pz_cipher) != IS_ARRAY) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_CONTEXT_TYPE_INVALID));
+		return FAILURE;
+	}
+
+	if (php_crypto_stream_cipher_parse_algorithm(pz_cipher, &enc, &cipher TSRMLS_CC) == FAILURE) {
 		return FAILURE;
 	}
+	params->enc = enc;
+	params->cipher = cipher;
 
 	mode = php_crypto_get_cipher_mode(cipher);
 	if (mode->auth_inlen_init) {
 		php_crypto_error_ex(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_MODE_NOT_SUPPORTED), mode->name);
 		return FAILURE;
 	}
-	if (mode->auth_enc) {
-		data->auth_enc = 1;
-	}
+	params->mode = mode;
 
-	if (!PHPC_HASH_CSTR_FIND_IN_COND(PHPC_ARRVAL_P(ppv_cipher), "key", ppv_key)) {
+	if (!PHPC_HASH_CSTR_FIND_IN_COND(Z_ARRVAL_P(pz_cipher), "key", params->ppv_key)) {
 		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_KEY_NOT_SUPPLIED));
 		return FAILURE;
 	}
-	if (PHPC_TYPE_P(ppv_key) != IS_STRING) {
+	if (PHPC_TYPE_P(params->ppv_key) != IS_STRING) {
 		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_KEY_TYPE_INVALID));
 		return FAILURE;
 	}
 
-	if (!PHPC_HASH_CSTR_FIND_IN_COND(PHPC_ARRVAL_P(ppv_cipher), "iv", ppv_iv)) {
+	if (!PHPC_HASH_CSTR_FIND_IN_COND(Z_ARRVAL_P(pz_cipher), "iv", params->ppv_iv)) {
 		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_IV_NOT_SUPPLIED));
 		return FAILURE;
 	}
-	if (PHPC_TYPE_P(ppv_iv) != IS_STRING) {
+	if (PHPC_TYPE_P(params->ppv_iv) != IS_STRING) {
 		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_IV_TYPE_INVALID));
 		return FAILURE;
 	}
 
-	if (!PHPC_HASH_CSTR_FIND_IN_COND(PHPC_ARRVAL_P(ppv_cipher), "tag", ppv_tag)) {
-		ppv_tag = NULL;
+	if (!PHPC_HASH_CSTR_FIND_IN_COND(Z_ARRVAL_P(pz_cipher), "tag", params->ppv_tag)) {
+		params->ppv_tag = NULL;
 	} else if (!mode->auth_enc) {
 		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_TAG_USELESS));
 	} else if (enc) {
 		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_TAG_FORBIDDEN));
 		return FAILURE;
 	}
-	if (!PHPC_HASH_CSTR_FIND_IN_COND(PHPC_ARRVAL_P(ppv_cipher), "aad", ppv_aad)) {
-		ppv_aad = NULL;
+	if (!PHPC_HASH_CSTR_FIND_IN_COND(Z_ARRVAL_P(pz_cipher), "aad", params->ppv_aad)) {
+		params->ppv_aad = NULL;
 	} else if (!mode->auth_enc) {
 		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_AAD_USELESS));
 	}
 
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_cipher_init */
+PHP_CRYPTO_API int php_crypto_stream_cipher_init(EVP_CIPHER_CTX *cipher_ctx,
+		php_crypto_stream_cipher_params *params TSRMLS_DC)
+{
+	const EVP_CIPHER *cipher = params->cipher;
+	const php_crypto_cipher_mode *mode = params->mode;
+	phpc_val *ppv_key = params->ppv_key, *ppv_iv = params->ppv_iv;
+	unsigned char *aad;
+	int aad_len;
+
+	/* check key length */
+	if (PHPC_STRLEN_P(ppv_key) != EVP_CIPHER_key_length(cipher) &&
+			!EVP_CIPHER_CTX_set_key_length(cipher_ctx, PHPC_STRLEN_P(ppv_key))) {
+		php_crypto_error_ex(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_KEY_LENGTH_INVALID),
+				EVP_CIPHER_key_length(cipher));
+		return FAILURE;
+	}
+	/* check iv length */
+	if (PHPC_STRLEN_P(ppv_iv) != EVP_CIPHER_iv_length(cipher) &&
+			(!mode->auth_enc || !EVP_CIPHER_CTX_ctrl(
+				cipher_ctx, mode->auth_ivlen_flag, PHPC_STRLEN_P(ppv_iv), NULL))) {
+		php_crypto_error_ex(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_IV_LENGTH_INVALID),
+				EVP_CIPHER_iv_length(cipher));
+		return FAILURE;
+	}
+
+	/* initialize cipher with key and iv */
+	if (!EVP_CipherInit_ex(cipher_ctx, NULL, NULL,
+			(unsigned char *) PHPC_STRVAL_P(ppv_key),
+			(unsigned char *) PHPC_STRVAL_P(ppv_iv), params->enc)) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_INIT_FAILED));
+		return FAILURE;
+	}
+
+	if (!mode->auth_enc) {
+		return SUCCESS;
+	}
+
+	/* authentication tag */
+	if (params->ppv_tag && php_crypto_cipher_set_tag(cipher_ctx, mode,
+			(unsigned char *) PHPC_STRVAL_P(params->ppv_tag),
+			PHPC_STRLEN_P(params->ppv_tag) TSRMLS_CC) == FAILURE) {
+		return FAILURE;
+	}
+	/* additional authentication data */
+	if (params->ppv_aad) {
+		aad =  (unsigned char *) PHPC_STRVAL_P(params->ppv_aad);
+		aad_len = PHPC_STRLEN_P(params->ppv_aad);
+	} else {
+		aad = NULL;
+		aad_len = 0;
+	}
+	if (php_crypto_cipher_write_aad(cipher_ctx, aad, aad_len TSRMLS_CC) == FAILURE) {
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_set_seekable_cipher */
+static int php_crypto_stream_set_seekable_cipher(php_crypto_stream_data *data,
+		php_crypto_stream_cipher_params *params TSRMLS_DC)
+{
+	EVP_CIPHER_CTX *cipher_ctx;
+
+#ifdef EVP_CIPH_CTR_MODE
+	if (params->mode->value != EVP_CIPH_CTR_MODE)
+#endif
+	{
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_SEEKABLE_MODE_INVALID));
+		return FAILURE;
+	}
+	if (data->sink) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(MEMORY_FILTER_UNSUPPORTED));
+		return FAILURE;
+	}
+	if (BIO_find_type(data->bio, BIO_TYPE_DESCRIPTOR)) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_SEEKABLE_FILE_REQUIRED));
+		return FAILURE;
+	}
+	/* the counter can be computed only from the file position */
+	if (BIO_method_type(data->bio) != BIO_TYPE_FILE || data->compress) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_SEEKABLE_NOT_ALONE));
+		return FAILURE;
+	}
+
+	cipher_ctx = EVP_CIPHER_CTX_new();
+	if (!cipher_ctx) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_INIT_FAILED));
+		return FAILURE;
+	}
+	/* the context is freed on stream close (even if the init fails) */
+	data->seekable_ctx = cipher_ctx;
+	if (!EVP_CipherInit_ex(cipher_ctx, params->cipher, NULL, NULL, NULL, params->enc)) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_INIT_FAILED));
+		return FAILURE;
+	}
+	if (php_crypto_stream_cipher_init(cipher_ctx, params TSRMLS_CC) == FAILURE) {
+		return FAILURE;
+	}
+	memcpy(data->seekable_iv, PHPC_STRVAL_P(params->ppv_iv), PHPC_STRLEN_P(params->ppv_iv));
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_set_cipher */
+static int php_crypto_stream_set_cipher(php_crypto_stream_data *data,
+		phpc_val *ppv_cipher TSRMLS_DC)
+{
+	php_crypto_stream_cipher_params params;
+	phpc_val *ppv_seekable;
+	zval *pz_cipher, *pz_seekable;
+	BIO *cipher_bio;
+	EVP_CIPHER_CTX *cipher_ctx;
+
+	if (data->seekable_ctx) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_SEEKABLE_NOT_ALONE));
+		return FAILURE;
+	}
+	if (data->segmented) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(SEGMENT_NOT_ALONE));
+		return FAILURE;
+	}
+	PHPC_PVAL_TO_PZVAL(ppv_cipher, pz_cipher);
+	if (php_crypto_stream_cipher_parse(&params, pz_cipher TSRMLS_CC) == FAILURE) {
+		return FAILURE;
+	}
+	if (PHPC_HASH_CSTR_FIND_IN_COND(Z_ARRVAL_P(pz_cipher), "seekable", ppv_seekable)) {
+		PHPC_PVAL_TO_PZVAL(ppv_seekable, pz_seekable);
+		if (zend_is_true(pz_seekable)) {
+			return php_crypto_stream_set_seekable_cipher(data, &params TSRMLS_CC);
+		}
+	}
+	data->is_encrypting = params.enc;
+	if (params.mode->auth_enc) {
+		data->auth_enc = 1;
+	}
+
 	cipher_bio = BIO_new(BIO_f_cipher());
-	BIO_set_cipher(cipher_bio, cipher, NULL, NULL, enc);
+	BIO_set_cipher(cipher_bio, params.cipher, NULL, NULL, params.enc);
 	BIO_push(cipher_bio, data->bio);
 	data->bio = cipher_bio;
 
 	BIO_get_cipher_ctx(cipher_bio, &cipher_ctx);
 
-	/* check key length */
-	if (PHPC_STRLEN_P(ppv_key) != EVP_CIPHER_key_length(cipher) &&
-			!EVP_CIPHER_CTX_set_key_length(cipher_ctx, PHPC_STRLEN_P(ppv_key))) {
+	return php_crypto_stream_cipher_init(cipher_ctx, &params TSRMLS_CC);
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_set_segmented */
+static int php_crypto_stream_set_segmented(php_crypto_stream_data *data,
+		phpc_val *ppv_aead TSRMLS_DC)
+{
+	php_crypto_stream_segmented *seg;
+	phpc_val *ppv_key, *ppv_aad, *ppv_segment_size, *ppv_threads;
+	zval *pz_aead, *pz_segment_size, *pz_threads;
+	const EVP_CIPHER *cipher;
+	const php_crypto_cipher_mode *mode;
+	phpc_long_t segment_size = PHP_CRYPTO_STREAM_SEGMENT_SIZE_DEFAULT;
+	phpc_long_t threads = -1;
+	int enc, i;
+
+	/* the segments are read and written directly from the file, sink or descriptor */
+	if ((BIO_method_type(data->bio) & BIO_TYPE_FILTER) || data->seekable_ctx) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(SEGMENT_NOT_ALONE));
+		return FAILURE;
+	}
+	PHPC_PVAL_TO_PZVAL(ppv_aead, pz_aead);
+	if (php_crypto_stream_cipher_parse_algorithm(pz_aead, &enc, &cipher TSRMLS_CC) == FAILURE) {
+		return FAILURE;
+	}
+	/* the memory stream data are only written through the filters */
+	if (data->sink && !enc) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(MEMORY_FILTER_UNSUPPORTED));
+		return FAILURE;
+	}
+	mode = php_crypto_get_cipher_mode(cipher);
+	if (!mode || !mode->auth_enc || mode->auth_inlen_init) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(SEGMENT_MODE_INVALID));
+		return FAILURE;
+	}
+
+	if (!PHPC_HASH_CSTR_FIND_IN_COND(Z_ARRVAL_P(pz_aead), "key", ppv_key)) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_KEY_NOT_SUPPLIED));
+		return FAILURE;
+	}
+	if (PHPC_TYPE_P(ppv_key) != IS_STRING) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_KEY_TYPE_INVALID));
+		return FAILURE;
+	}
+	if (PHPC_STRLEN_P(ppv_key) != EVP_CIPHER_key_length(cipher)) {
 		php_crypto_error_ex(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_KEY_LENGTH_INVALID),
 				EVP_CIPHER_key_length(cipher));
 		return FAILURE;
 	}
-	/* check iv length */
-	if (PHPC_STRLEN_P(ppv_iv) != EVP_CIPHER_iv_length(cipher) &&
-			(!mode->auth_enc || !EVP_CIPHER_CTX_ctrl(
-				cipher_ctx, mode->auth_ivlen_flag, PHPC_STRLEN_P(ppv_iv), NULL))) {
-		php_crypto_error_ex(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_IV_LENGTH_INVALID),
-				EVP_CIPHER_iv_length(cipher));
+	if (!PHPC_HASH_CSTR_FIND_IN_COND(Z_ARRVAL_P(pz_aead), "aad", ppv_aad)) {
+		ppv_aad = NULL;
+	} else if (PHPC_TYPE_P(ppv_aad) != IS_STRING) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_AAD_TYPE_INVALID));
+		return FAILURE;
+	}
+	/* the decryption uses the segment size from the header */
+	if (enc && PHPC_HASH_CSTR_FIND_IN_COND(Z_ARRVAL_P(pz_aead), "segment_size", ppv_segment_size)) {
+		PHPC_PVAL_TO_PZVAL(ppv_segment_size, pz_segment_size);
+		if (Z_TYPE_P(pz_segment_size) != IS_LONG) {
+			php_crypto_error_ex(PHP_CRYPTO_STREAM_ERROR_ARGS(FILTER_PARAM_TYPE_INVALID),
+					"segment_size");
+			return FAILURE;
+		}
+		segment_size = Z_LVAL_P(pz_segment_size);
+		if (segment_size < PHP_CRYPTO_STREAM_SEGMENT_SIZE_MIN ||
+				segment_size > PHP_CRYPTO_STREAM_SEGMENT_SIZE_MAX) {
+			php_crypto_error_ex(PHP_CRYPTO_STREAM_ERROR_ARGS(SEGMENT_SIZE_INVALID),
+					PHP_CRYPTO_STREAM_SEGMENT_SIZE_MIN, PHP_CRYPTO_STREAM_SEGMENT_SIZE_MAX);
+			return FAILURE;
+		}
+	}
+	/* number of workers for the pipelined writer (0 means no pipeline) */
+	if (enc && PHPC_HASH_CSTR_FIND_IN_COND(Z_ARRVAL_P(pz_aead), "threads", ppv_threads)) {
+		PHPC_PVAL_TO_PZVAL(ppv_threads, pz_threads);
+		if (Z_TYPE_P(pz_threads) != IS_LONG) {
+			php_crypto_error_ex(PHP_CRYPTO_STREAM_ERROR_ARGS(FILTER_PARAM_TYPE_INVALID),
+					"threads");
+			return FAILURE;
+		}
+		threads = Z_LVAL_P(pz_threads);
+		if (threads < 0 || threads > PHP_CRYPTO_THREADS_MAX) {
+			php_crypto_error_ex(PHP_CRYPTO_STREAM_ERROR_ARGS(SEGMENT_THREADS_INVALID),
+					PHP_CRYPTO_THREADS_MAX);
+			return FAILURE;
+		}
+	} else if (enc) {
+		/* the pipeline is used by default only if crypto.threads allows more workers */
+		threads = php_crypto_thread_workers(PHP_CRYPTO_THREADS_MAX TSRMLS_CC);
+		if (threads < 2) {
+			threads = 0;
+		}
+	}
+
+	/* the state is freed on stream close (even if the rest of init fails) */
+	seg = ecalloc(1, sizeof(php_crypto_stream_segmented));
+	data->segmented = seg;
+	seg->enc = enc;
+	seg->mode = mode;
+	if (ppv_aad && PHPC_STRLEN_P(ppv_aad) > 0) {
+		seg->aad_len = PHPC_STRLEN_P(ppv_aad);
+		seg->aad = emalloc(seg->aad_len);
+		memcpy(seg->aad, PHPC_STRVAL_P(ppv_aad), seg->aad_len);
+	}
+	seg->ctx = EVP_CIPHER_CTX_new();
+	if (!seg->ctx || !EVP_CipherInit_ex(seg->ctx, cipher, NULL, NULL, NULL, enc)) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_INIT_FAILED));
+		return FAILURE;
+	}
+	if (!enc) {
+		/* the header with the key salt is read with the first segment */
+		seg->key_len = PHPC_STRLEN_P(ppv_key);
+		seg->key = emalloc(seg->key_len);
+		memcpy(seg->key, PHPC_STRVAL_P(ppv_key), seg->key_len);
+		return SUCCESS;
+	}
+
+	/* header with a random key salt and nonce prefix so each stream has its own key */
+	seg->segment_size = (size_t) segment_size;
+	seg->header[0] = PHP_CRYPTO_STREAM_SEGMENT_VERSION;
+	seg->header[1] = (unsigned char) (segment_size >> 24);
+	seg->header[2] = (unsigned char) (segment_size >> 16);
+	seg->header[3] = (unsigned char) (segment_size >> 8);
+	seg->header[4] = (unsigned char) segment_size;
+	if (php_crypto_rand_bytes(seg->header + PHP_CRYPTO_STREAM_SEGMENT_SALT_OFFSET,
+				PHP_CRYPTO_STREAM_SEGMENT_HEADER_SIZE -
+				PHP_CRYPTO_STREAM_SEGMENT_SALT_OFFSET TSRMLS_CC) == FAILURE ||
+			php_crypto_stream_segmented_set_key(seg,
+				(unsigned char *) PHPC_STRVAL_P(ppv_key), PHPC_STRLEN_P(ppv_key)) == FAILURE) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_INIT_FAILED));
+		return FAILURE;
+	}
+	if (BIO_write(data->bio, seg->header, sizeof(seg->header)) != sizeof(seg->header)) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(SEGMENT_WRITE_FAILED));
+		return FAILURE;
+	}
+	seg->header_done = 1;
+
+	/* the queued segments are bounded so the big segments use less workers */
+	while (threads > 0 && (size_t) PHP_CRYPTO_STREAM_PIPELINE_DEPTH(threads) *
+			(seg->segment_size + PHP_CRYPTO_STREAM_SEGMENT_TAG_SIZE) >
+			PHP_CRYPTO_STREAM_PIPELINE_MEMORY_MAX) {
+		threads--;
+	}
+	/* the memory sink can be moved to a file between the writes */
+	if (threads > 0 && !data->sink) {
+		/* each worker seals segments with its own copy of the keyed context */
+		seg->worker_ctx = ecalloc(threads, sizeof(EVP_CIPHER_CTX *));
+		seg->workers = (int) threads;
+		for (i = 0; i < seg->workers; i++) {
+			seg->worker_ctx[i] = EVP_CIPHER_CTX_new();
+			if (!seg->worker_ctx[i] || !EVP_CIPHER_CTX_copy(seg->worker_ctx[i], seg->ctx)) {
+				php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_INIT_FAILED));
+				return FAILURE;
+			}
+		}
+		seg->pipeline = php_crypto_thread_pipeline_create(
+				php_crypto_stream_segmented_process, php_crypto_stream_segmented_output,
+				data, (int) seg->segment_size + PHP_CRYPTO_STREAM_SEGMENT_TAG_SIZE,
+				seg->workers, PHP_CRYPTO_STREAM_PIPELINE_DEPTH(seg->workers));
+		if (seg->pipeline) {
+			seg->buf = php_crypto_thread_pipeline_get(seg->pipeline);
+			return SUCCESS;
+		}
+		/* without threads the segments are sealed in the stream write */
+	}
+	seg->buf = emalloc(seg->segment_size + PHP_CRYPTO_STREAM_SEGMENT_TAG_SIZE + 1);
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_set_compress */
+static int php_crypto_stream_set_compress(php_crypto_stream_data *data,
+		phpc_val *ppv_compress, const char *mode TSRMLS_DC)
+{
+	php_crypto_stream_compress *comp;
+	php_crypto_compress_algorithm algorithm = PHP_CRYPTO_COMPRESS_ZLIB;
+	phpc_val *ppv_algorithm, *ppv_level;
+	zval *pz_compress, *pz_level;
+	phpc_long_t level = PHP_CRYPTO_COMPRESS_LEVEL_DEFAULT;
+	const char *algorithm_name = "zlib";
+
+	/* the plain data are compressed so no other filter can be before it */
+	if ((BIO_method_type(data->bio) & BIO_TYPE_FILTER) ||
+			data->seekable_ctx || data->segmented || data->compress) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(COMPRESS_NOT_FIRST));
+		return FAILURE;
+	}
+	PHPC_PVAL_TO_PZVAL(ppv_compress, pz_compress);
+	if (PHPC_HASH_CSTR_FIND_IN_COND(Z_ARRVAL_P(pz_compress), "algorithm", ppv_algorithm)) {
+		if (PHPC_TYPE_P(ppv_algorithm) != IS_STRING) {
+			php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(COMPRESS_ALGORITHM_TYPE_INVALID));
+			return FAILURE;
+		}
+		algorithm_name = PHPC_STRVAL_P(ppv_algorithm);
+	}
+	if (php_crypto_compress_find(algorithm_name, &algorithm) == FAILURE) {
+		php_crypto_error_ex(PHP_CRYPTO_STREAM_ERROR_ARGS(COMPRESS_ALGORITHM_UNKNOWN), algorithm_name);
+		return FAILURE;
+	}
+	if (PHPC_HASH_CSTR_FIND_IN_COND(Z_ARRVAL_P(pz_compress), "level", ppv_level)) {
+		PHPC_PVAL_TO_PZVAL(ppv_level, pz_level);
+		if (Z_TYPE_P(pz_level) != IS_LONG) {
+			php_crypto_error_ex(PHP_CRYPTO_STREAM_ERROR_ARGS(FILTER_PARAM_TYPE_INVALID), "level");
+			return FAILURE;
+		}
+		level = Z_LVAL_P(pz_level);
+	}
+	/* the memory streams only write through the filters */
+	if (strchr(mode, '+') && !data->sink) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(COMPRESS_MODE_INVALID));
+		return FAILURE;
+	}
+
+	comp = ecalloc(1, sizeof(php_crypto_stream_compress));
+	data->compress = comp;
+	comp->enc = data->sink || mode[0] != 'r';
+	if (level < INT_MIN || level > INT_MAX ||
+			(comp->ctx = php_crypto_compress_create(algorithm, (int) level, comp->enc)) == NULL) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(COMPRESS_INIT_FAILED));
 		return FAILURE;
 	}
+	comp->buf = emalloc(PHP_CRYPTO_STREAM_COMPRESS_BUFFER_SIZE);
 
-	/* initialize cipher with key and iv */
-	if (!EVP_CipherInit_ex(cipher_ctx, NULL, NULL,
-			(unsigned char *) PHPC_STRVAL_P(ppv_key),
-			(unsigned char *) PHPC_STRVAL_P(ppv_iv), enc)) {
-		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(CIPHER_INIT_FAILED));
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_set_buffer
+	Sets the file buffer so the file is read and written in large blocks */
+static int php_crypto_stream_set_buffer(php_crypto_stream_data *data,
+		phpc_val *ppv_buffer_size, size_t *buffer_size TSRMLS_DC)
+{
+	zval *pz_buffer_size;
+	FILE *fp;
+	phpc_long_t size;
+
+	PHPC_PVAL_TO_PZVAL(ppv_buffer_size, pz_buffer_size);
+	if (Z_TYPE_P(pz_buffer_size) != IS_LONG) {
+		size = 0;
+	} else {
+		size = Z_LVAL_P(pz_buffer_size);
+	}
+	if (size < PHP_CRYPTO_STREAM_BUFFER_SIZE_MIN || size > PHP_CRYPTO_STREAM_BUFFER_SIZE_MAX) {
+		php_crypto_error_ex(PHP_CRYPTO_STREAM_ERROR_ARGS(BUFFER_SIZE_INVALID),
+				PHP_CRYPTO_STREAM_BUFFER_SIZE_MIN, PHP_CRYPTO_STREAM_BUFFER_SIZE_MAX);
 		return FAILURE;
 	}
 
-	if (!mode->auth_enc) {
+	/* the buffer is freed after the file is closed */
+	data->buffer = emalloc((size_t) size);
+	BIO_get_fp(data->bio, &fp);
+	if (setvbuf(fp, data->buffer, _IOFBF, (size_t) size)) {
+		/* the stream works without the buffer */
+		efree(data->buffer);
+		data->buffer = NULL;
 		return SUCCESS;
 	}
+	*buffer_size = (size_t) size;
 
-	/* authentication tag */
-	if (ppv_tag && php_crypto_cipher_set_tag(cipher_ctx, mode,
-			(unsigned char *) PHPC_STRVAL_P(ppv_tag),
-			PHPC_STRLEN_P(ppv_tag) TSRMLS_CC) == FAILURE) {
-		return FAILURE;
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_set_mmap
+	Sets the mmap read path if the read only stream reads directly from
+	the file (the file is mapped on the first read) */
+static void php_crypto_stream_set_mmap(php_crypto_stream_data *data, const char *mode)
+{
+#ifdef PHP_CRYPTO_STREAM_HAS_MMAP
+	php_crypto_stream_mmap *map;
+	struct stat sb;
+	FILE *fp;
+	long page_size;
+
+	/* the cipher filters read from the file bio so they do not use the mapping */
+	if (mode[0] != 'r' || strchr(mode, '+') || BIO_method_type(data->bio) != BIO_TYPE_FILE) {
+		return;
 	}
-	/* additional authentication data */
-	if (ppv_aad) {
-		aad =  (unsigned char *) PHPC_STRVAL_P(ppv_aad);
-		aad_len = PHPC_STRLEN_P(ppv_aad);
-	} else {
-		aad = NULL;
-		aad_len = 0;
+	BIO_get_fp(data->bio, &fp);
+	if (fstat(fileno(fp), &sb) || !S_ISREG(sb.st_mode)) {
+		return;
 	}
-	if (php_crypto_cipher_write_aad(cipher_ctx, aad, aad_len TSRMLS_CC) == FAILURE) {
-		return FAILURE;
+	page_size = sysconf(_SC_PAGESIZE);
+
+	map = ecalloc(1, sizeof(php_crypto_stream_mmap));
+	map->fd = fileno(fp);
+	map->size = (uint64_t) sb.st_size;
+	map->page_size = page_size > 0 ? (size_t) page_size : PHP_CRYPTO_STREAM_MMAP_PAGE_SIZE;
+	data->map = map;
+#endif
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_set_uring
+	Sets the io_uring backend if the stream only reads or only writes
+	directly to the file */
+static void php_crypto_stream_set_uring(php_crypto_stream_data *data,
+		const char *mode, size_t buffer_size)
+{
+	FILE *fp;
+	long offset;
+
+	/* the appended writes could be reordered and the cipher filters use the file bio */
+	if (mode[0] == 'a' || strchr(mode, '+') || data->map ||
+			BIO_method_type(data->bio) != BIO_TYPE_FILE ||
+			(data->segmented && data->segmented->pipeline)) {
+		return;
+	}
+	/* the aead header is already written */
+	BIO_flush(data->bio);
+	offset = BIO_ctrl(data->bio, BIO_C_FILE_TELL, 0, NULL);
+	if (offset < 0) {
+		return;
+	}
+	BIO_get_fp(data->bio, &fp);
+	data->uring = php_crypto_uring_create(fileno(fp), (uint64_t) offset,
+			buffer_size ? buffer_size : PHP_CRYPTO_URING_BUFFER_SIZE);
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_set_filters
+	Sets the filters from the context to the bio chain */
+static int php_crypto_stream_set_filters(php_crypto_stream_data *data,
+		php_stream_context *context, const char *mode TSRMLS_DC)
+{
+	phpc_val *ppv_filter, *ppv_filter_item, *ppv_type;
+
+	if (PHPC_STREAM_CONTEXT_GET_OPTION_IN_COND(context,
+			PHP_CRYPTO_STREAM_WRAPPER_NAME, "filters", ppv_filter)) {
+		if (PHPC_TYPE_P(ppv_filter) != IS_ARRAY) {
+			php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(FILTERS_CONTEXT_TYPE_INVALID));
+			return FAILURE;
+		}
+		PHPC_HASH_FOREACH_VAL(PHPC_ARRVAL_P(ppv_filter), ppv_filter_item) {
+			if (PHPC_TYPE_P(ppv_filter_item) != IS_ARRAY) {
+				php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(FILTERS_ITEM_CONTEXT_TYPE_INVALID));
+				return FAILURE;
+			}
+			if (!PHPC_HASH_CSTR_FIND_IN_COND(PHPC_ARRVAL_P(ppv_filter_item), "type", ppv_type)) {
+				php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(FILTER_TYPE_NOT_SUPPLIED));
+				return FAILURE;
+			}
+			if (PHPC_TYPE_P(ppv_type) != IS_STRING) {
+				php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(FILTER_TYPE_INVALID));
+				return FAILURE;
+			}
+			/* call filter handler for supplied type */
+			if (strncmp(PHPC_STRVAL_P(ppv_type), "cipher", sizeof("cipher") - 1) == 0) {
+				if (php_crypto_stream_set_cipher(data, ppv_filter_item TSRMLS_CC) == FAILURE) {
+					return FAILURE;
+				}
+			} else if (strncmp(PHPC_STRVAL_P(ppv_type), "aead", sizeof("aead") - 1) == 0) {
+				if (php_crypto_stream_set_segmented(data, ppv_filter_item TSRMLS_CC) == FAILURE) {
+					return FAILURE;
+				}
+			} else if (strncmp(PHPC_STRVAL_P(ppv_type), "compress", sizeof("compress") - 1) == 0) {
+				if (php_crypto_stream_set_compress(data, ppv_filter_item, mode TSRMLS_CC) == FAILURE) {
+					return FAILURE;
+				}
+			} else {
+				php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(FILTER_TYPE_UNKNOWN));
+				return FAILURE;
+			}
+		} PHPC_HASH_FOREACH_END();
 	}
 
 	return SUCCESS;
@@ -518,7 +2565,9 @@ static php_stream *php_crypto_stream_opener(php_stream_wrapper *wrapper,
 		PHPC_STR_ARG_PTR_VAL(p_opened_path), php_stream_context *context STREAMS_DC TSRMLS_DC)
 {
 	char *realpath;
-	phpc_val *ppv_filter;
+	phpc_val *ppv_buffer_size, *ppv_mmap, *ppv_uring;
+	zval *pz_mmap, *pz_uring;
+	size_t buffer_size = 0;
 	php_stream *stream;
 	php_crypto_stream_data *self;
 	php_crypto_error_action initial_error_action = PHP_CRYPTO_G(error_action);
@@ -539,47 +2588,48 @@ static php_stream *php_crypto_stream_opener(php_stream_wrapper *wrapper,
 
 	PHP_CRYPTO_G(error_action) = PHP_CRYPTO_STREAM_ERROR_ACTION;
 
-	self = emalloc(sizeof(*self));
+	self = ecalloc(1, sizeof(*self));
 	self->bio = BIO_new_file(realpath, mode);
 	if (self->bio == NULL) {
 		goto opener_error_on_bio_init;
 	}
 
+	/* the buffer has to be set before the first file operation */
 	if (PHPC_STREAM_CONTEXT_GET_OPTION_IN_COND(context,
-			PHP_CRYPTO_STREAM_WRAPPER_NAME, "filters", ppv_filter)) {
-		phpc_val *ppv_filter_item, *ppv_type;
+			PHP_CRYPTO_STREAM_WRAPPER_NAME, "buffer_size", ppv_buffer_size) &&
+			php_crypto_stream_set_buffer(self, ppv_buffer_size, &buffer_size TSRMLS_CC) == FAILURE) {
+		goto opener_error;
+	}
 
-		if (PHPC_TYPE_P(ppv_filter) != IS_ARRAY) {
-			php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(FILTERS_CONTEXT_TYPE_INVALID));
-			goto opener_error;
+	if (php_crypto_stream_set_filters(self, context, mode TSRMLS_CC) == FAILURE) {
+		goto opener_error;
+	}
+
+	if (PHPC_STREAM_CONTEXT_GET_OPTION_IN_COND(context,
+			PHP_CRYPTO_STREAM_WRAPPER_NAME, "mmap", ppv_mmap)) {
+		PHPC_PVAL_TO_PZVAL(ppv_mmap, pz_mmap);
+		if (zend_is_true(pz_mmap)) {
+			php_crypto_stream_set_mmap(self, mode);
+		}
+	}
+	if (PHPC_STREAM_CONTEXT_GET_OPTION_IN_COND(context,
+			PHP_CRYPTO_STREAM_WRAPPER_NAME, "io_uring", ppv_uring)) {
+		PHPC_PVAL_TO_PZVAL(ppv_uring, pz_uring);
+		if (zend_is_true(pz_uring)) {
+			php_crypto_stream_set_uring(self, mode, buffer_size);
 		}
-		PHPC_HASH_FOREACH_VAL(PHPC_ARRVAL_P(ppv_filter), ppv_filter_item) {
-			if (PHPC_TYPE_P(ppv_filter_item) != IS_ARRAY) {
-				php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(FILTERS_ITEM_CONTEXT_TYPE_INVALID));
-				goto opener_error;
-			}
-			if (!PHPC_HASH_CSTR_FIND_IN_COND(PHPC_ARRVAL_P(ppv_filter_item), "type", ppv_type)) {
-				php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(FILTER_TYPE_NOT_SUPPLIED));
-				goto opener_error;
-			}
-			if (PHPC_TYPE_P(ppv_type) != IS_STRING) {
-				php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(FILTER_TYPE_INVALID));
-				goto opener_error;
-			}
-			/* call filter handler for supplied type */
-			if (strncmp(PHPC_STRVAL_P(ppv_type), "cipher", sizeof("cipher") - 1) == 0) {
-				if (php_crypto_stream_set_cipher(self, ppv_filter_item TSRMLS_CC) == FAILURE) {
-					goto opener_error;
-				}
-			} else {
-				php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(FILTER_TYPE_UNKNOWN));
-				goto opener_error;
-			}
-		} PHPC_HASH_FOREACH_END();
 	}
 
 	stream = php_stream_alloc_rel(&php_crypto_stream_ops, self, 0, mode);
 	if (stream) {
+		/* the caller can find out whether the ring is used or the BIO fallback */
+		if (self->uring) {
+			php_crypto_stream_set_meta(stream, PHP_CRYPTO_STREAM_META_IO, "io_uring");
+		}
+		/* the stream layer reads and writes in blocks of the buffer size */
+		if (buffer_size) {
+			php_stream_set_chunk_size(stream, buffer_size);
+		}
 		if (PHPC_STR_EXISTS(p_opened_path)) {
 			PHPC_STR_DECLARE(opened_path);
 			PHPC_STR_INIT(opened_path, realpath, strlen(realpath));
@@ -592,6 +2642,18 @@ static php_stream *php_crypto_stream_opener(php_stream_wrapper *wrapper,
 
 opener_error:
 	BIO_free_all(self->bio);
+	if (self->buffer) {
+		efree(self->buffer);
+	}
+	if (self->seekable_ctx) {
+		EVP_CIPHER_CTX_free(self->seekable_ctx);
+	}
+	if (self->segmented) {
+		php_crypto_stream_segmented_free(self->segmented);
+	}
+	if (self->compress) {
+		php_crypto_stream_compress_free(self->compress);
+	}
 opener_error_on_bio_init:
 	PHP_CRYPTO_G(error_action) = initial_error_action;
 	efree(self);
@@ -600,6 +2662,213 @@ opener_error_on_bio_init:
 }
 /* }}} */
 
+/* {{{ php_crypto_stream_memory_opener */
+static php_stream *php_crypto_stream_memory_opener(php_stream_wrapper *wrapper,
+		phpc_stream_opener_char_t *path, phpc_stream_opener_char_t *mode, int options,
+		PHPC_STR_ARG_PTR_VAL(p_opened_path), php_stream_context *context STREAMS_DC TSRMLS_DC)
+{
+	php_stream *stream;
+	php_crypto_stream_data *self;
+	php_crypto_error_action initial_error_action = PHP_CRYPTO_G(error_action);
+	phpc_long_t max_memory = 0;
+
+	PHP_CRYPTO_G(error_action) = PHP_CRYPTO_STREAM_ERROR_ACTION;
+
+	/* the temp stream keeps at most max memory bytes in memory */
+	if (strncasecmp(PHP_CRYPTO_STREAM_TEMP_SCHEME, path, PHP_CRYPTO_STREAM_TEMP_SCHEME_SIZE) == 0) {
+		path += PHP_CRYPTO_STREAM_TEMP_SCHEME_SIZE;
+		max_memory = PHP_CRYPTO_STREAM_TEMP_MAX_MEMORY;
+		if (strncasecmp(PHP_CRYPTO_STREAM_TEMP_MAX_MEMORY_PARAM, path,
+				PHP_CRYPTO_STREAM_TEMP_MAX_MEMORY_PARAM_SIZE) == 0) {
+			max_memory = ZEND_STRTOL(path + PHP_CRYPTO_STREAM_TEMP_MAX_MEMORY_PARAM_SIZE, NULL, 10);
+			if (max_memory < 0) {
+				php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(TEMP_MAX_MEMORY_INVALID));
+				PHP_CRYPTO_G(error_action) = initial_error_action;
+				return NULL;
+			}
+			/* zero means that the data are always in the file */
+			if (max_memory == 0) {
+				max_memory = 1;
+			}
+		}
+	}
+
+	self = ecalloc(1, sizeof(*self));
+	self->bio = self->sink = BIO_new(BIO_s_mem());
+	if (self->bio == NULL) {
+		goto opener_error_on_bio_init;
+	}
+	self->spill_size = (size_t) max_memory;
+
+	if (php_crypto_stream_set_filters(self, context, mode TSRMLS_CC) == FAILURE) {
+		goto opener_error;
+	}
+
+	stream = php_stream_alloc_rel(&php_crypto_stream_memory_ops, self, 0, mode);
+
+	return stream;
+
+opener_error:
+	BIO_free_all(self->bio);
+	if (self->segmented) {
+		php_crypto_stream_segmented_free(self->segmented);
+	}
+	if (self->compress) {
+		php_crypto_stream_compress_free(self->compress);
+	}
+opener_error_on_bio_init:
+	PHP_CRYPTO_G(error_action) = initial_error_action;
+	efree(self);
+	return NULL;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_open_bio
+	Opens the stream for the descriptor bio with the filters from the context */
+static php_stream *php_crypto_stream_open_bio(BIO *bio, const char *mode,
+		php_stream_context *context, php_crypto_error_action initial_error_action
+		STREAMS_DC TSRMLS_DC)
+{
+	php_stream *stream;
+	php_crypto_stream_data *self;
+	struct stat sb;
+	int fd;
+
+	self = ecalloc(1, sizeof(*self));
+	self->bio = bio;
+	if (php_crypto_stream_set_filters(self, context, mode TSRMLS_CC) == FAILURE) {
+		goto opener_error;
+	}
+
+	stream = php_stream_alloc_rel(&php_crypto_stream_ops, self, 0, mode);
+	if (stream) {
+		/* pipes and sockets cannot be seeked */
+		fd = php_crypto_stream_get_fd(self);
+		if (fd < 0 || fstat(fd, &sb) || !S_ISREG(sb.st_mode)) {
+			stream->flags |= PHP_STREAM_FLAG_NO_SEEK;
+		}
+	}
+	return stream;
+
+opener_error:
+	BIO_free_all(self->bio);
+	if (self->segmented) {
+		php_crypto_stream_segmented_free(self->segmented);
+	}
+	if (self->compress) {
+		php_crypto_stream_compress_free(self->compress);
+	}
+	PHP_CRYPTO_G(error_action) = initial_error_action;
+	efree(self);
+	return NULL;
+}
+/* }}} */
+
+/* {{{ php_crypto_stream_fd_opener */
+static php_stream *php_crypto_stream_fd_opener(php_stream_wrapper *wrapper,
+		phpc_stream_opener_char_t *path, phpc_stream_opener_char_t *mode, int options,
+		PHPC_STR_ARG_PTR_VAL(p_opened_path), php_stream_context *context STREAMS_DC TSRMLS_DC)
+{
+	BIO *bio;
+	char *end;
+	long fd_num;
+	int fd;
+	php_crypto_error_action initial_error_action = PHP_CRYPTO_G(error_action);
+
+	if (strncasecmp(PHP_CRYPTO_STREAM_FD_SCHEME, path, PHP_CRYPTO_STREAM_FD_SCHEME_SIZE) == 0) {
+		path += PHP_CRYPTO_STREAM_FD_SCHEME_SIZE;
+	}
+
+	PHP_CRYPTO_G(error_action) = PHP_CRYPTO_STREAM_ERROR_ACTION;
+
+	/* the same restriction as for php://fd */
+	if (strcmp(sapi_module.name, "cli")) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(FD_NOT_ALLOWED));
+		goto opener_error;
+	}
+	fd_num = ZEND_STRTOL(path, &end, 10);
+	if (end == path || *end != '\0' || fd_num < 0 || fd_num > INT_MAX) {
+		php_crypto_error_ex(PHP_CRYPTO_STREAM_ERROR_ARGS(FD_INVALID), path);
+		goto opener_error;
+	}
+	/* the stream owns a duplicate so the original descriptor stays open */
+	fd = dup((int) fd_num);
+	if (fd < 0) {
+		php_crypto_error_ex(PHP_CRYPTO_STREAM_ERROR_ARGS(FD_INVALID), path);
+		goto opener_error;
+	}
+	bio = BIO_new_fd(fd, BIO_CLOSE);
+	if (bio == NULL) {
+		close(fd);
+		goto opener_error;
+	}
+
+	return php_crypto_stream_open_bio(bio, mode, context, initial_error_action
+			STREAMS_CC TSRMLS_CC);
+
+opener_error:
+	PHP_CRYPTO_G(error_action) = initial_error_action;
+	return NULL;
+}
+/* }}} */
+
+#ifdef PHP_CRYPTO_STREAM_HAS_SOCKET
+/* {{{ php_crypto_stream_socket_opener */
+static php_stream *php_crypto_stream_socket_opener(php_stream_wrapper *wrapper,
+		phpc_stream_opener_char_t *path, phpc_stream_opener_char_t *mode, int options,
+		PHPC_STR_ARG_PTR_VAL(p_opened_path), php_stream_context *context STREAMS_DC TSRMLS_DC)
+{
+	struct sockaddr_un addr;
+	BIO *bio;
+	size_t path_len;
+	int fd, connect_errno;
+	php_crypto_error_action initial_error_action = PHP_CRYPTO_G(error_action);
+
+	if (strncasecmp(PHP_CRYPTO_STREAM_SOCKET_SCHEME, path, PHP_CRYPTO_STREAM_SOCKET_SCHEME_SIZE) == 0) {
+		path += PHP_CRYPTO_STREAM_SOCKET_SCHEME_SIZE;
+	}
+
+	if (((options & STREAM_DISABLE_OPEN_BASEDIR) == 0) && php_check_open_basedir(path TSRMLS_CC)) {
+		return NULL;
+	}
+
+	PHP_CRYPTO_G(error_action) = PHP_CRYPTO_STREAM_ERROR_ACTION;
+
+	path_len = strlen(path);
+	if (path_len >= sizeof(addr.sun_path)) {
+		php_crypto_error(PHP_CRYPTO_STREAM_ERROR_ARGS(SOCKET_PATH_INVALID));
+		goto opener_error;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	memcpy(addr.sun_path, path, path_len);
+
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0 || connect(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+		connect_errno = errno;
+		if (fd >= 0) {
+			close(fd);
+		}
+		php_crypto_error_ex(PHP_CRYPTO_STREAM_ERROR_ARGS(SOCKET_CONNECT_FAILED),
+				path, strerror(connect_errno));
+		goto opener_error;
+	}
+	bio = BIO_new_socket(fd, BIO_CLOSE);
+	if (bio == NULL) {
+		close(fd);
+		goto opener_error;
+	}
+
+	return php_crypto_stream_open_bio(bio, mode, context, initial_error_action
+			STREAMS_CC TSRMLS_CC);
+
+opener_error:
+	PHP_CRYPTO_G(error_action) = initial_error_action;
+	return NULL;
+}
+/* }}} */
+#endif
+
 /* crypto stream wrapper options */
 static php_stream_wrapper_ops php_crypto_stream_wrapper_ops = {
 	php_crypto_stream_opener,
@@ -621,11 +2890,86 @@ static php_stream_wrapper php_crypto_stream_wrapper = {
 	0
 };
 
+/* crypto memory and temp stream wrapper options */
+static php_stream_wrapper_ops php_crypto_stream_memory_wrapper_ops = {
+	php_crypto_stream_memory_opener,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	"crypto",
+	NULL,
+	NULL,
+	NULL,
+	NULL
+};
+
+/* crypto memory and temp stream wrapper */
+static php_stream_wrapper php_crypto_stream_memory_wrapper = {
+	&php_crypto_stream_memory_wrapper_ops,
+	NULL,
+	0
+};
+
+/* crypto fd stream wrapper options */
+static php_stream_wrapper_ops php_crypto_stream_fd_wrapper_ops = {
+	php_crypto_stream_fd_opener,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	"crypto",
+	NULL,
+	NULL,
+	NULL,
+	NULL
+};
+
+/* crypto fd stream wrapper */
+static php_stream_wrapper php_crypto_stream_fd_wrapper = {
+	&php_crypto_stream_fd_wrapper_ops,
+	NULL,
+	0
+};
+
+#ifdef PHP_CRYPTO_STREAM_HAS_SOCKET
+/* crypto socket stream wrapper options */
+static php_stream_wrapper_ops php_crypto_stream_socket_wrapper_ops = {
+	php_crypto_stream_socket_opener,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	"crypto",
+	NULL,
+	NULL,
+	NULL,
+	NULL
+};
+
+/* crypto socket stream wrapper */
+static php_stream_wrapper php_crypto_stream_socket_wrapper = {
+	&php_crypto_stream_socket_wrapper_ops,
+	NULL,
+	0
+};
+#endif
+
 /* {{{ PHP_MINIT_FUNCTION */
 PHP_MINIT_FUNCTION(crypto_stream)
 {
 	php_register_url_stream_wrapper(PHP_CRYPTO_STREAM_FILE_WRAPPER_NAME,
 			&php_crypto_stream_wrapper TSRMLS_CC);
+	php_register_url_stream_wrapper(PHP_CRYPTO_STREAM_MEMORY_WRAPPER_NAME,
+			&php_crypto_stream_memory_wrapper TSRMLS_CC);
+	php_register_url_stream_wrapper(PHP_CRYPTO_STREAM_TEMP_WRAPPER_NAME,
+			&php_crypto_stream_memory_wrapper TSRMLS_CC);
+	php_register_url_stream_wrapper(PHP_CRYPTO_STREAM_FD_WRAPPER_NAME,
+			&php_crypto_stream_fd_wrapper TSRMLS_CC);
+#ifdef PHP_CRYPTO_STREAM_HAS_SOCKET
+	php_register_url_stream_wrapper(PHP_CRYPTO_STREAM_SOCKET_WRAPPER_NAME,
+			&php_crypto_stream_socket_wrapper TSRMLS_CC);
+#endif
 
 	return SUCCESS;
 }
@@ -635,6 +2979,12 @@ PHP_MINIT_FUNCTION(crypto_stream)
 PHP_MSHUTDOWN_FUNCTION(crypto_stream)
 {
 	php_unregister_url_stream_wrapper(PHP_CRYPTO_STREAM_FILE_WRAPPER_NAME TSRMLS_CC);
+	php_unregister_url_stream_wrapper(PHP_CRYPTO_STREAM_MEMORY_WRAPPER_NAME TSRMLS_CC);
+	php_unregister_url_stream_wrapper(PHP_CRYPTO_STREAM_TEMP_WRAPPER_NAME TSRMLS_CC);
+	php_unregister_url_stream_wrapper(PHP_CRYPTO_STREAM_FD_WRAPPER_NAME TSRMLS_CC);
+#ifdef PHP_CRYPTO_STREAM_HAS_SOCKET
+	php_unregister_url_stream_wrapper(PHP_CRYPTO_STREAM_SOCKET_WRAPPER_NAME TSRMLS_CC);
+#endif
 
 	return SUCCESS;
 }
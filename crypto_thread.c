@@ -0,0 +1,468 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 2013-2016 Jakub Zelenka                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: Jakub Zelenka <bukka@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "php.h"
+#include "php_crypto.h"
+#include "php_crypto_thread.h"
+
+#include <openssl/crypto.h>
+
+#ifdef HAVE_CRYPTO_PTHREAD
+#include <pthread.h>
+#endif
+
+ZEND_EXTERN_MODULE_GLOBALS(crypto)
+
+/* {{{ php_crypto_thread_workers */
+PHP_CRYPTO_API int php_crypto_thread_workers(int items TSRMLS_DC)
+{
+#ifdef HAVE_CRYPTO_PTHREAD
+	phpc_long_t workers = PHP_CRYPTO_G(threads);
+
+	if (workers > PHP_CRYPTO_THREADS_MAX) {
+		workers = PHP_CRYPTO_THREADS_MAX;
+	}
+	if (workers > items) {
+		workers = items;
+	}
+	return workers < 1 ? 1 : (int) workers;
+#else
+	return 1;
+#endif
+}
+/* }}} */
+
+#ifdef HAVE_CRYPTO_PTHREAD
+
+typedef struct {
+	php_crypto_thread_func func;
+	void *data;
+	int items;
+	int next;
+	pthread_mutex_t mutex;
+} php_crypto_thread_pool;
+
+typedef struct {
+	php_crypto_thread_pool *pool;
+	int worker;
+} php_crypto_thread_worker;
+
+/* {{{ php_crypto_thread_work */
+static void php_crypto_thread_work(php_crypto_thread_pool *pool, int worker)
+{
+	int item;
+
+	for (;;) {
+		pthread_mutex_lock(&pool->mutex);
+		item = pool->next++;
+		pthread_mutex_unlock(&pool->mutex);
+		if (item >= pool->items) {
+			break;
+		}
+		pool->func(pool->data, worker, item);
+	}
+}
+/* }}} */
+
+/* {{{ php_crypto_thread_main */
+static void *php_crypto_thread_main(void *arg)
+{
+	php_crypto_thread_worker *w = (php_crypto_thread_worker *) arg;
+
+	php_crypto_thread_work(w->pool, w->worker);
+
+	return NULL;
+}
+/* }}} */
+
+#endif
+
+/* {{{ php_crypto_thread_run */
+PHP_CRYPTO_API void php_crypto_thread_run(
+		php_crypto_thread_func func, void *data, int items, int workers)
+{
+#ifdef HAVE_CRYPTO_PTHREAD
+	php_crypto_thread_pool pool;
+	php_crypto_thread_worker w[PHP_CRYPTO_THREADS_MAX];
+	pthread_t threads[PHP_CRYPTO_THREADS_MAX];
+	int i, started = 0;
+
+	if (workers > PHP_CRYPTO_THREADS_MAX) {
+		workers = PHP_CRYPTO_THREADS_MAX;
+	}
+	if (workers > items) {
+		workers = items;
+	}
+
+	if (workers > 1) {
+		pool.func = func;
+		pool.data = data;
+		pool.items = items;
+		pool.next = 0;
+		pthread_mutex_init(&pool.mutex, NULL);
+
+		/* if a thread cannot be created, the work is done by the started ones */
+		for (i = 1; i < workers; i++) {
+			w[started].pool = &pool;
+			w[started].worker = i;
+			if (pthread_create(&threads[started], NULL,
+					php_crypto_thread_main, &w[started]) != 0) {
+				break;
+			}
+			started++;
+		}
+
+		php_crypto_thread_work(&pool, 0);
+
+		for (i = 0; i < started; i++) {
+			pthread_join(threads[i], NULL);
+		}
+		pthread_mutex_destroy(&pool.mutex);
+		return;
+	}
+#endif
+	{
+		int item;
+
+		for (item = 0; item < items; item++) {
+			func(data, 0, item);
+		}
+	}
+}
+/* }}} */
+
+#ifdef HAVE_CRYPTO_PTHREAD
+
+/* pipeline item states */
+typedef enum {
+	PHP_CRYPTO_THREAD_ITEM_FREE = 0,
+	PHP_CRYPTO_THREAD_ITEM_QUEUED,
+	PHP_CRYPTO_THREAD_ITEM_PROCESSING,
+	PHP_CRYPTO_THREAD_ITEM_DONE
+} php_crypto_thread_item_state;
+
+typedef struct {
+	unsigned char *buf;
+	int len;
+	int last;
+	uint32_t index;
+	php_crypto_thread_item_state state;
+} php_crypto_thread_item;
+
+typedef struct {
+	struct _php_crypto_thread_pipeline *pipeline;
+	int worker;
+} php_crypto_thread_pipeline_worker_data;
+
+struct _php_crypto_thread_pipeline {
+	php_crypto_thread_pipeline_process_func process;
+	php_crypto_thread_pipeline_write_func write;
+	void *data;
+	php_crypto_thread_item *items;
+	/* one block for the buffers of all items */
+	unsigned char *bufs;
+	int depth;
+	int item_size;
+	/* counters of submitted, processing and written items */
+	uint64_t submitted;
+	uint64_t next;
+	uint64_t written;
+	int failed;
+	int stop;
+	/* one condition is used for all state changes */
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	pthread_t threads[PHP_CRYPTO_THREADS_MAX + 1];
+	int started;
+	php_crypto_thread_pipeline_worker_data workers[PHP_CRYPTO_THREADS_MAX];
+};
+
+/* {{{ php_crypto_thread_pipeline_worker */
+static void *php_crypto_thread_pipeline_worker(void *arg)
+{
+	php_crypto_thread_pipeline_worker_data *w = (php_crypto_thread_pipeline_worker_data *) arg;
+	php_crypto_thread_pipeline *pipeline = w->pipeline;
+	php_crypto_thread_item *item;
+	int len, failed;
+
+	pthread_mutex_lock(&pipeline->mutex);
+	for (;;) {
+		while (pipeline->next == pipeline->submitted && !pipeline->stop) {
+			pthread_cond_wait(&pipeline->cond, &pipeline->mutex);
+		}
+		if (pipeline->next == pipeline->submitted) {
+			break;
+		}
+		item = &pipeline->items[pipeline->next++ % pipeline->depth];
+		item->state = PHP_CRYPTO_THREAD_ITEM_PROCESSING;
+		failed = pipeline->failed;
+		pthread_mutex_unlock(&pipeline->mutex);
+
+		len = failed ? -1 : pipeline->process(pipeline->data, w->worker,
+				item->buf, item->len, item->index, item->last);
+
+		pthread_mutex_lock(&pipeline->mutex);
+		if (len < 0) {
+			pipeline->failed = 1;
+		}
+		item->len = len;
+		item->state = PHP_CRYPTO_THREAD_ITEM_DONE;
+		pthread_cond_broadcast(&pipeline->cond);
+	}
+	pthread_mutex_unlock(&pipeline->mutex);
+
+	return NULL;
+}
+/* }}} */
+
+/* {{{ php_crypto_thread_pipeline_writer */
+static void *php_crypto_thread_pipeline_writer(void *arg)
+{
+	php_crypto_thread_pipeline *pipeline = (php_crypto_thread_pipeline *) arg;
+	php_crypto_thread_item *item;
+	int failed;
+
+	pthread_mutex_lock(&pipeline->mutex);
+	for (;;) {
+		item = &pipeline->items[pipeline->written % pipeline->depth];
+		while (item->state != PHP_CRYPTO_THREAD_ITEM_DONE &&
+				!(pipeline->stop && pipeline->written == pipeline->submitted)) {
+			pthread_cond_wait(&pipeline->cond, &pipeline->mutex);
+		}
+		if (item->state != PHP_CRYPTO_THREAD_ITEM_DONE) {
+			break;
+		}
+		failed = pipeline->failed;
+		pthread_mutex_unlock(&pipeline->mutex);
+
+		/* the items are written in order and nothing is written after a failure */
+		if (!failed && pipeline->write(pipeline->data, item->buf, item->len) == FAILURE) {
+			failed = 1;
+		}
+
+		pthread_mutex_lock(&pipeline->mutex);
+		if (failed) {
+			pipeline->failed = 1;
+		}
+		item->state = PHP_CRYPTO_THREAD_ITEM_FREE;
+		pipeline->written++;
+		pthread_cond_broadcast(&pipeline->cond);
+	}
+	pthread_mutex_unlock(&pipeline->mutex);
+
+	return NULL;
+}
+/* }}} */
+
+/* {{{ php_crypto_thread_pipeline_stop */
+static void php_crypto_thread_pipeline_stop(php_crypto_thread_pipeline *pipeline)
+{
+	int i;
+
+	pthread_mutex_lock(&pipeline->mutex);
+	pipeline->stop = 1;
+	pthread_cond_broadcast(&pipeline->cond);
+	pthread_mutex_unlock(&pipeline->mutex);
+
+	for (i = 0; i < pipeline->started; i++) {
+		pthread_join(pipeline->threads[i], NULL);
+	}
+	pthread_cond_destroy(&pipeline->cond);
+	pthread_mutex_destroy(&pipeline->mutex);
+	/* the buffers can contain plain data */
+	OPENSSL_cleanse(pipeline->bufs, (size_t) pipeline->depth * pipeline->item_size);
+	efree(pipeline->bufs);
+	efree(pipeline->items);
+	efree(pipeline);
+}
+/* }}} */
+
+#endif
+
+/* {{{ php_crypto_thread_pipeline_create */
+PHP_CRYPTO_API php_crypto_thread_pipeline *php_crypto_thread_pipeline_create(
+		php_crypto_thread_pipeline_process_func process,
+		php_crypto_thread_pipeline_write_func write, void *data,
+		int item_size, int workers, int depth)
+{
+#ifdef HAVE_CRYPTO_PTHREAD
+	php_crypto_thread_pipeline *pipeline;
+	int i;
+
+	if (workers > PHP_CRYPTO_THREADS_MAX) {
+		workers = PHP_CRYPTO_THREADS_MAX;
+	}
+	if (workers < 1 || depth < 1) {
+		return NULL;
+	}
+
+	/* the memory is allocated and freed by the request thread (the threads only
+	 * use it between create and destroy) so it is counted in the memory_limit */
+	pipeline = ecalloc(1, sizeof(php_crypto_thread_pipeline));
+	pipeline->process = process;
+	pipeline->write = write;
+	pipeline->data = data;
+	pipeline->depth = depth;
+	pipeline->item_size = item_size;
+	pipeline->items = ecalloc(depth, sizeof(php_crypto_thread_item));
+	pipeline->bufs = safe_emalloc(depth, item_size, 0);
+	for (i = 0; i < depth; i++) {
+		pipeline->items[i].buf = pipeline->bufs + (size_t) i * item_size;
+	}
+	pthread_mutex_init(&pipeline->mutex, NULL);
+	pthread_cond_init(&pipeline->cond, NULL);
+
+	/* the I/O thread is required and then at least one worker */
+	if (pthread_create(&pipeline->threads[0], NULL,
+			php_crypto_thread_pipeline_writer, pipeline) != 0) {
+		php_crypto_thread_pipeline_stop(pipeline);
+		return NULL;
+	}
+	pipeline->started = 1;
+	for (i = 0; i < workers; i++) {
+		pipeline->workers[i].pipeline = pipeline;
+		pipeline->workers[i].worker = i;
+		if (pthread_create(&pipeline->threads[pipeline->started], NULL,
+				php_crypto_thread_pipeline_worker, &pipeline->workers[i]) != 0) {
+			break;
+		}
+		pipeline->started++;
+	}
+	if (pipeline->started == 1) {
+		php_crypto_thread_pipeline_stop(pipeline);
+		return NULL;
+	}
+
+	return pipeline;
+#else
+	return NULL;
+#endif
+}
+/* }}} */
+
+#ifdef HAVE_CRYPTO_PTHREAD
+
+/* {{{ php_crypto_thread_pipeline_get */
+PHP_CRYPTO_API unsigned char *php_crypto_thread_pipeline_get(
+		php_crypto_thread_pipeline *pipeline)
+{
+	php_crypto_thread_item *item = &pipeline->items[pipeline->submitted % pipeline->depth];
+
+	/* back pressure - wait for the item to be written */
+	pthread_mutex_lock(&pipeline->mutex);
+	while (item->state != PHP_CRYPTO_THREAD_ITEM_FREE) {
+		pthread_cond_wait(&pipeline->cond, &pipeline->mutex);
+	}
+	pthread_mutex_unlock(&pipeline->mutex);
+
+	return item->buf;
+}
+/* }}} */
+
+/* {{{ php_crypto_thread_pipeline_submit */
+PHP_CRYPTO_API int php_crypto_thread_pipeline_submit(
+		php_crypto_thread_pipeline *pipeline, int len, int last)
+{
+	php_crypto_thread_item *item = &pipeline->items[pipeline->submitted % pipeline->depth];
+	int failed;
+
+	pthread_mutex_lock(&pipeline->mutex);
+	item->len = len;
+	item->last = last;
+	item->index = (uint32_t) pipeline->submitted;
+	item->state = PHP_CRYPTO_THREAD_ITEM_QUEUED;
+	pipeline->submitted++;
+	failed = pipeline->failed;
+	pthread_cond_broadcast(&pipeline->cond);
+	pthread_mutex_unlock(&pipeline->mutex);
+
+	return failed ? FAILURE : SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_thread_pipeline_drain */
+PHP_CRYPTO_API int php_crypto_thread_pipeline_drain(
+		php_crypto_thread_pipeline *pipeline)
+{
+	int failed;
+
+	pthread_mutex_lock(&pipeline->mutex);
+	while (pipeline->written != pipeline->submitted) {
+		pthread_cond_wait(&pipeline->cond, &pipeline->mutex);
+	}
+	failed = pipeline->failed;
+	pthread_mutex_unlock(&pipeline->mutex);
+
+	return failed ? FAILURE : SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_thread_pipeline_destroy */
+PHP_CRYPTO_API int php_crypto_thread_pipeline_destroy(
+		php_crypto_thread_pipeline *pipeline)
+{
+	int rc = php_crypto_thread_pipeline_drain(pipeline);
+
+	php_crypto_thread_pipeline_stop(pipeline);
+
+	return rc;
+}
+/* }}} */
+
+#else
+
+/* the pipeline is never created without threads */
+PHP_CRYPTO_API unsigned char *php_crypto_thread_pipeline_get(
+		php_crypto_thread_pipeline *pipeline)
+{
+	return NULL;
+}
+
+PHP_CRYPTO_API int php_crypto_thread_pipeline_submit(
+		php_crypto_thread_pipeline *pipeline, int len, int last)
+{
+	return FAILURE;
+}
+
+PHP_CRYPTO_API int php_crypto_thread_pipeline_drain(
+		php_crypto_thread_pipeline *pipeline)
+{
+	return FAILURE;
+}
+
+PHP_CRYPTO_API int php_crypto_thread_pipeline_destroy(
+		php_crypto_thread_pipeline *pipeline)
+{
+	return FAILURE;
+}
+
+#endif
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
@@ -0,0 +1,435 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 2013-2016 Jakub Zelenka                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: Jakub Zelenka <bukka@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "php.h"
+#include "php_crypto.h"
+#include "php_crypto_uring.h"
+
+#ifdef HAVE_CRYPTO_URING
+
+#include <liburing.h>
+#include <errno.h>
+#include <unistd.h>
+#include <openssl/crypto.h>
+
+/* buffer states */
+typedef enum {
+	PHP_CRYPTO_URING_SLOT_FREE = 0,
+	PHP_CRYPTO_URING_SLOT_INFLIGHT,
+	PHP_CRYPTO_URING_SLOT_DONE
+} php_crypto_uring_slot_state;
+
+typedef struct {
+	unsigned char *buf;
+	uint64_t offset;
+	size_t len;
+	int res;
+	php_crypto_uring_slot_state state;
+} php_crypto_uring_slot;
+
+struct _php_crypto_uring {
+	struct io_uring ring;
+	int fd;
+	size_t buffer_size;
+	php_crypto_uring_slot slots[PHP_CRYPTO_URING_DEPTH];
+	/* slot that is filled (write) or consumed (read) */
+	int head;
+	/* number of bytes filled or consumed in the head slot */
+	size_t head_len;
+	/* file offset of the next submitted operation */
+	uint64_t offset;
+	/* read position */
+	uint64_t pos;
+	zend_bool reading;
+	zend_bool eof;
+	zend_bool failed;
+};
+
+/* {{{ php_crypto_uring_reap
+	Waits for one completion and saves its result to the slot */
+static int php_crypto_uring_reap(php_crypto_uring *uring)
+{
+	struct io_uring_cqe *cqe;
+	php_crypto_uring_slot *slot;
+	int rc;
+
+	do {
+		rc = io_uring_wait_cqe(&uring->ring, &cqe);
+	} while (rc == -EINTR);
+	if (rc < 0) {
+		return FAILURE;
+	}
+	slot = (php_crypto_uring_slot *) io_uring_cqe_get_data(cqe);
+	slot->res = cqe->res;
+	slot->state = PHP_CRYPTO_URING_SLOT_DONE;
+	io_uring_cqe_seen(&uring->ring, cqe);
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_uring_wait
+	Waits for the slot operation (the finished write slot is freed) */
+static int php_crypto_uring_wait(php_crypto_uring *uring, php_crypto_uring_slot *slot)
+{
+	size_t done;
+	ssize_t n;
+
+	while (slot->state == PHP_CRYPTO_URING_SLOT_INFLIGHT) {
+		if (php_crypto_uring_reap(uring) == FAILURE) {
+			uring->failed = 1;
+			return FAILURE;
+		}
+	}
+	if (slot->state == PHP_CRYPTO_URING_SLOT_DONE && !uring->reading) {
+		if (slot->res < 0) {
+			uring->failed = 1;
+		} else {
+			/* the rest of the short write is written synchronously */
+			done = (size_t) slot->res;
+			while (done < slot->len) {
+				n = pwrite(uring->fd, slot->buf + done, slot->len - done, (off_t) (slot->offset + done));
+				if (n <= 0) {
+					if (n < 0 && errno == EINTR) {
+						continue;
+					}
+					uring->failed = 1;
+					break;
+				}
+				done += (size_t) n;
+			}
+		}
+		slot->state = PHP_CRYPTO_URING_SLOT_FREE;
+	}
+
+	return uring->failed ? FAILURE : SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_uring_submit */
+static int php_crypto_uring_submit(php_crypto_uring *uring, php_crypto_uring_slot *slot,
+		size_t len)
+{
+	struct io_uring_sqe *sqe;
+
+	/* nothing is submitted after a failure as the ring state is not known */
+	if (uring->failed || (sqe = io_uring_get_sqe(&uring->ring)) == NULL) {
+		uring->failed = 1;
+		return FAILURE;
+	}
+	slot->offset = uring->offset;
+	slot->len = len;
+	if (uring->reading) {
+		io_uring_prep_read(sqe, uring->fd, slot->buf, (unsigned) len, slot->offset);
+	} else {
+		io_uring_prep_write(sqe, uring->fd, slot->buf, (unsigned) len, slot->offset);
+	}
+	io_uring_sqe_set_data(sqe, slot);
+	if (io_uring_submit(&uring->ring) < 0) {
+		uring->failed = 1;
+		return FAILURE;
+	}
+	slot->state = PHP_CRYPTO_URING_SLOT_INFLIGHT;
+	uring->offset += len;
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_uring_submit_head
+	Submits the filled part of the write buffer and moves to the next one */
+static int php_crypto_uring_submit_head(php_crypto_uring *uring)
+{
+	int rc;
+
+	if (uring->head_len == 0) {
+		return SUCCESS;
+	}
+	rc = php_crypto_uring_submit(uring, &uring->slots[uring->head], uring->head_len);
+	uring->head = (uring->head + 1) % PHP_CRYPTO_URING_DEPTH;
+	uring->head_len = 0;
+
+	return rc;
+}
+/* }}} */
+
+/* {{{ php_crypto_uring_create */
+PHP_CRYPTO_API php_crypto_uring *php_crypto_uring_create(int fd,
+		uint64_t offset, size_t buffer_size)
+{
+	php_crypto_uring *uring;
+	int i;
+
+	/* the memory is persistent as the kernel can use it until the ring exits */
+	uring = pecalloc(1, sizeof(php_crypto_uring), 1);
+	if (io_uring_queue_init(PHP_CRYPTO_URING_DEPTH, &uring->ring, 0) < 0) {
+		pefree(uring, 1);
+		return NULL;
+	}
+	for (i = 0; i < PHP_CRYPTO_URING_DEPTH; i++) {
+		uring->slots[i].buf = pemalloc(buffer_size, 1);
+	}
+	uring->fd = fd;
+	uring->buffer_size = buffer_size;
+	uring->offset = offset;
+	uring->pos = offset;
+
+	return uring;
+}
+/* }}} */
+
+/* {{{ php_crypto_uring_write_buffer */
+PHP_CRYPTO_API unsigned char *php_crypto_uring_write_buffer(
+		php_crypto_uring *uring, size_t *avail)
+{
+	php_crypto_uring_slot *slot = &uring->slots[uring->head];
+
+	if (slot->state != PHP_CRYPTO_URING_SLOT_FREE &&
+			php_crypto_uring_wait(uring, slot) == FAILURE) {
+		return NULL;
+	}
+	*avail = uring->buffer_size - uring->head_len;
+
+	return slot->buf + uring->head_len;
+}
+/* }}} */
+
+/* {{{ php_crypto_uring_write_commit */
+PHP_CRYPTO_API int php_crypto_uring_write_commit(php_crypto_uring *uring, size_t len)
+{
+	uring->head_len += len;
+	if (uring->head_len == uring->buffer_size) {
+		return php_crypto_uring_submit_head(uring);
+	}
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_uring_write */
+PHP_CRYPTO_API int php_crypto_uring_write(php_crypto_uring *uring,
+		const unsigned char *buf, size_t len)
+{
+	unsigned char *dst;
+	size_t avail;
+
+	while (len > 0) {
+		if ((dst = php_crypto_uring_write_buffer(uring, &avail)) == NULL) {
+			return FAILURE;
+		}
+		if (avail > len) {
+			avail = len;
+		}
+		memcpy(dst, buf, avail);
+		if (php_crypto_uring_write_commit(uring, avail) == FAILURE) {
+			return FAILURE;
+		}
+		buf += avail;
+		len -= avail;
+	}
+
+	return SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_uring_drop
+	Waits for all reads and drops the read ahead data */
+static void php_crypto_uring_drop(php_crypto_uring *uring)
+{
+	int i;
+
+	for (i = 0; i < PHP_CRYPTO_URING_DEPTH; i++) {
+		php_crypto_uring_wait(uring, &uring->slots[i]);
+		uring->slots[i].state = PHP_CRYPTO_URING_SLOT_FREE;
+	}
+	uring->head = 0;
+	uring->head_len = 0;
+	uring->offset = uring->pos;
+}
+/* }}} */
+
+/* {{{ php_crypto_uring_read */
+PHP_CRYPTO_API int php_crypto_uring_read(php_crypto_uring *uring, size_t max,
+		unsigned char **ptr, size_t *len)
+{
+	php_crypto_uring_slot *slot;
+	int i;
+
+	*len = 0;
+	uring->reading = 1;
+	for (;;) {
+		/* the free slots follow the head so they read ahead in order */
+		for (i = 0; i < PHP_CRYPTO_URING_DEPTH && !uring->eof; i++) {
+			slot = &uring->slots[(uring->head + i) % PHP_CRYPTO_URING_DEPTH];
+			if (slot->state == PHP_CRYPTO_URING_SLOT_FREE &&
+					php_crypto_uring_submit(uring, slot, uring->buffer_size) == FAILURE) {
+				return FAILURE;
+			}
+		}
+		slot = &uring->slots[uring->head];
+		if (slot->state == PHP_CRYPTO_URING_SLOT_FREE) {
+			/* end of file */
+			return SUCCESS;
+		}
+		if (php_crypto_uring_wait(uring, slot) == FAILURE || slot->res < 0) {
+			uring->failed = 1;
+			return FAILURE;
+		}
+		if (uring->head_len < (size_t) slot->res) {
+			*ptr = slot->buf + uring->head_len;
+			*len = (size_t) slot->res - uring->head_len;
+			if (*len > max) {
+				*len = max;
+			}
+			uring->head_len += *len;
+			uring->pos += *len;
+			return SUCCESS;
+		}
+		if ((size_t) slot->res < slot->len) {
+			/* the short read is the end of file so the rest is dropped */
+			php_crypto_uring_drop(uring);
+			uring->eof = 1;
+			return SUCCESS;
+		}
+		slot->state = PHP_CRYPTO_URING_SLOT_FREE;
+		uring->head = (uring->head + 1) % PHP_CRYPTO_URING_DEPTH;
+		uring->head_len = 0;
+	}
+}
+/* }}} */
+
+/* {{{ php_crypto_uring_flush */
+PHP_CRYPTO_API int php_crypto_uring_flush(php_crypto_uring *uring)
+{
+	int i;
+
+	if (!uring->reading) {
+		php_crypto_uring_submit_head(uring);
+	}
+	for (i = 0; i < PHP_CRYPTO_URING_DEPTH; i++) {
+		php_crypto_uring_wait(uring, &uring->slots[i]);
+	}
+
+	/* the read failures are returned by the read */
+	return uring->failed && !uring->reading ? FAILURE : SUCCESS;
+}
+/* }}} */
+
+/* {{{ php_crypto_uring_seek */
+PHP_CRYPTO_API int php_crypto_uring_seek(php_crypto_uring *uring, uint64_t offset)
+{
+	int rc = php_crypto_uring_flush(uring);
+
+	uring->pos = offset;
+	php_crypto_uring_drop(uring);
+	uring->eof = 0;
+
+	return rc;
+}
+/* }}} */
+
+/* {{{ php_crypto_uring_tell */
+PHP_CRYPTO_API uint64_t php_crypto_uring_tell(php_crypto_uring *uring)
+{
+	return uring->reading ? uring->pos : uring->offset + uring->head_len;
+}
+/* }}} */
+
+/* {{{ php_crypto_uring_destroy */
+PHP_CRYPTO_API int php_crypto_uring_destroy(php_crypto_uring *uring)
+{
+	int i, rc = php_crypto_uring_flush(uring);
+
+	io_uring_queue_exit(&uring->ring);
+	for (i = 0; i < PHP_CRYPTO_URING_DEPTH; i++) {
+		OPENSSL_cleanse(uring->slots[i].buf, uring->buffer_size);
+		pefree(uring->slots[i].buf, 1);
+	}
+	pefree(uring, 1);
+
+	return rc;
+}
+/* }}} */
+
+#else
+
+/* the ring is never created without io_uring */
+PHP_CRYPTO_API php_crypto_uring *php_crypto_uring_create(int fd,
+		uint64_t offset, size_t buffer_size)
+{
+	return NULL;
+}
+
+PHP_CRYPTO_API unsigned char *php_crypto_uring_write_buffer(
+		php_crypto_uring *uring, size_t *avail)
+{
+	return NULL;
+}
+
+PHP_CRYPTO_API int php_crypto_uring_write_commit(php_crypto_uring *uring, size_t len)
+{
+	return FAILURE;
+}
+
+PHP_CRYPTO_API int php_crypto_uring_write(php_crypto_uring *uring,
+		const unsigned char *buf, size_t len)
+{
+	return FAILURE;
+}
+
+PHP_CRYPTO_API int php_crypto_uring_read(php_crypto_uring *uring, size_t max,
+		unsigned char **ptr, size_t *len)
+{
+	return FAILURE;
+}
+
+PHP_CRYPTO_API int php_crypto_uring_flush(php_crypto_uring *uring)
+{
+	return FAILURE;
+}
+
+PHP_CRYPTO_API int php_crypto_uring_seek(php_crypto_uring *uring, uint64_t offset)
+{
+	return FAILURE;
+}
+
+PHP_CRYPTO_API uint64_t php_crypto_uring_tell(php_crypto_uring *uring)
+{
+	return 0;
+}
+
+PHP_CRYPTO_API int php_crypto_uring_destroy(php_crypto_uring *uring)
+{
+	return FAILURE;
+}
+
+#endif
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
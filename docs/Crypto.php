@@ -11,6 +11,7 @@ class Crypto\Cipher {
     const MODE_GCM = 6;
     const MODE_CCM = 7;
     const MODE_XTS = 65537;
+    const MODE_OCB = 65539;
     
     /**
      * Returns cipher algorithms
@@ -323,6 +324,11 @@ class Crypto\CipherException extends Exception {
      */
     const INPUT_DATA_LENGTH_HIGH = 30;
     
+    /**
+     * The tag variable is required for %s cipher mode
+     */
+    const TAG_REQUIRED = 31;
+    
 }
 
 /**
@@ -466,6 +472,21 @@ class Crypto\MACException extends Crypto\HashException {
      */
     const KEY_LENGTH_INVALID = 2;
     
+    /**
+     * Initialization of MAC failed
+     */
+    const INIT_FAILED = 3;
+    
+    /**
+     * Updating of MAC context failed
+     */
+    const UPDATE_FAILED = 4;
+    
+    /**
+     * Creating of MAC digest failed
+     */
+    const DIGEST_FAILED = 5;
+    
 }
 
 /**
@@ -555,6 +576,15 @@ class Crypto\KDFException {
  * Class providing PBKDF2 functionality
  */
 class Crypto\PBKDF2 extends Crypto\KDF {
+    /**
+     * Returns iterations count that takes the target time on this machine
+     * @param int $targetMillis
+     * @param string $hashAlgorithm
+     * @param int $length
+     * @return int
+     */
+    public static function calibrate($targetMillis, $hashAlgorithm, $length = 0) {}
+    
     /**
      * KDF constructor
      * @param string $hashAlgorithm
@@ -571,6 +601,14 @@ class Crypto\PBKDF2 extends Crypto\KDF {
      */
     public function derive($password) {}
     
+    /**
+     * Derive keys for all password and salt pairs
+     * @param array $passwords
+     * @param array $salts
+     * @return array
+     */
+    public function deriveMany($passwords, $salts) {}
+    
     /**
      * Get iterations
      * @return int
@@ -614,6 +652,346 @@ class Crypto\PBKDF2Exception extends Crypto\KDFException {
      */
     const ITERATIONS_HIGH = 2;
     
+    /**
+     * The number of passwords and salts has to be the same
+     */
+    const PASSWORDS_SALTS_MISMATCH = 3;
+    
+    /**
+     * The password has to be a string
+     */
+    const PASSWORD_TYPE_INVALID = 4;
+    
+    /**
+     * The salt has to be a string
+     */
+    const SALT_TYPE_INVALID = 5;
+    
+    /**
+     * The target time has to be greater than 0
+     */
+    const TARGET_TIME_INVALID = 6;
+    
+    /**
+     * PBKDF2 calibration failed
+     */
+    const CALIBRATION_FAILED = 7;
+    
+}
+
+/**
+ * Class providing scrypt functionality
+ */
+class Crypto\Scrypt extends Crypto\KDF {
+    /**
+     * Scrypt constructor
+     * @param int $length
+     * @param string $salt
+     * @param int $n
+     * @param int $r
+     * @param int $p
+     */
+    public function __construct($length, $salt = NULL, $n = 16384, $r = 8, $p = 1) {}
+    
+    /**
+     * Derive key from password
+     * @param string $password
+     * @return string
+     */
+    public function derive($password) {}
+    
+    /**
+     * Get CPU/memory cost parameter
+     * @return int
+     */
+    public function getN() {}
+    
+    /**
+     * Set CPU/memory cost parameter
+     * @param int $n
+     * @return bool
+     */
+    public function setN($n) {}
+    
+    /**
+     * Get block size parameter
+     * @return int
+     */
+    public function getR() {}
+    
+    /**
+     * Set block size parameter
+     * @param int $r
+     * @return bool
+     */
+    public function setR($r) {}
+    
+    /**
+     * Get parallelization parameter
+     * @return int
+     */
+    public function getP() {}
+    
+    /**
+     * Set parallelization parameter
+     * @param int $p
+     * @return bool
+     */
+    public function setP($p) {}
+    
+    /**
+     * Get max memory in bytes that can be used by a derivation
+     * @return int
+     */
+    public function getMaxMemory() {}
+    
+    /**
+     * Set max memory in bytes that can be used by a derivation
+     * @param int $maxMemory
+     * @return bool
+     */
+    public function setMaxMemory($maxMemory) {}
+    
+}
+
+/**
+ * Exception class for scrypt errors
+ */
+class Crypto\ScryptException extends Crypto\KDFException {
+    
+    /**
+     * The cost parameter N must be a power of two greater than 1
+     */
+    const COST_INVALID = 1;
+    
+    /**
+     * The cost parameter N is too high for the block size
+     */
+    const COST_HIGH = 2;
+    
+    /**
+     * The block size parameter r is invalid
+     */
+    const BLOCK_SIZE_INVALID = 3;
+    
+    /**
+     * The parallelization parameter p is invalid
+     */
+    const PARALLELISM_INVALID = 4;
+    
+    /**
+     * The product of the block size and parallelization is too high
+     */
+    const PARAMETERS_HIGH = 5;
+    
+    /**
+     * The max memory must be greater than 0
+     */
+    const MAX_MEMORY_INVALID = 6;
+    
+    /**
+     * The derivation requires more memory than the max memory
+     */
+    const MEMORY_LIMIT_EXCEEDED = 7;
+    
+}
+
+/**
+ * Class providing HKDF functionality
+ */
+class Crypto\HKDF extends Crypto\KDF {
+    /**
+     * HKDF constructor
+     * @param string $hashAlgorithm
+     * @param int $length
+     * @param string $salt
+     */
+    public function __construct($hashAlgorithm, $length, $salt = NULL) {}
+    
+    /**
+     * Derive key from input key using extract and expand with empty info
+     * @param string $password
+     * @return string
+     */
+    public function derive($password) {}
+    
+    /**
+     * Extract pseudorandom key from input key and keep it for expanding
+     * @param string $inputKey
+     * @return bool
+     */
+    public function extract($inputKey) {}
+    
+    /**
+     * Expand extracted pseudorandom key to output key for info
+     * @param string $info
+     * @param int $length
+     * @return string
+     */
+    public function expand($info, $length = NULL) {}
+    
+    /**
+     * Expand extracted pseudorandom key to output keys for all infos
+     * @param array $infos
+     * @param int $length
+     * @return array
+     */
+    public function expandMany($infos, $length = NULL) {}
+    
+    /**
+     * Get hash algorithm
+     * @return string
+     */
+    public function getHashAlgorithm() {}
+    
+    /**
+     * Set hash algorithm (the extracted key is discarded)
+     * @param string $hashAlgorithm
+     * @return bool
+     */
+    public function setHashAlgorithm($hashAlgorithm) {}
+    
+}
+
+/**
+ * Exception class for HKDF errors
+ */
+class Crypto\HKDFException extends Crypto\KDFException {
+    
+    /**
+     * Hash algorithm '%s' not found
+     */
+    const HASH_ALGORITHM_NOT_FOUND = 1;
+    
+    /**
+     * The pseudorandom key has to be extracted before expanding
+     */
+    const EXTRACT_REQUIRED = 2;
+    
+    /**
+     * HKDF extraction failed
+     */
+    const EXTRACT_FAILED = 3;
+    
+    /**
+     * HKDF expansion failed
+     */
+    const EXPAND_FAILED = 4;
+    
+    /**
+     * The output length is too high for the hash algorithm
+     */
+    const LENGTH_HIGH = 5;
+    
+    /**
+     * The info has to be a string
+     */
+    const INFO_TYPE_INVALID = 6;
+    
+}
+
+/**
+ * Class providing Argon2id functionality
+ */
+class Crypto\Argon2 extends Crypto\KDF {
+    /**
+     * Argon2 constructor
+     * @param int $length
+     * @param string $salt
+     * @param int $memoryCost
+     * @param int $timeCost
+     * @param int $lanes
+     */
+    public function __construct($length, $salt = NULL, $memoryCost = 65536, $timeCost = 3, $lanes = 1) {}
+    
+    /**
+     * Derive key from password
+     * @param string $password
+     * @return string
+     */
+    public function derive($password) {}
+    
+    /**
+     * Get memory cost in KiB
+     * @return int
+     */
+    public function getMemoryCost() {}
+    
+    /**
+     * Set memory cost in KiB
+     * @param int $memoryCost
+     * @return bool
+     */
+    public function setMemoryCost($memoryCost) {}
+    
+    /**
+     * Get time cost (number of passes)
+     * @return int
+     */
+    public function getTimeCost() {}
+    
+    /**
+     * Set time cost (number of passes)
+     * @param int $timeCost
+     * @return bool
+     */
+    public function setTimeCost($timeCost) {}
+    
+    /**
+     * Get number of lanes
+     * @return int
+     */
+    public function getLanes() {}
+    
+    /**
+     * Set number of lanes
+     * @param int $lanes
+     * @return bool
+     */
+    public function setLanes($lanes) {}
+    
+}
+
+/**
+ * Exception class for Argon2 errors
+ */
+class Crypto\Argon2Exception extends Crypto\KDFException {
+    
+    /**
+     * The memory cost must be at least 8 KiB and fit to 32 bits
+     */
+    const MEMORY_COST_INVALID = 1;
+    
+    /**
+     * The memory cost must be at least 8 KiB per lane
+     */
+    const MEMORY_COST_LOW = 2;
+    
+    /**
+     * The memory cost is too high for this platform
+     */
+    const MEMORY_COST_HIGH = 3;
+    
+    /**
+     * The time cost must be greater than 0 and fit to 32 bits
+     */
+    const TIME_COST_INVALID = 4;
+    
+    /**
+     * The number of lanes must be between 1 and 16777215
+     */
+    const LANES_INVALID = 5;
+    
+    /**
+     * The salt must be at least 8 bytes long
+     */
+    const SALT_LENGTH_LOW = 6;
+    
+    /**
+     * The key length must be at least 4 bytes
+     */
+    const KEY_LENGTH_LOW = 7;
+    
 }
 
 /**
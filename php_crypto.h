@@ -43,6 +43,7 @@ extern zend_module_entry crypto_module_entry;
 
 #include "php.h"
 #include <openssl/evp.h>
+#include <openssl/hmac.h>
 
 /* PHP Compatibility layer */
 #include "phpc/phpc.h"
@@ -75,6 +76,14 @@ extern zend_module_entry crypto_module_entry;
 #define PHP_CRYPTO_ABSTRACT_ME(classname, name, arg_info) \
 	PHP_ABSTRACT_ME(Crypto_##_##classname, name, arg_info)
 
+/* Crypto function definition */
+#define PHP_CRYPTO_FUNCTION(name) \
+	PHP_FUNCTION(Crypto_##name)
+
+/* Crypto function entry */
+#define PHP_CRYPTO_FE(name, arg_info) \
+	ZEND_NS_NAMED_FE(PHP_CRYPTO_NS_NAME, name, ZEND_FN(Crypto_##name), arg_info)
+
 /* Macros for dealing with Crypto sub namespaces (not used yet) */
 #define PHP_CRYPTO_NS_NAMESPACE(ns) \
 	PHP_CRYPTO_NS_NAME PHP_CRYPTO_NS_SEPARATOR #ns
@@ -191,10 +200,59 @@ PHP_CRYPTO_API void php_crypto_error(
 PHP_CRYPTO_EXCEPTION_EXPORT(Crypto)
 
 
+/* ALGORITHM CACHE */
+
+/* Number of cached algorithms per algorithm type */
+#define PHP_CRYPTO_ALG_CACHE_SIZE 8
+
+/* Max length of the cached algorithm name (longer names are not cached) */
+#define PHP_CRYPTO_ALG_CACHE_NAME_LEN 32
+
+/* Algorithm cache entry */
+typedef struct {
+	char name[PHP_CRYPTO_ALG_CACHE_NAME_LEN];
+	phpc_str_size_t name_len;
+	const void *alg;
+} php_crypto_alg_cache_entry;
+
+/* Algorithm cache (name to EVP_MD or EVP_CIPHER lookup) */
+typedef struct {
+	php_crypto_alg_cache_entry entries[PHP_CRYPTO_ALG_CACHE_SIZE];
+	int next;
+} php_crypto_alg_cache;
+
+PHP_CRYPTO_API const void *php_crypto_alg_cache_find(
+		php_crypto_alg_cache *cache, const char *name, phpc_str_size_t name_len);
+PHP_CRYPTO_API void php_crypto_alg_cache_add(
+		php_crypto_alg_cache *cache, const char *name, phpc_str_size_t name_len,
+		const void *alg);
+
+
 /* GLOBALS */
 
+/* Buffered random generator (defined in php_crypto_rand.h) */
+typedef struct _php_crypto_rand_pool php_crypto_rand_pool;
+
 ZEND_BEGIN_MODULE_GLOBALS(crypto)
-	php_crypto_error_action error_action;  
+	php_crypto_error_action error_action;
+	/* max number of worker threads (crypto.threads INI) */
+	phpc_long_t threads;
+	/* algorithm caches for the crypto functions */
+	php_crypto_alg_cache md_cache;
+	php_crypto_alg_cache cipher_cache;
+	/* contexts reused by the crypto functions (freed on request shutdown) */
+	EVP_MD_CTX *md_ctx;
+	HMAC_CTX *hmac_ctx;
+	EVP_CIPHER_CTX *cipher_ctx;
+	/* Argon2 block memory reused by derivations (freed on globals shutdown) */
+	void *argon2_arena;
+	/* max size of the Argon2 block memory (crypto.argon2_max_memory INI) */
+	phpc_long_t argon2_max_memory;
+	size_t argon2_arena_size;
+	/* random bytes backend (crypto.rand_backend INI) */
+	char *rand_backend;
+	/* buffered random generator (freed on globals shutdown) */
+	php_crypto_rand_pool *rand_pool;
 ZEND_END_MODULE_GLOBALS(crypto)
 
 #ifdef ZTS
@@ -208,7 +266,9 @@ ZEND_END_MODULE_GLOBALS(crypto)
 
 PHP_MINIT_FUNCTION(crypto);
 PHP_GINIT_FUNCTION(crypto);
+PHP_GSHUTDOWN_FUNCTION(crypto);
 PHP_MSHUTDOWN_FUNCTION(crypto);
+PHP_RSHUTDOWN_FUNCTION(crypto);
 PHP_MINFO_FUNCTION(crypto);
 
 
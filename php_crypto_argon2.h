@@ -0,0 +1,71 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 2013-2016 Jakub Zelenka                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: Jakub Zelenka <bukka@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifndef PHP_CRYPTO_ARGON2_H
+#define PHP_CRYPTO_ARGON2_H
+
+#include "php.h"
+#include "php_crypto.h"
+
+/* Argon2 block size in bytes */
+#define PHP_CRYPTO_ARGON2_BLOCK_SIZE 1024
+
+/* Number of slices in a pass (lanes are synchronized after each slice) */
+#define PHP_CRYPTO_ARGON2_SYNC_POINTS 4
+
+/* Min number of memory blocks (KiB) per lane */
+#define PHP_CRYPTO_ARGON2_LANE_BLOCKS_MIN (2 * PHP_CRYPTO_ARGON2_SYNC_POINTS)
+
+/* Max number of lanes */
+#define PHP_CRYPTO_ARGON2_LANES_MAX 0xFFFFFF
+
+/* Min salt length */
+#define PHP_CRYPTO_ARGON2_SALT_MIN 8
+
+/* Number of blocks used for the memory cost m (in KiB) and p lanes */
+#define PHP_CRYPTO_ARGON2_BLOCKS(m, p) \
+	((m) / (PHP_CRYPTO_ARGON2_SYNC_POINTS * (p)) * (PHP_CRYPTO_ARGON2_SYNC_POINTS * (p)))
+
+/* Memory in bytes needed for the memory cost m (in KiB) and p lanes */
+#define PHP_CRYPTO_ARGON2_MEMORY(m, p) \
+	((uint64_t) PHP_CRYPTO_ARGON2_BLOCKS(m, p) * PHP_CRYPTO_ARGON2_BLOCK_SIZE)
+
+/* Returns memory for the Argon2 blocks. The memory is kept in the arena
+ * so the following derivations of the same or lower size reuse it (the
+ * caller has to wipe it after the derivation). */
+PHP_CRYPTO_API void *php_crypto_argon2_arena(size_t size TSRMLS_DC);
+
+/* Derives Argon2id key and fills up to workers lanes in parallel (the caller
+ * is responsible for checking parameter limits and for supplying memory
+ * of PHP_CRYPTO_ARGON2_MEMORY bytes) */
+PHP_CRYPTO_API int php_crypto_argon2id(
+		const char *pass, int pass_len, const unsigned char *salt, int salt_len,
+		const unsigned char *secret, int secret_len, const unsigned char *ad, int ad_len,
+		uint32_t t_cost, uint32_t m_cost, uint32_t lanes, int workers, void *memory,
+		unsigned char *key, int key_len);
+
+#endif	/* PHP_CRYPTO_ARGON2_H */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
@@ -22,7 +22,32 @@
 #include "php.h"
 #include "php_crypto.h"
 
-#include <openssl/evp.h>
+/* Base64 line lengths (characters without new line) for wrapping */
+#define PHP_CRYPTO_BASE64_WRAP_NONE 0
+#define PHP_CRYPTO_BASE64_WRAP_PEM 64
+#define PHP_CRYPTO_BASE64_WRAP_MIME 76
+#define PHP_CRYPTO_BASE64_WRAP_MAX PHP_CRYPTO_BASE64_WRAP_MIME
+
+/* Base64 characters decoded at once (the size of the decoding buffer) */
+#define PHP_CRYPTO_BASE64_LINE_CHARS 64
+
+typedef enum {
+	PHP_CRYPTO_BASE64_ALPHABET_STANDARD,
+	PHP_CRYPTO_BASE64_ALPHABET_URL
+} php_crypto_base64_alphabet;
+
+/* Base64 streaming context (the input that has not been processed yet) */
+typedef struct {
+	unsigned char data[PHP_CRYPTO_BASE64_LINE_CHARS];
+	int num;
+	int wrap;
+	php_crypto_base64_alphabet alphabet;
+	zend_bool padding;
+} php_crypto_base64_ctx;
+
+/* Base64 engine kernel (returns number of processed input bytes) */
+typedef size_t (*php_crypto_base64_kernel)(unsigned char *out,
+		const unsigned char *in, size_t len, php_crypto_base64_alphabet alphabet);
 
 typedef enum {
 	PHP_CRYPTO_BASE64_STATUS_CLEAR,
@@ -32,12 +57,12 @@ typedef enum {
 
 PHPC_OBJ_STRUCT_BEGIN(crypto_base64)
 	php_crypto_base64_status status;
-	EVP_ENCODE_CTX *ctx;
+	php_crypto_base64_ctx ctx;
 PHPC_OBJ_STRUCT_END()
 
 /* Base64 macros for endoding and decoding context size */
 #define PHP_CRYPTO_BASE64_DECODING_SIZE_MIN 50
-#define PHP_CRYPTO_BASE64_ENCODING_SIZE_MIN 66
+#define PHP_CRYPTO_BASE64_ENCODING_SIZE_MIN (PHP_CRYPTO_BASE64_WRAP_MAX + 2)
 
 /* Exceptions */
 PHP_CRYPTO_EXCEPTION_EXPORT(Base64)
@@ -47,12 +72,34 @@ PHP_CRYPTO_ERROR_INFO_EXPORT(Base64)
 /* Class entries */
 extern PHP_CRYPTO_API zend_class_entry *php_crypto_base64_ce;
 
+/* Base64 engine API (the streaming functions have the same semantics
+ * as EVP_Encode* and EVP_Decode* functions for the default options) */
+PHP_CRYPTO_API const char *php_crypto_base64_engine_name(void);
+PHP_CRYPTO_API int php_crypto_base64_ctx_init(php_crypto_base64_ctx *ctx,
+		int wrap, php_crypto_base64_alphabet alphabet, zend_bool padding);
+PHP_CRYPTO_API size_t php_crypto_base64_encode_length(
+		php_crypto_base64_ctx *ctx, size_t inl, zend_bool final);
+PHP_CRYPTO_API size_t php_crypto_base64_decode_length(
+		php_crypto_base64_ctx *ctx, size_t inl);
+PHP_CRYPTO_API void php_crypto_base64_encode_init(php_crypto_base64_ctx *ctx);
+PHP_CRYPTO_API void php_crypto_base64_encode_update(php_crypto_base64_ctx *ctx,
+		unsigned char *out, int *outl, const unsigned char *in, int inl);
+PHP_CRYPTO_API void php_crypto_base64_encode_final(php_crypto_base64_ctx *ctx,
+		unsigned char *out, int *outl);
+PHP_CRYPTO_API void php_crypto_base64_decode_init(php_crypto_base64_ctx *ctx);
+PHP_CRYPTO_API int php_crypto_base64_decode_update(php_crypto_base64_ctx *ctx,
+		unsigned char *out, int *outl, const unsigned char *in, int inl);
+PHP_CRYPTO_API int php_crypto_base64_decode_final(php_crypto_base64_ctx *ctx,
+		unsigned char *out, int *outl);
+
 /* Module init for Crypto Base64 */
 PHP_MINIT_FUNCTION(crypto_base64);
 
 /* Base64 methods */
 PHP_CRYPTO_METHOD(Base64, encode);
 PHP_CRYPTO_METHOD(Base64, decode);
+PHP_CRYPTO_METHOD(Base64, encodeMany);
+PHP_CRYPTO_METHOD(Base64, decodeMany);
 PHP_CRYPTO_METHOD(Base64, __construct);
 PHP_CRYPTO_METHOD(Base64, encodeUpdate);
 PHP_CRYPTO_METHOD(Base64, encodeFinish);
@@ -144,8 +144,9 @@ extern PHP_CRYPTO_API zend_class_entry *php_crypto_cipher_ce;
 
 /* USER METHODS */
 
-/* Module init for Crypto Cipher */
+/* Module init and request shutdown for Crypto Cipher */
 PHP_MINIT_FUNCTION(crypto_cipher);
+PHP_RSHUTDOWN_FUNCTION(crypto_cipher);
 
 /* Methods */
 PHP_CRYPTO_METHOD(Cipher, getAlgorithms);
@@ -172,6 +173,10 @@ PHP_CRYPTO_METHOD(Cipher, setTagLength);
 PHP_CRYPTO_METHOD(Cipher, getAAD);
 PHP_CRYPTO_METHOD(Cipher, setAAD);
 
+/* Functions */
+PHP_CRYPTO_FUNCTION(encrypt);
+PHP_CRYPTO_FUNCTION(decrypt);
+
 /* API FUNCTIONS */
 PHP_CRYPTO_API const EVP_CIPHER *php_crypto_get_cipher_algorithm(
 		char *algorithm,
@@ -0,0 +1,71 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 2013-2016 Jakub Zelenka                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: Jakub Zelenka <bukka@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifndef PHP_CRYPTO_COMPRESS_H
+#define PHP_CRYPTO_COMPRESS_H
+
+#include "php.h"
+#include "php_crypto.h"
+
+/* Compression algorithms (zlib and gzip are available if the extension is
+ * built with zlib and zstd if it is built with libzstd) */
+typedef enum {
+	PHP_CRYPTO_COMPRESS_ZLIB = 0,
+	PHP_CRYPTO_COMPRESS_GZIP,
+	PHP_CRYPTO_COMPRESS_ZSTD
+} php_crypto_compress_algorithm;
+
+/* Default level of the algorithm */
+#define PHP_CRYPTO_COMPRESS_LEVEL_DEFAULT -1
+
+/* Update results */
+#define PHP_CRYPTO_COMPRESS_ERROR -1
+#define PHP_CRYPTO_COMPRESS_OK     0
+#define PHP_CRYPTO_COMPRESS_END    1
+
+/* Streaming compressor or decompressor */
+typedef struct _php_crypto_compress php_crypto_compress;
+
+/* Finds the algorithm by name (FAILURE is returned if it is not available) */
+PHP_CRYPTO_API int php_crypto_compress_find(const char *name,
+		php_crypto_compress_algorithm *algorithm);
+
+/* Creates the compressor (enc) or decompressor (NULL is returned if the
+ * level is not valid for the algorithm or the init fails) */
+PHP_CRYPTO_API php_crypto_compress *php_crypto_compress_create(
+		php_crypto_compress_algorithm algorithm, int level, zend_bool enc);
+
+/* Processes the input to the output and moves both buffers (END is returned
+ * when the compression is finished or the end of compressed data is found) */
+PHP_CRYPTO_API int php_crypto_compress_update(php_crypto_compress *compress,
+		const unsigned char **in, size_t *in_len,
+		unsigned char **out, size_t *out_len, zend_bool finish);
+
+/* Frees the compressor */
+PHP_CRYPTO_API void php_crypto_compress_free(php_crypto_compress *compress);
+
+#endif	/* PHP_CRYPTO_COMPRESS_H */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
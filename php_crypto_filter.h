@@ -0,0 +1,65 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 2013-2016 Jakub Zelenka                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: Jakub Zelenka <bukka@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifndef PHP_CRYPTO_FILTER_H
+#define PHP_CRYPTO_FILTER_H
+
+#include "php.h"
+#include "php_crypto.h"
+
+/* filter names */
+#define PHP_CRYPTO_FILTER_BASE64_ENCODE_NAME "crypto.base64-encode"
+#define PHP_CRYPTO_FILTER_BASE64_DECODE_NAME "crypto.base64-decode"
+#define PHP_CRYPTO_FILTER_HEX_ENCODE_NAME "crypto.hex-encode"
+#define PHP_CRYPTO_FILTER_HEX_DECODE_NAME "crypto.hex-decode"
+#define PHP_CRYPTO_FILTER_CIPHER_NAME "crypto.cipher"
+
+/* Max number of bytes of one bucket passed to the codec at once (the codec
+ * output for this size still fits to int) */
+#define PHP_CRYPTO_FILTER_CHUNK_MAX (1 << 30)
+
+/* Type of the persistent flag of filter factory */
+#if PHP_VERSION_ID < 70200
+typedef int php_crypto_filter_persistent_t;
+#elif PHP_VERSION_ID < 80000
+typedef uint8_t php_crypto_filter_persistent_t;
+#else
+typedef bool php_crypto_filter_persistent_t;
+#endif
+
+/* Filter abstract data (it is a pointer zval on PHP 7) */
+#if PHP_MAJOR_VERSION < 7
+#define PHP_CRYPTO_FILTER_ABSTRACT(thisfilter) (thisfilter)->abstract
+#else
+#define PHP_CRYPTO_FILTER_ABSTRACT(thisfilter) Z_PTR((thisfilter)->abstract)
+#endif
+
+/* Module init and shut down callbacks */
+PHP_MINIT_FUNCTION(crypto_filter);
+PHP_MSHUTDOWN_FUNCTION(crypto_filter);
+
+#endif	/* PHP_CRYPTO_FILTER_H */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
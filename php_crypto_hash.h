@@ -28,6 +28,25 @@
 #include <openssl/cmac.h>
 #endif
 
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+
+static inline HMAC_CTX *HMAC_CTX_new()
+{
+	HMAC_CTX *ctx = OPENSSL_malloc(sizeof(HMAC_CTX));
+	if (ctx) {
+		HMAC_CTX_init(ctx);
+	}
+
+	return ctx;
+}
+
+static inline void HMAC_CTX_free(HMAC_CTX *ctx)
+{
+	OPENSSL_free(ctx);
+}
+
+#endif
+
 typedef enum {
 	PHP_CRYPTO_HASH_TYPE_NONE,
 	PHP_CRYPTO_HASH_TYPE_MD,
@@ -88,8 +107,9 @@ extern PHP_CRYPTO_API zend_class_entry *php_crypto_cmac_ce;
 
 /* USER METHODS */
 
-/* Module init for Crypto Hash */
+/* Module init and request shutdown for Crypto Hash */
 PHP_MINIT_FUNCTION(crypto_hash);
+PHP_RSHUTDOWN_FUNCTION(crypto_hash);
 
 /* Hash methods */
 PHP_CRYPTO_METHOD(Hash, getAlgorithms);
@@ -106,6 +126,10 @@ PHP_CRYPTO_METHOD(Hash, getBlockSize);
 /* MAC methods */
 PHP_CRYPTO_METHOD(MAC, __construct);
 
+/* Hash functions */
+PHP_CRYPTO_FUNCTION(hash);
+PHP_CRYPTO_FUNCTION(hmac);
+
 
 /* CRYPTO API FUNCTIONS */
 /* Hash functions */
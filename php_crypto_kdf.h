@@ -27,9 +27,25 @@
 #define PHP_CRYPTO_HAS_PBKDF2 1
 #endif
 
+/* HKDF feature test (it needs HMAC functions returning status) */
+#if OPENSSL_VERSION_NUMBER >= 0x10000000L
+#define PHP_CRYPTO_HAS_HKDF 1
+#endif
+
+/* Scrypt feature test (lanes are mixed by own ROMix that needs PBKDF2) */
+#ifdef PHP_CRYPTO_HAS_PBKDF2
+#define PHP_CRYPTO_HAS_SCRYPT 1
+#endif
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L && !defined(OPENSSL_NO_SCRYPT)
+#define PHP_CRYPTO_HAS_EVP_SCRYPT 1
+#endif
+
 typedef enum {
 	PHP_CRYPTO_KDF_TYPE_NONE,
-	PHP_CRYPTO_KDF_TYPE_PBKDF2
+	PHP_CRYPTO_KDF_TYPE_PBKDF2,
+	PHP_CRYPTO_KDF_TYPE_SCRYPT,
+	PHP_CRYPTO_KDF_TYPE_HKDF,
+	PHP_CRYPTO_KDF_TYPE_ARGON2
 } php_crypto_kdf_type;
 
 PHPC_OBJ_STRUCT_BEGIN(crypto_kdf)
@@ -39,6 +55,21 @@ PHPC_OBJ_STRUCT_BEGIN(crypto_kdf)
 			const EVP_MD *md;
 			int iter;
 		} pbkdf2;
+		struct {
+			uint64_t n;
+			uint32_t r;
+			uint32_t p;
+			uint64_t maxmem;
+		} scrypt;
+		struct {
+			const EVP_MD *md;
+			HMAC_CTX *prk;
+		} hkdf;
+		struct {
+			uint32_t m_cost;
+			uint32_t t_cost;
+			uint32_t lanes;
+		} argon2;
 	} ctx;
 	char *salt;
 	int salt_len;
@@ -51,15 +82,47 @@ PHPC_OBJ_STRUCT_END()
 
 #define PHP_CRYPTO_PBKDF2_ITER_DEFAULT 1000
 
+#define PHP_CRYPTO_SCRYPT_CTX_N(pobj) (pobj)->ctx.scrypt.n
+#define PHP_CRYPTO_SCRYPT_CTX_R(pobj) (pobj)->ctx.scrypt.r
+#define PHP_CRYPTO_SCRYPT_CTX_P(pobj) (pobj)->ctx.scrypt.p
+#define PHP_CRYPTO_SCRYPT_CTX_MAXMEM(pobj) (pobj)->ctx.scrypt.maxmem
+
+#define PHP_CRYPTO_SCRYPT_N_DEFAULT 16384
+#define PHP_CRYPTO_SCRYPT_R_DEFAULT 8
+#define PHP_CRYPTO_SCRYPT_P_DEFAULT 1
+#define PHP_CRYPTO_SCRYPT_MAXMEM_DEFAULT (32 * 1024 * 1024)
+
+#define PHP_CRYPTO_HKDF_CTX_MD(pobj) (pobj)->ctx.hkdf.md
+/* HMAC context keyed with the extracted PRK (NULL if not extracted) */
+#define PHP_CRYPTO_HKDF_CTX_PRK(pobj) (pobj)->ctx.hkdf.prk
+
+/* Max number of HKDF expand blocks (RFC 5869) */
+#define PHP_CRYPTO_HKDF_BLOCKS_MAX 255
+
+/* Argon2 memory cost is in KiB */
+#define PHP_CRYPTO_ARGON2_CTX_M_COST(pobj) (pobj)->ctx.argon2.m_cost
+#define PHP_CRYPTO_ARGON2_CTX_T_COST(pobj) (pobj)->ctx.argon2.t_cost
+#define PHP_CRYPTO_ARGON2_CTX_LANES(pobj) (pobj)->ctx.argon2.lanes
+
+#define PHP_CRYPTO_ARGON2_M_COST_DEFAULT 65536
+#define PHP_CRYPTO_ARGON2_T_COST_DEFAULT 3
+#define PHP_CRYPTO_ARGON2_LANES_DEFAULT 1
+
 /* Exceptions */
 PHP_CRYPTO_EXCEPTION_EXPORT(KDF)
 PHP_CRYPTO_EXCEPTION_EXPORT(PBKDF2)
+PHP_CRYPTO_EXCEPTION_EXPORT(Scrypt)
+PHP_CRYPTO_EXCEPTION_EXPORT(HKDF)
+PHP_CRYPTO_EXCEPTION_EXPORT(Argon2)
 
 /* CLASSES */
 
 /* Class entries */
 extern PHP_CRYPTO_API zend_class_entry *php_crypto_kdf_ce;
 extern PHP_CRYPTO_API zend_class_entry *php_crypto_pbkdf2_ce;
+extern PHP_CRYPTO_API zend_class_entry *php_crypto_scrypt_ce;
+extern PHP_CRYPTO_API zend_class_entry *php_crypto_hkdf_ce;
+extern PHP_CRYPTO_API zend_class_entry *php_crypto_argon2_ce;
 
 /* USER METHODS */
 
@@ -75,14 +138,51 @@ PHP_CRYPTO_METHOD(KDF, setSalt);
 
 #ifdef PHP_CRYPTO_HAS_PBKDF2
 /* PBKDF2 methods */
+PHP_CRYPTO_METHOD(PBKDF2, calibrate);
 PHP_CRYPTO_METHOD(PBKDF2, __construct);
 PHP_CRYPTO_METHOD(PBKDF2, derive);
+PHP_CRYPTO_METHOD(PBKDF2, deriveMany);
 PHP_CRYPTO_METHOD(PBKDF2, getIterations);
 PHP_CRYPTO_METHOD(PBKDF2, setIterations);
 PHP_CRYPTO_METHOD(PBKDF2, getHashAlgorithm);
 PHP_CRYPTO_METHOD(PBKDF2, setHashAlgorithm);
 #endif
 
+#ifdef PHP_CRYPTO_HAS_SCRYPT
+/* Scrypt methods */
+PHP_CRYPTO_METHOD(Scrypt, __construct);
+PHP_CRYPTO_METHOD(Scrypt, derive);
+PHP_CRYPTO_METHOD(Scrypt, getN);
+PHP_CRYPTO_METHOD(Scrypt, setN);
+PHP_CRYPTO_METHOD(Scrypt, getR);
+PHP_CRYPTO_METHOD(Scrypt, setR);
+PHP_CRYPTO_METHOD(Scrypt, getP);
+PHP_CRYPTO_METHOD(Scrypt, setP);
+PHP_CRYPTO_METHOD(Scrypt, getMaxMemory);
+PHP_CRYPTO_METHOD(Scrypt, setMaxMemory);
+#endif
+
+#ifdef PHP_CRYPTO_HAS_HKDF
+/* HKDF methods */
+PHP_CRYPTO_METHOD(HKDF, __construct);
+PHP_CRYPTO_METHOD(HKDF, derive);
+PHP_CRYPTO_METHOD(HKDF, extract);
+PHP_CRYPTO_METHOD(HKDF, expand);
+PHP_CRYPTO_METHOD(HKDF, expandMany);
+PHP_CRYPTO_METHOD(HKDF, getHashAlgorithm);
+PHP_CRYPTO_METHOD(HKDF, setHashAlgorithm);
+#endif
+
+/* Argon2 methods */
+PHP_CRYPTO_METHOD(Argon2, __construct);
+PHP_CRYPTO_METHOD(Argon2, derive);
+PHP_CRYPTO_METHOD(Argon2, getMemoryCost);
+PHP_CRYPTO_METHOD(Argon2, setMemoryCost);
+PHP_CRYPTO_METHOD(Argon2, getTimeCost);
+PHP_CRYPTO_METHOD(Argon2, setTimeCost);
+PHP_CRYPTO_METHOD(Argon2, getLanes);
+PHP_CRYPTO_METHOD(Argon2, setLanes);
+
 #endif	/* PHP_CRYPTO_KDF_H */
 
 /*
@@ -0,0 +1,60 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 2013-2016 Jakub Zelenka                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: Jakub Zelenka <bukka@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+
+#ifndef PHP_CRYPTO_PBKDF2_H
+#define PHP_CRYPTO_PBKDF2_H
+
+#include "php.h"
+#include "php_crypto.h"
+
+#include <openssl/evp.h>
+
+/* PBKDF2 engine feature test (it needs low level SHA transform functions) */
+#if OPENSSL_VERSION_NUMBER >= 0x10000000L && !defined(OPENSSL_NO_DEPRECATED_3_0)
+#define PHP_CRYPTO_HAS_PBKDF2_ENGINE 1
+#endif
+
+/* Derives PBKDF2 key (the SHA digests are computed by the own engine that
+ * computes independent output blocks in parallel, other digests are passed
+ * to OpenSSL) */
+PHP_CRYPTO_API int php_crypto_pbkdf2(const EVP_MD *md,
+		const char *pass, int pass_len, const unsigned char *salt, int salt_len,
+		int iter, unsigned char *key, int key_len TSRMLS_DC);
+
+/* Derives count PBKDF2 keys (SHA-256 keys are computed in SIMD lanes if the
+ * CPU supports it and all output blocks are spread across threads) */
+PHP_CRYPTO_API int php_crypto_pbkdf2_many(const EVP_MD *md, int count,
+		const char **pass, const int *pass_len, const unsigned char **salt, const int *salt_len,
+		int iter, unsigned char **keys, int key_len TSRMLS_DC);
+
+/* Finds the number of iterations of a key_len bytes key derivation that takes
+ * target_ms milliseconds on this machine (0 key_len is the digest size) */
+PHP_CRYPTO_API int php_crypto_pbkdf2_calibrate(const EVP_MD *md, int target_ms,
+		int key_len, int *iter TSRMLS_DC);
+
+#endif	/* PHP_CRYPTO_PBKDF2_H */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
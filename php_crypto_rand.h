@@ -23,6 +23,93 @@
 #include "php_crypto.h"
 
 #include <openssl/rand.h>
+#include <openssl/evp.h>
+
+/* Buffered generator feature test (ChaCha20 keystream) */
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L && !defined(OPENSSL_NO_CHACHA)
+#define PHP_CRYPTO_HAS_RAND_POOL 1
+#endif
+
+/* Rand backends (crypto.rand_backend INI) */
+typedef enum {
+	PHP_CRYPTO_RAND_BACKEND_OPENSSL,
+	PHP_CRYPTO_RAND_BACKEND_BUFFERED,
+	PHP_CRYPTO_RAND_BACKEND_GETRANDOM
+} php_crypto_rand_backend;
+
+/* Max number of bytes requested by one getrandom call */
+#define PHP_CRYPTO_RAND_GETRANDOM_MAX (32 * 1024 * 1024 - 1)
+
+/* Size of the buffered generator keystream buffer */
+#define PHP_CRYPTO_RAND_POOL_SIZE 4096
+
+/* Number of bytes generated before the buffered generator is reseeded */
+#define PHP_CRYPTO_RAND_POOL_RESEED (1024 * 1024)
+
+/* ChaCha20 key and IV (counter and nonce) length */
+#define PHP_CRYPTO_RAND_POOL_KEY_LEN 32
+#define PHP_CRYPTO_RAND_POOL_IV_LEN 16
+#define PHP_CRYPTO_RAND_POOL_SEED_LEN \
+	(PHP_CRYPTO_RAND_POOL_KEY_LEN + PHP_CRYPTO_RAND_POOL_IV_LEN)
+
+/* Buffered generator state (wiped in the child process after fork if
+ * the system supports it) */
+typedef struct {
+	unsigned char buf[PHP_CRYPTO_RAND_POOL_SIZE];
+	/* number of unused bytes at the end of buf */
+	size_t avail;
+	/* number of bytes generated since the last seeding */
+	size_t generated;
+	/* process identifier of the seeding (0 if not seeded) */
+	unsigned long fork_id;
+} php_crypto_rand_pool_state;
+
+/* Buffered generator (fast key erasure ChaCha20 seeded from RAND_bytes) */
+struct _php_crypto_rand_pool {
+	EVP_CIPHER_CTX *ctx;
+	php_crypto_rand_pool_state *state;
+	/* whether the state is mapped with MADV_WIPEONFORK */
+	int wipe_on_fork;
+};
+
+/* Size of the random bytes batch used for generating integers */
+#define PHP_CRYPTO_RAND_BATCH_SIZE 4096
+#define PHP_CRYPTO_RAND_BATCH_MIN 16
+
+/* Batch of random bytes fetched at once and consumed by integer generation */
+typedef struct {
+	unsigned char buf[PHP_CRYPTO_RAND_BATCH_SIZE];
+	/* number of bytes fetched at once */
+	int size;
+	/* number of fetched bytes in buf */
+	int len;
+	/* position of the first unused byte */
+	int pos;
+} php_crypto_rand_batch;
+
+/* Token encodings (without padding) */
+typedef enum {
+	PHP_CRYPTO_RAND_ENCODING_BASE64URL,
+	PHP_CRYPTO_RAND_ENCODING_HEX,
+	PHP_CRYPTO_RAND_ENCODING_BASE32
+} php_crypto_rand_encoding;
+
+/* Number of random bytes encoded at once (multiple of 3 and 5 so only
+ * the last chunk of the token can end in the middle of a group) */
+#define PHP_CRYPTO_RAND_TOKEN_CHUNK 960
+
+/* Swap array values (hash bucket data has to stay in place on PHP 7) */
+#if PHP_MAJOR_VERSION < 7
+#define PHP_CRYPTO_RAND_VAL_SWAP(_pa, _pb, _tmp) \
+	do { _tmp = *(_pa); *(_pa) = *(_pb); *(_pb) = _tmp; } while (0)
+#else
+#define PHP_CRYPTO_RAND_VAL_SWAP(_pa, _pb, _tmp) \
+	do { \
+		ZVAL_COPY_VALUE(&_tmp, _pa); \
+		ZVAL_COPY_VALUE(_pa, _pb); \
+		ZVAL_COPY_VALUE(_pb, &_tmp); \
+	} while (0)
+#endif
 
 /* Exceptions */
 PHP_CRYPTO_EXCEPTION_EXPORT(Rand)
@@ -32,9 +119,25 @@ PHP_CRYPTO_ERROR_INFO_EXPORT(Rand)
 /* Class entries */
 extern PHP_CRYPTO_API zend_class_entry *php_crypto_rand_ce;
 
+/* API */
+PHP_CRYPTO_API php_crypto_rand_backend php_crypto_rand_get_backend(TSRMLS_D);
+PHP_CRYPTO_API int php_crypto_rand_bytes(unsigned char *buf, int num TSRMLS_DC);
+PHP_CRYPTO_API void php_crypto_rand_pool_free(php_crypto_rand_pool *pool);
+/* Returns pointer to len (at most batch size) random bytes from the batch */
+PHP_CRYPTO_API unsigned char *php_crypto_rand_batch_fetch(
+		php_crypto_rand_batch *batch, int len TSRMLS_DC);
+/* Returns uniformly distributed random value from [0, range] */
+PHP_CRYPTO_API int php_crypto_rand_batch_uniform(
+		php_crypto_rand_batch *batch, uint64_t range, uint64_t *value TSRMLS_DC);
+
 /* Methods definitions */
 PHP_MINIT_FUNCTION(crypto_rand);
 PHP_CRYPTO_METHOD(Rand, generate);
+PHP_CRYPTO_METHOD(Rand, int);
+PHP_CRYPTO_METHOD(Rand, ints);
+PHP_CRYPTO_METHOD(Rand, shuffle);
+PHP_CRYPTO_METHOD(Rand, token);
+PHP_CRYPTO_METHOD(Rand, tokens);
 PHP_CRYPTO_METHOD(Rand, seed);
 PHP_CRYPTO_METHOD(Rand, cleanup);
 PHP_CRYPTO_METHOD(Rand, loadFile);
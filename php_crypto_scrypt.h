@@ -0,0 +1,50 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 2013-2016 Jakub Zelenka                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: Jakub Zelenka <bukka@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+
+#ifndef PHP_CRYPTO_SCRYPT_H
+#define PHP_CRYPTO_SCRYPT_H
+
+#include "php.h"
+#include "php_crypto.h"
+
+/* Memory in bytes needed by one ROMix lane (V, X and T blocks) */
+#define PHP_CRYPTO_SCRYPT_LANE_MEMORY(n, r) \
+	((uint64_t) 128 * (r) * ((n) + 2))
+
+/* Memory in bytes needed by the B block of all p lanes */
+#define PHP_CRYPTO_SCRYPT_BLOCK_MEMORY(r, p) \
+	((uint64_t) 128 * (r) * (p))
+
+/* Derives key using scrypt and runs max lanes ROMix lanes in parallel
+ * (the caller is responsible for checking memory and parameter limits) */
+PHP_CRYPTO_API int php_crypto_scrypt(
+		const char *pass, int pass_len, const unsigned char *salt, int salt_len,
+		uint64_t n, uint32_t r, uint32_t p, int lanes,
+		unsigned char *key, int key_len);
+
+#endif	/* PHP_CRYPTO_SCRYPT_H */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
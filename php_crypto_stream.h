@@ -20,6 +20,7 @@
 #define	PHP_CRYPTO_STREAM_H
 
 #include "php_crypto.h"
+#include "php_crypto_cipher.h"
 
 #define PHP_CRYPTO_STREAM_SCHEME_PREFIX "://"
 
@@ -32,9 +33,75 @@
 	PHP_CRYPTO_STREAM_FILE_WRAPPER_NAME PHP_CRYPTO_STREAM_SCHEME_PREFIX
 #define PHP_CRYPTO_STREAM_FILE_SCHEME_SIZE sizeof(PHP_CRYPTO_STREAM_FILE_SCHEME) - 1
 
+/* memory stream */
+#define PHP_CRYPTO_STREAM_MEMORY_WRAPPER_NAME "crypto.memory"
+#define PHP_CRYPTO_STREAM_MEMORY_SCHEME \
+	PHP_CRYPTO_STREAM_MEMORY_WRAPPER_NAME PHP_CRYPTO_STREAM_SCHEME_PREFIX
+#define PHP_CRYPTO_STREAM_MEMORY_SCHEME_SIZE sizeof(PHP_CRYPTO_STREAM_MEMORY_SCHEME) - 1
+
+/* temp stream (memory stream that spills to a temporary file) */
+#define PHP_CRYPTO_STREAM_TEMP_WRAPPER_NAME "crypto.temp"
+#define PHP_CRYPTO_STREAM_TEMP_SCHEME \
+	PHP_CRYPTO_STREAM_TEMP_WRAPPER_NAME PHP_CRYPTO_STREAM_SCHEME_PREFIX
+#define PHP_CRYPTO_STREAM_TEMP_SCHEME_SIZE sizeof(PHP_CRYPTO_STREAM_TEMP_SCHEME) - 1
+#define PHP_CRYPTO_STREAM_TEMP_MAX_MEMORY_PARAM "maxmemory:"
+#define PHP_CRYPTO_STREAM_TEMP_MAX_MEMORY_PARAM_SIZE sizeof(PHP_CRYPTO_STREAM_TEMP_MAX_MEMORY_PARAM) - 1
+/* default max size of the temp stream data kept in memory */
+#define PHP_CRYPTO_STREAM_TEMP_MAX_MEMORY (2 * 1024 * 1024)
+
+/* fd stream (the path is the file descriptor number) */
+#define PHP_CRYPTO_STREAM_FD_WRAPPER_NAME "crypto.fd"
+#define PHP_CRYPTO_STREAM_FD_SCHEME \
+	PHP_CRYPTO_STREAM_FD_WRAPPER_NAME PHP_CRYPTO_STREAM_SCHEME_PREFIX
+#define PHP_CRYPTO_STREAM_FD_SCHEME_SIZE sizeof(PHP_CRYPTO_STREAM_FD_SCHEME) - 1
+
+/* unix socket stream (the path is the socket path) */
+#define PHP_CRYPTO_STREAM_SOCKET_WRAPPER_NAME "crypto.socket"
+#define PHP_CRYPTO_STREAM_SOCKET_SCHEME \
+	PHP_CRYPTO_STREAM_SOCKET_WRAPPER_NAME PHP_CRYPTO_STREAM_SCHEME_PREFIX
+#define PHP_CRYPTO_STREAM_SOCKET_SCHEME_SIZE sizeof(PHP_CRYPTO_STREAM_SOCKET_SCHEME) - 1
+
 /* stream meta headers for cipher authentication */
 #define PHP_CRYPTO_STREAM_META_AUTH_TAG    "X-PHP-Crypto-Auth-Tag"
 #define PHP_CRYPTO_STREAM_META_AUTH_RESULT "X-PHP-Crypto-Auth-Result"
+/* stream meta header set if the file I/O backend is used */
+#define PHP_CRYPTO_STREAM_META_IO          "X-PHP-Crypto-IO"
+
+/* limits of the file buffer set by buffer_size context option */
+#define PHP_CRYPTO_STREAM_BUFFER_SIZE_MIN 4096
+#define PHP_CRYPTO_STREAM_BUFFER_SIZE_MAX (1 << 26)
+
+/* size of the file window mapped by mmap context option */
+#define PHP_CRYPTO_STREAM_MMAP_WINDOW (1 << 26)
+/* page size used if it cannot be found out */
+#define PHP_CRYPTO_STREAM_MMAP_PAGE_SIZE 4096
+
+/* size of the compressed data buffer of the compress filter */
+#define PHP_CRYPTO_STREAM_COMPRESS_BUFFER_SIZE 65536
+
+/* max size of the data encrypted at once by seekable stream write */
+#define PHP_CRYPTO_STREAM_SEEKABLE_CHUNK_SIZE 8192
+
+/* segmented AEAD stream format - the header (version, segment size, key salt
+ * and nonce prefix) is followed by segments of sealed data each with its own
+ * tag; the segments are sealed with a stream key HKDF(key, salt) */
+#define PHP_CRYPTO_STREAM_SEGMENT_VERSION 2
+#define PHP_CRYPTO_STREAM_SEGMENT_HEADER_SIZE 44
+#define PHP_CRYPTO_STREAM_SEGMENT_SALT_OFFSET 5
+#define PHP_CRYPTO_STREAM_SEGMENT_SALT_SIZE 32
+#define PHP_CRYPTO_STREAM_SEGMENT_NONCE_PREFIX_SIZE 7
+#define PHP_CRYPTO_STREAM_SEGMENT_KEY_INFO "crypto aead stream key"
+#define PHP_CRYPTO_STREAM_SEGMENT_NONCE_SIZE 12
+#define PHP_CRYPTO_STREAM_SEGMENT_TAG_SIZE 16
+#define PHP_CRYPTO_STREAM_SEGMENT_SIZE_DEFAULT 65536
+#define PHP_CRYPTO_STREAM_SEGMENT_SIZE_MIN 16
+#define PHP_CRYPTO_STREAM_SEGMENT_SIZE_MAX (1 << 24)
+
+/* number of segments queued in the pipelined aead writer for the workers
+ * (one more is filled by the stream write and one more is written) */
+#define PHP_CRYPTO_STREAM_PIPELINE_DEPTH(workers) (2 * (workers) + 2)
+/* max memory of the queued segments - the workers are reduced to fit it */
+#define PHP_CRYPTO_STREAM_PIPELINE_MEMORY_MAX (64 * 1024 * 1024)
 
 /* Error info */
 PHP_CRYPTO_ERROR_INFO_EXPORT(Stream)
@@ -46,6 +113,29 @@ PHP_CRYPTO_ERROR_INFO_EXPORT(Stream)
 #define PHP_CRYPTO_STREAM_ERROR_ARGS(einame) \
 	PHP_CRYPTO_ERROR_ARGS_EX(Stream, NULL, PHP_CRYPTO_STREAM_ERROR_ACTION, einame)
 
+/* Cipher params parsed from the cipher filters context */
+typedef struct {
+	const EVP_CIPHER *cipher;
+	const php_crypto_cipher_mode *mode;
+	phpc_val *ppv_key;
+	phpc_val *ppv_iv;
+	phpc_val *ppv_tag;
+	phpc_val *ppv_aad;
+	int enc;
+} php_crypto_stream_cipher_params;
+
+/* Parses and checks the cipher params array (the values are owned by the array) */
+PHP_CRYPTO_API int php_crypto_stream_cipher_parse(php_crypto_stream_cipher_params *params,
+		zval *pz_cipher TSRMLS_DC);
+/* Sets key, IV, tag and AAD to the cipher context with already set cipher */
+PHP_CRYPTO_API int php_crypto_stream_cipher_init(EVP_CIPHER_CTX *cipher_ctx,
+		php_crypto_stream_cipher_params *params TSRMLS_DC);
+/* Saves the auth tag to the stream meta */
+PHP_CRYPTO_API void php_crypto_stream_auth_save_tag(php_stream *stream,
+		EVP_CIPHER_CTX *cipher_ctx TSRMLS_DC);
+/* Saves the auth result to the stream meta */
+PHP_CRYPTO_API void php_crypto_stream_auth_save_result(php_stream *stream, int ok);
+
 /* Module init and shut down callbacks */
 PHP_MINIT_FUNCTION(crypto_stream);
 PHP_MSHUTDOWN_FUNCTION(crypto_stream);
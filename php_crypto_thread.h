@@ -0,0 +1,90 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 2013-2016 Jakub Zelenka                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: Jakub Zelenka <bukka@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+
+#ifndef PHP_CRYPTO_THREAD_H
+#define PHP_CRYPTO_THREAD_H
+
+#include "php.h"
+#include "php_crypto.h"
+
+/* Max number of worker threads */
+#define PHP_CRYPTO_THREADS_MAX 64
+
+/* Work item callback - it is called from worker threads so it must not
+ * use any PHP API (no emalloc, no errors) */
+typedef void (*php_crypto_thread_func)(void *data, int worker, int item);
+
+/* Returns number of workers for the supplied number of items
+ * (limited by crypto.threads INI) */
+PHP_CRYPTO_API int php_crypto_thread_workers(int items TSRMLS_DC);
+
+/* Runs func for all items using max workers threads (the calling
+ * thread is used as the first worker) */
+PHP_CRYPTO_API void php_crypto_thread_run(
+		php_crypto_thread_func func, void *data, int items, int workers);
+
+/* Ordered pipeline - items are processed in worker threads and written
+ * in the submitted order by the I/O thread */
+typedef struct _php_crypto_thread_pipeline php_crypto_thread_pipeline;
+
+/* Processes the item in place and returns the output length or -1 on error
+ * (it is called from worker threads so it must not use any PHP API) */
+typedef int (*php_crypto_thread_pipeline_process_func)(void *data, int worker,
+		unsigned char *buf, int len, uint32_t index, int last);
+
+/* Writes the processed item and returns SUCCESS or FAILURE (it is called
+ * from the I/O thread so it must not use any PHP API) */
+typedef int (*php_crypto_thread_pipeline_write_func)(void *data,
+		const unsigned char *buf, int len);
+
+/* Creates a pipeline with depth item buffers of item_size bytes allocated
+ * from the request memory (NULL is returned if threads are not available so
+ * the caller can process items serially) */
+PHP_CRYPTO_API php_crypto_thread_pipeline *php_crypto_thread_pipeline_create(
+		php_crypto_thread_pipeline_process_func process,
+		php_crypto_thread_pipeline_write_func write, void *data,
+		int item_size, int workers, int depth);
+
+/* Returns the buffer for the next item (it waits if all buffers are in use) */
+PHP_CRYPTO_API unsigned char *php_crypto_thread_pipeline_get(
+		php_crypto_thread_pipeline *pipeline);
+
+/* Submits the item in the buffer returned by the last get call (it returns
+ * FAILURE if any previous item failed) */
+PHP_CRYPTO_API int php_crypto_thread_pipeline_submit(
+		php_crypto_thread_pipeline *pipeline, int len, int last);
+
+/* Waits until all submitted items are written */
+PHP_CRYPTO_API int php_crypto_thread_pipeline_drain(
+		php_crypto_thread_pipeline *pipeline);
+
+/* Drains the pipeline, stops threads and frees it */
+PHP_CRYPTO_API int php_crypto_thread_pipeline_destroy(
+		php_crypto_thread_pipeline *pipeline);
+
+#endif	/* PHP_CRYPTO_THREAD_H */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
@@ -0,0 +1,80 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 2013-2016 Jakub Zelenka                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: Jakub Zelenka <bukka@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifndef PHP_CRYPTO_URING_H
+#define PHP_CRYPTO_URING_H
+
+#include "php.h"
+#include "php_crypto.h"
+
+/* Number of buffers that can be in flight */
+#define PHP_CRYPTO_URING_DEPTH 4
+
+/* Default size of one buffer */
+#define PHP_CRYPTO_URING_BUFFER_SIZE 131072
+
+/* Asynchronous sequential file I/O using io_uring. The file is either only
+ * read (with read ahead) or only written (with write behind). */
+typedef struct _php_crypto_uring php_crypto_uring;
+
+/* Creates the ring for the file descriptor starting at the offset (NULL is
+ * returned if io_uring is not available so the caller can use the BIO) */
+PHP_CRYPTO_API php_crypto_uring *php_crypto_uring_create(int fd,
+		uint64_t offset, size_t buffer_size);
+
+/* Returns the free space in the current write buffer (it waits if the
+ * buffer write is still in flight) */
+PHP_CRYPTO_API unsigned char *php_crypto_uring_write_buffer(
+		php_crypto_uring *uring, size_t *avail);
+
+/* Marks len bytes of the write buffer as filled (the full buffer is
+ * submitted to the kernel) */
+PHP_CRYPTO_API int php_crypto_uring_write_commit(php_crypto_uring *uring, size_t len);
+
+/* Copies data to the write buffers */
+PHP_CRYPTO_API int php_crypto_uring_write(php_crypto_uring *uring,
+		const unsigned char *buf, size_t len);
+
+/* Returns pointer to max len bytes of the read data (len is 0 at the end
+ * of the file) and keeps the following reads in flight */
+PHP_CRYPTO_API int php_crypto_uring_read(php_crypto_uring *uring, size_t max,
+		unsigned char **ptr, size_t *len);
+
+/* Submits the partial write buffer and waits for all operations (it
+ * returns FAILURE if any write failed) */
+PHP_CRYPTO_API int php_crypto_uring_flush(php_crypto_uring *uring);
+
+/* Flushes and moves the position (the read ahead data are dropped) */
+PHP_CRYPTO_API int php_crypto_uring_seek(php_crypto_uring *uring, uint64_t offset);
+
+/* Returns the current position */
+PHP_CRYPTO_API uint64_t php_crypto_uring_tell(php_crypto_uring *uring);
+
+/* Flushes and frees the ring */
+PHP_CRYPTO_API int php_crypto_uring_destroy(php_crypto_uring *uring);
+
+#endif	/* PHP_CRYPTO_URING_H */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
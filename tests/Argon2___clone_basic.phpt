@@ -0,0 +1,25 @@
+--TEST--
+Crypto\Argon2::__clone basic usage.
+--FILE--
+<?php
+function print_argon2($kdf) {
+	echo $kdf->getMemoryCost() . ' ' . $kdf->getTimeCost() . ' ' . $kdf->getLanes() . "\n";
+}
+
+$argon2 = new Crypto\Argon2(32, 'somesalt', 1024, 2, 2);
+$argon2_clone = clone $argon2;
+print_argon2($argon2_clone);
+$argon2->setMemoryCost(2048);
+$argon2->setLanes(4);
+print_argon2($argon2);
+print_argon2($argon2_clone);
+$argon2_clone->setTimeCost(3);
+print_argon2($argon2);
+print_argon2($argon2_clone);
+?>
+--EXPECT--
+1024 2 2
+2048 2 4
+1024 2 2
+2048 2 4
+1024 3 2
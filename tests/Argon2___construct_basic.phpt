@@ -0,0 +1,52 @@
+--TEST--
+Crypto\Argon2::__construct basic usage.
+--FILE--
+<?php
+// basic creation with just length
+$argon2 = new Crypto\Argon2(32);
+if ($argon2 instanceof Crypto\Argon2) {
+    echo "LENGTH ONLY\n";
+}
+
+// creation with all parameters
+$argon2 = new Crypto\Argon2(32, 'somesalt', 1024, 2, 4);
+if ($argon2 instanceof Crypto\Argon2) {
+    echo "ALL PARAMETERS\n";
+}
+
+// invalid memory cost
+try {
+    $argon2 = new Crypto\Argon2(32, 'somesalt', 7);
+}
+catch (Crypto\Argon2Exception $e) {
+    if ($e->getCode() === Crypto\Argon2Exception::MEMORY_COST_INVALID) {
+        echo "MEMORY COST INVALID\n";
+    }
+}
+
+// invalid time cost
+try {
+    $argon2 = new Crypto\Argon2(32, 'somesalt', 1024, 0);
+}
+catch (Crypto\Argon2Exception $e) {
+    if ($e->getCode() === Crypto\Argon2Exception::TIME_COST_INVALID) {
+        echo "TIME COST INVALID\n";
+    }
+}
+
+// invalid lanes
+try {
+    $argon2 = new Crypto\Argon2(32, 'somesalt', 1024, 2, 0);
+}
+catch (Crypto\Argon2Exception $e) {
+    if ($e->getCode() === Crypto\Argon2Exception::LANES_INVALID) {
+        echo "LANES INVALID\n";
+    }
+}
+?>
+--EXPECT--
+LENGTH ONLY
+ALL PARAMETERS
+MEMORY COST INVALID
+TIME COST INVALID
+LANES INVALID
@@ -0,0 +1,84 @@
+--TEST--
+Crypto\Argon2::derive basic usage.
+--FILE--
+<?php
+$vectors = array(
+	array(
+		'P' => 'password',
+		'S' => 'somesalt',
+		'm' => 65536,
+		't' => 2,
+		'p' => 1,
+		'tagLen' => 32,
+		'tag' => "09316115d5cf24ed5a15a31a3ba326e5cf32edc24702987c02b6566f61913cf7"
+	),
+	array(
+		'P' => 'password',
+		'S' => 'somesalt',
+		'm' => 256,
+		't' => 2,
+		'p' => 1,
+		'tagLen' => 32,
+		'tag' => "9dfeb910e80bad0311fee20f9c0e2b12c17987b4cac90c2ef54d5b3021c68bfe"
+	),
+	array(
+		'P' => 'password',
+		'S' => 'somesalt',
+		'm' => 256,
+		't' => 2,
+		'p' => 2,
+		'tagLen' => 32,
+		'tag' => "6d093c501fd5999645e0ea3bf620d7b8be7fd2db59c20d9fff9539da2bf57037"
+	),
+);
+
+foreach ($vectors as $v) {
+	$argon2 = new Crypto\Argon2($v['tagLen'], $v['S'], $v['m'], $v['t'], $v['p']);
+	if (pack('H*', $v['tag']) !== $argon2->derive($v['P'])) {
+		print_r($v);
+	}
+	// the second derivation reuses the arena memory
+	if (pack('H*', $v['tag']) !== $argon2->derive($v['P'])) {
+		print_r($v);
+	}
+}
+
+// memory cost lower than 8 KiB per lane
+$argon2 = new Crypto\Argon2(32, 'somesalt', 16, 2, 4);
+try {
+	$argon2->derive('password');
+}
+catch (Crypto\Argon2Exception $e) {
+	if ($e->getCode() === Crypto\Argon2Exception::MEMORY_COST_LOW) {
+		echo "MEMORY COST LOW\n";
+	}
+}
+
+// memory cost higher than crypto.argon2_max_memory (256 MiB)
+$argon2 = new Crypto\Argon2(32, 'somesalt', 1048576, 1, 1);
+try {
+	$argon2->derive('password');
+}
+catch (Crypto\Argon2Exception $e) {
+	if ($e->getCode() === Crypto\Argon2Exception::MEMORY_COST_HIGH) {
+		echo "MEMORY COST HIGH\n";
+	}
+}
+
+// short salt
+$argon2 = new Crypto\Argon2(32, 'salt');
+try {
+	$argon2->derive('password');
+}
+catch (Crypto\Argon2Exception $e) {
+	if ($e->getCode() === Crypto\Argon2Exception::SALT_LENGTH_LOW) {
+		echo "SALT LENGTH LOW\n";
+	}
+}
+echo "DONE";
+?>
+--EXPECT--
+MEMORY COST LOW
+MEMORY COST HIGH
+SALT LENGTH LOW
+DONE
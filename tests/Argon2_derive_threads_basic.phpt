@@ -0,0 +1,57 @@
+--TEST--
+Crypto\Argon2::derive with parallel lanes.
+--INI--
+crypto.threads=4
+--FILE--
+<?php
+$vectors = array(
+	array(
+		'P' => 'password',
+		'S' => 'somesalt',
+		'm' => 65536,
+		't' => 2,
+		'p' => 1,
+		'tagLen' => 32,
+		'tag' => "09316115d5cf24ed5a15a31a3ba326e5cf32edc24702987c02b6566f61913cf7"
+	),
+	array(
+		'P' => 'password',
+		'S' => 'somesalt',
+		'm' => 256,
+		't' => 2,
+		'p' => 1,
+		'tagLen' => 32,
+		'tag' => "9dfeb910e80bad0311fee20f9c0e2b12c17987b4cac90c2ef54d5b3021c68bfe"
+	),
+	array(
+		'P' => 'password',
+		'S' => 'somesalt',
+		'm' => 256,
+		't' => 2,
+		'p' => 2,
+		'tagLen' => 32,
+		'tag' => "6d093c501fd5999645e0ea3bf620d7b8be7fd2db59c20d9fff9539da2bf57037"
+	),
+);
+
+foreach ($vectors as $v) {
+	$argon2 = new Crypto\Argon2($v['tagLen'], $v['S'], $v['m'], $v['t'], $v['p']);
+	if (pack('H*', $v['tag']) !== $argon2->derive($v['P'])) {
+		print_r($v);
+	}
+	// the second derivation reuses the arena memory
+	if (pack('H*', $v['tag']) !== $argon2->derive($v['P'])) {
+		print_r($v);
+	}
+}
+
+// more lanes than threads
+$argon2 = new Crypto\Argon2(32, 'somesalt', 256, 2, 8);
+if ($argon2->derive('password') === $argon2->derive('password')) {
+	echo "MORE LANES\n";
+}
+echo "DONE";
+?>
+--EXPECT--
+MORE LANES
+DONE
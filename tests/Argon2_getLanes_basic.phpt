@@ -0,0 +1,9 @@
+--TEST--
+Crypto\Argon2::getLanes basic usage.
+--FILE--
+<?php
+$argon2 = new Crypto\Argon2(32, 'somesalt', 1024, 2, 2);
+var_dump($argon2->getLanes());
+?>
+--EXPECT--
+int(2)
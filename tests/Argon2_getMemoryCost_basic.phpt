@@ -0,0 +1,9 @@
+--TEST--
+Crypto\Argon2::getMemoryCost basic usage.
+--FILE--
+<?php
+$argon2 = new Crypto\Argon2(32, 'somesalt', 1024);
+var_dump($argon2->getMemoryCost());
+?>
+--EXPECT--
+int(1024)
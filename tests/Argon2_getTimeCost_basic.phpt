@@ -0,0 +1,9 @@
+--TEST--
+Crypto\Argon2::getTimeCost basic usage.
+--FILE--
+<?php
+$argon2 = new Crypto\Argon2(32, 'somesalt', 1024, 2);
+var_dump($argon2->getTimeCost());
+?>
+--EXPECT--
+int(2)
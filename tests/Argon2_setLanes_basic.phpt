@@ -0,0 +1,22 @@
+--TEST--
+Crypto\Argon2::setLanes basic usage.
+--FILE--
+<?php
+$argon2 = new Crypto\Argon2(32);
+var_dump($argon2->getLanes());
+var_dump($argon2->setLanes(4));
+var_dump($argon2->getLanes());
+try {
+	$argon2->setLanes(0);
+}
+catch (Crypto\Argon2Exception $e) {
+	if ($e->getCode() === Crypto\Argon2Exception::LANES_INVALID) {
+		echo "LANES INVALID\n";
+	}
+}
+?>
+--EXPECT--
+int(1)
+bool(true)
+int(4)
+LANES INVALID
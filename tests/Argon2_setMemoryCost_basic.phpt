@@ -0,0 +1,22 @@
+--TEST--
+Crypto\Argon2::setMemoryCost basic usage.
+--FILE--
+<?php
+$argon2 = new Crypto\Argon2(32);
+var_dump($argon2->getMemoryCost());
+var_dump($argon2->setMemoryCost(2048));
+var_dump($argon2->getMemoryCost());
+try {
+	$argon2->setMemoryCost(7);
+}
+catch (Crypto\Argon2Exception $e) {
+	if ($e->getCode() === Crypto\Argon2Exception::MEMORY_COST_INVALID) {
+		echo "MEMORY COST INVALID\n";
+	}
+}
+?>
+--EXPECT--
+int(65536)
+bool(true)
+int(2048)
+MEMORY COST INVALID
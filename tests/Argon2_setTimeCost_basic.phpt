@@ -0,0 +1,22 @@
+--TEST--
+Crypto\Argon2::setTimeCost basic usage.
+--FILE--
+<?php
+$argon2 = new Crypto\Argon2(32);
+var_dump($argon2->getTimeCost());
+var_dump($argon2->setTimeCost(4));
+var_dump($argon2->getTimeCost());
+try {
+	$argon2->setTimeCost(0);
+}
+catch (Crypto\Argon2Exception $e) {
+	if ($e->getCode() === Crypto\Argon2Exception::TIME_COST_INVALID) {
+		echo "TIME COST INVALID\n";
+	}
+}
+?>
+--EXPECT--
+int(3)
+bool(true)
+int(4)
+TIME COST INVALID
@@ -0,0 +1,59 @@
+--TEST--
+Crypto\Base64::__construct with wrap, alphabet and padding options.
+--FILE--
+<?php
+$data = "\xfa\xfb\xfc\xfd\xfe\xff" . str_repeat("hello world?>~", 6) . "!";
+
+// MIME wrapping
+$b64 = new Crypto\Base64(Crypto\Base64::WRAP_MIME);
+echo $b64->encodeUpdate(substr($data, 0, 50));
+echo $b64->encodeUpdate(substr($data, 50));
+echo $b64->encodeFinish();
+
+// unwrapped URL safe without padding
+$b64 = new Crypto\Base64(Crypto\Base64::WRAP_NONE, Crypto\Base64::ALPHABET_URL, false);
+$encoded = '';
+foreach (str_split($data, 7) as $chunk) {
+	$encoded .= $b64->encodeUpdate($chunk);
+}
+$encoded .= $b64->encodeFinish();
+echo "$encoded\n";
+
+$b64 = new Crypto\Base64(Crypto\Base64::WRAP_NONE, Crypto\Base64::ALPHABET_URL, false);
+$decoded = '';
+foreach (str_split($encoded, 5) as $chunk) {
+	$decoded .= $b64->decodeUpdate($chunk);
+}
+$decoded .= $b64->decodeFinish();
+echo ($decoded === $data ? "DECODED" : "ERROR") . "\n";
+
+// clone keeps options
+$b64 = new Crypto\Base64(Crypto\Base64::WRAP_NONE);
+$b64_clone = clone $b64;
+echo $b64_clone->encodeUpdate("abcd") . $b64_clone->encodeFinish() . "\n";
+
+try {
+	new Crypto\Base64(60);
+}
+catch (Crypto\Base64Exception $e) {
+	if ($e->getCode() === Crypto\Base64Exception::WRAP_INVALID) {
+		echo "WRAP INVALID\n";
+	}
+}
+try {
+	new Crypto\Base64(Crypto\Base64::WRAP_PEM, 5);
+}
+catch (Crypto\Base64Exception $e) {
+	if ($e->getCode() === Crypto\Base64Exception::ALPHABET_INVALID) {
+		echo "ALPHABET INVALID\n";
+	}
+}
+?>
+--EXPECT--
++vv8/f7/aGVsbG8gd29ybGQ/Pn5oZWxsbyB3b3JsZD8+fmhlbGxvIHdvcmxkPz5+aGVsbG8gd29y
+bGQ/Pn5oZWxsbyB3b3JsZD8+fmhlbGxvIHdvcmxkPz5+IQ==
+-vv8_f7_aGVsbG8gd29ybGQ_Pn5oZWxsbyB3b3JsZD8-fmhlbGxvIHdvcmxkPz5-aGVsbG8gd29ybGQ_Pn5oZWxsbyB3b3JsZD8-fmhlbGxvIHdvcmxkPz5-IQ
+DECODED
+YWJjZA==
+WRAP INVALID
+ALPHABET INVALID
@@ -0,0 +1,37 @@
+--TEST--
+Crypto\Base64::decodeMany basic usage.
+--FILE--
+<?php
+$data = array('eyJhbGciOiJIUzI1NiJ9', 'eyJzdWIiOiIxMjM0In0', '');
+print_r(Crypto\Base64::decodeMany($data, Crypto\Base64::ALPHABET_URL, false));
+$decoded = Crypto\Base64::decodeMany(array("YWI=\n", Crypto\Base64::encode(str_repeat('x', 100))));
+var_dump($decoded[0]);
+var_dump($decoded[1] === str_repeat('x', 100));
+try {
+	Crypto\Base64::decodeMany(array('YWI=', '#YWI'));
+}
+catch (Crypto\Base64Exception $e) {
+	if ($e->getCode() === Crypto\Base64Exception::DECODE_UPDATE_FAILED) {
+		echo "DECODE UPDATE FAILED\n";
+	}
+}
+try {
+	Crypto\Base64::decodeMany(array('YWI=', null));
+}
+catch (Crypto\Base64Exception $e) {
+	if ($e->getCode() === Crypto\Base64Exception::DATA_TYPE_INVALID) {
+		echo "DATA TYPE INVALID\n";
+	}
+}
+?>
+--EXPECT--
+Array
+(
+    [0] => {"alg":"HS256"}
+    [1] => {"sub":"1234"}
+    [2] => 
+)
+string(2) "ab"
+bool(true)
+DECODE UPDATE FAILED
+DATA TYPE INVALID
@@ -14,7 +14,23 @@ ZWZnaGlqa2xtbm9wcXJzdHV2KyoqXiUk
 EOI;
 
 echo ($data_orig == Crypto\Base64::decode($data_encoded) ? "SUCCESS" : "ERROR") . "\n";
+var_dump(Crypto\Base64::decode(''));
+
+// short invalid input and missing padding in the last quad
+foreach (array('!', 'QQ') as $data_invalid) {
+	try {
+		Crypto\Base64::decode($data_invalid);
+	}
+	catch (Crypto\Base64Exception $e) {
+		if ($e->getCode() === Crypto\Base64Exception::DECODE_UPDATE_FAILED) {
+			echo "DECODE UPDATE FAILED\n";
+		}
+	}
+}
 
 ?>
 --EXPECT--
 SUCCESS
+string(0) ""
+DECODE UPDATE FAILED
+DECODE UPDATE FAILED
@@ -0,0 +1,30 @@
+--TEST--
+Crypto\Base64::encodeMany basic usage.
+--FILE--
+<?php
+$data = array('{"alg":"HS256"}', '{"sub":"1234"}', '');
+print_r(Crypto\Base64::encodeMany($data, Crypto\Base64::WRAP_NONE,
+		Crypto\Base64::ALPHABET_URL, false));
+$encoded = Crypto\Base64::encodeMany(array('ab', str_repeat('x', 100)));
+var_dump($encoded[0]);
+var_dump($encoded[1] === Crypto\Base64::encode(str_repeat('x', 100)));
+try {
+	Crypto\Base64::encodeMany(array('data', 1));
+}
+catch (Crypto\Base64Exception $e) {
+	if ($e->getCode() === Crypto\Base64Exception::DATA_TYPE_INVALID) {
+		echo "DATA TYPE INVALID\n";
+	}
+}
+?>
+--EXPECT--
+Array
+(
+    [0] => eyJhbGciOiJIUzI1NiJ9
+    [1] => eyJzdWIiOiIxMjM0In0
+    [2] => 
+)
+string(5) "YWI=
+"
+bool(true)
+DATA TYPE INVALID
@@ -0,0 +1,38 @@
+--TEST--
+Crypto\Base64 engine encoding and decoding of long data.
+--FILE--
+<?php
+foreach (array(47, 48, 100, 1000, 4097, 100000) as $len) {
+	$data = Crypto\Rand::generate($len);
+	$encoded = Crypto\Base64::encode($data);
+	if ($encoded !== chunk_split(base64_encode($data), 64, "\n")) {
+		echo "ENCODE $len\n";
+	}
+	if (Crypto\Base64::decode($encoded) !== $data) {
+		echo "DECODE $len\n";
+	}
+	if (Crypto\Base64::decode(base64_encode($data)) !== $data) {
+		echo "DECODE UNWRAPPED $len\n";
+	}
+	$base64 = new Crypto\Base64();
+	$decoded = '';
+	foreach (str_split($encoded, 61) as $chunk) {
+		$decoded .= $base64->decodeUpdate($chunk);
+	}
+	if ($decoded . $base64->decodeFinish() !== $data) {
+		echo "DECODE UPDATE $len\n";
+	}
+}
+try {
+	Crypto\Base64::decode(str_repeat('QUJD', 20) . "\x80" . str_repeat('QUJD', 20));
+}
+catch (Crypto\Base64Exception $e) {
+	if ($e->getCode() === Crypto\Base64Exception::DECODE_UPDATE_FAILED) {
+		echo "FAILED\n";
+	}
+}
+echo "OK\n";
+?>
+--EXPECT--
+FAILED
+OK
@@ -0,0 +1,39 @@
+--TEST--
+Crypto\Base64::encode and Crypto\Base64::decode with options.
+--FILE--
+<?php
+$data = "\xfa\xfb\xfc\xfd\xfe\xff" . str_repeat("hello world?>~", 6) . "!";
+
+$encoded = Crypto\Base64::encode($data, Crypto\Base64::WRAP_NONE, Crypto\Base64::ALPHABET_URL);
+echo "$encoded\n";
+echo (Crypto\Base64::decode($encoded, Crypto\Base64::ALPHABET_URL) === $data ? "URL" : "ERROR") . "\n";
+
+$encoded = Crypto\Base64::encode($data, Crypto\Base64::WRAP_NONE, Crypto\Base64::ALPHABET_URL, false);
+echo "$encoded\n";
+echo (Crypto\Base64::decode($encoded, Crypto\Base64::ALPHABET_URL, false) === $data ? "NO PADDING" : "ERROR") . "\n";
+// padding is required by default
+var_dump(Crypto\Base64::decode($encoded, Crypto\Base64::ALPHABET_URL) === $data);
+
+echo Crypto\Base64::encode($data, Crypto\Base64::WRAP_NONE) . "\n";
+echo Crypto\Base64::encode("ab", Crypto\Base64::WRAP_NONE, Crypto\Base64::ALPHABET_STANDARD, false) . "\n";
+var_dump(Crypto\Base64::encode("", Crypto\Base64::WRAP_NONE));
+
+try {
+	Crypto\Base64::decode("+vv8", Crypto\Base64::ALPHABET_URL);
+}
+catch (Crypto\Base64Exception $e) {
+	if ($e->getCode() === Crypto\Base64Exception::DECODE_UPDATE_FAILED) {
+		echo "DECODE FAILED\n";
+	}
+}
+?>
+--EXPECT--
+-vv8_f7_aGVsbG8gd29ybGQ_Pn5oZWxsbyB3b3JsZD8-fmhlbGxvIHdvcmxkPz5-aGVsbG8gd29ybGQ_Pn5oZWxsbyB3b3JsZD8-fmhlbGxvIHdvcmxkPz5-IQ==
+URL
+-vv8_f7_aGVsbG8gd29ybGQ_Pn5oZWxsbyB3b3JsZD8-fmhlbGxvIHdvcmxkPz5-aGVsbG8gd29ybGQ_Pn5oZWxsbyB3b3JsZD8-fmhlbGxvIHdvcmxkPz5-IQ
+NO PADDING
+bool(false)
++vv8/f7/aGVsbG8gd29ybGQ/Pn5oZWxsbyB3b3JsZD8+fmhlbGxvIHdvcmxkPz5+aGVsbG8gd29ybGQ/Pn5oZWxsbyB3b3JsZD8+fmhlbGxvIHdvcmxkPz5+IQ==
+YWI
+string(0) ""
+DECODE FAILED
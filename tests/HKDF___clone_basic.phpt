@@ -0,0 +1,18 @@
+--TEST--
+Crypto\HKDF::__clone basic usage.
+--SKIPIF--
+<?php if (!class_exists('Crypto\HKDF')) die("Skip: HKDF is not supported (update OpenSSL version)"); ?>
+--FILE--
+<?php
+$hkdf = new Crypto\HKDF('sha256', 16, 'salt');
+$hkdf->extract('secret');
+$hkdf_clone = clone $hkdf;
+var_dump($hkdf->expand('info') === $hkdf_clone->expand('info'));
+$hkdf->extract('other secret');
+var_dump($hkdf->expand('info') === $hkdf_clone->expand('info'));
+var_dump($hkdf_clone->getHashAlgorithm());
+?>
+--EXPECT--
+bool(true)
+bool(false)
+string(6) "SHA256"
@@ -0,0 +1,32 @@
+--TEST--
+Crypto\HKDF::__construct basic usage.
+--SKIPIF--
+<?php if (!class_exists('Crypto\HKDF')) die("Skip: HKDF is not supported (update OpenSSL version)"); ?>
+--FILE--
+<?php
+// basic creation with just hash algorithm parameter
+$hkdf = new Crypto\HKDF('sha256', 32);
+if ($hkdf instanceof Crypto\HKDF) {
+    echo "HASH ONLY\n";
+}
+
+// invalid creation
+try {
+    $hkdf = new Crypto\HKDF('nnn', 32);
+}
+catch (Crypto\HKDFException $e) {
+    if ($e->getCode() === Crypto\HKDFException::HASH_ALGORITHM_NOT_FOUND) {
+        echo "HASH NOT FOUND\n";
+    }
+}
+
+// creation with hash algorithm and salt
+$hkdf = new Crypto\HKDF('sha256', 32, 'salt');
+if ($hkdf instanceof Crypto\HKDF) {
+    echo "HASH AND SALT\n";
+}
+?>
+--EXPECT--
+HASH ONLY
+HASH NOT FOUND
+HASH AND SALT
@@ -0,0 +1,13 @@
+--TEST--
+Crypto\HKDF::derive basic usage.
+--SKIPIF--
+<?php if (!class_exists('Crypto\HKDF')) die("Skip: HKDF is not supported (update OpenSSL version)"); ?>
+--FILE--
+<?php
+// RFC 5869 test case 3 (empty salt and info)
+$hkdf = new Crypto\HKDF('sha256', 42);
+$okm = $hkdf->derive(str_repeat("\x0b", 22));
+echo bin2hex($okm) . "\n";
+?>
+--EXPECT--
+8da4e775a563c18f715f802a063c5a31b8a11f5c5ee1879ec3454e5f3c738d2d9d201395faa4b61a96c8
@@ -0,0 +1,32 @@
+--TEST--
+Crypto\HKDF::expandMany basic usage.
+--SKIPIF--
+<?php if (!class_exists('Crypto\HKDF')) die("Skip: HKDF is not supported (update OpenSSL version)"); ?>
+--FILE--
+<?php
+$hkdf = new Crypto\HKDF('sha256', 32, 'salt');
+$hkdf->extract('master secret');
+$infos = array('tenant-1/enc', 'tenant-1/mac', 'tenant-2/enc');
+$keys = $hkdf->expandMany($infos);
+var_dump(count($keys));
+foreach ($infos as $i => $info) {
+    var_dump($keys[$i] === $hkdf->expand($info));
+}
+$keys = $hkdf->expandMany($infos, 16);
+var_dump(strlen($keys[2]));
+try {
+    $hkdf->expandMany(array('info', 1));
+}
+catch (Crypto\HKDFException $e) {
+    if ($e->getCode() === Crypto\HKDFException::INFO_TYPE_INVALID) {
+        echo "INFO TYPE INVALID\n";
+    }
+}
+?>
+--EXPECT--
+int(3)
+bool(true)
+bool(true)
+bool(true)
+int(16)
+INFO TYPE INVALID
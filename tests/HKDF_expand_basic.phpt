@@ -0,0 +1,29 @@
+--TEST--
+Crypto\HKDF::expand basic usage.
+--SKIPIF--
+<?php if (!class_exists('Crypto\HKDF')) die("Skip: HKDF is not supported (update OpenSSL version)"); ?>
+--FILE--
+<?php
+// RFC 5869 test case 1
+$hkdf = new Crypto\HKDF('sha256', 32, pack('H*', '000102030405060708090a0b0c'));
+$hkdf->extract(str_repeat("\x0b", 22));
+$info = pack('H*', 'f0f1f2f3f4f5f6f7f8f9');
+// the extracted key is reused by all expansions
+echo bin2hex($hkdf->expand($info, 42)) . "\n";
+echo bin2hex($hkdf->expand($info, 42)) . "\n";
+// default length is the key length
+echo bin2hex($hkdf->expand($info)) . "\n";
+try {
+    $hkdf->expand($info, 255 * 32 + 1);
+}
+catch (Crypto\HKDFException $e) {
+    if ($e->getCode() === Crypto\HKDFException::LENGTH_HIGH) {
+        echo "LENGTH HIGH\n";
+    }
+}
+?>
+--EXPECT--
+3cb25f25faacd57a90434f64d0362f2a2d2d0a90cf1a5a4c5db02d56ecc4c5bf34007208d5b887185865
+3cb25f25faacd57a90434f64d0362f2a2d2d0a90cf1a5a4c5db02d56ecc4c5bf34007208d5b887185865
+3cb25f25faacd57a90434f64d0362f2a2d2d0a90cf1a5a4c5db02d56ecc4c5bf
+LENGTH HIGH
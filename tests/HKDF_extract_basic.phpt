@@ -0,0 +1,22 @@
+--TEST--
+Crypto\HKDF::extract basic usage.
+--SKIPIF--
+<?php if (!class_exists('Crypto\HKDF')) die("Skip: HKDF is not supported (update OpenSSL version)"); ?>
+--FILE--
+<?php
+$hkdf = new Crypto\HKDF('sha256', 42, pack('H*', '000102030405060708090a0b0c'));
+try {
+    $hkdf->expand('info');
+}
+catch (Crypto\HKDFException $e) {
+    if ($e->getCode() === Crypto\HKDFException::EXTRACT_REQUIRED) {
+        echo "EXTRACT REQUIRED\n";
+    }
+}
+var_dump($hkdf->extract(str_repeat("\x0b", 22)));
+echo bin2hex($hkdf->expand(pack('H*', 'f0f1f2f3f4f5f6f7f8f9'))) . "\n";
+?>
+--EXPECT--
+EXTRACT REQUIRED
+bool(true)
+3cb25f25faacd57a90434f64d0362f2a2d2d0a90cf1a5a4c5db02d56ecc4c5bf34007208d5b887185865
@@ -0,0 +1,11 @@
+--TEST--
+Crypto\HKDF::getHashAlgorithm basic usage.
+--SKIPIF--
+<?php if (!class_exists('Crypto\HKDF')) die("Skip: HKDF is not supported (update OpenSSL version)"); ?>
+--FILE--
+<?php
+$hkdf = new Crypto\HKDF('sha256', 32);
+var_dump($hkdf->getHashAlgorithm());
+?>
+--EXPECT--
+string(6) "SHA256"
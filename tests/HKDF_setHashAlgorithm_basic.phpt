@@ -0,0 +1,24 @@
+--TEST--
+Crypto\HKDF::setHashAlgorithm basic usage.
+--SKIPIF--
+<?php if (!class_exists('Crypto\HKDF')) die("Skip: HKDF is not supported (update OpenSSL version)"); ?>
+--FILE--
+<?php
+$hkdf = new Crypto\HKDF('sha256', 32);
+$hkdf->extract('secret');
+var_dump($hkdf->setHashAlgorithm('sha512'));
+var_dump($hkdf->getHashAlgorithm());
+// the extracted key is discarded
+try {
+    $hkdf->expand('info');
+}
+catch (Crypto\HKDFException $e) {
+    if ($e->getCode() === Crypto\HKDFException::EXTRACT_REQUIRED) {
+        echo "EXTRACT REQUIRED\n";
+    }
+}
+?>
+--EXPECT--
+bool(true)
+string(6) "SHA512"
+EXTRACT REQUIRED
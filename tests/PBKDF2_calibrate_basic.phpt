@@ -0,0 +1,44 @@
+--TEST--
+Crypto\PBKDF2::calibrate basic usage.
+--SKIPIF--
+<?php if (!class_exists('Crypto\PBKDF2')) die("Skip: PBKDF2 is not supported (update OpenSSL version)"); ?>
+--FILE--
+<?php
+$iterations = Crypto\PBKDF2::calibrate(20, 'sha256');
+var_dump(is_int($iterations) && $iterations > 0);
+// two output blocks take about twice as long as one block
+ini_set('crypto.threads', 1);
+$one = Crypto\PBKDF2::calibrate(50, 'sha256', 32);
+$two = Crypto\PBKDF2::calibrate(50, 'sha256', 64);
+var_dump($two < $one * 0.75);
+try {
+	Crypto\PBKDF2::calibrate(20, 'sha256', -1);
+}
+catch (Crypto\KDFException $e) {
+	if ($e->getCode() === Crypto\KDFException::KEY_LENGTH_LOW) {
+		echo "KEY LENGTH\n";
+	}
+}
+try {
+	Crypto\PBKDF2::calibrate(0, 'sha256');
+}
+catch (Crypto\PBKDF2Exception $e) {
+	if ($e->getCode() === Crypto\PBKDF2Exception::TARGET_TIME_INVALID) {
+		echo "TARGET\n";
+	}
+}
+try {
+	Crypto\PBKDF2::calibrate(20, 'nnn');
+}
+catch (Crypto\PBKDF2Exception $e) {
+	if ($e->getCode() === Crypto\PBKDF2Exception::HASH_ALGORITHM_NOT_FOUND) {
+		echo "NOT FOUND\n";
+	}
+}
+?>
+--EXPECT--
+bool(true)
+bool(true)
+KEY LENGTH
+TARGET
+NOT FOUND
@@ -0,0 +1,93 @@
+--TEST--
+Crypto\PBKDF2::deriveMany basic usage.
+--SKIPIF--
+<?php if (!class_exists('Crypto\PBKDF2')) die("Skip: PBKDF2 is not supported (update OpenSSL version)"); ?>
+--FILE--
+<?php
+$passwords = array();
+$salts = array();
+// count that is not a multiple of the lanes
+for ($i = 0; $i < 21; $i++) {
+	$passwords[] = str_repeat(chr(65 + $i), $i * 4);
+	$salts[] = "salt $i";
+}
+foreach (array('sha256', 'sha1', 'md5') as $alg) {
+	foreach (array(20, 32, 70) as $length) {
+		$pbkdf2 = new Crypto\PBKDF2($alg, $length, NULL, 50);
+		$keys = $pbkdf2->deriveMany($passwords, $salts);
+		if (count($keys) !== count($passwords)) {
+			echo "$alg: $length count\n";
+		}
+		foreach ($passwords as $i => $password) {
+			$pbkdf2->setSalt($salts[$i]);
+			if ($keys[$i] !== $pbkdf2->derive($password)) {
+				echo "$alg: $length: $i\n";
+			}
+		}
+	}
+}
+// RFC 6070 (SHA-1) and RFC 7914 (SHA-256) vectors
+$vectors = array(
+	array('sha1', 1, 20, 'password', 'salt'),
+	array('sha1', 2, 20, 'password', 'salt'),
+	array('sha1', 4096, 20, 'password', 'salt'),
+	array('sha1', 4096, 25, 'passwordPASSWORDpassword', 'saltSALTsaltSALTsaltSALTsaltSALTsalt'),
+	array('sha1', 4096, 16, "pass\0word", "sa\0lt"),
+	array('sha256', 1, 64, 'passwd', 'salt'),
+	array('sha256', 80000, 64, 'Password', 'NaCl'),
+);
+foreach ($vectors as $vector) {
+	list($alg, $iterations, $length, $password, $salt) = $vector;
+	$pbkdf2 = new Crypto\PBKDF2($alg, $length, NULL, $iterations);
+	// more pairs to fill the SIMD lanes
+	$keys = $pbkdf2->deriveMany(array_fill(0, 4, $password), array_fill(0, 4, $salt));
+	echo bin2hex($keys[0]) . "\n";
+	if (count(array_unique($keys)) !== 1) {
+		echo "$alg: $iterations: lanes differ\n";
+	}
+}
+// passwords and salts are paired by key
+$pbkdf2 = new Crypto\PBKDF2('sha1', 20, NULL, 1);
+$keys = $pbkdf2->deriveMany(array(1 => 'password', 0 => 'other'), array('other salt', 'salt'));
+echo bin2hex($keys[1]) . "\n";
+try {
+	$pbkdf2->deriveMany(array('a' => 'p1', 'b' => 'p2'), array('b' => 's2', 'a' => 's1'));
+}
+catch (Crypto\PBKDF2Exception $e) {
+	if ($e->getCode() === Crypto\PBKDF2Exception::PASSWORDS_SALTS_MISMATCH) {
+		echo "KEYS MISMATCH\n";
+	}
+}
+$pbkdf2 = new Crypto\PBKDF2('sha256', 32, NULL, 50);
+var_dump($pbkdf2->deriveMany(array(), array()));
+try {
+	$pbkdf2->deriveMany(array('p1', 'p2'), array('s1'));
+}
+catch (Crypto\PBKDF2Exception $e) {
+	if ($e->getCode() === Crypto\PBKDF2Exception::PASSWORDS_SALTS_MISMATCH) {
+		echo "MISMATCH\n";
+	}
+}
+try {
+	$pbkdf2->deriveMany(array('p1', 1), array('s1', 's2'));
+}
+catch (Crypto\PBKDF2Exception $e) {
+	if ($e->getCode() === Crypto\PBKDF2Exception::PASSWORD_TYPE_INVALID) {
+		echo "PASSWORD TYPE\n";
+	}
+}
+?>
+--EXPECT--
+0c60c80f961f0e71f3a9b524af6012062fe037a6
+ea6c014dc72d6f8ccd1ed92ace1d41f0d8de8957
+4b007901b765489abead49d926f721d065a429c1
+3d2eec4fe41c849b80c8d83662c0e44a8b291a964cf2f07038
+56fa6aa75548099dcc37d7f03425e0c3
+55ac046e56e3089fec1691c22544b605f94185216dde0465e68b9d57c20dacbc49ca9cccf179b645991664b39d77ef317c71b845b1e30bd509112041d3a19783
+4ddcd8f60b98be21830cee5ef22701f9641a4418d04c0414aeff08876b34ab56a1d425a1225833549adb841b51c9b3176a272bdebba1d078478f62b397f33c8d
+0c60c80f961f0e71f3a9b524af6012062fe037a6
+KEYS MISMATCH
+array(0) {
+}
+MISMATCH
+PASSWORD TYPE
@@ -0,0 +1,28 @@
+--TEST--
+Crypto\PBKDF2::derive output matches OpenSSL for all engine digests.
+--SKIPIF--
+<?php
+if (!class_exists('Crypto\PBKDF2')) die("Skip: PBKDF2 is not supported (update OpenSSL version)");
+if (!function_exists('openssl_pbkdf2')) die("Skip: openssl_pbkdf2 is not available");
+?>
+--INI--
+crypto.threads=2
+--FILE--
+<?php
+$passwords = array('', 'password', str_repeat('long password ', 20));
+foreach (array('sha1', 'sha224', 'sha256', 'sha384', 'sha512', 'md5') as $alg) {
+	foreach ($passwords as $password) {
+		// lengths shorter than, equal to and spanning multiple digest blocks
+		foreach (array(1, 20, 32, 64, 100, 129) as $length) {
+			$pbkdf2 = new Crypto\PBKDF2($alg, $length, 'salt', 100);
+			$expected = openssl_pbkdf2($password, 'salt', $length, 100, $alg);
+			if ($pbkdf2->derive($password) !== $expected) {
+				echo "$alg: $length\n";
+			}
+		}
+	}
+}
+echo "DONE";
+?>
+--EXPECT--
+DONE
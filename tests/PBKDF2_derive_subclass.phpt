@@ -0,0 +1,34 @@
+--TEST--
+Crypto\PBKDF2::derive and deriveMany in subclass without parent constructor call.
+--SKIPIF--
+<?php if (!class_exists('Crypto\PBKDF2')) die("Skip: PBKDF2 is not supported (update OpenSSL version)"); ?>
+--FILE--
+<?php
+class SubPBKDF2 extends Crypto\PBKDF2 {
+	function __construct($length, $salt) {
+		// the hash algorithm is not set
+		Crypto\KDF::__construct($length, $salt);
+	}
+}
+
+$pbkdf2 = new SubPBKDF2(32, 'salt');
+try {
+	$pbkdf2->derive('password');
+}
+catch (Crypto\KDFException $e) {
+	if ($e->getCode() === Crypto\KDFException::DERIVATION_FAILED) {
+		echo "DERIVATION FAILED\n";
+	}
+}
+try {
+	$pbkdf2->deriveMany(array('password', 'pass'), array('salt', 'salt'));
+}
+catch (Crypto\KDFException $e) {
+	if ($e->getCode() === Crypto\KDFException::DERIVATION_FAILED) {
+		echo "DERIVATION FAILED\n";
+	}
+}
+?>
+--EXPECT--
+DERIVATION FAILED
+DERIVATION FAILED
@@ -0,0 +1,50 @@
+--TEST--
+Crypto\Rand::generate with buffered backend.
+--INI--
+crypto.rand_backend=buffered
+--FILE--
+<?php
+foreach (array(0, 1, 16, 1000, 5000) as $len) {
+	$data = Crypto\Rand::generate($len);
+	if (strlen($data) !== $len) {
+		echo "LENGTH $len\n";
+	}
+}
+
+// small requests are served from the buffer
+$values = array();
+for ($i = 0; $i < 1000; $i++) {
+	$values[Crypto\Rand::generate(16)] = true;
+}
+echo count($values) . "\n";
+
+// the result is always strong
+$strong = false;
+Crypto\Rand::generate(32, false, $strong);
+var_dump($strong);
+
+// seeding forces reseed of the buffered generator
+Crypto\Rand::seed('seed data');
+echo strlen(Crypto\Rand::generate(8)) . "\n";
+
+// the child process must not get the same bytes as the parent
+if (function_exists('pcntl_fork')) {
+	$pair = stream_socket_pair(STREAM_PF_UNIX, STREAM_SOCK_STREAM, STREAM_IPPROTO_IP);
+	$pid = pcntl_fork();
+	if ($pid === 0) {
+		fwrite($pair[1], Crypto\Rand::generate(32));
+		exit(0);
+	}
+	$parent = Crypto\Rand::generate(32);
+	$child = fread($pair[0], 32);
+	pcntl_waitpid($pid, $status);
+	echo $parent !== $child ? "FORK OK\n" : "FORK SAME\n";
+} else {
+	echo "FORK OK\n";
+}
+?>
+--EXPECT--
+1000
+bool(true)
+8
+FORK OK
@@ -0,0 +1,28 @@
+--TEST--
+Crypto\Rand::generate with getrandom backend.
+--INI--
+crypto.rand_backend=getrandom
+--FILE--
+<?php
+foreach (array(0, 1, 16, 300, 100000) as $len) {
+	$data = Crypto\Rand::generate($len);
+	if (strlen($data) !== $len) {
+		echo "LENGTH $len\n";
+	}
+}
+var_dump(Crypto\Rand::generate(32) !== Crypto\Rand::generate(32));
+
+// the result is always strong
+$strong = false;
+Crypto\Rand::generate(32, false, $strong);
+var_dump($strong);
+
+// integers and tokens use the same backend
+var_dump(count(Crypto\Rand::ints(100, 1, 10)));
+echo strlen(Crypto\Rand::token(32)) . "\n";
+?>
+--EXPECT--
+bool(true)
+bool(true)
+int(100)
+43
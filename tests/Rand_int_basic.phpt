@@ -0,0 +1,38 @@
+--TEST--
+Crypto\Rand::int basic usage.
+--FILE--
+<?php
+$counts = array_fill(0, 6, 0);
+for ($i = 0; $i < 6000; $i++) {
+	$value = Crypto\Rand::int(0, 5);
+	if (!is_int($value) || $value < 0 || $value > 5) {
+		echo "OUT OF RANGE: $value\n";
+	}
+	$counts[$value]++;
+}
+foreach ($counts as $value => $count) {
+	// the probability of failure is negligible
+	if ($count < 700 || $count > 1300) {
+		echo "BIASED: $value $count\n";
+	}
+}
+
+var_dump(Crypto\Rand::int(7, 7));
+$value = Crypto\Rand::int(-10, -5);
+var_dump($value >= -10 && $value <= -5);
+var_dump(is_int(Crypto\Rand::int(-PHP_INT_MAX - 1, PHP_INT_MAX)));
+
+try {
+	Crypto\Rand::int(5, 4);
+}
+catch (Crypto\RandException $e) {
+	if ($e->getCode() === Crypto\RandException::RANGE_INVALID) {
+		echo "RANGE INVALID\n";
+	}
+}
+?>
+--EXPECT--
+int(7)
+bool(true)
+bool(true)
+RANGE INVALID
@@ -0,0 +1,47 @@
+--TEST--
+Crypto\Rand::ints basic usage.
+--FILE--
+<?php
+$values = Crypto\Rand::ints(10000, 1, 100);
+echo count($values) . "\n";
+var_dump(array_keys($values) === range(0, 9999));
+var_dump(min($values) >= 1 && max($values) <= 100);
+echo count(array_unique($values)) . "\n";
+
+var_dump(Crypto\Rand::ints(0, 1, 2));
+var_dump(Crypto\Rand::ints(3, -1, -1));
+
+try {
+	Crypto\Rand::ints(-1, 1, 2);
+}
+catch (Crypto\RandException $e) {
+	if ($e->getCode() === Crypto\RandException::COUNT_INVALID) {
+		echo "COUNT INVALID\n";
+	}
+}
+try {
+	Crypto\Rand::ints(1, 2, 1);
+}
+catch (Crypto\RandException $e) {
+	if ($e->getCode() === Crypto\RandException::RANGE_INVALID) {
+		echo "RANGE INVALID\n";
+	}
+}
+?>
+--EXPECT--
+10000
+bool(true)
+bool(true)
+100
+array(0) {
+}
+array(3) {
+  [0]=>
+  int(-1)
+  [1]=>
+  int(-1)
+  [2]=>
+  int(-1)
+}
+COUNT INVALID
+RANGE INVALID
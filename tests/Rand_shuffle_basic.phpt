@@ -0,0 +1,39 @@
+--TEST--
+Crypto\Rand::shuffle basic usage.
+--FILE--
+<?php
+$list = range(1, 100);
+$shuffled = $list;
+Crypto\Rand::shuffle($shuffled);
+echo count($shuffled) . "\n";
+var_dump(array_keys($shuffled) === array_keys($list));
+var_dump($shuffled !== $list);
+sort($shuffled);
+var_dump($shuffled === $list);
+
+// keys stay in place and only values are shuffled
+$map = array('a' => 1, 'b' => 2, 'c' => 3);
+Crypto\Rand::shuffle($map);
+echo implode(',', array_keys($map)) . "\n";
+echo array_sum($map) . "\n";
+
+// the original array is not changed when shared
+$copy = $list;
+$other = $copy;
+Crypto\Rand::shuffle($copy);
+var_dump($other === $list);
+
+$empty = array();
+Crypto\Rand::shuffle($empty);
+var_dump($empty);
+?>
+--EXPECT--
+100
+bool(true)
+bool(true)
+bool(true)
+a,b,c
+6
+bool(true)
+array(0) {
+}
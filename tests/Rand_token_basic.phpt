@@ -0,0 +1,64 @@
+--TEST--
+Crypto\Rand::token basic usage.
+--FILE--
+<?php
+$token = Crypto\Rand::token(32);
+echo strlen($token) . "\n";
+var_dump((bool) preg_match('/^[A-Za-z0-9_-]+$/', $token));
+
+$token = Crypto\Rand::token(16, 'hex');
+echo strlen($token) . "\n";
+var_dump(ctype_xdigit($token));
+
+$token = Crypto\Rand::token(20, 'base32');
+echo strlen($token) . "\n";
+var_dump((bool) preg_match('/^[A-Z2-7]+$/', $token));
+
+// lengths without padding
+foreach (array(0, 1, 2, 3, 4, 5, 1000, 2000) as $bytes) {
+	echo strlen(Crypto\Rand::token($bytes)) . ' ';
+	echo strlen(Crypto\Rand::token($bytes, 'hex')) . ' ';
+	echo strlen(Crypto\Rand::token($bytes, 'base32')) . "\n";
+}
+
+// the decoded token has the requested length
+var_dump(strlen(base64_decode(strtr(Crypto\Rand::token(33), '-_', '+/'))));
+
+var_dump(Crypto\Rand::token(8) !== Crypto\Rand::token(8));
+
+try {
+	Crypto\Rand::token(16, 'base64');
+}
+catch (Crypto\RandException $e) {
+	if ($e->getCode() === Crypto\RandException::TOKEN_ENCODING_INVALID) {
+		echo "TOKEN ENCODING INVALID\n";
+	}
+}
+try {
+	Crypto\Rand::token(-1);
+}
+catch (Crypto\RandException $e) {
+	if ($e->getCode() === Crypto\RandException::TOKEN_LENGTH_INVALID) {
+		echo "TOKEN LENGTH INVALID\n";
+	}
+}
+?>
+--EXPECT--
+43
+bool(true)
+32
+bool(true)
+32
+bool(true)
+0 0 0
+2 2 2
+3 4 4
+4 6 5
+6 8 7
+7 10 8
+1334 2000 1600
+2667 4000 3200
+int(33)
+bool(true)
+TOKEN ENCODING INVALID
+TOKEN LENGTH INVALID
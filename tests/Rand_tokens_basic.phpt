@@ -0,0 +1,35 @@
+--TEST--
+Crypto\Rand::tokens basic usage.
+--FILE--
+<?php
+$tokens = Crypto\Rand::tokens(1000, 16);
+echo count($tokens) . "\n";
+echo count(array_unique($tokens)) . "\n";
+echo strlen($tokens[0]) . "\n";
+
+$tokens = Crypto\Rand::tokens(3, 4, 'hex');
+foreach ($tokens as $token) {
+	var_dump(strlen($token) === 8 && ctype_xdigit($token));
+}
+
+var_dump(Crypto\Rand::tokens(0, 16));
+
+try {
+	Crypto\Rand::tokens(-1, 16);
+}
+catch (Crypto\RandException $e) {
+	if ($e->getCode() === Crypto\RandException::COUNT_INVALID) {
+		echo "COUNT INVALID\n";
+	}
+}
+?>
+--EXPECT--
+1000
+1000
+22
+bool(true)
+bool(true)
+bool(true)
+array(0) {
+}
+COUNT INVALID
@@ -0,0 +1,27 @@
+--TEST--
+Crypto\Scrypt::__clone basic usage.
+--SKIPIF--
+<?php if (!class_exists('Crypto\Scrypt')) die("Skip: Scrypt is not supported (update OpenSSL version)"); ?>
+--FILE--
+<?php
+function print_scrypt($kdf) {
+	echo $kdf->getN() . ' ' . $kdf->getR() . ' ' . $kdf->getP() . "\n";
+}
+
+$scrypt = new Crypto\Scrypt(32, 'salt', 1024, 8, 2);
+$scrypt_clone = clone $scrypt;
+print_scrypt($scrypt_clone);
+$scrypt->setN(2048);
+$scrypt->setP(4);
+print_scrypt($scrypt);
+print_scrypt($scrypt_clone);
+$scrypt_clone->setR(4);
+print_scrypt($scrypt);
+print_scrypt($scrypt_clone);
+?>
+--EXPECT--
+1024 8 2
+2048 8 4
+1024 8 2
+2048 8 4
+1024 4 2
@@ -0,0 +1,54 @@
+--TEST--
+Crypto\Scrypt::__construct basic usage.
+--SKIPIF--
+<?php if (!class_exists('Crypto\Scrypt')) die("Skip: Scrypt is not supported (update OpenSSL version)"); ?>
+--FILE--
+<?php
+// basic creation with just length
+$scrypt = new Crypto\Scrypt(32);
+if ($scrypt instanceof Crypto\Scrypt) {
+    echo "LENGTH ONLY\n";
+}
+
+// creation with all parameters
+$scrypt = new Crypto\Scrypt(32, 'salt', 1024, 8, 16);
+if ($scrypt instanceof Crypto\Scrypt) {
+    echo "ALL PARAMETERS\n";
+}
+
+// invalid cost
+try {
+    $scrypt = new Crypto\Scrypt(32, 'salt', 1000);
+}
+catch (Crypto\ScryptException $e) {
+    if ($e->getCode() === Crypto\ScryptException::COST_INVALID) {
+        echo "COST INVALID\n";
+    }
+}
+
+// invalid block size
+try {
+    $scrypt = new Crypto\Scrypt(32, 'salt', 1024, 0);
+}
+catch (Crypto\ScryptException $e) {
+    if ($e->getCode() === Crypto\ScryptException::BLOCK_SIZE_INVALID) {
+        echo "BLOCK SIZE INVALID\n";
+    }
+}
+
+// invalid parallelization
+try {
+    $scrypt = new Crypto\Scrypt(32, 'salt', 1024, 8, 0);
+}
+catch (Crypto\ScryptException $e) {
+    if ($e->getCode() === Crypto\ScryptException::PARALLELISM_INVALID) {
+        echo "PARALLELISM INVALID\n";
+    }
+}
+?>
+--EXPECT--
+LENGTH ONLY
+ALL PARAMETERS
+COST INVALID
+BLOCK SIZE INVALID
+PARALLELISM INVALID
@@ -0,0 +1,49 @@
+--TEST--
+Crypto\Scrypt::derive with parallel lanes.
+--SKIPIF--
+<?php if (!class_exists('Crypto\Scrypt')) die("Skip: Scrypt is not supported (update OpenSSL version)"); ?>
+--INI--
+crypto.threads=4
+--FILE--
+<?php
+$vectors = array(
+	array(
+		'P' => '',
+		'S' => '',
+		'N' => 16,
+		'r' => 1,
+		'p' => 1,
+		'dkLen' => 64,
+		'DK' => "77d6576238657b203b19ca42c18a0497f16b4844e3074ae8dfdffa3fede21442" .
+			"fcd0069ded0948f8326a753a0fc81f17e8d3e0fb2e0d3628cf35e20c38d18906"
+	),
+	array(
+		'P' => 'password',
+		'S' => 'NaCl',
+		'N' => 1024,
+		'r' => 8,
+		'p' => 16,
+		'dkLen' => 64,
+		'DK' => "fdbabe1c9d3472007856e7190d01e9fe7c6ad7cbc8237830e77376634b373162" .
+			"2eaf30d92e22a3886ff109279d9830dac727afb94a83ee6d8360cbdfa2cc0640"
+	),
+);
+
+foreach ($vectors as $v) {
+	$scrypt = new Crypto\Scrypt($v['dkLen'], $v['S'], $v['N'], $v['r'], $v['p']);
+	if (pack('H*', $v['DK']) !== $scrypt->derive($v['P'])) {
+		print_r($v);
+	}
+}
+
+// the memory limit allows only 2 concurrent lanes
+$scrypt = new Crypto\Scrypt(64, 'NaCl', 1024, 8, 16);
+$scrypt->setMaxMemory(16 * 1024 + 2 * 128 * 8 * 1026);
+if (pack('H*', $vectors[1]['DK']) === $scrypt->derive('password')) {
+	echo "LIMITED LANES\n";
+}
+echo "DONE";
+?>
+--EXPECT--
+LIMITED LANES
+DONE
@@ -0,0 +1,11 @@
+--TEST--
+Crypto\Scrypt::getMaxMemory basic usage.
+--SKIPIF--
+<?php if (!class_exists('Crypto\Scrypt')) die("Skip: Scrypt is not supported (update OpenSSL version)"); ?>
+--FILE--
+<?php
+$scrypt = new Crypto\Scrypt(32);
+var_dump($scrypt->getMaxMemory());
+?>
+--EXPECT--
+int(33554432)
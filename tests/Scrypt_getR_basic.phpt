@@ -0,0 +1,11 @@
+--TEST--
+Crypto\Scrypt::getR basic usage.
+--SKIPIF--
+<?php if (!class_exists('Crypto\Scrypt')) die("Skip: Scrypt is not supported (update OpenSSL version)"); ?>
+--FILE--
+<?php
+$scrypt = new Crypto\Scrypt(32, 'salt', 1024, 4);
+var_dump($scrypt->getR());
+?>
+--EXPECT--
+int(4)
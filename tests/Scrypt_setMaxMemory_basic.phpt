@@ -0,0 +1,22 @@
+--TEST--
+Crypto\Scrypt::setMaxMemory basic usage.
+--SKIPIF--
+<?php if (!class_exists('Crypto\Scrypt')) die("Skip: Scrypt is not supported (update OpenSSL version)"); ?>
+--FILE--
+<?php
+$scrypt = new Crypto\Scrypt(32);
+var_dump($scrypt->setMaxMemory(64 * 1024 * 1024));
+var_dump($scrypt->getMaxMemory());
+try {
+	$scrypt->setMaxMemory(0);
+}
+catch (Crypto\ScryptException $e) {
+	if ($e->getCode() === Crypto\ScryptException::MAX_MEMORY_INVALID) {
+		echo "MAX MEMORY INVALID\n";
+	}
+}
+?>
+--EXPECT--
+bool(true)
+int(67108864)
+MAX MEMORY INVALID
@@ -0,0 +1,24 @@
+--TEST--
+Crypto\Scrypt::setN basic usage.
+--SKIPIF--
+<?php if (!class_exists('Crypto\Scrypt')) die("Skip: Scrypt is not supported (update OpenSSL version)"); ?>
+--FILE--
+<?php
+$scrypt = new Crypto\Scrypt(32);
+var_dump($scrypt->getN());
+var_dump($scrypt->setN(2048));
+var_dump($scrypt->getN());
+try {
+	$scrypt->setN(3);
+}
+catch (Crypto\ScryptException $e) {
+	if ($e->getCode() === Crypto\ScryptException::COST_INVALID) {
+		echo "COST INVALID\n";
+	}
+}
+?>
+--EXPECT--
+int(16384)
+bool(true)
+int(2048)
+COST INVALID
@@ -0,0 +1,15 @@
+--TEST--
+Crypto\Scrypt::setP basic usage.
+--SKIPIF--
+<?php if (!class_exists('Crypto\Scrypt')) die("Skip: Scrypt is not supported (update OpenSSL version)"); ?>
+--FILE--
+<?php
+$scrypt = new Crypto\Scrypt(32);
+var_dump($scrypt->getP());
+var_dump($scrypt->setP(2));
+var_dump($scrypt->getP());
+?>
+--EXPECT--
+int(1)
+bool(true)
+int(2)
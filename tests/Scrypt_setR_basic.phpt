@@ -0,0 +1,15 @@
+--TEST--
+Crypto\Scrypt::setR basic usage.
+--SKIPIF--
+<?php if (!class_exists('Crypto\Scrypt')) die("Skip: Scrypt is not supported (update OpenSSL version)"); ?>
+--FILE--
+<?php
+$scrypt = new Crypto\Scrypt(32);
+var_dump($scrypt->getR());
+var_dump($scrypt->setR(16));
+var_dump($scrypt->getR());
+?>
+--EXPECT--
+int(8)
+bool(true)
+int(16)
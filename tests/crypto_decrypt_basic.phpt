@@ -0,0 +1,36 @@
+--TEST--
+Crypto\decrypt basic usage.
+--SKIPIF--
+<?php
+if (!Crypto\Cipher::hasMode(Crypto\Cipher::MODE_GCM))
+	die("Skip: GCM mode not defined (update OpenSSL version)");
+?>
+--FILE--
+<?php
+$key = str_repeat('x', 32);
+$iv = str_repeat('i', 16);
+
+$data = pack("H*", '8f8853a1685607133cb9ee0fc7a5b8a57103935cbc39ea680def0db0767e954e');
+echo Crypto\decrypt('aes-256-cbc', $data, $key, $iv) . "\n";
+
+$data = pack("H*", '622070d3bea6f720943d1198a7e6afa5');
+$tag = pack("H*", 'ed39e13f9a9fdf19036ad2f1ed5d2d1f');
+$aad_tag = pack("H*", '840768a2c2d1ee2d8582bf3f472bef62');
+
+echo Crypto\decrypt('aes-256-gcm', $data, $key, $iv, $tag) . "\n";
+echo Crypto\decrypt('aes-256-gcm', $data, $key, $iv, $aad_tag, 'crypto') . "\n";
+
+try {
+	Crypto\decrypt('aes-256-gcm', $data, $key, $iv, $tag, 'crypto');
+}
+catch (Crypto\CipherException $e) {
+	if ($e->getCode() === Crypto\CipherException::TAG_VERIFY_FAILED) {
+		echo "FAILED\n";
+	}
+}
+?>
+--EXPECT--
+aaaaaaaaaaaaaaaa
+aaaaaaaaaaaaaaaa
+aaaaaaaaaaaaaaaa
+FAILED
@@ -0,0 +1,81 @@
+--TEST--
+Crypto\encrypt basic usage.
+--SKIPIF--
+<?php
+if (!Crypto\Cipher::hasMode(Crypto\Cipher::MODE_GCM))
+	die("Skip: GCM mode not defined (update OpenSSL version)");
+?>
+--FILE--
+<?php
+$key = str_repeat('x', 32);
+$iv = str_repeat('i', 16);
+$data = str_repeat('a', 16);
+
+// key length
+try {
+	Crypto\encrypt('aes-256-cbc', $data, 'short_key', $iv);
+}
+catch (Crypto\CipherException $e) {
+	if ($e->getCode() === Crypto\CipherException::KEY_LENGTH_INVALID) {
+		echo "SHORT KEY\n";
+	}
+}
+
+// iv length
+try {
+	Crypto\encrypt('aes-256-cbc', $data, $key, 'short_iv');
+}
+catch (Crypto\CipherException $e) {
+	if ($e->getCode() === Crypto\CipherException::IV_LENGTH_INVALID) {
+		echo "SHORT IV\n";
+	}
+}
+
+// aad in not authenticated mode
+try {
+	Crypto\encrypt('aes-256-cbc', $data, $key, $iv, $tag, 'aad');
+}
+catch (Crypto\CipherException $e) {
+	if ($e->getCode() === Crypto\CipherException::AUTHENTICATION_NOT_SUPPORTED) {
+		echo "NO AUTH\n";
+	}
+}
+
+// tag in not authenticated mode
+try {
+	Crypto\encrypt('aes-256-cbc', $data, $key, $iv, $tag);
+}
+catch (Crypto\CipherException $e) {
+	if ($e->getCode() === Crypto\CipherException::AUTHENTICATION_NOT_SUPPORTED) {
+		echo "NO AUTH TAG\n";
+	}
+}
+
+// no tag in authenticated mode
+try {
+	Crypto\encrypt('aes-256-gcm', $data, $key, $iv);
+}
+catch (Crypto\CipherException $e) {
+	if ($e->getCode() === Crypto\CipherException::TAG_REQUIRED) {
+		echo "TAG REQUIRED\n";
+	}
+}
+
+echo bin2hex(Crypto\encrypt('aes-256-cbc', $data, $key, $iv)) . "\n";
+
+echo bin2hex(Crypto\encrypt('aes-256-gcm', $data, $key, $iv, $tag)) . "\n";
+echo bin2hex($tag) . "\n";
+echo bin2hex(Crypto\encrypt('aes-256-gcm', $data, $key, $iv, $tag, 'crypto')) . "\n";
+echo bin2hex($tag) . "\n";
+?>
+--EXPECT--
+SHORT KEY
+SHORT IV
+NO AUTH
+NO AUTH TAG
+TAG REQUIRED
+8f8853a1685607133cb9ee0fc7a5b8a57103935cbc39ea680def0db0767e954e
+622070d3bea6f720943d1198a7e6afa5
+ed39e13f9a9fdf19036ad2f1ed5d2d1f
+622070d3bea6f720943d1198a7e6afa5
+840768a2c2d1ee2d8582bf3f472bef62
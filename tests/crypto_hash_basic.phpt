@@ -0,0 +1,27 @@
+--TEST--
+Crypto\hash basic usage.
+--FILE--
+<?php
+$msg = "abc";
+
+echo Crypto\hash('sha256', $msg) . "\n";
+echo bin2hex(Crypto\hash('sha256', $msg, true)) . "\n";
+echo Crypto\hash('md5', $msg) . "\n";
+// the algorithm is cached so the second call must return the same result
+echo Crypto\hash('md5', $msg) . "\n";
+
+try {
+	Crypto\hash('nonexistent', $msg);
+}
+catch (Crypto\HashException $e) {
+	if ($e->getCode() === Crypto\HashException::HASH_ALGORITHM_NOT_FOUND) {
+		echo "NOT FOUND\n";
+	}
+}
+?>
+--EXPECT--
+ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad
+ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad
+900150983cd24fb0d6963f7d28e17f72
+900150983cd24fb0d6963f7d28e17f72
+NOT FOUND
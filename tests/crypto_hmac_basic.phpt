@@ -0,0 +1,25 @@
+--TEST--
+Crypto\hmac basic usage.
+--FILE--
+<?php
+$msg = "The quick brown fox jumps over the lazy dog";
+$key = "key";
+
+echo Crypto\hmac('md5', $msg, $key) . "\n";
+echo Crypto\hmac('sha1', $msg, $key) . "\n";
+echo bin2hex(Crypto\hmac('sha256', $msg, $key, true)) . "\n";
+
+try {
+	Crypto\hmac('nonexistent', $msg, $key);
+}
+catch (Crypto\MACException $e) {
+	if ($e->getCode() === Crypto\MACException::MAC_ALGORITHM_NOT_FOUND) {
+		echo "NOT FOUND\n";
+	}
+}
+?>
+--EXPECT--
+80070713463e7749b90c2dc24911e275
+de7c9b85b8b78aa6bc8a7a36f70a90701c9db4d9
+f7bc83f430538424b13298e6aa6fb143ef4d59a14946175997479dbc2d1a3cd8
+NOT FOUND
@@ -0,0 +1,40 @@
+--TEST--
+Stream crypto.fd encryption to the standard output
+--SKIPIF--
+<?php if (php_sapi_name() != 'cli') die("Skip: CLI only"); ?>
+--FILE--
+<?php
+$key = str_repeat('k', 32);
+$iv = str_repeat('i', 16);
+$cipher = new Crypto\Cipher('aes-256-ctr');
+// the data encrypted by the key stream are printed as the plain text
+$key_stream = $cipher->encrypt(str_repeat("\0", 6), $key, $iv);
+
+$context = stream_context_create(array(
+	'crypto' => array(
+		'filters' => array(
+			array(
+				'type' => 'cipher',
+				'action' => 'encrypt',
+				'algorithm' => 'aes-256-ctr',
+				'key' => $key,
+				'iv' => $iv,
+			)
+		)
+	),
+));
+$stream = fopen("crypto.fd://1", "w", false, $context);
+fwrite($stream, $key_stream ^ "hello\n");
+fclose($stream);
+// the original descriptor stays open
+echo "open\n";
+
+fopen("crypto.fd://x", "w");
+?>
+--EXPECTF--
+hello
+open
+
+Warning: fopen(): The file descriptor 'x' is not valid in %s on line %d
+
+Warning: %s failed to open stream: operation failed in %s on line %d
@@ -0,0 +1,50 @@
+--TEST--
+Stream filters crypto.base64-encode and crypto.base64-decode
+--FILE--
+<?php
+function crypto_test_filter($data, $filter, $params = null, $mode = STREAM_FILTER_READ) {
+	$stream = fopen('php://memory', 'w+');
+	if ($mode == STREAM_FILTER_WRITE) {
+		$filter = stream_filter_append($stream, $filter, $mode, $params);
+		// write in small chunks to split base64 groups
+		foreach (str_split($data, 7) as $chunk) {
+			fwrite($stream, $chunk);
+		}
+		// removing filter finishes the data
+		stream_filter_remove($filter);
+		rewind($stream);
+		$result = stream_get_contents($stream);
+	} else {
+		fwrite($stream, $data);
+		rewind($stream);
+		stream_filter_append($stream, $filter, $mode, $params);
+		$result = stream_get_contents($stream);
+	}
+	fclose($stream);
+	return $result;
+}
+
+$data = str_repeat("abc\x00\xff", 20);
+
+$encoded = crypto_test_filter($data, 'crypto.base64-encode');
+echo $encoded;
+var_dump(crypto_test_filter($encoded, 'crypto.base64-decode') === $data);
+var_dump(crypto_test_filter($encoded, 'crypto.base64-decode', null, STREAM_FILTER_WRITE) === $data);
+
+$params = array(
+	'wrap' => 0,
+	'alphabet' => Crypto\Base64::ALPHABET_URL,
+	'padding' => false,
+);
+$encoded = crypto_test_filter($data, 'crypto.base64-encode', $params);
+echo "$encoded\n";
+var_dump(crypto_test_filter($encoded, 'crypto.base64-decode', $params) === $data);
+?>
+--EXPECT--
+YWJjAP9hYmMA/2FiYwD/YWJjAP9hYmMA/2FiYwD/YWJjAP9hYmMA/2FiYwD/YWJj
+AP9hYmMA/2FiYwD/YWJjAP9hYmMA/2FiYwD/YWJjAP9hYmMA/2FiYwD/YWJjAP9h
+YmMA/w==
+bool(true)
+bool(true)
+YWJjAP9hYmMA_2FiYwD_YWJjAP9hYmMA_2FiYwD_YWJjAP9hYmMA_2FiYwD_YWJjAP9hYmMA_2FiYwD_YWJjAP9hYmMA_2FiYwD_YWJjAP9hYmMA_2FiYwD_YWJjAP9hYmMA_w
+bool(true)
@@ -0,0 +1,19 @@
+--TEST--
+Stream filter crypto.base64-encode with invalid params
+--FILE--
+<?php
+$stream = fopen('php://memory', 'w+');
+var_dump(stream_filter_append($stream, 'crypto.base64-encode', STREAM_FILTER_READ, array('wrap' => 10)));
+var_dump(stream_filter_append($stream, 'crypto.base64-encode', STREAM_FILTER_READ, array('alphabet' => 'url')));
+fclose($stream);
+?>
+--EXPECTF--
+Warning: stream_filter_append(): The base64 filter wrap has to be 0, 64 or 76 in %s on line %d
+
+Warning: stream_filter_append(): Unable to create or locate filter "crypto.base64-encode" in %s on line %d
+bool(false)
+
+Warning: stream_filter_append(): The filter parameter 'alphabet' has to be an integer in %s on line %d
+
+Warning: stream_filter_append(): Unable to create or locate filter "crypto.base64-encode" in %s on line %d
+bool(false)
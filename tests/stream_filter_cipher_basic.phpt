@@ -0,0 +1,70 @@
+--TEST--
+Stream filter crypto.cipher
+--SKIPIF--
+<?php if (!Crypto\Cipher::hasMode(Crypto\Cipher::MODE_GCM)) die("Skip: GCM mode not defined (update OpenSSL version)"); ?>
+--FILE--
+<?php
+function crypto_test_filter($data, $params, $mode = STREAM_FILTER_READ) {
+	$stream = fopen('php://memory', 'w+');
+	if ($mode == STREAM_FILTER_WRITE) {
+		$filter = stream_filter_append($stream, 'crypto.cipher', $mode, $params);
+		// write in small chunks to split cipher blocks
+		foreach (str_split($data, 7) as $chunk) {
+			fwrite($stream, $chunk);
+		}
+		// removing filter finishes the data
+		stream_filter_remove($filter);
+		rewind($stream);
+		$result = stream_get_contents($stream);
+	} else {
+		fwrite($stream, $data);
+		rewind($stream);
+		stream_filter_append($stream, 'crypto.cipher', $mode, $params);
+		$result = stream_get_contents($stream);
+	}
+	$meta_data = stream_get_meta_data($stream);
+	if (isset($meta_data['wrapper_data'][0])) {
+		echo $meta_data['wrapper_data'][0] . "\n";
+	}
+	fclose($stream);
+	return $result;
+}
+
+$key = str_repeat('x', 32);
+$iv = str_repeat('i', 16);
+$data = str_repeat('a', 16);
+
+$params = array(
+	'action' => 'encrypt',
+	'algorithm' => 'aes-256-cbc',
+	'key' => $key,
+	'iv'  => $iv,
+);
+$ciphertext = crypto_test_filter($data, $params);
+echo bin2hex($ciphertext) . "\n";
+$params['action'] = 'decrypt';
+var_dump(crypto_test_filter($ciphertext, $params, STREAM_FILTER_WRITE) === $data);
+
+$params = array(
+	'action' => 'encrypt',
+	'algorithm' => 'aes-256-gcm',
+	'key' => $key,
+	'iv'  => $iv,
+	'aad' => str_repeat('b', 16),
+);
+$ciphertext = crypto_test_filter($data, $params, STREAM_FILTER_WRITE);
+echo bin2hex($ciphertext) . "\n";
+$params['action'] = 'decrypt';
+$params['tag'] = pack("H*", 'f3c2954804f101d3342f6b37ba46ac8e');
+var_dump(crypto_test_filter($ciphertext, $params) === $data);
+$params['tag'] = str_repeat('t', 16);
+crypto_test_filter($ciphertext, $params);
+?>
+--EXPECT--
+8f8853a1685607133cb9ee0fc7a5b8a57103935cbc39ea680def0db0767e954e
+bool(true)
+X-PHP-Crypto-Auth-Tag: f3c2954804f101d3342f6b37ba46ac8e
+622070d3bea6f720943d1198a7e6afa5
+X-PHP-Crypto-Auth-Result: success
+bool(true)
+X-PHP-Crypto-Auth-Result: failure
@@ -0,0 +1,34 @@
+--TEST--
+Stream filters crypto.hex-encode and crypto.hex-decode
+--FILE--
+<?php
+$data = "abc\x00\xff\x10";
+
+$stream = fopen('php://memory', 'w+');
+fwrite($stream, $data);
+rewind($stream);
+stream_filter_append($stream, 'crypto.hex-encode', STREAM_FILTER_READ);
+$encoded = stream_get_contents($stream);
+fclose($stream);
+echo "$encoded\n";
+
+$stream = fopen('php://memory', 'w+');
+fwrite($stream, "61 62 63\n00FF1\n0");
+rewind($stream);
+stream_filter_append($stream, 'crypto.hex-decode', STREAM_FILTER_READ);
+var_dump(stream_get_contents($stream) === $data);
+fclose($stream);
+
+$stream = fopen('php://memory', 'w+');
+fwrite($stream, "6162x");
+rewind($stream);
+stream_filter_append($stream, 'crypto.hex-decode', STREAM_FILTER_READ);
+var_dump(stream_get_contents($stream));
+fclose($stream);
+?>
+--EXPECTF--
+61626300ff10
+bool(true)
+
+Warning: stream_get_contents(): The hex filter input is not valid hex data in %s on line %d
+string(0) ""
@@ -0,0 +1,75 @@
+--TEST--
+Stream aead filter with segmented authentication
+--SKIPIF--
+<?php if (!Crypto\Cipher::hasMode(Crypto\Cipher::MODE_GCM)) die("Skip: GCM mode not defined (update OpenSSL version)"); ?>
+--FILE--
+<?php
+$filename = (dirname( __FILE__) . "/stream_filters_aead_basic.tmp");
+$data = str_repeat('abcdefghij', 10);
+
+function crypto_test_context($action) {
+	return stream_context_create(array(
+		'crypto' => array(
+			'filters' => array(
+				array(
+					'type' => 'aead',
+					'action' => $action,
+					'algorithm' => 'aes-256-gcm',
+					'key' => str_repeat('k', 32),
+					'aad' => 'file header',
+					'segment_size' => 32,
+				)
+			)
+		),
+	));
+}
+
+function crypto_test_read($filename) {
+	$stream = fopen("crypto.file://" . $filename, "r", false, crypto_test_context('decrypt'));
+	$result = '';
+	while (!feof($stream)) {
+		$result .= fread($stream, 20);
+	}
+	$meta_data = stream_get_meta_data($stream);
+	echo $meta_data['wrapper_data'][0] . "\n";
+	fclose($stream);
+	return $result;
+}
+
+$stream = fopen("crypto.file://" . $filename, "w", false, crypto_test_context('encrypt'));
+foreach (str_split($data, 7) as $chunk) {
+	fwrite($stream, $chunk);
+}
+fclose($stream);
+// header, 4 segments and 4 tags
+var_dump(filesize($filename));
+var_dump(crypto_test_read($filename) === $data);
+
+// segment tampering (the second segment)
+$sealed = file_get_contents($filename);
+$sealed[100] = chr(ord($sealed[100]) ^ 1);
+file_put_contents($filename, $sealed);
+var_dump(strlen(crypto_test_read($filename)));
+
+// truncation at the segment boundary
+file_put_contents($filename, substr($sealed, 0, 44 + 3 * 48));
+var_dump(strlen(crypto_test_read($filename)));
+?>
+--CLEAN--
+<?php
+$filename = (dirname( __FILE__) . "/stream_filters_aead_basic.tmp");
+if (file_exists($filename))
+	unlink($filename);
+?>
+--EXPECTF--
+int(208)
+X-PHP-Crypto-Auth-Result: success
+bool(true)
+
+Warning: fread(): The aead stream segment authentication failed in %s on line %d
+X-PHP-Crypto-Auth-Result: failure
+int(32)
+
+Warning: fread(): The aead stream segment authentication failed in %s on line %d
+X-PHP-Crypto-Auth-Result: failure
+int(64)
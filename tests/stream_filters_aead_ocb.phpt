@@ -0,0 +1,55 @@
+--TEST--
+Stream aead filter with OCB mode
+--SKIPIF--
+<?php if (!Crypto\Cipher::hasMode(Crypto\Cipher::MODE_OCB)) die("Skip: OCB mode not defined (update OpenSSL version)"); ?>
+--FILE--
+<?php
+$filename = (dirname( __FILE__) . "/stream_filters_aead_ocb.tmp");
+$data = str_repeat('abcdefghij', 10);
+
+function crypto_test_context($action, $algorithm) {
+	return stream_context_create(array(
+		'crypto' => array(
+			'filters' => array(
+				array(
+					'type' => 'aead',
+					'action' => $action,
+					'algorithm' => $algorithm,
+					'key' => str_repeat('k', 32),
+					'segment_size' => 32,
+				)
+			)
+		),
+	));
+}
+
+file_put_contents("crypto.file://" . $filename, $data, 0,
+		crypto_test_context('encrypt', 'aes-256-ocb'));
+var_dump(filesize($filename));
+var_dump(file_get_contents("crypto.file://" . $filename, false,
+		crypto_test_context('decrypt', 'aes-256-ocb')) === $data);
+
+// the same key and data give a different stream key
+$sealed = file_get_contents($filename);
+file_put_contents("crypto.file://" . $filename, $data, 0,
+		crypto_test_context('encrypt', 'aes-256-ocb'));
+var_dump(substr(file_get_contents($filename), 5) !== substr($sealed, 5));
+
+// not authenticated mode
+$stream = fopen("crypto.file://" . $filename, "w", false,
+		crypto_test_context('encrypt', 'aes-256-cbc'));
+?>
+--CLEAN--
+<?php
+$filename = (dirname( __FILE__) . "/stream_filters_aead_ocb.tmp");
+if (file_exists($filename))
+	unlink($filename);
+?>
+--EXPECTF--
+int(208)
+bool(true)
+bool(true)
+
+Warning: fopen(): The aead filter requires GCM or OCB mode in %s on line %d
+
+Warning: %s failed to open stream: operation failed in %s on line %d
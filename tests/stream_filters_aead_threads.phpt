@@ -0,0 +1,64 @@
+--TEST--
+Stream aead filter with pipelined writer
+--SKIPIF--
+<?php if (!Crypto\Cipher::hasMode(Crypto\Cipher::MODE_GCM)) die("Skip: GCM mode not defined (update OpenSSL version)"); ?>
+--FILE--
+<?php
+$filename = (dirname( __FILE__) . "/stream_filters_aead_threads.tmp");
+$data = str_repeat('abcdefghij', 1000);
+
+function crypto_test_context($action, $threads = null) {
+	$filter = array(
+		'type' => 'aead',
+		'action' => $action,
+		'algorithm' => 'aes-256-gcm',
+		'key' => str_repeat('k', 32),
+		'segment_size' => 64,
+	);
+	if ($threads !== null) {
+		$filter['threads'] = $threads;
+	}
+	return stream_context_create(array(
+		'crypto' => array(
+			'filters' => array($filter)
+		),
+	));
+}
+
+foreach (array(0, 1, 4) as $threads) {
+	$stream = fopen("crypto.file://" . $filename, "w", false, crypto_test_context('encrypt', $threads));
+	foreach (str_split($data, 333) as $chunk) {
+		fwrite($stream, $chunk);
+	}
+	// stat waits for the queued segments
+	$stat = fstat($stream);
+	fclose($stream);
+	// header, 157 segments and 157 tags
+	var_dump(filesize($filename), $stat['size'] <= filesize($filename));
+	$stream = fopen("crypto.file://" . $filename, "r", false, crypto_test_context('decrypt'));
+	var_dump(stream_get_contents($stream) === $data);
+	fclose($stream);
+}
+
+$stream = fopen("crypto.file://" . $filename, "w", false, crypto_test_context('encrypt', 65));
+?>
+--CLEAN--
+<?php
+$filename = (dirname( __FILE__) . "/stream_filters_aead_threads.tmp");
+if (file_exists($filename))
+	unlink($filename);
+?>
+--EXPECTF--
+int(12556)
+bool(true)
+bool(true)
+int(12556)
+bool(true)
+bool(true)
+int(12556)
+bool(true)
+bool(true)
+
+Warning: fopen(): The aead filter threads has to be between 0 and 64 in %s on line %d
+
+Warning: %s failed to open stream: operation failed in %s on line %d
@@ -0,0 +1,56 @@
+--TEST--
+Stream buffer_size context option
+--FILE--
+<?php
+$filename = (dirname( __FILE__) . "/stream_filters_buffer_size.tmp");
+$data = str_repeat('abcdefghij', 10000);
+
+function crypto_test_context($action, $buffer_size) {
+	return stream_context_create(array(
+		'crypto' => array(
+			'buffer_size' => $buffer_size,
+			'filters' => array(
+				array(
+					'type' => 'cipher',
+					'action' => $action,
+					'algorithm' => 'aes-256-ctr',
+					'key' => str_repeat('k', 32),
+					'iv' => str_repeat('i', 16),
+				)
+			)
+		),
+	));
+}
+
+$stream = fopen("crypto.file://" . $filename, "w", false, crypto_test_context('encrypt', 65536));
+foreach (str_split($data, 777) as $chunk) {
+	fwrite($stream, $chunk);
+}
+fclose($stream);
+var_dump(filesize($filename));
+
+// different buffer size for reading
+$stream = fopen("crypto.file://" . $filename, "r", false, crypto_test_context('decrypt', 4096));
+var_dump(stream_get_contents($stream) === $data);
+fclose($stream);
+
+$stream = fopen("crypto.file://" . $filename, "r", false, crypto_test_context('decrypt', 100));
+$stream = fopen("crypto.file://" . $filename, "r", false, crypto_test_context('decrypt', '65536'));
+?>
+--CLEAN--
+<?php
+$filename = (dirname( __FILE__) . "/stream_filters_buffer_size.tmp");
+if (file_exists($filename))
+	unlink($filename);
+?>
+--EXPECTF--
+int(100000)
+bool(true)
+
+Warning: fopen(): The buffer size has to be an integer between 4096 and 67108864 bytes in %s on line %d
+
+Warning: %s failed to open stream: operation failed in %s on line %d
+
+Warning: fopen(): The buffer size has to be an integer between 4096 and 67108864 bytes in %s on line %d
+
+Warning: %s failed to open stream: operation failed in %s on line %d
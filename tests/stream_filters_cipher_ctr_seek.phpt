@@ -0,0 +1,73 @@
+--TEST--
+Stream cipher seekable ctr filter
+--FILE--
+<?php
+$filename = (dirname( __FILE__) . "/stream_filters_cipher_ctr_seek.tmp");
+$data = '';
+for ($i = 0; $i < 100; $i++) {
+	$data .= sprintf("%03d-", $i);
+}
+
+function crypto_test_context($action, $algorithm = 'aes-128-ctr', $seekable = true) {
+	return stream_context_create(array(
+		'crypto' => array(
+			'filters' => array(
+				array(
+					'type' => 'cipher',
+					'action' => $action,
+					'algorithm' => $algorithm,
+					'key' => str_repeat('k', 16),
+					'iv'  => str_repeat("\xff", 16),
+					'seekable' => $seekable,
+				)
+			)
+		),
+	));
+}
+
+file_put_contents("crypto.file://" . $filename, $data, 0, crypto_test_context('encrypt', 'aes-128-ctr', false));
+
+$stream = fopen("crypto.file://" . $filename, "r", false, crypto_test_context('decrypt'));
+fseek($stream, 200);
+echo fread($stream, 8) . "\n";
+fseek($stream, 8, SEEK_CUR);
+echo fread($stream, 8) . "\n";
+fseek($stream, -8, SEEK_END);
+echo fread($stream, 8) . "\n";
+fseek($stream, 1);
+echo fread($stream, 6) . "\n";
+$stat = fstat($stream);
+var_dump($stat['size']);
+fclose($stream);
+
+// overwrite in the middle
+$stream = fopen("crypto.file://" . $filename, "r+", false, crypto_test_context('encrypt'));
+fseek($stream, 41);
+fwrite($stream, "XYZ");
+fclose($stream);
+$plain = file_get_contents("crypto.file://" . $filename, false, crypto_test_context('decrypt', 'aes-128-ctr', false));
+echo substr($plain, 36, 12) . "\n";
+var_dump(strlen($plain));
+
+// seekable is supported only for ctr
+var_dump(fopen("crypto.file://" . $filename, "r", false, crypto_test_context('decrypt', 'aes-128-cbc')));
+?>
+--CLEAN--
+<?php
+$filename = (dirname( __FILE__) . "/stream_filters_cipher_ctr_seek.tmp");
+if (file_exists($filename))
+	unlink($filename);
+?>
+--EXPECTF--
+050-051-
+054-055-
+098-099-
+00-001
+int(400)
+009-0XYZ011-
+int(400)
+
+Warning: fopen(): The seekable cipher filter requires CTR mode in %s on line %d
+
+Warning: %s failed to open stream: operation failed in %s on line %d
+bool(false)
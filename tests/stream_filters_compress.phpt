@@ -0,0 +1,116 @@
+--TEST--
+Stream compress filter chained with cipher and aead filters
+--SKIPIF--
+<?php
+$context = stream_context_create(array(
+	'crypto' => array('filters' => array(array('type' => 'compress'))),
+));
+if (!@fopen('crypto.memory://', 'w+', false, $context)) die("Skip: zlib not available");
+?>
+--FILE--
+<?php
+$filename = (dirname( __FILE__) . "/stream_filters_compress.tmp");
+$data = str_repeat('abcdefghij', 1000);
+
+function crypto_test_context($action, $algorithm) {
+	return stream_context_create(array(
+		'crypto' => array(
+			'filters' => array(
+				array(
+					'type' => 'compress',
+					'algorithm' => $algorithm,
+					'level' => 9,
+				),
+				array(
+					'type' => 'cipher',
+					'action' => $action,
+					'algorithm' => 'aes-256-cbc',
+					'key' => str_repeat('x', 32),
+					'iv'  => str_repeat('i', 16),
+				)
+			)
+		),
+	));
+}
+
+foreach (array('zlib', 'gzip') as $algorithm) {
+	$stream = fopen("crypto.file://" . $filename, "w", false, crypto_test_context('encrypt', $algorithm));
+	foreach (str_split($data, 333) as $chunk) {
+		fwrite($stream, $chunk);
+	}
+	fclose($stream);
+	var_dump(filesize($filename) < 200);
+
+	$stream = fopen("crypto.file://" . $filename, "r", false, crypto_test_context('decrypt', $algorithm));
+	$result = '';
+	while (!feof($stream)) {
+		$result .= fread($stream, 1000);
+	}
+	fclose($stream);
+	var_dump($result === $data);
+}
+
+// compression before the segmented authentication
+$context = stream_context_create(array(
+	'crypto' => array(
+		'filters' => array(
+			array('type' => 'compress'),
+			array(
+				'type' => 'aead',
+				'action' => 'encrypt',
+				'algorithm' => 'aes-256-gcm',
+				'key' => str_repeat('k', 32),
+			)
+		)
+	),
+));
+file_put_contents("crypto.file://" . $filename, $data, 0, $context);
+$context = stream_context_create(array(
+	'crypto' => array(
+		'filters' => array(
+			array('type' => 'compress'),
+			array(
+				'type' => 'aead',
+				'action' => 'decrypt',
+				'algorithm' => 'aes-256-gcm',
+				'key' => str_repeat('k', 32),
+			)
+		)
+	),
+));
+var_dump(file_get_contents("crypto.file://" . $filename, false, $context) === $data);
+
+// unknown algorithm
+$context = stream_context_create(array(
+	'crypto' => array(
+		'filters' => array(array('type' => 'compress', 'algorithm' => 'unknown'))
+	),
+));
+$stream = fopen("crypto.file://" . $filename, "r", false, $context);
+
+// compress filter after the cipher filter
+$context = crypto_test_context('encrypt', 'zlib');
+$options = stream_context_get_options($context);
+$options['crypto']['filters'] = array_reverse($options['crypto']['filters']);
+$stream = fopen("crypto.file://" . $filename, "w", false, stream_context_create($options));
+?>
+--CLEAN--
+<?php
+$filename = (dirname( __FILE__) . "/stream_filters_compress.tmp");
+if (file_exists($filename))
+	unlink($filename);
+?>
+--EXPECTF--
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+
+Warning: fopen(): The compress algorithm 'unknown' is not supported in %s on line %d
+
+Warning: %s failed to open stream: operation failed in %s on line %d
+
+Warning: fopen(): The compress filter has to be the first filter in %s on line %d
+
+Warning: %s failed to open stream: operation failed in %s on line %d
@@ -0,0 +1,118 @@
+--TEST--
+Stream io_uring context option
+--SKIPIF--
+<?php
+ob_start();
+phpinfo(INFO_MODULES);
+if (!preg_match('/io_uring Support => enabled/', ob_get_clean())) die("Skip: crypto is built without liburing");
+?>
+--FILE--
+<?php
+$filename = (dirname( __FILE__) . "/stream_filters_io_uring.tmp");
+$data = str_repeat('abcdefghij', 100000);
+
+function crypto_test_context($filter, $io_uring = true) {
+	$options = array('io_uring' => $io_uring, 'buffer_size' => 65536);
+	if ($filter) {
+		$options['filters'] = array($filter);
+	}
+	return stream_context_create(array('crypto' => $options));
+}
+
+// the test fails if the stream falls back to the BIO
+function crypto_test_uring($stream) {
+	$meta_data = stream_get_meta_data($stream);
+	var_dump(isset($meta_data['wrapper_data']) &&
+			in_array('X-PHP-Crypto-IO: io_uring', $meta_data['wrapper_data']));
+}
+
+$ctr = array(
+	'type' => 'cipher',
+	'algorithm' => 'aes-256-ctr',
+	'key' => str_repeat('k', 32),
+	'iv' => str_repeat('i', 16),
+	'seekable' => true,
+);
+$aead = array(
+	'type' => 'aead',
+	'algorithm' => 'aes-256-gcm',
+	'key' => str_repeat('k', 32),
+	'segment_size' => 10000,
+);
+
+// no filter
+$stream = fopen("crypto.file://" . $filename, "w", false, crypto_test_context(null));
+crypto_test_uring($stream);
+fwrite($stream, $data);
+fclose($stream);
+var_dump(file_get_contents($filename) === $data);
+$stream = fopen("crypto.file://" . $filename, "r", false, crypto_test_context(null));
+crypto_test_uring($stream);
+var_dump(stream_get_contents($stream) === $data);
+fclose($stream);
+
+// seekable CTR
+$stream = fopen("crypto.file://" . $filename, "w", false,
+		crypto_test_context(array('action' => 'encrypt') + $ctr));
+crypto_test_uring($stream);
+fwrite($stream, $data);
+fseek($stream, 500000);
+fwrite($stream, 'ABCDEFGHIJ');
+fclose($stream);
+$expected = substr_replace($data, 'ABCDEFGHIJ', 500000, 10);
+$stream = fopen("crypto.file://" . $filename, "r", false,
+		crypto_test_context(array('action' => 'decrypt') + $ctr, false));
+crypto_test_uring($stream);
+var_dump(stream_get_contents($stream) === $expected);
+fclose($stream);
+$stream = fopen("crypto.file://" . $filename, "r", false,
+		crypto_test_context(array('action' => 'decrypt') + $ctr));
+crypto_test_uring($stream);
+var_dump(stream_get_contents($stream) === $expected);
+fseek($stream, 499995);
+var_dump(fread($stream, 20) === substr($expected, 499995, 20));
+fseek($stream, -5, SEEK_END);
+var_dump(fread($stream, 10) === substr($expected, -5));
+fclose($stream);
+
+// aead
+$stream = fopen("crypto.file://" . $filename, "w", false,
+		crypto_test_context(array('action' => 'encrypt') + $aead));
+crypto_test_uring($stream);
+fwrite($stream, $data);
+fclose($stream);
+$stream = fopen("crypto.file://" . $filename, "r", false,
+		crypto_test_context(array('action' => 'decrypt') + $aead, false));
+var_dump(stream_get_contents($stream) === $data);
+fclose($stream);
+$stream = fopen("crypto.file://" . $filename, "r", false,
+		crypto_test_context(array('action' => 'decrypt') + $aead));
+crypto_test_uring($stream);
+var_dump(stream_get_contents($stream) === $data);
+$meta_data = stream_get_meta_data($stream);
+echo end($meta_data['wrapper_data']) . "\n";
+fclose($stream);
+?>
+--CLEAN--
+<?php
+$filename = (dirname( __FILE__) . "/stream_filters_io_uring.tmp");
+if (file_exists($filename))
+	unlink($filename);
+?>
+--EXPECT--
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(false)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+X-PHP-Crypto-Auth-Result: success
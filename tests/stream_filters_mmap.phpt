@@ -0,0 +1,68 @@
+--TEST--
+Stream mmap context option
+--FILE--
+<?php
+$filename = (dirname( __FILE__) . "/stream_filters_mmap.tmp");
+$data = str_repeat('abcdefghij', 10000);
+
+function crypto_test_context($filter, $mmap = true) {
+	$options = array('mmap' => $mmap);
+	if ($filter) {
+		$options['filters'] = array($filter);
+	}
+	return stream_context_create(array('crypto' => $options));
+}
+
+$ctr = array(
+	'type' => 'cipher',
+	'algorithm' => 'aes-256-ctr',
+	'key' => str_repeat('k', 32),
+	'iv' => str_repeat('i', 16),
+	'seekable' => true,
+);
+$aead = array(
+	'type' => 'aead',
+	'algorithm' => 'aes-256-gcm',
+	'key' => str_repeat('k', 32),
+	'segment_size' => 1000,
+);
+
+// no filter
+file_put_contents($filename, $data);
+$stream = fopen("crypto.file://" . $filename, "r", false, crypto_test_context(null));
+var_dump(stream_get_contents($stream) === $data);
+fclose($stream);
+
+// seekable CTR
+file_put_contents("crypto.file://" . $filename, $data, 0,
+		crypto_test_context(array('action' => 'encrypt') + $ctr, false));
+$stream = fopen("crypto.file://" . $filename, "r", false,
+		crypto_test_context(array('action' => 'decrypt') + $ctr));
+fseek($stream, 54321);
+var_dump(fread($stream, 10) === substr($data, 54321, 10));
+fseek($stream, -5, SEEK_END);
+var_dump(fread($stream, 10) === substr($data, -5));
+fclose($stream);
+
+// aead
+file_put_contents("crypto.file://" . $filename, $data, 0,
+		crypto_test_context(array('action' => 'encrypt') + $aead, false));
+$stream = fopen("crypto.file://" . $filename, "r", false,
+		crypto_test_context(array('action' => 'decrypt') + $aead));
+var_dump(stream_get_contents($stream) === $data);
+$meta_data = stream_get_meta_data($stream);
+echo $meta_data['wrapper_data'][0] . "\n";
+fclose($stream);
+?>
+--CLEAN--
+<?php
+$filename = (dirname( __FILE__) . "/stream_filters_mmap.tmp");
+if (file_exists($filename))
+	unlink($filename);
+?>
+--EXPECT--
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+X-PHP-Crypto-Auth-Result: success
@@ -0,0 +1,85 @@
+--TEST--
+Stream crypto.memory basic encryption
+--SKIPIF--
+<?php if (!Crypto\Cipher::hasMode(Crypto\Cipher::MODE_GCM)) die("Skip: GCM mode not defined (update OpenSSL version)"); ?>
+--FILE--
+<?php
+function crypto_test_context($filter) {
+	return stream_context_create(array(
+		'crypto' => array(
+			'filters' => array($filter)
+		),
+	));
+}
+
+$gcm = array(
+	'type' => 'cipher',
+	'action' => 'encrypt',
+	'algorithm' => 'aes-256-gcm',
+	'key' => str_repeat('x', 32),
+	'iv'  => str_repeat('i', 16),
+	'aad' => str_repeat('b', 16),
+);
+
+$stream = fopen("crypto.memory://", "w+", false, crypto_test_context($gcm));
+fwrite($stream, str_repeat('a', 8));
+fwrite($stream, str_repeat('a', 8));
+rewind($stream);
+echo bin2hex(stream_get_contents($stream)) . "\n";
+$meta_data = stream_get_meta_data($stream);
+echo $meta_data['wrapper_data'][0] . "\n";
+$stat = fstat($stream);
+var_dump($stat['size']);
+// the written data are finished when the stream is read
+fwrite($stream, 'a');
+fclose($stream);
+
+// decryption of the written data
+$stream = fopen("crypto.memory://", "w+", false,
+		crypto_test_context(array('action' => 'decrypt') + $gcm));
+fwrite($stream, hex2bin('622070d3bea6f720943d1198a7e6afa5'));
+var_dump(stream_get_contents($stream));
+$meta_data = stream_get_meta_data($stream);
+echo $meta_data['wrapper_data'][0] . "\n";
+fclose($stream);
+
+// aead segments
+$aead = array(
+	'type' => 'aead',
+	'algorithm' => 'aes-256-gcm',
+	'key' => str_repeat('k', 32),
+	'segment_size' => 32,
+);
+$data = str_repeat('abcdefghij', 10);
+$stream = fopen("crypto.memory://", "w+", false,
+		crypto_test_context(array('action' => 'encrypt') + $aead));
+fwrite($stream, $data);
+$sealed = stream_get_contents($stream);
+fclose($stream);
+var_dump(strlen($sealed));
+$filename = (dirname( __FILE__) . "/stream_memory_basic.tmp");
+file_put_contents($filename, $sealed);
+var_dump(file_get_contents("crypto.file://" . $filename, false,
+		crypto_test_context(array('action' => 'decrypt') + $aead)) === $data);
+fopen("crypto.memory://", "w+", false, crypto_test_context(array('action' => 'decrypt') + $aead));
+?>
+--CLEAN--
+<?php
+$filename = (dirname( __FILE__) . "/stream_memory_basic.tmp");
+if (file_exists($filename))
+	unlink($filename);
+?>
+--EXPECTF--
+622070d3bea6f720943d1198a7e6afa5
+X-PHP-Crypto-Auth-Tag: f3c2954804f101d3342f6b37ba46ac8e
+int(16)
+
+Warning: fwrite(): The memory stream cannot be written after it is read in %s on line %d
+string(16) "aaaaaaaaaaaaaaaa"
+X-PHP-Crypto-Auth-Result: success
+int(208)
+bool(true)
+
+Warning: fopen(): The seekable cipher and aead decryption are not supported in the memory stream in %s on line %d
+
+Warning: %s failed to open stream: operation failed in %s on line %d
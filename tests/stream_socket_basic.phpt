@@ -0,0 +1,79 @@
+--TEST--
+Stream crypto.socket with non-blocking read and stream_select
+--SKIPIF--
+<?php if (substr(PHP_OS, 0, 3) == 'WIN') die("Skip: Unix sockets only"); ?>
+--FILE--
+<?php
+$key = str_repeat('k', 32);
+$iv = str_repeat('i', 16);
+$cipher = new Crypto\Cipher('aes-256-ctr');
+$path = sys_get_temp_dir() . '/crypto_stream_socket_basic.sock';
+if (file_exists($path))
+	unlink($path);
+
+function crypto_test_context($action, $key, $iv) {
+	return stream_context_create(array(
+		'crypto' => array(
+			'filters' => array(
+				array(
+					'type' => 'cipher',
+					'action' => $action,
+					'algorithm' => 'aes-256-ctr',
+					'key' => $key,
+					'iv' => $iv,
+				)
+			)
+		),
+	));
+}
+
+$server = stream_socket_server("unix://" . $path);
+
+// encrypted writing
+$writer = fopen("crypto.socket://" . $path, "r+", false, crypto_test_context('encrypt', $key, $iv));
+$peer = stream_socket_accept($server);
+fwrite($writer, "hello");
+$sealed = fread($peer, 100);
+var_dump($sealed !== "hello");
+var_dump($cipher->decrypt($sealed, $key, $iv));
+fclose($writer);
+fclose($peer);
+
+// non-blocking decrypted reading
+$reader = fopen("crypto.socket://" . $path, "r+", false, crypto_test_context('decrypt', $key, $iv));
+$peer = stream_socket_accept($server);
+var_dump(stream_set_blocking($reader, false));
+var_dump(fread($reader, 100));
+var_dump(feof($reader));
+$read = array($reader);
+$write = $except = null;
+var_dump(stream_select($read, $write, $except, 0));
+fwrite($peer, $cipher->encrypt("world", $key, $iv));
+$read = array($reader);
+var_dump(stream_select($read, $write, $except, 1));
+var_dump(fread($reader, 100));
+fclose($peer);
+fclose($reader);
+fclose($server);
+
+fopen("crypto.socket://" . $path, "r+");
+?>
+--CLEAN--
+<?php
+$path = sys_get_temp_dir() . '/crypto_stream_socket_basic.sock';
+if (file_exists($path))
+	unlink($path);
+?>
+--EXPECTF--
+bool(true)
+string(5) "hello"
+bool(true)
+string(0) ""
+bool(false)
+int(0)
+int(1)
+string(5) "world"
+
+Warning: fopen(): The socket connection to '%s' failed: %s in %s on line %d
+
+Warning: %s failed to open stream: operation failed in %s on line %d
@@ -0,0 +1,48 @@
+--TEST--
+Stream crypto.temp spilling to the temporary file
+--FILE--
+<?php
+$ctr = array(
+	'type' => 'cipher',
+	'algorithm' => 'aes-256-ctr',
+	'key' => str_repeat('k', 32),
+	'iv' => str_repeat('i', 16),
+);
+
+function crypto_test_temp($path, $filter, $data) {
+	$context = stream_context_create(array('crypto' => array('filters' => array($filter))));
+	$stream = fopen($path, "w+", false, $context);
+	foreach (str_split($data, 1000) as $chunk) {
+		fwrite($stream, $chunk);
+	}
+	fseek($stream, 54321);
+	$part = fread($stream, 10);
+	rewind($stream);
+	$result = stream_get_contents($stream);
+	fclose($stream);
+	if ($part !== substr($result, 54321, 10)) {
+		echo "Seek failed\n";
+	}
+	return $result;
+}
+
+$data = str_repeat('abcdefghij', 10000);
+$memory = crypto_test_temp("crypto.memory://", array('action' => 'encrypt') + $ctr, $data);
+// default limit (2 MiB) keeps the data in memory
+$temp = crypto_test_temp("crypto.temp://", array('action' => 'encrypt') + $ctr, $data);
+var_dump($temp === $memory);
+// the data are moved to the file after 4096 bytes
+$temp = crypto_test_temp("crypto.temp://maxmemory:4096", array('action' => 'encrypt') + $ctr, $data);
+var_dump($temp === $memory);
+$temp = crypto_test_temp("crypto.temp://maxmemory:0", array('action' => 'decrypt') + $ctr, $memory);
+var_dump($temp === $data);
+fopen("crypto.temp://maxmemory:-1", "w+");
+?>
+--EXPECTF--
+bool(true)
+bool(true)
+bool(true)
+
+Warning: fopen(): The temp stream max memory has to be a non-negative integer in %s on line %d
+
+Warning: %s failed to open stream: operation failed in %s on line %d
@@ -76,6 +76,36 @@ class Apidoc {
 				'parent' => 'Crypto\KDFException',
 				'description' => 'Exception class for PBKDF2 errors',
 			),
+			array(
+				'name' => 'Crypto\Scrypt',
+				'parent' => 'Crypto\KDF',
+				'description' => 'Class providing scrypt functionality',
+			),
+			array(
+				'name' => 'Crypto\ScryptException',
+				'parent' => 'Crypto\KDFException',
+				'description' => 'Exception class for scrypt errors',
+			),
+			array(
+				'name' => 'Crypto\HKDF',
+				'parent' => 'Crypto\KDF',
+				'description' => 'Class providing HKDF functionality',
+			),
+			array(
+				'name' => 'Crypto\HKDFException',
+				'parent' => 'Crypto\KDFException',
+				'description' => 'Exception class for HKDF errors',
+			),
+			array(
+				'name' => 'Crypto\Argon2',
+				'parent' => 'Crypto\KDF',
+				'description' => 'Class providing Argon2id functionality',
+			),
+			array(
+				'name' => 'Crypto\Argon2Exception',
+				'parent' => 'Crypto\KDFException',
+				'description' => 'Exception class for Argon2 errors',
+			),
 			array(
 				'name' => 'Crypto\Base64',
 				'description' => 'Class for base64 encoding and docoding',
@@ -127,6 +157,18 @@ class Apidoc {
 					'name' => 'PBKDF2',
 					'file' => '/crypto_kdf.c',
 				),
+				'Crypto\ScryptException' => array(
+					'name' => 'Scrypt',
+					'file' => '/crypto_kdf.c',
+				),
+				'Crypto\HKDFException' => array(
+					'name' => 'HKDF',
+					'file' => '/crypto_kdf.c',
+				),
+				'Crypto\Argon2Exception' => array(
+					'name' => 'Argon2',
+					'file' => '/crypto_kdf.c',
+				),
 				'Crypto\Base64Exception' => array(
 					'name' => 'Base64',
 					'file' => '/crypto_base64.c',
@@ -0,0 +1,32 @@
+<?php
+/**
+ * Benchmark of Argon2 derivation for different number of lanes
+ *
+ * Usage: php -d crypto.threads=8 bench_argon2.php [memory_cost_kib] [time_cost] [repeats]
+ */
+
+$memory_cost = isset($argv[1]) ? (int) $argv[1] : 262144;
+$time_cost = isset($argv[2]) ? (int) $argv[2] : 3;
+$repeats = isset($argv[3]) ? (int) $argv[3] : 3;
+
+$salt = Crypto\Rand::generate(16);
+
+printf("memory %d KiB, time cost %d, %d threads\n\n", $memory_cost, $time_cost,
+	ini_get('crypto.threads'));
+printf("%-6s %14s %14s\n", 'lanes', 'first [ms]', 'reused [ms]');
+foreach (array(1, 2, 4, 8, 16) as $lanes) {
+	$argon2 = new Crypto\Argon2(32, $salt, $memory_cost, $time_cost, $lanes);
+
+	// the first derivation may allocate the arena
+	$start = microtime(true);
+	$argon2->derive('password');
+	$first = (microtime(true) - $start) * 1000;
+
+	$start = microtime(true);
+	for ($i = 0; $i < $repeats; $i++) {
+		$argon2->derive('password');
+	}
+	$reused = (microtime(true) - $start) * 1000 / $repeats;
+
+	printf("%-6d %14.1f %14.1f\n", $lanes, $first, $reused);
+}
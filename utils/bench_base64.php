@@ -0,0 +1,43 @@
+<?php
+/**
+ * Benchmark of Base64 encoding and decoding compared to base64_encode
+ *
+ * Usage: php bench_base64.php [size] [iterations]
+ */
+
+$size = isset($argv[1]) ? (int) $argv[1] : 1048576;
+$iterations = isset($argv[2]) ? (int) $argv[2] : 200;
+
+$data = Crypto\Rand::generate($size);
+$encoded = Crypto\Base64::encode($data);
+$native = base64_encode($data);
+
+function bench_base64_rate($callback, $arg, $size, $iterations)
+{
+	$start = microtime(true);
+	for ($i = 0; $i < $iterations; $i++) {
+		$callback($arg);
+	}
+
+	return $size * $iterations / (microtime(true) - $start) / 1e9;
+}
+
+$encoder = function ($data) {
+	$base64 = new Crypto\Base64();
+	return $base64->encodeUpdate($data) . $base64->encodeFinish();
+};
+
+printf("%d bytes x %d iterations\n\n", $size, $iterations);
+printf("%-32s %10s\n", 'method', 'GB/s');
+printf("%-32s %10.2f\n", 'Base64::encode',
+		bench_base64_rate('Crypto\Base64::encode', $data, $size, $iterations));
+printf("%-32s %10.2f\n", 'Base64::encodeUpdate',
+		bench_base64_rate($encoder, $data, $size, $iterations));
+printf("%-32s %10.2f\n", 'base64_encode',
+		bench_base64_rate('base64_encode', $data, $size, $iterations));
+printf("%-32s %10.2f\n", 'Base64::decode',
+		bench_base64_rate('Crypto\Base64::decode', $encoded, $size, $iterations));
+printf("%-32s %10.2f\n", 'Base64::decode (no new lines)',
+		bench_base64_rate('Crypto\Base64::decode', $native, $size, $iterations));
+printf("%-32s %10.2f\n", 'base64_decode',
+		bench_base64_rate('base64_decode', $native, $size, $iterations));
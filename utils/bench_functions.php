@@ -0,0 +1,65 @@
+<?php
+/**
+ * Benchmark of the Crypto functions against the object API
+ *
+ * Usage: php bench_functions.php [iterations] [data_length]
+ */
+
+$iterations = isset($argv[1]) ? (int) $argv[1] : 100000;
+$data_len = isset($argv[2]) ? (int) $argv[2] : 64;
+
+$data = str_repeat('a', $data_len);
+$key = str_repeat('k', 32);
+$iv = str_repeat('i', 12);
+
+$benchmarks = array(
+	'hash sha256' => array(
+		function () use ($data) {
+			return Crypto\Hash::sha256($data)->hexdigest();
+		},
+		function () use ($data) {
+			return Crypto\hash('sha256', $data);
+		},
+	),
+	'hmac sha256' => array(
+		function () use ($data, $key) {
+			$hmac = new Crypto\HMAC($key, 'sha256');
+			return $hmac->update($data)->hexdigest();
+		},
+		function () use ($data, $key) {
+			return Crypto\hmac('sha256', $data, $key);
+		},
+	),
+	'encrypt aes-256-gcm' => array(
+		function () use ($data, $key, $iv) {
+			$cipher = new Crypto\Cipher('aes-256-gcm');
+			$ct = $cipher->encrypt($data, $key, $iv);
+			return $ct . $cipher->getTag();
+		},
+		function () use ($data, $key, $iv) {
+			$ct = Crypto\encrypt('aes-256-gcm', $data, $key, $iv, $tag);
+			return $ct . $tag;
+		},
+	),
+);
+
+function crypto_bench_run($callback, $iterations) {
+	$start = microtime(true);
+	for ($i = 0; $i < $iterations; $i++) {
+		$callback();
+	}
+	return microtime(true) - $start;
+}
+
+printf("%d iterations, %d bytes of data\n\n", $iterations, $data_len);
+printf("%-22s %12s %12s %9s\n", 'benchmark', 'object [s]', 'function [s]', 'speedup');
+foreach ($benchmarks as $name => $callbacks) {
+	list($object_callback, $function_callback) = $callbacks;
+	if ($object_callback() !== $function_callback()) {
+		die("Results for $name differ\n");
+	}
+	$object_time = crypto_bench_run($object_callback, $iterations);
+	$function_time = crypto_bench_run($function_callback, $iterations);
+	printf("%-22s %12.4f %12.4f %8.2fx\n", $name,
+		$object_time, $function_time, $object_time / $function_time);
+}
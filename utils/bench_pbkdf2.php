@@ -0,0 +1,41 @@
+<?php
+/**
+ * Benchmark of PBKDF2::derive against PBKDF2::deriveMany
+ *
+ * Usage: php -d crypto.threads=1 bench_pbkdf2.php [iterations] [count]
+ */
+
+$iterations = isset($argv[1]) ? (int) $argv[1] : 10000;
+$count = isset($argv[2]) ? (int) $argv[2] : 16;
+
+$passwords = array();
+$salts = array();
+for ($i = 0; $i < $count; $i++) {
+	$passwords[] = "password $i";
+	$salts[] = Crypto\Rand::generate(16);
+}
+
+printf("%d iterations, %d keys, %d threads\n\n", $iterations, $count,
+	ini_get('crypto.threads'));
+printf("%-8s %18s %18s %9s\n", 'hash', 'derive [keys/s]', 'deriveMany [keys/s]', 'speedup');
+foreach (array('sha1', 'sha256', 'sha512') as $alg) {
+	$pbkdf2 = new Crypto\PBKDF2($alg, 32, NULL, $iterations);
+
+	$start = microtime(true);
+	$keys = array();
+	foreach ($passwords as $i => $password) {
+		$pbkdf2->setSalt($salts[$i]);
+		$keys[] = $pbkdf2->derive($password);
+	}
+	$derive_rate = $count / (microtime(true) - $start);
+
+	$start = microtime(true);
+	$many_keys = $pbkdf2->deriveMany($passwords, $salts);
+	$many_rate = $count / (microtime(true) - $start);
+
+	if ($keys !== $many_keys) {
+		die("Results for $alg differ\n");
+	}
+	printf("%-8s %18.1f %18.1f %8.2fx\n", $alg, $derive_rate, $many_rate,
+		$many_rate / $derive_rate);
+}
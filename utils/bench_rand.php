@@ -0,0 +1,23 @@
+<?php
+/**
+ * Benchmark of Rand::generate for OpenSSL and buffered backend
+ *
+ * Usage: php bench_rand.php [calls]
+ */
+
+$calls = isset($argv[1]) ? (int) $argv[1] : 1000000;
+
+printf("%d calls\n\n", $calls);
+printf("%-6s %16s %16s\n", 'bytes', 'openssl [ns]', 'buffered [ns]');
+foreach (array(8, 16, 32, 64, 256) as $bytes) {
+	$results = array();
+	foreach (array('openssl', 'buffered') as $backend) {
+		ini_set('crypto.rand_backend', $backend);
+		$start = microtime(true);
+		for ($i = 0; $i < $calls; $i++) {
+			Crypto\Rand::generate($bytes);
+		}
+		$results[] = (microtime(true) - $start) * 1e9 / $calls;
+	}
+	printf("%-6d %16.1f %16.1f\n", $bytes, $results[0], $results[1]);
+}
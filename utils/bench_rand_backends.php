@@ -0,0 +1,73 @@
+<?php
+/**
+ * Benchmark of throughput and p99 latency of Rand::generate backends
+ * for 1, 8 and 32 concurrent workers
+ *
+ * The workers are threads if the parallel extension is loaded (ZTS build),
+ * otherwise they are forked processes (requires pcntl).
+ *
+ * Usage: php bench_rand_backends.php [calls_per_worker] [bytes]
+ */
+
+$calls = isset($argv[1]) ? (int) $argv[1] : 20000;
+$bytes = isset($argv[2]) ? (int) $argv[2] : 16;
+
+$use_threads = extension_loaded('parallel');
+if (!$use_threads && !function_exists('pcntl_fork')) {
+	die("The parallel or pcntl extension is required\n");
+}
+
+// returns the list of call latencies in nanoseconds
+$bench = function ($backend, $calls, $bytes) {
+	ini_set('crypto.rand_backend', $backend);
+	$latencies = array();
+	for ($i = 0; $i < $calls; $i++) {
+		$start = hrtime(true);
+		Crypto\Rand::generate($bytes);
+		$latencies[] = hrtime(true) - $start;
+	}
+	return $latencies;
+};
+
+function run_workers($bench, $workers, $backend, $calls, $bytes, $use_threads) {
+	$latencies = array();
+	if ($use_threads) {
+		$futures = array();
+		for ($i = 0; $i < $workers; $i++) {
+			$runtime = new parallel\Runtime();
+			$futures[] = $runtime->run($bench, array($backend, $calls, $bytes));
+		}
+		foreach ($futures as $future) {
+			$latencies = array_merge($latencies, $future->value());
+		}
+		return $latencies;
+	}
+
+	$files = array();
+	for ($i = 0; $i < $workers; $i++) {
+		$files[$i] = tempnam(sys_get_temp_dir(), 'crypto_rand');
+		if (pcntl_fork() === 0) {
+			file_put_contents($files[$i], serialize($bench($backend, $calls, $bytes)));
+			exit(0);
+		}
+	}
+	while (pcntl_wait($status) > 0);
+	foreach ($files as $file) {
+		$latencies = array_merge($latencies, unserialize(file_get_contents($file)));
+		unlink($file);
+	}
+	return $latencies;
+}
+
+printf("%d calls of %d bytes per %s\n\n", $calls, $bytes, $use_threads ? 'thread' : 'process');
+printf("%-10s %8s %14s %10s\n", 'backend', 'workers', 'calls/s', 'p99 [ns]');
+foreach (array('openssl', 'getrandom', 'buffered') as $backend) {
+	foreach (array(1, 8, 32) as $workers) {
+		$start = microtime(true);
+		$latencies = run_workers($bench, $workers, $backend, $calls, $bytes, $use_threads);
+		$elapsed = microtime(true) - $start;
+		sort($latencies);
+		printf("%-10s %8d %14.0f %10d\n", $backend, $workers,
+			count($latencies) / $elapsed, $latencies[(int) (count($latencies) * 0.99)]);
+	}
+}
@@ -0,0 +1,70 @@
+<?php
+/**
+ * Benchmark of the sequential crypto.file stream throughput for various
+ * buffer_size context option values
+ *
+ * Usage: php bench_stream_buffer.php [size] [iterations] [algorithm]
+ */
+
+$size = isset($argv[1]) ? (int) $argv[1] : 67108864;
+$iterations = isset($argv[2]) ? (int) $argv[2] : 5;
+$algorithm = isset($argv[3]) ? $argv[3] : 'aes-256-ctr';
+
+$key = Crypto\Rand::generate(32);
+$iv = Crypto\Rand::generate(16);
+$chunk = Crypto\Rand::generate(65536);
+$filename = tempnam(sys_get_temp_dir(), 'crypto');
+
+function bench_stream_buffer_context($action, $buffer_size, $algorithm, $key, $iv)
+{
+	$options = array(
+		'filters' => array(array(
+			'type' => 'cipher',
+			'action' => $action,
+			'algorithm' => $algorithm,
+			'key' => $key,
+			'iv' => $iv,
+		)),
+	);
+	if ($buffer_size) {
+		$options['buffer_size'] = $buffer_size;
+	}
+
+	return stream_context_create(array('crypto' => $options));
+}
+
+function bench_stream_buffer_rate($callback, $size, $iterations)
+{
+	$start = microtime(true);
+	for ($i = 0; $i < $iterations; $i++) {
+		$callback();
+	}
+
+	return $size * $iterations / (microtime(true) - $start) / 1048576;
+}
+
+printf("%s: %d bytes x %d iterations\n\n", $algorithm, $size, $iterations);
+printf("%-12s %12s %12s\n", 'buffer_size', 'write MB/s', 'read MB/s');
+foreach (array(0, 8192, 65536, 262144, 1048576, 4194304) as $buffer_size) {
+	$write = function () use ($filename, $buffer_size, $algorithm, $key, $iv, $chunk, $size) {
+		$context = bench_stream_buffer_context('encrypt', $buffer_size, $algorithm, $key, $iv);
+		$stream = fopen('crypto.file://' . $filename, 'w', false, $context);
+		for ($written = 0; $written < $size; $written += strlen($chunk)) {
+			fwrite($stream, $chunk);
+		}
+		fclose($stream);
+	};
+	$read = function () use ($filename, $buffer_size, $algorithm, $key, $iv) {
+		$context = bench_stream_buffer_context('decrypt', $buffer_size, $algorithm, $key, $iv);
+		$stream = fopen('crypto.file://' . $filename, 'r', false, $context);
+		while (!feof($stream)) {
+			fread($stream, 65536);
+		}
+		fclose($stream);
+	};
+	printf("%-12s %12.1f %12.1f\n", $buffer_size ? $buffer_size : 'default',
+			bench_stream_buffer_rate($write, $size, $iterations),
+			bench_stream_buffer_rate($read, $size, $iterations));
+}
+
+unlink($filename);
@@ -0,0 +1,73 @@
+<?php
+/**
+ * Benchmark of the crypto.cipher stream filter compared to the crypto.file
+ * stream with cipher filters context
+ *
+ * Usage: php bench_stream_cipher.php [size] [iterations] [algorithm]
+ */
+
+$size = isset($argv[1]) ? (int) $argv[1] : 16777216;
+$iterations = isset($argv[2]) ? (int) $argv[2] : 10;
+$algorithm = isset($argv[3]) ? $argv[3] : 'aes-256-gcm';
+
+$params = array(
+	'action' => 'encrypt',
+	'algorithm' => $algorithm,
+	'key' => Crypto\Rand::generate(32),
+	'iv' => Crypto\Rand::generate(16),
+);
+
+$filename = tempnam(sys_get_temp_dir(), 'crypto');
+file_put_contents($filename, Crypto\Rand::generate($size));
+
+function bench_stream_cipher_rate($callback, $size, $iterations)
+{
+	$start = microtime(true);
+	for ($i = 0; $i < $iterations; $i++) {
+		$callback();
+	}
+
+	return $size * $iterations / (microtime(true) - $start) / 1e6;
+}
+
+$wrapper_read = function () use ($filename, $params) {
+	$context = stream_context_create(array(
+		'crypto' => array(
+			'filters' => array(array('type' => 'cipher') + $params)
+		),
+	));
+	$stream = fopen('crypto.file://' . $filename, 'r', false, $context);
+	while (!feof($stream)) {
+		fread($stream, 65536);
+	}
+	fclose($stream);
+};
+
+$filter_read = function () use ($filename, $params) {
+	$stream = fopen($filename, 'r');
+	stream_filter_append($stream, 'crypto.cipher', STREAM_FILTER_READ, $params);
+	while (!feof($stream)) {
+		fread($stream, 65536);
+	}
+	fclose($stream);
+};
+
+$filter_copy = function () use ($filename, $params) {
+	$in = fopen($filename, 'r');
+	$out = fopen('php://temp/maxmemory:0', 'w');
+	stream_filter_append($out, 'crypto.cipher', STREAM_FILTER_WRITE, $params);
+	stream_copy_to_stream($in, $out);
+	fclose($out);
+	fclose($in);
+};
+
+printf("%s: %d bytes x %d iterations\n\n", $algorithm, $size, $iterations);
+printf("%-32s %10s\n", 'method', 'MB/s');
+printf("%-32s %10.0f\n", 'crypto.file (read)',
+		bench_stream_cipher_rate($wrapper_read, $size, $iterations));
+printf("%-32s %10.0f\n", 'crypto.cipher (read)',
+		bench_stream_cipher_rate($filter_read, $size, $iterations));
+printf("%-32s %10.0f\n", 'crypto.cipher (copy to temp)',
+		bench_stream_cipher_rate($filter_copy, $size, $iterations));
+
+unlink($filename);
@@ -0,0 +1,52 @@
+<?php
+/**
+ * Benchmark of the pipelined aead stream writer for various numbers
+ * of worker threads
+ *
+ * Usage: php bench_stream_pipeline.php [size] [iterations] [segment_size]
+ */
+
+$size = isset($argv[1]) ? (int) $argv[1] : 268435456;
+$iterations = isset($argv[2]) ? (int) $argv[2] : 3;
+$segment_size = isset($argv[3]) ? (int) $argv[3] : 65536;
+
+$key = Crypto\Rand::generate(32);
+$chunk = Crypto\Rand::generate(65536);
+$filename = tempnam(sys_get_temp_dir(), 'crypto');
+
+function bench_stream_pipeline_rate($threads, $filename, $key, $chunk,
+		$size, $segment_size, $iterations)
+{
+	$context = stream_context_create(array(
+		'crypto' => array(
+			'filters' => array(array(
+				'type' => 'aead',
+				'action' => 'encrypt',
+				'algorithm' => 'aes-256-gcm',
+				'key' => $key,
+				'segment_size' => $segment_size,
+				'threads' => $threads,
+			))
+		),
+	));
+	$start = microtime(true);
+	for ($i = 0; $i < $iterations; $i++) {
+		$stream = fopen('crypto.file://' . $filename, 'w', false, $context);
+		for ($written = 0; $written < $size; $written += strlen($chunk)) {
+			fwrite($stream, $chunk);
+		}
+		fclose($stream);
+	}
+
+	return $size * $iterations / (microtime(true) - $start) / 1048576;
+}
+
+printf("aes-256-gcm: %d bytes x %d iterations, %d bytes segments\n\n",
+		$size, $iterations, $segment_size);
+printf("%-10s %10s\n", 'threads', 'MB/s');
+foreach (array(0, 1, 2, 4, 8, 16) as $threads) {
+	printf("%-10d %10.1f\n", $threads, bench_stream_pipeline_rate($threads,
+			$filename, $key, $chunk, $size, $segment_size, $iterations));
+}
+
+unlink($filename);
@@ -0,0 +1,85 @@
+<?php
+/**
+ * Benchmark of the sequential crypto.file stream encryption and decryption
+ * with and without the io_uring context option
+ *
+ * Usage: php bench_stream_uring.php [size] [iterations] [buffer_size] [dir]
+ */
+
+$size = isset($argv[1]) ? (int) $argv[1] : 268435456;
+$iterations = isset($argv[2]) ? (int) $argv[2] : 3;
+$buffer_size = isset($argv[3]) ? (int) $argv[3] : 131072;
+$dir = isset($argv[4]) ? $argv[4] : sys_get_temp_dir();
+
+$key = Crypto\Rand::generate(32);
+$iv = Crypto\Rand::generate(16);
+$chunk = Crypto\Rand::generate(65536);
+$filename = tempnam($dir, 'crypto');
+
+$filters = array(
+	'ctr' => array(
+		'type' => 'cipher',
+		'algorithm' => 'aes-256-ctr',
+		'key' => $key,
+		'iv' => $iv,
+		'seekable' => true,
+	),
+	'aead' => array(
+		'type' => 'aead',
+		'algorithm' => 'aes-256-gcm',
+		'key' => $key,
+	),
+	'none' => null,
+);
+
+function bench_stream_uring_context($filter, $action, $io_uring, $buffer_size)
+{
+	$options = array(
+		'io_uring' => $io_uring,
+		'buffer_size' => $buffer_size,
+	);
+	if ($filter) {
+		$options['filters'] = array(array('action' => $action) + $filter);
+	}
+
+	return stream_context_create(array('crypto' => $options));
+}
+
+function bench_stream_uring_rate($callback, $size, $iterations)
+{
+	$start = microtime(true);
+	for ($i = 0; $i < $iterations; $i++) {
+		$callback();
+	}
+
+	return $size * $iterations / (microtime(true) - $start) / 1048576;
+}
+
+printf("%d bytes x %d iterations, buffer %d bytes, %s\n\n",
+		$size, $iterations, $buffer_size, $dir);
+printf("%-6s %-9s %12s %12s\n", 'filter', 'io_uring', 'write MB/s', 'read MB/s');
+foreach ($filters as $name => $filter) {
+	foreach (array(false, true) as $io_uring) {
+		$write = function () use ($filename, $filter, $io_uring, $buffer_size, $chunk, $size) {
+			$context = bench_stream_uring_context($filter, 'encrypt', $io_uring, $buffer_size);
+			$stream = fopen('crypto.file://' . $filename, 'w', false, $context);
+			for ($written = 0; $written < $size; $written += strlen($chunk)) {
+				fwrite($stream, $chunk);
+			}
+			fclose($stream);
+		};
+		$read = function () use ($filename, $filter, $io_uring, $buffer_size) {
+			$context = bench_stream_uring_context($filter, 'decrypt', $io_uring, $buffer_size);
+			$stream = fopen('crypto.file://' . $filename, 'r', false, $context);
+			while (!feof($stream)) {
+				fread($stream, 65536);
+			}
+			fclose($stream);
+		};
+		printf("%-6s %-9s %12.1f %12.1f\n", $name, $io_uring ? 'on' : 'off',
+				bench_stream_uring_rate($write, $size, $iterations),
+				bench_stream_uring_rate($read, $size, $iterations));
+	}
+}
+
+unlink($filename);
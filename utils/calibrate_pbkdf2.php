@@ -0,0 +1,21 @@
+<?php
+/**
+ * Prints PBKDF2 iterations per millisecond for all available digests
+ *
+ * Usage: php calibrate_pbkdf2.php [target_millis] [key_length]
+ */
+
+$target = isset($argv[1]) ? (int) $argv[1] : 100;
+$length = isset($argv[2]) ? (int) $argv[2] : 0;
+
+printf("target %d ms, key length %s\n\n", $target, $length ? $length : 'digest size');
+printf("%-24s %14s %14s\n", 'hash', 'iterations', 'iterations/ms');
+foreach (Crypto\Hash::getAlgorithms() as $alg) {
+	try {
+		$iterations = Crypto\PBKDF2::calibrate($target, $alg, $length);
+		printf("%-24s %14d %14.1f\n", $alg, $iterations, $iterations / $target);
+	}
+	catch (Crypto\KDFException $e) {
+		printf("%-24s %14s %14s\n", $alg, 'n/a', 'n/a');
+	}
+}